@@ -0,0 +1,200 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+/*!
+@file
+@ingroup ExamplePrograms
+@brief Compares the matching of BRIEF descriptors with a distance matrix and with the QVBinaryDescriptorMatcher class.
+
+@section UsageBRIEFMatchingBenchmark Usage of the program.
+Compile and execute the application with the following line:
+@code ./brief-matching-benchmark [databaseSize queries descriptorInts] @endcode
+
+The program creates a database of random binary descriptors, and a set of query descriptors. Four out of five query
+descriptors are copies of a database descriptor with some random bits flipped, and the rest are random. The nearest and
+second nearest database descriptors for each query are found:
+
+- Filling a QVMatrix with the distance between each pair of descriptors, evaluated with QVBRIEFDetector::distance, and
+then looking for the two lowest values in each row of the matrix. This is the matching pattern shown in the documentation
+of QVBRIEFDetector.
+- With a QVBinaryDescriptorMatcher object using brute force search, for each instruction set supported by the processor.
+- With a QVBinaryDescriptorMatcher object using an LSH index, for the different levels of multi-probe search.
+
+For each method, the program prints the number of query descriptors matched per second. For the brute force search it
+also checks that the distances found equal those obtained with the distance matrix, printing the string '[** FAILED **]'
+otherwise. For the LSH search it prints the recall: the fraction of the queries matched with the distance matrix, which
+are also matched to the same database descriptor with the LSH index.
+*/
+
+#include <iostream>
+#include <QVector>
+#include <QString>
+#include <QThread>
+#include <QVMatrix>
+#include <QVBRIEFDetector>
+#include <QVBinaryDescriptorMatcher>
+#include <qvip/qvsimd.h>
+
+int databaseSize, numQueries, descriptorInts;
+QVector<unsigned int> database, queries;
+
+// Nearest and second nearest distances, and index of the nearest database descriptor for each query.
+QVector<int> referenceIndexes, referenceDistances, referenceSecondDistances;
+
+unsigned int randomInt()
+	{
+	return (unsigned int)(qrand() & 0xffff) | ((unsigned int)(qrand() & 0xffff) << 16);
+	}
+
+void createDescriptors()
+	{
+	database = QVector<unsigned int>(databaseSize * descriptorInts);
+	for(int i = 0; i < database.size(); i++)
+		database[i] = randomInt();
+
+	queries = QVector<unsigned int>(numQueries * descriptorInts);
+	for(int q = 0; q < numQueries; q++)
+		{
+		const int source = qrand() % databaseSize;
+		for(int i = 0; i < descriptorInts; i++)
+			{
+			unsigned int value = database[source * descriptorInts + i];
+			if (q % 5 == 0)
+				value = randomInt();
+			else
+				for(int flip = 0; flip < 3; flip++)
+					if (qrand() % 4 == 0)
+						value ^= 1u << (qrand() % 32);
+			queries[q * descriptorInts + i] = value;
+			}
+		}
+	}
+
+// Matching with a distance matrix.
+double runDistanceMatrix(const QVBRIEFDetector &BRIEFDetector)
+	{
+	const long long start = getMicroseconds();
+
+	QVMatrix distanceMatrix(numQueries, databaseSize, 0.0);
+	for(int i = 0; i < numQueries; i++)
+		for(int j = 0; j < databaseSize; j++)
+			distanceMatrix(i,j) = BRIEFDetector.distance(queries, database, i, j);
+
+	const int noDistance = 32 * descriptorInts + 1;
+	referenceIndexes = QVector<int>(numQueries, -1);
+	referenceDistances = referenceSecondDistances = QVector<int>(numQueries, noDistance);
+	for(int i = 0; i < numQueries; i++)
+		for(int j = 0; j < databaseSize; j++)
+			{
+			const int distance = int(distanceMatrix(i,j));
+			if (distance < referenceDistances[i])
+				{
+				referenceSecondDistances[i] = referenceDistances[i];
+				referenceDistances[i] = distance;
+				referenceIndexes[i] = j;
+				}
+			else if (distance < referenceSecondDistances[i])
+				referenceSecondDistances[i] = distance;
+			}
+
+	return double(getMicroseconds() - start);
+	}
+
+int main(int argc, char *argv[])
+	{
+	databaseSize = (argc > 3)? atoi(argv[1]) : 10000;
+	numQueries = (argc > 3)? atoi(argv[2]) : 1000;
+	descriptorInts = (argc > 3)? atoi(argv[3]) : 4;
+
+	if (databaseSize <= 0 or numQueries <= 0 or descriptorInts <= 0)
+		{
+		std::cout << "Usage: " << argv[0] << " [databaseSize queries descriptorInts]" << std::endl;
+		return 1;
+		}
+
+	const TQVSimdLevel supportedLevel = qvSimdSupportedLevel();
+	std::cout << databaseSize << " database descriptors, " << numQueries << " queries, " << (32*descriptorInts) << " bits per descriptor, "
+				<< QThread::idealThreadCount() << " threads." << std::endl;
+	std::cout << "Supported instruction set: " << qvSimdLevelName(supportedLevel) << std::endl << std::endl;
+
+	qsrand(0);
+	createDescriptors();
+
+	const QVBRIEFDetector BRIEFDetector(descriptorInts);
+	const double matrixTime = runDistanceMatrix(BRIEFDetector);
+	std::cout << "distance matrix:\t" << QString::number(1e6 * numQueries / matrixTime, 'f', 0).toStdString() << " queries/s" << std::endl;
+
+	bool failed = false;
+	QVBinaryDescriptorMatcher matcher(descriptorInts);
+	matcher.setDatabase(database);
+	for(int level = QVSIMD_SCALAR; level <= supportedLevel; level++)
+		{
+		qvSetSimdLevel((TQVSimdLevel) level);
+
+		const long long start = getMicroseconds();
+		matcher.match(queries);
+		const double time = double(getMicroseconds() - start);
+
+		const bool equal =	matcher.getNearestDistances() == referenceDistances and
+							matcher.getSecondDistances() == referenceSecondDistances;
+
+		std::cout << "brute force " << qvSimdLevelName((TQVSimdLevel) level) << ":\t" << QString::number(1e6 * numQueries / time, 'f', 0).toStdString()
+					<< " queries/s (x" << QString::number(matrixTime / time, 'f', 1).toStdString() << ")";
+		if (not equal)
+			{
+			std::cout << " [** FAILED **]";
+			failed = true;
+			}
+		std::cout << std::endl;
+		}
+
+	const long long indexStart = getMicroseconds();
+	matcher.buildLSHIndex();
+	std::cout << "LSH index built in " << double(getMicroseconds() - indexStart) / 1000.0 << " ms" << std::endl;
+
+	for(int probeLevel = 0; probeLevel <= 2; probeLevel++)
+		{
+		matcher.setMultiProbeLevel(probeLevel);
+
+		const long long start = getMicroseconds();
+		matcher.match(queries);
+		const double time = double(getMicroseconds() - start);
+
+		int matched = 0, found = 0;
+		for(int q = 0; q < numQueries; q++)
+			if (referenceDistances[q] < 0.8 * referenceSecondDistances[q])
+				{
+				matched++;
+				if (matcher.getNearestIndexes()[q] == referenceIndexes[q])
+					found++;
+				}
+
+		std::cout << "LSH, multi-probe level " << probeLevel << ":\t" << QString::number(1e6 * numQueries / time, 'f', 0).toStdString()
+					<< " queries/s (x" << QString::number(matrixTime / time, 'f', 1).toStdString() << ")"
+					<< "\trecall: " << QString::number(double(found) / MAX(1, matched), 'f', 3).toStdString() << std::endl;
+		}
+
+	qvSetSimdLevel(supportedLevel);
+	return failed? 1 : 0;
+	}
@@ -0,0 +1,186 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+/*!
+@file
+@ingroup ExamplePrograms
+@brief Compares the generated GEA essential matrix evaluation functions with their batched SIMD versions.
+
+@section UsageEssentialBenchmark Usage of the program.
+Compile and execute the application with the following line:
+@code ./essential-benchmark [pairs blockSize iterations] @endcode
+
+The program evaluates the essential matrix and its jacobians for a set of random pairs of camera poses, with the so3 and
+quaternion rotation parametrizations. It prints the mean time per pair using the generated functions
+(so3EssentialEvaluation and quaternionEssentialEvaluation), evaluated one pair at a time, and using the batched functions
+with each instruction set supported by the processor, evaluated in blocks of 'blockSize' pairs. It also prints the
+maximal relative difference between the outputs of both versions. If it is not small, the string '[** FAILED **]' is
+printed.
+*/
+
+#include <iostream>
+#include <QVector>
+#include <QString>
+#include <qvip/qvsimd.h>
+#include <qvsfm/qvgea/so3EssentialEvaluation.h>
+#include <qvsfm/qvgea/quaternionEssentialEvaluation.h>
+#include <qvsfm/qvgea/batchedEssentialEvaluation.h>
+
+// Poses in structure of arrays layout, and outputs of the generated and the batched functions.
+int numPairs, blockSize;
+QVector<double> poses1, poses2, generatedOutput, batchedOutput;
+
+double randomValue(const double min, const double max)
+	{
+	return min + (max - min) * double(qrand()) / RAND_MAX;
+	}
+
+// Evaluates every pair with the generated functions, storing the results in structure of arrays layout.
+void runGenerated(const int dof)
+	{
+	const int size = 9 * (2*dof+1);
+	double pose1[7], pose2[7], cg[9*15];
+	for(int i = 0; i < numPairs; i++)
+		{
+		for(int k = 0; k < dof; k++)
+			{
+			pose1[k] = poses1[k*numPairs + i];
+			pose2[k] = poses2[k*numPairs + i];
+			}
+
+		if (dof == 6)
+			so3EssentialEvaluation(pose1, pose2, cg);
+		else
+			quaternionEssentialEvaluation(pose1, pose2, cg);
+
+		for(int j = 0; j < size; j++)
+			generatedOutput[j*numPairs + i] = cg[j];
+		}
+	}
+
+// Evaluates the pairs with the batched functions, in blocks of 'blockSize' pairs.
+void runBatched(const int dof)
+	{
+	const int size = 9 * (2*dof+1);
+	QVector<double> block1(dof * blockSize), block2(dof * blockSize), cg(size * blockSize);
+	for(int first = 0; first < numPairs; first += blockSize)
+		{
+		const int count = MIN(blockSize, numPairs - first);
+		for(int k = 0; k < dof; k++)
+			for(int i = 0; i < count; i++)
+				{
+				block1[k*count + i] = poses1[k*numPairs + first + i];
+				block2[k*count + i] = poses2[k*numPairs + first + i];
+				}
+
+		if (dof == 6)
+			so3EssentialEvaluationBatch(count, block1.constData(), block2.constData(), cg.data());
+		else
+			quaternionEssentialEvaluationBatch(count, block1.constData(), block2.constData(), cg.data());
+
+		for(int j = 0; j < size; j++)
+			for(int i = 0; i < count; i++)
+				batchedOutput[j*numPairs + first + i] = cg[j*count + i];
+		}
+	}
+
+// Maximal difference between both outputs for each pair, relative to the largest output value of the pair.
+double maxRelativeDifference(const int dof)
+	{
+	const int size = 9 * (2*dof+1);
+	double result = 0.0;
+	for(int i = 0; i < numPairs; i++)
+		{
+		double maxValue = 0.0, maxDifference = 0.0;
+		for(int j = 0; j < size; j++)
+			{
+			maxValue = MAX(maxValue, ABS(generatedOutput[j*numPairs + i]));
+			maxDifference = MAX(maxDifference, ABS(generatedOutput[j*numPairs + i] - batchedOutput[j*numPairs + i]));
+			}
+		result = MAX(result, maxDifference / maxValue);
+		}
+	return result;
+	}
+
+int main(int argc, char *argv[])
+	{
+	numPairs = (argc > 3)? atoi(argv[1]) : 10000;
+	blockSize = (argc > 3)? atoi(argv[2]) : 64;
+	const int iterations = (argc > 3)? atoi(argv[3]) : 20;
+
+	const TQVSimdLevel supportedLevel = qvSimdSupportedLevel();
+	std::cout << numPairs << " pairs, blocks of " << blockSize << " pairs, " << iterations << " iterations." << std::endl;
+	std::cout << "Supported instruction set: " << qvSimdLevelName(supportedLevel) << std::endl << std::endl;
+
+	qsrand(0);
+	bool failed = false;
+	for(int dof = 6; dof <= 7; dof++)
+		{
+		// Random rotations (so3 vectors or quaternions), and camera centers.
+		poses1 = poses2 = QVector<double>(dof * numPairs);
+		for(int k = 0; k < dof; k++)
+			for(int i = 0; i < numPairs; i++)
+				{
+				poses1[k*numPairs + i] = randomValue(-1.0, 1.0);
+				poses2[k*numPairs + i] = randomValue(-1.0, 1.0);
+				}
+
+		generatedOutput = batchedOutput = QVector<double>(9 * (2*dof+1) * numPairs);
+
+		std::cout << ((dof == 6)? "so3" : "quaternion") << " parametrization" << std::endl;
+
+		runGenerated(dof);
+		long long start = getMicroseconds();
+		for(int i = 0; i < iterations; i++)
+			runGenerated(dof);
+		const double generatedTime = double(getMicroseconds() - start) / (double(iterations) * numPairs);
+		std::cout << "\tgenerated: " << generatedTime << " us" << std::endl;
+
+		for(int level = QVSIMD_SCALAR; level <= supportedLevel; level++)
+			{
+			qvSetSimdLevel((TQVSimdLevel) level);
+
+			runBatched(dof);
+			const double difference = maxRelativeDifference(dof);
+
+			start = getMicroseconds();
+			for(int i = 0; i < iterations; i++)
+				runBatched(dof);
+			const double time = double(getMicroseconds() - start) / (double(iterations) * numPairs);
+
+			std::cout << "\tbatched " << qvSimdLevelName((TQVSimdLevel) level) << ": " << time << " us"
+						<< " (x" << QString::number(generatedTime / time, 'f', 2).toStdString() << ")"
+						<< "\tmax. relative difference: " << difference;
+			if (not (difference < 1e-9))
+				{
+				std::cout << " [** FAILED **]";
+				failed = true;
+				}
+			std::cout << std::endl;
+			}
+		}
+
+	qvSetSimdLevel(supportedLevel);
+	return failed? 1 : 0;
+	}
@@ -39,6 +39,10 @@ SUBDIRS = AugmentedReality/     \
           matrixalgebra-tests/  \
           movingEdgesDetector/  \
           rotoscoper/           \
+          fixedmatrix-benchmark/ \
+          essential-benchmark/  \
+          brief-matching-benchmark/ \
+          simd-benchmark/       \
 #         testGEA/              \
           SIFTGPU/                \
           userIO/               \
@@ -0,0 +1,172 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+/*!
+@file
+@ingroup ExamplePrograms
+@brief Compares the geometry functions using QVMatrix objects, with their fixed size matrix versions.
+
+@section UsageFixedMatrixBenchmark Usage of the program.
+Compile and execute the application with the following line:
+@code ./fixedmatrix-benchmark [points iterations] @endcode
+
+For each geometry function, the program prints the mean time per call using @ref QVMatrix objects, and using
+@ref QVFixedMatrix objects, and the speed-up of the latter. It also checks that both versions produce the same output,
+up to a small numerical error. If not, the string '[** FAILED **]' is printed.
+*/
+
+#include <iostream>
+#include <QVMatrix>
+#include <QVFixedMatrix>
+#include <QVCameraPose>
+#include <qvmath/qvprojective.h>
+#include <qvmath/qvepipolar.h>
+
+// Base class for the benchmarked functions. Each one accumulates a checksum of its outputs.
+class Benchmark
+	{
+	public:
+		Benchmark(const QString &name): name(name)	{ }
+		virtual ~Benchmark()						{ }
+		virtual double runHeap() = 0;
+		virtual double runFixed() = 0;
+		const QString name;
+	};
+
+#define DEFINE_BENCHMARK(CLASS, HEAP_CODE, FIXED_CODE)				\
+class CLASS: public Benchmark										\
+	{																\
+	public:															\
+		CLASS(): Benchmark(#CLASS)	{ }								\
+		double runHeap()											\
+			{														\
+			double checksum = 0.0;									\
+			for(int i = 0; i < matchings.count(); i++)				\
+				{ HEAP_CODE; }										\
+			return checksum;										\
+			}														\
+		double runFixed()											\
+			{														\
+			double checksum = 0.0;									\
+			for(int i = 0; i < matchings.count(); i++)				\
+				{ FIXED_CODE; }										\
+			return checksum;										\
+			}														\
+	};
+
+QVector<QPointFMatching> matchings;
+QVector<QVCameraPose> poses;
+QVMatrix H, F;
+QVFixedMatrix<3,3> fixedH, fixedF;
+
+DEFINE_BENCHMARK(ApplyHomography,
+	const QPointF p = applyHomography(H, matchings[i].first); checksum += p.x() + p.y(),
+	const QPointF p = applyHomography(fixedH, matchings[i].first); checksum += p.x() + p.y())
+DEFINE_BENCHMARK(SymmetricEpipolarDistance,
+	checksum += symmetricEpipolarDistance(F, matchings[i]),
+	checksum += symmetricEpipolarDistance(fixedF, matchings[i]))
+DEFINE_BENCHMARK(RotationMatrix,
+	checksum += poses[i].getOrientation().toRotationMatrix().trace(),
+	checksum += poses[i].getOrientation().toFixedRotationMatrix().trace())
+DEFINE_BENCHMARK(ProjectionProduct,
+	const QVMatrix P = poses[i].toProjectionMatrix(); checksum += (P * P.transpose()).trace(),
+	const QVFixedMatrix<3,4> P = poses[i].toFixedProjectionMatrix(); checksum += (P * P.transpose()).trace())
+DEFINE_BENCHMARK(Triangulation,
+	const QV3DPointF X = linear3DPointTriangulation(matchings[i], poses[0].toProjectionMatrix(), poses[i].toProjectionMatrix()); checksum += X.x() + X.y() + X.z(),
+	const QV3DPointF X = linear3DPointTriangulation(matchings[i], poses[0].toFixedProjectionMatrix(), poses[i].toFixedProjectionMatrix()); checksum += X.x() + X.y() + X.z())
+
+double randomValue(const double min, const double max)
+	{
+	return min + (max - min) * double(qrand()) / RAND_MAX;
+	}
+
+int main(int argc, char *argv[])
+	{
+	const int	numPoints = (argc > 2)? atoi(argv[1]) : 10000,
+				iterations = (argc > 2)? atoi(argv[2]) : 20;
+
+	qsrand(0);
+
+	// Random camera poses, looking at a point cloud located around the origin.
+	const QV3DPointF X(randomValue(-1, 1), randomValue(-1, 1), randomValue(-1, 1));
+	for(int i = 0; i < numPoints; i++)
+		{
+		const QVCameraPose	pose(	QVQuaternion(randomValue(-0.1, 0.1), randomValue(-0.1, 0.1), randomValue(-0.1, 0.1)),
+									QV3DPointF(randomValue(-1, 1), randomValue(-1, 1), randomValue(-6, -4)) );
+		poses << pose;
+
+		const QVCameraPose &firstPose = poses.first();
+
+		const QV3DPointF Y = X + QV3DPointF(randomValue(-1, 1), randomValue(-1, 1), randomValue(-1, 1));
+		matchings << QPointFMatching(firstPose.project(Y), pose.project(Y));
+		}
+
+	H = QVMatrix::identity(3);
+	F = QVMatrix(3,3);
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			{
+			H(i,j) += randomValue(-0.1, 0.1);
+			F(i,j) = randomValue(-1.0, 1.0);
+			}
+	fixedH = H;
+	fixedF = F;
+
+	QList<Benchmark *> benchmarks;
+	benchmarks	<< new ApplyHomography() << new SymmetricEpipolarDistance() << new RotationMatrix()
+				<< new ProjectionProduct() << new Triangulation();
+
+	std::cout << numPoints << " points, " << iterations << " iterations." << std::endl << std::endl;
+
+	bool failed = false;
+	foreach(Benchmark *benchmark, benchmarks)
+		{
+		std::cout << qPrintable(benchmark->name.leftJustified(28));
+
+		const double	heapChecksum = benchmark->runHeap(),
+						fixedChecksum = benchmark->runFixed();
+		if (ABS(heapChecksum - fixedChecksum) > 1e-6 * MAX(1.0, ABS(heapChecksum)))
+			{
+			std::cout << "[** FAILED **] ";
+			failed = true;
+			}
+
+		long long start = getMicroseconds();
+		for(int i = 0; i < iterations; i++)
+			benchmark->runHeap();
+		const double heapTime = double(getMicroseconds() - start) / (double(iterations) * numPoints);
+
+		start = getMicroseconds();
+		for(int i = 0; i < iterations; i++)
+			benchmark->runFixed();
+		const double fixedTime = double(getMicroseconds() - start) / (double(iterations) * numPoints);
+
+		std::cout	<< "\tQVMatrix: " << heapTime << " us"
+					<< "\tQVFixedMatrix: " << fixedTime << " us"
+					<< " (x" << QString::number(heapTime / fixedTime, 'f', 2).toStdString() << ")" << std::endl;
+		delete benchmark;
+		}
+
+	return failed? 1 : 0;
+	}
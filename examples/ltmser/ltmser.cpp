@@ -101,6 +101,8 @@ class QVLTMSERWorker: public QVProcessingBlock {
             addProperty< QList<QVPolyline> >("output_contours", outputFlag);
         }
     protected:
+        QVLTMSERExtractor extractor;
+
         void iterate() {
             // 0. Read input image and parameters:
             QVImage<uChar> input_image = getPropertyValue< QVImage<uChar> >("input_image");
@@ -115,7 +117,7 @@ class QVLTMSERWorker: public QVProcessingBlock {
             timeFlag("Read input parameters");
 
             // 1. (Possible) previous median filter:
-            QVImage< uChar > input_image_preprocessed = input_image, not_input_image_preprocessed;
+            QVImage< uChar > input_image_preprocessed = input_image;
             if(medianFilterMask > 0) {
                 FilterMedian(input_image, input_image_preprocessed,QSize(2*medianFilterMask+1, 2*medianFilterMask+1),
                              QPoint(0,0), QPoint(medianFilterMask,medianFilterMask));
@@ -123,43 +125,16 @@ class QVLTMSERWorker: public QVProcessingBlock {
             }
             timeFlag("Median filter");
 
-            // 2. Compute MSER regions:
-            QList<QVPolyline> output_contours,output_contours2;
-            QList<QVMSER> seed_list,seed_list2;
-            switch (MSERType) {
-                case 1: // MSER+
-                    seed_list = getLTMSER(input_image_preprocessed, minArea, maxArea, delta,
-                                          delta_threshold,downscale);
-                    timeFlag("MSER seeds");
-                    output_contours = getLTMSERContours(input_image_preprocessed,seed_list);
-                    timeFlag("MSER contours");
-                    // You could have also obtained directly the output contours, if you were not
-                    // interested in the seeds data:
-                    // output_contours = getLTMSER(input_image_preprocessed, minArea, maxArea,
-                    //                             delta, delta_threshold,downscale);
-                    break;
-                case 2: // MSER-
-                    Not(input_image_preprocessed,not_input_image_preprocessed);
-                    seed_list = getLTMSER(not_input_image_preprocessed, minArea, maxArea, delta,
-                                          delta_threshold,downscale);
-                    timeFlag("MSER seeds");
-                    output_contours = getLTMSERContours(not_input_image_preprocessed,seed_list);
-                    timeFlag("MSER contours");
-                    break;
-                case 3: // MSER+ y MSER-
-                    seed_list = getLTMSER(input_image_preprocessed, minArea, maxArea,
-                                          delta, delta_threshold,downscale);
-                    Not(input_image_preprocessed,not_input_image_preprocessed);
-                    seed_list2 = getLTMSER(not_input_image_preprocessed, minArea, maxArea,
-                                               delta, delta_threshold,downscale);
-                    timeFlag("MSER seeds");
-                    output_contours = getLTMSERContours(input_image_preprocessed,seed_list);
-                    output_contours2 = getLTMSERContours(not_input_image_preprocessed,seed_list2);
-                    timeFlag("MSER contours");
-                    seed_list += seed_list2;
-                    output_contours += output_contours2;
-                    break;
-            }
+            // 2. Compute MSER regions. The extractor keeps its structures between frames, and obtains MSER+ and
+            // MSER- regions concurrently when both are requested:
+            extractor.setParameters(minArea, maxArea, delta, delta_threshold, downscale);
+            extractor.detect(input_image_preprocessed, (QVLTMSERExtractor::Polarity) MSERType);
+            timeFlag("MSER seeds and contours");
+
+            QList<QVMSER> seed_list = extractor.getMSERPlus();
+            seed_list += extractor.getMSERMinus();
+            QList<QVPolyline> output_contours = extractor.getContoursPlus();
+            output_contours += extractor.getContoursMinus();
 
             // 3. Publish results:
             //Set(0,input_image_preprocessed);
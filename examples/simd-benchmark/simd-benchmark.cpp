@@ -0,0 +1,175 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+/*!
+@file
+@ingroup ExamplePrograms
+@brief Compares the scalar, SSE2 and AVX2 versions of the image functions available without the IPP.
+
+@section UsageSimdBenchmark Usage of the program.
+Compile and execute the application with the following line:
+@code ./simd-benchmark [cols rows iterations] @endcode
+
+For each image function, the program prints the mean time per call with each instruction set supported by the
+processor, and the speed-up over the scalar version. It also checks that every instruction set produces exactly the
+same output as the scalar version. If not, the string '[** FAILED **]' is printed.
+*/
+
+#include <iostream>
+#include <QVImage>
+#include <qvip/qvsimd.h>
+
+// Base class for the benchmarked functions. Each one stores the output of its last run.
+class Benchmark
+	{
+	public:
+		Benchmark(const QString &name): name(name)	{ }
+		virtual ~Benchmark()						{ }
+		virtual void run() = 0;
+		virtual bool sameOutput() const = 0;
+		virtual void saveOutput() = 0;
+		const QString name;
+	};
+
+template <typename Type, int C> class ImageBenchmark: public Benchmark
+	{
+	public:
+		ImageBenchmark(const QString &name): Benchmark(name)	{ }
+		QVImage<Type, C> output, reference;
+
+		void saveOutput()	{ reference = output; reference.detach(); }
+		bool sameOutput() const
+			{
+			if (output.getROI() != reference.getROI())
+				return false;
+
+			const QRect roi = output.getROI();
+			for(int row = roi.top(); row <= roi.bottom(); row++)
+				for(int col = roi.left(); col <= roi.right(); col++)
+					for(int c = 0; c < C; c++)
+						if (output(col, row, c) != reference(col, row, c))
+							return false;
+			return true;
+			}
+	};
+
+#define DEFINE_BENCHMARK(CLASS, TYPE, C, CODE)						\
+class CLASS: public ImageBenchmark<TYPE, C>							\
+	{																\
+	public:															\
+		CLASS(): ImageBenchmark<TYPE, C>(#CLASS)	{ }				\
+		void run()	{ CODE; }										\
+	};
+
+QVImage<uChar, 1> image8u, otherImage8u;
+QVImage<uChar, 3> image8uC3, otherImage8uC3;
+QVImage<sFloat, 1> image32f, otherImage32f;
+
+DEFINE_BENCHMARK(Add_8u_C1,			uChar, 1,	Add(image8u, otherImage8u, output, 1))
+DEFINE_BENCHMARK(Sub_8u_C1,			uChar, 1,	Sub(image8u, otherImage8u, output, 0))
+DEFINE_BENCHMARK(Mul_8u_C3,			uChar, 3,	Mul(image8uC3, otherImage8uC3, output, 8))
+DEFINE_BENCHMARK(Add_32f_C1,		sFloat, 1,	Add(image32f, otherImage32f, output))
+DEFINE_BENCHMARK(Mul_32f_C1,		sFloat, 1,	Mul(image32f, otherImage32f, output))
+DEFINE_BENCHMARK(Convert_8u32f,		sFloat, 1,	Convert(image8u, output))
+DEFINE_BENCHMARK(Convert_32f8u,		uChar, 1,	Convert(image32f, output))
+DEFINE_BENCHMARK(FilterGauss3x3_8u,	uChar, 1,	FilterGauss(image8u, output, ippMskSize3x3))
+DEFINE_BENCHMARK(FilterGauss5x5_8u,	uChar, 1,	FilterGauss(image8u, output, ippMskSize5x5))
+DEFINE_BENCHMARK(FilterGauss5x5_32f,sFloat, 1,	FilterGauss(image32f, output, ippMskSize5x5))
+DEFINE_BENCHMARK(SobelHoriz3x3_32f,	sFloat, 1,	FilterSobelHorizMask(image32f, output, ippMskSize3x3))
+DEFINE_BENCHMARK(SobelVert5x5_32f,	sFloat, 1,	FilterSobelVertMask(image32f, output, ippMskSize5x5))
+DEFINE_BENCHMARK(Resize_8u_C1,		uChar, 1,	output = QVImage<uChar>(image8u.getCols()*3/4, image8u.getRows()*3/4); Resize(image8u, output))
+DEFINE_BENCHMARK(Resize_8u_C3,		uChar, 3,	output = QVImage<uChar, 3>(image8uC3.getCols()/2, image8uC3.getRows()/2); Resize(image8uC3, output))
+DEFINE_BENCHMARK(Resize_32f,		sFloat, 1,	output = QVImage<sFloat>(image32f.getCols()*3/2, image32f.getRows()*3/2); Resize(image32f, output))
+
+int main(int argc, char *argv[])
+	{
+	const int	cols = (argc > 3)? atoi(argv[1]) : 1280,
+				rows = (argc > 3)? atoi(argv[2]) : 720,
+				iterations = (argc > 3)? atoi(argv[3]) : 50;
+
+	image8u = otherImage8u = QVImage<uChar, 1>(cols, rows);
+	image8uC3 = otherImage8uC3 = QVImage<uChar, 3>(cols, rows);
+	image32f = otherImage32f = QVImage<sFloat, 1>(cols, rows);
+
+	qsrand(0);
+	for(int row = 0; row < rows; row++)
+		for(int col = 0; col < cols; col++)
+			{
+			image8u(col, row) = qrand() % 256;
+			otherImage8u(col, row) = qrand() % 256;
+			for(int c = 0; c < 3; c++)
+				{
+				image8uC3(col, row, c) = qrand() % 256;
+				otherImage8uC3(col, row, c) = qrand() % 256;
+				}
+			image32f(col, row) = (qrand() % 100000) / 200.0 - 100.0;
+			otherImage32f(col, row) = (qrand() % 100000) / 200.0;
+			}
+
+	QList<Benchmark *> benchmarks;
+	benchmarks	<< new Add_8u_C1() << new Sub_8u_C1() << new Mul_8u_C3() << new Add_32f_C1() << new Mul_32f_C1()
+				<< new Convert_8u32f() << new Convert_32f8u()
+				<< new FilterGauss3x3_8u() << new FilterGauss5x5_8u() << new FilterGauss5x5_32f()
+				<< new SobelHoriz3x3_32f() << new SobelVert5x5_32f()
+				<< new Resize_8u_C1() << new Resize_8u_C3() << new Resize_32f();
+
+	const TQVSimdLevel supportedLevel = qvSimdSupportedLevel();
+	std::cout << "Image size: " << cols << "x" << rows << ", " << iterations << " iterations." << std::endl;
+	std::cout << "Supported instruction set: " << qvSimdLevelName(supportedLevel) << std::endl << std::endl;
+
+	bool failed = false;
+	foreach(Benchmark *benchmark, benchmarks)
+		{
+		std::cout << qPrintable(benchmark->name.leftJustified(20));
+		double scalarTime = 0.0;
+		for(int level = QVSIMD_SCALAR; level <= supportedLevel; level++)
+			{
+			qvSetSimdLevel((TQVSimdLevel) level);
+
+			benchmark->run();
+			if (level == QVSIMD_SCALAR)
+				benchmark->saveOutput();
+			else if (not benchmark->sameOutput())
+				{
+				std::cout << "[** FAILED **] ";
+				failed = true;
+				}
+
+			const long long start = getMicroseconds();
+			for(int i = 0; i < iterations; i++)
+				benchmark->run();
+			const double time = double(getMicroseconds() - start) / iterations;
+
+			if (level == QVSIMD_SCALAR)
+				scalarTime = time;
+			std::cout	<< "\t" << qvSimdLevelName((TQVSimdLevel) level) << ": " << time << " us"
+						<< " (x" << QString::number(scalarTime / time, 'f', 2).toStdString() << ")";
+			}
+		std::cout << std::endl;
+		delete benchmark;
+		}
+
+	qvSetSimdLevel(supportedLevel);
+	return failed? 1 : 0;
+	}
@@ -0,0 +1,35 @@
+#
+#   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+#   <http://perception.inf.um.es>
+#   University of Murcia, Spain.
+#
+#   This file is part of the QVision library.
+#
+#   QVision is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU Lesser General Public License as
+#   published by the Free Software Foundation, version 3 of the License.
+#
+#   QVision is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU Lesser General Public License for more details.
+#
+#   You should have received a copy of the GNU Lesser General Public
+#   License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+
+##############################
+#
+#   File simd-benchmark.pro
+#
+
+include(../../qvproject.pri)
+
+qvipp_available {
+		warning(in example \'simd-benchmark\'. The built-in pixel kernels are only used when QVision is configured without the IPP. See file \'config.pri\'.)
+		TEMPLATE = subdirs
+		SUBDIRS =
+		}
+else	{
+		TARGET = simd-benchmark
+		SOURCES += simd-benchmark.cpp
+		}
@@ -39,6 +39,8 @@
     HEADERS +=  $$PWD/qvblockprogramming/qvguiblocks/qvimagecanvas.h \
                 $$PWD/qvblockprogramming/qvapplication.h             \
                 $$PWD/qvblockprogramming/qvprocessingblock.h         \
+                $$PWD/qvblockprogramming/qvblockscheduler.h          \
+                $$PWD/qvblockprogramming/qvlinkringbuffer.h          \
                 $$PWD/qvblockprogramming/qvpropertycontainer.h       \
                 $$PWD/qvblockprogramming/qvpropertycontainerchange.h \
                 $$PWD/qvblockprogramming/qvcpustat.h                 \
@@ -47,6 +49,7 @@
     SOURCES +=  $$PWD/qvblockprogramming/qvguiblocks/qvimagecanvas.cpp \
                 $$PWD/qvblockprogramming/qvapplication.cpp             \
                 $$PWD/qvblockprogramming/qvprocessingblock.cpp         \
+                $$PWD/qvblockprogramming/qvblockscheduler.cpp          \
                 $$PWD/qvblockprogramming/qvpropertycontainer.cpp       \
                 $$PWD/qvblockprogramming/qvpropertycontainerchange.cpp \
                 $$PWD/qvblockprogramming/qvcpustat.cpp                 \
@@ -31,13 +31,15 @@
 #include <QVGUI>
 #include <QVImageCanvas>
 #include <QVProcessingBlock>
+#include <QVBlockScheduler>
 #include <QMutexLocker>
 
 #ifdef QVQWT
 #include "qvguiblocks/qvplot.h"
 #endif
 
-QVApplication::QVApplication (int &argc,char **argv, QString infoString,bool GUIenabled) : QApplication(argc,argv,GUIenabled), info(infoString), unusedArguments(), qvps(), visionInterface(NULL), isRunningFlag(FALSE), blockCount(0), terminateOnLastBlock(TRUE), forHelpFlag(FALSE)
+QVApplication::QVApplication (int &argc,char **argv, QString infoString,bool GUIenabled) : QApplication(argc,argv,GUIenabled), info(infoString), unusedArguments(), qvps(), visionInterface(NULL), isRunningFlag(FALSE), blockCount(0), terminateOnLastBlock(TRUE), forHelpFlag(FALSE),
+	schedulingMode(ThreadScheduling), schedulingThreads(0), scheduler(NULL)
 	{
 
 	if (GUIenabled and not QGLFormat::hasOpenGL() )
@@ -46,6 +48,7 @@ QVApplication::QVApplication (int &argc,char **argv, QString infoString,bool GUI
 	qRegisterMetaType< QVariant >("QVariant");
 	//qRegisterMetaType< QVCamera::TCameraStatus >("QVCamera::TCameraStatus");
 	qRegisterMetaType< QVProcessingBlock::TBlockStatus >("QVProcessingBlock::TBlockStatus");
+	qRegisterMetaType< QVProcessingBlock * >("QVProcessingBlock *");
 	qRegisterMetaType< QVImage<uChar,1> >("QVImage<uChar,1>");
 	qRegisterMetaType< QVImage<sShort,1> >("QVImage<sShort,1>");
 	qRegisterMetaType< QVImage<sFloat,1> >("QVImage<sFloat,1>");
@@ -176,7 +179,29 @@ bool QVApplication::startItems()
 	qDebug() << "QVApplication::initItems(): canvas shown";
 
 	// Now we will start all blocks:
-	foreach(QVPropertyContainer* qvp, qvps)
+	if (schedulingMode == PoolScheduling)
+		{
+		// Blocks stay in the main thread, and the scheduler executes the sequential groups on its worker threads.
+		QList<QVProcessingBlock *> masters;
+		foreach(QVPropertyContainer* qvp, qvps)
+			{
+			QVProcessingBlock* block;
+			if((block = dynamic_cast<QVProcessingBlock*>(qvp)) != NULL and block->isSequentialGroupMaster())
+				{
+				blockCount++;
+				masters << block;
+				}
+			}
+
+		if (scheduler == NULL)
+			{
+			scheduler = new QVBlockScheduler(schedulingThreads);
+			scheduler->setParent(this);
+			connect(scheduler,SIGNAL(groupFinished(QVProcessingBlock *)),this,SLOT(blockFinished()));
+			}
+		scheduler->start(masters);
+		}
+	else foreach(QVPropertyContainer* qvp, qvps)
 		{
 		QVProcessingBlock* block;
 		if((block = dynamic_cast<QVProcessingBlock*>(qvp)) != NULL)
@@ -218,6 +243,9 @@ void QVApplication::quitItems()
 		}
 	// ... and then wait for all of them (Warning, it won't work if we try to
 	// finish and wait in the same loop).
+	if (scheduler != NULL)
+		scheduler->stop();
+
 	foreach(QVPropertyContainer* qvp, qvps)
 		{
 		QVProcessingBlock* block;
@@ -279,6 +307,8 @@ void QVApplication::quitBlock(QVProcessingBlock *block)
 		if (qvps.contains(block)) {
 			block->finish();
 
+			if (scheduler != NULL)
+				while(not scheduler->wait(block, 10/*ms*/)) processEvents();
 			while(not block->wait(10/*ms*/)) processEvents();
 			deregisterQVPropertyContainer(block);
 
@@ -286,6 +316,23 @@ void QVApplication::quitBlock(QVProcessingBlock *block)
 		}
 	}
 
+void QVApplication::setSchedulingMode(const TSchedulingMode mode, const int threads)
+	{
+	if (isRunningFlag)
+		{
+		std::cerr << "Warning: QVApplication::setSchedulingMode() must be called before exec(). Ignoring." << std::endl;
+		return;
+		}
+
+	schedulingMode = mode;
+	schedulingThreads = threads;
+	if (scheduler != NULL)
+		{
+		delete scheduler;
+		scheduler = NULL;
+		}
+	}
+
 QStringList QVApplication::getUnusedArguments()
 	{ return unusedArguments; }
 
@@ -37,6 +37,7 @@ class QVGUI;
 class QVPropertyContainer;
 class QVProcessingBlock;
 class QVImageCanvas;
+class QVBlockScheduler;
 
 #define qvApp ((QVApplication*) qApp)
 
@@ -114,6 +115,29 @@ public:
 	/// @param terminate flag to indicate desired behavior.
 	void setTerminateOnLastBlock(bool terminate) { terminateOnLastBlock=terminate; };
 
+	/// @brief Ways to execute the processing blocks of the application.
+	typedef enum {
+		ThreadScheduling,	///< Each sequential group of blocks runs in its own thread. This is the default mode.
+		PoolScheduling		///< Sequential groups of blocks run on a fixed set of threads (see @ref QVBlockScheduler).
+	} TSchedulingMode;
+
+	/// @brief Sets how the processing blocks of the application will be executed.
+	///
+	/// With the default mode, @ref ThreadScheduling, each sequential group of blocks runs in its own thread. With
+	/// @ref PoolScheduling, the groups are dispatched to a fixed set of worker threads as soon as their synchronous
+	/// inputs are available, which avoids oversubscribing the processor in applications with many blocks.
+	/// The behaviour of the blocks and their links is the same in both modes.
+	///
+	/// This method must be called before @ref exec().
+	/// @param mode scheduling mode.
+	/// @param threads number of worker threads for the @ref PoolScheduling mode. If it is not positive, one thread is
+	///        created for each processor core.
+	void setSchedulingMode(const TSchedulingMode mode, const int threads = 0);
+
+	/// @brief Gets the scheduling mode of the application.
+	/// @see setSchedulingMode
+	TSchedulingMode getSchedulingMode() const { return schedulingMode; };
+
 	/// @brief Marks a given command line argument as used.
 	///
 	/// This function is useful if the programmer wish to process manually 
@@ -246,6 +270,9 @@ private:
 	bool isRunningFlag;
 	int blockCount;
 	bool terminateOnLastBlock, forHelpFlag;
+	TSchedulingMode schedulingMode;
+	int schedulingThreads;
+	QVBlockScheduler *scheduler;
 
 	void printHelp();
 };
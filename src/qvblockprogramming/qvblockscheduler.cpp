@@ -0,0 +1,394 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <QDebug>
+#include <QThread>
+#include <QSet>
+#include <QMutexLocker>
+#include <QApplication>
+
+#include <QVBlockScheduler>
+
+#ifndef DOXYGEN_IGNORE_THIS
+class QVBlockSchedulerWorker: public QThread
+    {
+    public:
+        QVBlockSchedulerWorker(QVBlockScheduler *scheduler, const int index): QThread(), scheduler(scheduler), index(index)  { }
+
+        // Ready tasks of the worker. The owner pops from the back, other workers steal from the front.
+        QMutex mutex;
+        QList<QVBlockScheduler::TTask *> queue;
+
+    protected:
+        void run()  { scheduler->workerLoop(index); }
+
+    private:
+        QVBlockScheduler *scheduler;
+        const int index;
+    };
+#endif
+
+QVBlockScheduler::QVBlockScheduler(const int threads): QObject(), stopping(false), timedWaiters(0), timedDeadline(0)
+    {
+    const int count = (threads > 0)? threads : qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < count; i++)
+        workers << new QVBlockSchedulerWorker(this, i);
+    }
+
+QVBlockScheduler::~QVBlockScheduler()
+    {
+    stop();
+    qDeleteAll(workers);
+    qDeleteAll(tasks);
+    }
+
+void QVBlockScheduler::start(const QList<QVProcessingBlock *> &masters)
+    {
+    qDebug() << "QVBlockScheduler::start()";
+
+    QMutexLocker locker(&stateMutex);
+
+    stopping = false;
+    clock.start();
+
+    foreach(QVProcessingBlock *master, masters)
+        {
+        Q_ASSERT_X(master->isSequentialGroupMaster(), "QVBlockScheduler::start()", "block is not a sequential group master");
+        if (tasks.contains(master))
+            delete tasks.take(master);
+
+        TTask *task = new TTask;
+        task->master = master;
+        task->state = Waiting;
+        task->notBefore = 0;
+        tasks.insert(master, task);
+        waiting << task;
+
+        // Status changes can make a parked group ready (for example, when it is unpaused).
+        foreach(QVProcessingBlock *block, master->getGroupBlocks())
+            connect(block, SIGNAL(statusUpdate(QVProcessingBlock::TBlockStatus)), this, SLOT(statusChanged()), Qt::DirectConnection);
+        }
+
+    // Linked containers which are not executed by the scheduler (for example, image canvas) notify it when they read
+    // or write their links, because that can make a parked group ready. The groups of the scheduler are woken up
+    // directly by the worker which executes their linked groups.
+    QSet<QVPropertyContainer *> notifiers;
+    foreach(TTask *task, tasks)
+        foreach(QVProcessingBlock *block, task->master->getGroupBlocks())
+            foreach(QVPropertyContainer *container, block->getLinkedContainers())
+                if (not tasks.contains(dynamic_cast<QVProcessingBlock *>(container->getMaster())) and not notifiers.contains(container))
+                    {
+                    notifiers.insert(container);
+                    connect(container->getInformer(), SIGNAL(linksUpdated()), this, SLOT(linksUpdated()), Qt::DirectConnection);
+                    }
+
+    foreach(QVBlockSchedulerWorker *worker, workers)
+        worker->start();
+
+    wakeUp.wakeAll();
+
+    qDebug() << "QVBlockScheduler::start() <- return";
+    }
+
+void QVBlockScheduler::stop()
+    {
+    qDebug() << "QVBlockScheduler::stop()";
+
+    stateMutex.lock();
+    stopping = true;
+    wakeUp.wakeAll();
+    stateMutex.unlock();
+
+    // Blocks can be waiting for the main thread on Qt::BlockingQueuedConnection signals, so events are processed
+    // while waiting for the workers, as QVApplication::quitItems() does.
+    foreach(QVBlockSchedulerWorker *worker, workers)
+        while(not worker->wait(10/*ms*/))
+            qApp->processEvents();
+
+    // Groups are unlinked with the state mutex unlocked, because unlinking can wait for the main thread.
+    QList<TTask *> unfinished;
+    stateMutex.lock();
+    foreach(QVBlockSchedulerWorker *worker, workers)
+        worker->queue.clear();
+    waiting.clear();
+    foreach(TTask *task, tasks)
+        if (task->state != Done)
+            unfinished << task;
+    stateMutex.unlock();
+
+    foreach(TTask *task, unfinished)
+        task->master->groupFinish();
+
+    stateMutex.lock();
+    foreach(TTask *task, unfinished)
+        task->state = Done;
+    groupDone.wakeAll();
+    stateMutex.unlock();
+
+    qDebug() << "QVBlockScheduler::stop() <- return";
+    }
+
+bool QVBlockScheduler::wait(QVProcessingBlock *master, const unsigned long time)
+    {
+    QMutexLocker locker(&stateMutex);
+
+    const TTask *task = tasks.value(master, NULL);
+    if (task == NULL or task->state == Done)
+        return true;
+
+    groupDone.wait(&stateMutex, time);
+    return task->state == Done;
+    }
+
+void QVBlockScheduler::statusChanged()
+    {
+    QVProcessingBlock *block = qobject_cast<QVProcessingBlock *>(sender());
+    if (block == NULL)
+        return;
+
+    QMutexLocker locker(&stateMutex);
+
+    TTask *task = tasks.value(dynamic_cast<QVProcessingBlock *>(block->getMaster()), NULL);
+    if (task != NULL and task->state == Waiting)
+        {
+        task->notBefore = 0;
+        if (isDispatchable(task))
+            {
+            waiting.removeAll(task);
+            enqueue(0, task);
+            }
+        }
+    }
+
+void QVBlockScheduler::linksUpdated()
+    {
+    QMutexLocker locker(&stateMutex);
+    if (not stopping)
+        dispatchWaiting(0);
+    }
+
+#ifndef DOXYGEN_IGNORE_THIS
+QVBlockScheduler::TTask * QVBlockScheduler::nextTask(const int workerIndex)
+    {
+    // Own queue first, newest task first.
+    QVBlockSchedulerWorker *own = workers[workerIndex];
+        {
+        QMutexLocker locker(&own->mutex);
+        if (not own->queue.isEmpty())
+            return own->queue.takeLast();
+        }
+
+    // Steal the oldest task from another worker.
+    for (int i = 1; i < workers.count(); i++)
+        {
+        QVBlockSchedulerWorker *victim = workers[(workerIndex + i) % workers.count()];
+        QMutexLocker locker(&victim->mutex);
+        if (not victim->queue.isEmpty())
+            return victim->queue.takeFirst();
+        }
+
+    return NULL;
+    }
+
+bool QVBlockScheduler::isDispatchable(TTask *task) const
+    {
+    return task->master->getStatus() == QVProcessingBlock::Finished or task->master->isGroupReady();
+    }
+
+void QVBlockScheduler::enqueue(const int workerIndex, TTask *task)
+    {
+    task->state = Queued;
+
+    QVBlockSchedulerWorker *worker = workers[workerIndex];
+    worker->mutex.lock();
+    worker->queue << task;
+    worker->mutex.unlock();
+
+    wakeUp.wakeOne();
+    }
+
+void QVBlockScheduler::park(TTask *task, const int delay)
+    {
+    task->state = Waiting;
+    task->notBefore = (delay > 0)? clock.elapsed() + (delay + 999) / 1000 : 0;
+    waiting << task;
+
+    // The worker waiting for the earliest minimum iteration time must wait less.
+    if (delay > 0 and timedWaiters > 0 and task->notBefore < timedDeadline)
+        wakeUp.wakeAll();
+    }
+
+bool QVBlockScheduler::dispatchWaiting(const int workerIndex)
+    {
+    const int now = clock.elapsed();
+    bool dispatched = false;
+
+    QMutableListIterator<TTask *> iterator(waiting);
+    while (iterator.hasNext())
+        {
+        TTask *task = iterator.next();
+        if (task->notBefore <= now and isDispatchable(task))
+            {
+            iterator.remove();
+            enqueue(workerIndex, task);
+            dispatched = true;
+            }
+        }
+
+    return dispatched;
+    }
+
+bool QVBlockScheduler::nextDeadline(int &deadline) const
+    {
+    const int now = clock.elapsed();
+    bool found = false;
+
+    foreach(TTask *task, waiting)
+        if (task->notBefore > now and (not found or task->notBefore < deadline))
+            {
+            deadline = task->notBefore;
+            found = true;
+            }
+
+    return found;
+    }
+
+void QVBlockScheduler::wakeLinkedGroups(const int workerIndex, TTask *task)
+    {
+    // A step of a group can only make ready the groups which read its outputs or write its inputs.
+    const int now = clock.elapsed();
+    foreach(QVProcessingBlock *block, task->master->getGroupBlocks())
+        foreach(QVPropertyContainer *container, block->getLinkedContainers())
+            {
+            QVProcessingBlock *linkedMaster = dynamic_cast<QVProcessingBlock *>(container->getMaster());
+            TTask *linked = tasks.value(linkedMaster, NULL);
+            if (linked != NULL and linked->state == Waiting and linked->notBefore <= now and isDispatchable(linked))
+                {
+                waiting.removeAll(linked);
+                enqueue(workerIndex, linked);
+                }
+            }
+    }
+
+void QVBlockScheduler::runTask(const int workerIndex, TTask *task)
+    {
+    QVProcessingBlock *master = task->master;
+
+    stateMutex.lock();
+    if (stopping)
+        {
+        stateMutex.unlock();
+        return;
+        }
+    task->state = Running;
+    stateMutex.unlock();
+
+    // The group was ready when the task was queued, and only this task consumes its synchronous inputs and fills its
+    // synchronous outputs, so the step does not block.
+    const int delay = master->groupStep();
+
+    if (master->getStatus() == QVProcessingBlock::Finished)
+        {
+        // If the scheduler is being stopped, stop() unlinks the group.
+        stateMutex.lock();
+        const bool finishedByStop = stopping;
+        stateMutex.unlock();
+        if (finishedByStop)
+            return;
+
+        // The linked groups are collected before unlinking, because unlinking the group can release them.
+        QSet<TTask *> linked;
+        foreach(QVProcessingBlock *block, master->getGroupBlocks())
+            foreach(QVPropertyContainer *container, block->getLinkedContainers())
+                if (tasks.contains(dynamic_cast<QVProcessingBlock *>(container->getMaster())))
+                    linked.insert(tasks.value(dynamic_cast<QVProcessingBlock *>(container->getMaster())));
+
+        master->groupFinish();
+
+        stateMutex.lock();
+        task->state = Done;
+        groupDone.wakeAll();
+        foreach(TTask *other, linked)
+            if (other->state == Waiting and isDispatchable(other))
+                {
+                waiting.removeAll(other);
+                enqueue(workerIndex, other);
+                }
+        stateMutex.unlock();
+
+        emit groupFinished(master);
+        return;
+        }
+
+    QMutexLocker locker(&stateMutex);
+
+    if (delay <= 0 and isDispatchable(task))
+        enqueue(workerIndex, task);
+    else
+        park(task, delay);
+
+    wakeLinkedGroups(workerIndex, task);
+    dispatchWaiting(workerIndex);
+    }
+
+void QVBlockScheduler::workerLoop(const int workerIndex)
+    {
+    qDebug() << "QVBlockScheduler::workerLoop(" << workerIndex << ")";
+
+    forever
+        {
+        TTask *task = nextTask(workerIndex);
+
+        if (task == NULL)
+            {
+            QMutexLocker locker(&stateMutex);
+            if (stopping)
+                break;
+
+            // Checked again with the state mutex locked, so no task queued by other workers is missed.
+            dispatchWaiting(workerIndex);
+            if ((task = nextTask(workerIndex)) == NULL)
+                {
+                // Only one idle worker waits for the earliest minimum iteration time of the parked tasks. The others
+                // sleep until a task is queued.
+                int deadline;
+                if (timedWaiters == 0 and nextDeadline(deadline))
+                    {
+                    timedWaiters++;
+                    timedDeadline = deadline;
+                    wakeUp.wait(&stateMutex, qMax(1, deadline - clock.elapsed()));
+                    timedWaiters--;
+                    }
+                else
+                    wakeUp.wait(&stateMutex);
+                continue;
+                }
+            }
+
+        runTask(workerIndex, task);
+        }
+
+    qDebug() << "QVBlockScheduler::workerLoop(" << workerIndex << ") <- return";
+    }
+#endif
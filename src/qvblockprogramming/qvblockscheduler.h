@@ -0,0 +1,142 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVBLOCKSCHEDULER_H
+#define QVBLOCKSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTime>
+
+#include <QVProcessingBlock>
+
+#ifndef DOXYGEN_IGNORE_THIS
+class QVBlockSchedulerWorker;
+#endif
+
+/*!
+@class QVBlockScheduler qvblockprogramming/qvblockscheduler.h QVBlockScheduler
+@brief Executes the sequential groups of processing blocks of an application on a fixed set of threads.
+
+By default, each sequential group of blocks runs in its own thread, which polls its links with short sleeps while
+it has no data to process. When the @ref QVApplication is configured with @ref QVApplication::setSchedulingMode()
+to use the @ref QVApplication::PoolScheduling mode, the groups are executed instead by this scheduler, which keeps a
+fixed number of worker threads (by default, one per processor core).
+
+Each step of a group (one iteration of every block in the group) is a task. A task is only dispatched when the
+synchronous inputs of the blocks of the group hold new data and their synchronous outputs have been read, so
+it never blocks a worker thread. Groups which are not ready are parked, and woken up when a linked group completes
+a step, when another linked container (such as an image canvas) reads or writes its properties, when their status
+changes, or when their minimum iteration time expires. Idle workers sleep until one of these events happens. Each worker keeps its own queue of ready tasks, and idle workers steal tasks
+from the queues of the other workers.
+
+The behaviour of the blocks and the links is the same in both modes, including the minimum iteration time
+(see @ref QVProcessingBlock::setMinimumDelay), pausing, stopping and finishing.
+
+@ingroup qvblockprogramming
+*/
+class QVBlockScheduler: public QObject
+    {
+    Q_OBJECT
+
+    public:
+        /// @brief Creates a scheduler.
+        ///
+        /// @param threads number of worker threads. If it is not positive, QThread::idealThreadCount() threads are used.
+        QVBlockScheduler(const int threads = 0);
+
+        /// @brief Stops the worker threads, and finishes the groups still scheduled.
+        ~QVBlockScheduler();
+
+        /// @brief Number of worker threads of the scheduler.
+        int getThreadCount() const  { return workers.count(); }
+
+        /// @brief Starts the execution of several sequential groups.
+        ///
+        /// @param masters master blocks of the sequential groups to execute.
+        void start(const QList<QVProcessingBlock *> &masters);
+
+        /// @brief Stops the worker threads.
+        ///
+        /// Waits for the tasks being executed, and unlinks the groups which were not finished yet. The signal
+        /// @ref groupFinished is not emitted for them.
+        void stop();
+
+        /// @brief Waits for a sequential group to finish and be unlinked.
+        ///
+        /// @param master master block of the group.
+        /// @param time maximum time to wait, in milliseconds.
+        /// @return true if the group was finished, or is not executed by the scheduler. False if the time expired.
+        bool wait(QVProcessingBlock *master, const unsigned long time);
+
+    signals:
+        /// @brief Emitted when a sequential group finishes, from the worker thread which executed its last step.
+        ///
+        /// @param master master block of the group.
+        void groupFinished(QVProcessingBlock *master);
+
+    #ifndef DOXYGEN_IGNORE_THIS
+    private slots:
+        void statusChanged();
+        void linksUpdated();
+
+    private:
+        friend class QVBlockSchedulerWorker;
+
+        typedef enum { Waiting, Queued, Running, Done } TTaskState;
+
+        typedef struct
+            {
+            QVProcessingBlock *master;
+            TTaskState state;
+            int notBefore;  // Waiting tasks are not dispatched before this time (in ms, see 'clock').
+            } TTask;
+
+        QList<QVBlockSchedulerWorker *> workers;
+        QHash<QVProcessingBlock *, TTask *> tasks;
+        QList<TTask *> waiting;
+
+        // Protects the task states, and the list of waiting tasks.
+        QMutex stateMutex;
+        QWaitCondition wakeUp, groupDone;
+        bool stopping;
+        int timedWaiters, timedDeadline;	// Idle workers waiting for the minimum iteration time of a parked task.
+        QTime clock;
+
+        TTask * nextTask(const int workerIndex);
+        void runTask(const int workerIndex, TTask *task);
+        bool dispatchWaiting(const int workerIndex);
+        bool nextDeadline(int &deadline) const;
+        void enqueue(const int workerIndex, TTask *task);
+        void park(TTask *task, const int delay);
+        void wakeLinkedGroups(const int workerIndex, TTask *task);
+        bool isDispatchable(TTask *task) const;
+        void workerLoop(const int workerIndex);
+    #endif
+    };
+
+#endif // QVBLOCKSCHEDULER_H
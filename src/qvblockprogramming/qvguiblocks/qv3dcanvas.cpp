@@ -378,7 +378,7 @@ void QV3DCanvas::draw(const QList<QV3DPointF> &qv3DPointList, const QColor color
 
 bool QV3DCanvas::linkUnspecifiedInputProperty(QVPropertyContainer *sourceContainer, QString sourcePropName, LinkType linkType)
     {
-    if (linkType == SynchronousLink)
+    if (linkType == SynchronousLink or linkType == BufferedLink)
         {
         std::cerr	<< "ERROR: QVImageCanvas::linkUnspecifiedInputProperty():"
                 << " the linkType must be AsynchronousLink, the link will not be done"
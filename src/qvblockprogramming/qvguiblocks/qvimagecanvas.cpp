@@ -384,7 +384,7 @@ bool QVImageCanvas::linkUnspecifiedInputProperty(QVPropertyContainer *sourceCont
 	if (containsProperty(sourcePropName))
 		return false;
 
-	if (linkType == SynchronousLink)
+	if (linkType == SynchronousLink or linkType == BufferedLink)
 		{
 		std::cerr << "ERROR: QVImageCanvas::linkUnspecifiedInputProperty(): the linkType must be AsynchronousLink, the link will not be done" << std::endl;
 		return false;
@@ -447,7 +447,7 @@ bool QVImageCanvas::linkUnspecifiedInputProperty(QVPropertyContainer *sourceCont
 bool QVImageCanvas::linkUnspecifiedOutputProperty(QVPropertyContainer *destContainer, QString destPropName, LinkType linkType)
 	{
 	
-	if (linkType == SynchronousLink)
+	if (linkType == SynchronousLink or linkType == BufferedLink)
 		std::cerr << "ERROR: QVImageCanvas::linkUnspecifiedOutputProperty(): the linkType must be AsynchronousLink, the link will not be done." << std::endl;
 	else if (dynamic_cast<QVProcessingBlock*>(destContainer) == NULL)
 		std::cerr << "ERROR: QVImageCanvas::linkUnspecifiedOutputProperty(): destination block is not a block." << std::endl;
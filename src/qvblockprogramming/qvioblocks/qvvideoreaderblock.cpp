@@ -45,6 +45,7 @@ QVVideoReaderBlock::QVVideoReaderBlock(QString name): QVProcessingBlock(name)
     addProperty<QString>("URL", inputFlag, QString("#0"),"URL of the video source to read");
     addProperty<int>("Cols", inputFlag, 0, "Suggested number of columns of the video");
     addProperty<int>("Rows", inputFlag, 0, "Suggested number of rows of the video");
+    addProperty<int>("Prefetch", inputFlag, 0, "Number of frames decoded in advance (0 => no decoding in advance)", 0, 64);
     // RealTime property is also input (and as such can be initialized using the command line), but invisible to the GUI
     // (because once the camera has been linked, it cannot be relinked changing its synchronism):
     addProperty<bool>("RealTime", inputFlag|guiInvisible, FALSE, "If the camera should be opened in real time mode");
@@ -57,6 +58,8 @@ QVVideoReaderBlock::QVVideoReaderBlock(QString name): QVProcessingBlock(name)
     addProperty<int>("RowsR", outputFlag, 0, "Actual number of rows of the video");
     addProperty<int>("Pos", outputFlag, 0.0, "Current position on the video");
     addProperty<int>("Length", outputFlag, 0.0, "Length of the video (0 if not available)");
+    addProperty<int>("Queue depth", outputFlag, 0, "Number of frames decoded in advance, waiting to be grabbed");
+    addProperty<int>("Decode latency", outputFlag, 0, "Time spent decoding the last frame in advance (ms)");
 
     // Output image properties:
     addProperty< QVImage<uChar,3> >("RGB image", outputFlag, QVImage<uChar,3>(), "Last grabbed RGB image");
@@ -126,6 +129,21 @@ void QVVideoReaderBlock::tryOpeningCam()
     if(realTime) opts |= QVVideoReader::RealTime;
     if(noLoop) opts |= QVVideoReader::NoLoop;
     if(deinterlaced) opts |= QVVideoReader::Deinterlaced;
+
+    // When decoding in advance, frames are converted in the decoding thread to the formats of the linked outputs.
+    // Real time sources discard the oldest frames if the consumers are too slow, while the rest wait for them:
+    QVVideoReader::PrefetchFormats formats;
+    if (isLinkedOutput("RGB image"))
+        formats |= QVVideoReader::PrefetchRGB;
+    if (isLinkedOutput("Y channel image") and not isLinkedOutput("U channel image") and not isLinkedOutput("V channel image"))
+        formats |= QVVideoReader::PrefetchGray;
+    else if(isLinkedOutput("Y channel image") and (isLinkedOutput("U channel image") or isLinkedOutput("V channel image")))
+        formats |= QVVideoReader::PrefetchYUV;
+    if (isLinkedOutput("R channel image") or isLinkedOutput("G channel image") or isLinkedOutput("B channel image"))
+        formats |= QVVideoReader::PrefetchRGBChannels;
+    video_reader.setPrefetch(getPropertyValue<int>("Prefetch"),
+                             realTime? QVVideoReader::DropOldest : QVVideoReader::BlockWhenFull, formats);
+
     if(video_reader.open(urlName,cols,rows,fps,opts,source_mode))
         {
         setPropertyValue<bool>("Opened",TRUE);
@@ -212,6 +230,8 @@ void QVVideoReaderBlock::reset()
     setPropertyValue<int>("Frames",0);
     setPropertyValue<int>("Pos",0);
     setPropertyValue<int>("Length",0);
+    setPropertyValue<int>("Queue depth",0);
+    setPropertyValue<int>("Decode latency",0);
 
     // ...and stop block:
     stop();
@@ -307,6 +327,8 @@ void QVVideoReaderBlock::grabFrame()
         setPropertyValue<int>("Pos",video_reader.getPos());
         // Needed here because mplayer does not know the length of the video until it has played a few frames:
         setPropertyValue<int>("Length",video_reader.getLength());
+        setPropertyValue<int>("Queue depth",video_reader.getPrefetchQueueLength());
+        setPropertyValue<int>("Decode latency",video_reader.getDecodeLatency());
 
         // Compute FPS:
         static QTime t;
@@ -54,6 +54,10 @@ the corresponding @ref QVProcessingBlock::setPropertyValue method:
 - <i>URL</i> (QString): URL of the video source to read.
 - <i>Cols</i> (int): Number of suggested columns for the video source.
 - <i>Rows</i> (int): Number of suggested rows for the video source.
+- <i>Prefetch</i> (int): Number of frames decoded in advance, in a separate thread (0, the default, decodes each
+frame when it is grabbed). In real time mode the oldest decoded frame is discarded when the queue is full;
+otherwise, decoding waits for the frames to be grabbed. See section @ref VideoReaderPrefetch in the
+@ref QVVideoReader documentation.
 
 \b Note.- RealTime property is also input (and as such can be initialized using the command line), but
 invisible to the GUI (because once the source has been linked, it cannot be relinked changing its synchronism).
@@ -75,6 +79,9 @@ columns, which will in any case be transparently rounded to the nearest upper ev
 which will in any case be transparently rounded to the nearest upper even integer-.
 - <i>Pos</i> (double): Current position in the video, if available.
 - <i>Length</i> (double): Length of the video, if available.
+- <i>Queue depth</i> (int): Number of frames decoded in advance, waiting to be grabbed (only if <i>Prefetch</i> > 0).
+- <i>Decode latency</i> (int): Time spent reading, decoding and converting the last frame decoded in advance, in
+milliseconds (only if <i>Prefetch</i> > 0).
 
 \a Note.- Remember again that you can open the camera in a different size of that specified in the real video
 source file (this class will automatically rescale output images if needed); thus, <i>ColsR</i> and <i>RowsR</i>
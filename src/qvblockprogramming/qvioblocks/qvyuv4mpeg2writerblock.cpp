@@ -31,7 +31,7 @@
 
 QVYUV4MPEG2WriterBlock::~QVYUV4MPEG2WriterBlock()
 	{
-	videoFile.close();
+	writer.close();
 	}
 
 QVYUV4MPEG2WriterBlock::QVYUV4MPEG2WriterBlock(QString name, const QString fileName, const int fps, const bool recording): QVProcessingBlock(name),
@@ -53,6 +53,12 @@ QVYUV4MPEG2WriterBlock::QVYUV4MPEG2WriterBlock(QString name, const QString fileN
 
 	addProperty< QString >("File", inputFlag, fileName);
 
+	addProperty<int>("Queue depth", inputFlag, 8, "Number of frames waiting to be written to the file", 1, 256);
+	addProperty<bool>("Drop frames", inputFlag, FALSE, "If frames should be discarded when the queue is full (always in real time mode)");
+	addProperty<bool>("Direct IO", inputFlag, FALSE, "If the file should be written bypassing the system cache (O_DIRECT)");
+	addProperty<int>("Dropped frames", outputFlag, 0, "Number of frames discarded because the queue was full");
+	addProperty<double>("Write throughput", outputFlag, 0.0, "Average write speed to the file (MB/s)");
+
 	// If the camera is in real time mode, set minimum delay sleep between iterations regarding the fps.
 	if (realTimeMode)
 		setMinimumDelay((int)(1000/(double) getPropertyValue<int>("FPS")));
@@ -78,7 +84,7 @@ bool QVYUV4MPEG2WriterBlock::linkUnspecifiedInputProperty(QVPropertyContainer *s
 		std::cout << "Warning @ QVYUV4MPEG2WriterBlock: tried to establish an asynchronous link to a not real time recorder." << std::endl;
 		actualLinkType = SynchronousLink;
 		}
-	else if (realTimeMode && actualLinkType == SynchronousLink)
+	else if (realTimeMode && (actualLinkType == SynchronousLink || actualLinkType == BufferedLink))
 		{
 		std::cout << "Warning @ QVYUV4MPEG2WriterBlock: tried to establish a synchronous link to a real time recorder." << std::endl;
 		actualLinkType = AsynchronousLink;
@@ -129,13 +135,16 @@ void QVYUV4MPEG2WriterBlock::grabFrame()
 
 		if (cols > 1 && rows > 1)
 			{
-			videoFile.setFileName(getPropertyValue<QString>("File"));
-			videoFile.open(QIODevice::WriteOnly|QIODevice::Truncate);
-			writeYUV4MPEG2Header(videoFile, cols, rows, getPropertyValue<int>("FPS"));
+			const QVYUV4MPEG2Writer::TQueuePolicy policy = (realTimeMode || getPropertyValue<bool>("Drop frames"))?
+									QVYUV4MPEG2Writer::DropWhenFull: QVYUV4MPEG2Writer::BlockWhenFull;
+			writer.open(getPropertyValue<QString>("File"), cols, rows, getPropertyValue<int>("FPS"),
+					getPropertyValue<int>("Queue depth"), policy, QVYUV4MPEG2Writer::defaultBufferSize,
+					getPropertyValue<bool>("Direct IO"));
 			initiated = true;
 			}
 		}
 
+	// Frames are cropped or padded to the size of the video, and converted to YUV, in the writer thread.
 	if (not rgbMode)
 		{
 		const QVImage<uChar, 1> imageY = getPropertyValue< QVImage<uChar, 1> >("Input image Y");
@@ -147,16 +156,7 @@ void QVYUV4MPEG2WriterBlock::grabFrame()
 			std::cout	<< "QVYUV4MPEG2WriterBlock::grabFrame(): image has " << imageY.getRows()
 					<< ", but video file is set to " << rows << " rows." << std::endl;
 
-		QVImage<uChar, 1> storedImageY(cols, rows);
-
-		Set(0, storedImageY);
-		#ifdef QVIPP
-		Copy(imageY, storedImageY);
-		#else
-		storedImageY = imageY;
-		#endif
-
-		writeYUV4MPEG2Frame(videoFile, imageY);
+		writer.writeFrame(imageY);
 		}
 	#ifdef QVIPP
 	else	{
@@ -169,14 +169,10 @@ void QVYUV4MPEG2WriterBlock::grabFrame()
 			std::cout	<< "QVYUV4MPEG2WriterBlock::grabFrame(): image has " << imageRGB.getRows()
 					<< ", but video file is set to " << rows << " rows." << std::endl;
 
-		QVImage<uChar, 3> storedImage(cols, rows);
-		const uChar zero[3] = {0,0,0};
-
-		Set(zero, storedImage);
-		Copy(imageRGB, storedImage);
-
-		writeYUV4MPEG2Frame(videoFile, storedImage);
+		writer.writeFrame(imageRGB);
 		}
 	#endif
 
+	setPropertyValue<int>("Dropped frames", writer.getDroppedFrames());
+	setPropertyValue<double>("Write throughput", writer.getWriteThroughput());
 	}
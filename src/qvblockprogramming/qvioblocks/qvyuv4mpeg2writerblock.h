@@ -27,7 +27,7 @@
 
 #include <QVProcessingBlock>
 #include <QVImage>
-#include <QFile>
+#include <QVYUV4MPEG2Writer>
 
 /*!
 @class QVYUV4MPEG2WriterBlock qvblockprogramming/qvioblocks/qvyuv4mpeg2writerblock.h QVYUV4MPEG2WriterBlock
@@ -54,6 +54,12 @@ You can tune the number of frames per second and the name of the file to store t
 
 Once the object reads the first image frame changing those values will have no effect.
 
+Frames are written to the file by a separate thread (see @ref QVYUV4MPEG2Writer), so a slow disk does not stall the
+pipeline unless the queue of frames waiting to be written fills up. The properties <i>Queue depth</i>, <i>Drop frames</i>
+and <i>Direct IO</i> tune the writer (they are also read with the first frame), and the output properties
+<i>Dropped frames</i> and <i>Write throughput</i> report the frames discarded because the queue was full and the
+average write speed. Frames are always dropped instead of blocking in real time mode.
+
 @ingroup qvblockprogramming
 */
 class QVYUV4MPEG2WriterBlock: public QVProcessingBlock
@@ -72,7 +78,7 @@ class QVYUV4MPEG2WriterBlock: public QVProcessingBlock
 
 	private:
 		bool initiated, rgbMode, recording, realTimeMode;
-		QFile videoFile;
+		QVYUV4MPEG2Writer writer;
 		uint cols, rows;
 
 		void grabFrame();
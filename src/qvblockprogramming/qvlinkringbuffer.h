@@ -0,0 +1,162 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVLINKRINGBUFFER_H
+#define QVLINKRINGBUFFER_H
+
+#include <QVariant>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Bounded single-producer/single-consumer queue of property values, used by the buffered links between property
+// containers (see QVPropertyContainer::BufferedLink).
+//
+// Only the source container of the link calls hasRoom() and tryPush(), and only the destination calls isEmpty() and
+// tryPop(). No lock is used to push or pop values: the producer is the only writer of 'tail', the consumer is the
+// only writer of 'head', and a slot is only accessed by the side that owns it between both indexes. One slot is always
+// left empty, to tell a full buffer from an empty one. The mutex and the wait condition are only used when one side
+// has to wait for the other, with waitForRoom() or waitForData().
+class QVLinkRingBuffer
+    {
+    public:
+        QVLinkRingBuffer(const int depth): ringSlots(NULL), ringSize(0), head(0), tail(0), maxOccupancy(0),
+            producerStalls(0), consumerStalls(0), waiters(0)
+            { setDepth(depth); }
+
+        ~QVLinkRingBuffer()     { delete [] ringSlots; }
+
+        // Must only be called while neither the producer nor the consumer use the buffer.
+        void setDepth(const int depth)
+            {
+            Q_ASSERT_X(depth > 0, "QVLinkRingBuffer::setDepth()", "depth must be positive");
+            delete [] ringSlots;
+            ringSize = depth + 1;
+            ringSlots = new QVariant[ringSize];
+            head = 0;
+            tail = 0;
+            maxOccupancy = 0;
+            }
+
+        int getDepth() const    { return ringSize - 1; }
+
+        int getOccupancy() const
+            {
+            const int h = load(head), t = load(tail);
+            return (t - h + ringSize) % ringSize;
+            }
+
+        // Producer side.
+        bool hasRoom() const    { return (load(tail) + 1) % ringSize != load(head); }
+
+        bool tryPush(const QVariant &value)
+            {
+            const int t = load(tail), next = (t + 1) % ringSize;
+            if (next == load(head))
+                return false;
+
+            ringSlots[t] = value;
+            tail.fetchAndStoreOrdered(next);
+            wakeWaiters();
+
+            const int occupancy = getOccupancy();
+            if (occupancy > load(maxOccupancy))
+                maxOccupancy.fetchAndStoreRelaxed(occupancy);
+            return true;
+            }
+
+        // Consumer side.
+        bool isEmpty() const    { return load(head) == load(tail); }
+
+        bool tryPop(QVariant &value)
+            {
+            const int h = load(head);
+            if (h == load(tail))
+                return false;
+
+            value = ringSlots[h];
+            ringSlots[h] = QVariant(); // Do not retain the value (for example, an image buffer) once read.
+            head.fetchAndStoreOrdered((h + 1) % ringSize);
+            wakeWaiters();
+            return true;
+            }
+
+        // Block the producer until the buffer has room, and the consumer until it has a value, or until 'cancelled'
+        // is true and wake() is called.
+        void waitForRoom(const bool &cancelled)
+            {
+            QMutexLocker locker(&mutex);
+            waiters.fetchAndAddOrdered(1);
+            while (not hasRoom() and not cancelled)
+                changed.wait(&mutex);
+            waiters.fetchAndAddOrdered(-1);
+            }
+
+        void waitForData(const bool &cancelled)
+            {
+            QMutexLocker locker(&mutex);
+            waiters.fetchAndAddOrdered(1);
+            while (isEmpty() and not cancelled)
+                changed.wait(&mutex);
+            waiters.fetchAndAddOrdered(-1);
+            }
+
+        void wake()
+            {
+            QMutexLocker locker(&mutex);
+            changed.wakeAll();
+            }
+
+        int getMaxOccupancy() const     { return load(maxOccupancy); }
+        int getProducerStalls() const   { return load(producerStalls); }
+        int getConsumerStalls() const   { return load(consumerStalls); }
+        void addProducerStall()         { producerStalls.fetchAndAddRelaxed(1); }
+        void addConsumerStall()         { consumerStalls.fetchAndAddRelaxed(1); }
+
+    private:
+        static int load(QAtomicInt &value)  { return value.fetchAndAddAcquire(0); }
+
+        // The indexes are stored, and 'waiters' incremented, with ordered operations. So either the waiting side sees
+        // the new index before waiting, or the other side sees it waiting and wakes it up.
+        void wakeWaiters()
+            {
+            if (waiters.fetchAndAddOrdered(0) > 0)
+                wake();
+            }
+
+        QVariant *ringSlots;
+        int ringSize;
+        mutable QAtomicInt head, tail, maxOccupancy, producerStalls, consumerStalls;
+        QAtomicInt waiters;
+        QMutex mutex;
+        QWaitCondition changed;
+
+        // Not copyable.
+        QVLinkRingBuffer(const QVLinkRingBuffer &);
+        QVLinkRingBuffer & operator=(const QVLinkRingBuffer &);
+    };
+#endif // DOXYGEN_IGNORE_THIS
+
+#endif // QVLINKRINGBUFFER_H
@@ -27,6 +27,7 @@
 #include <QDebug>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QSet>
 #include <QApplication>
 
 #include <QVProcessingBlock>
@@ -112,74 +113,131 @@ void QVProcessingBlock::run()
         // it should not be appreciable in any practical situation.
         usleep(1000);
 
-        switch (status)
-            {
-            case RunningOneStep:
-                qDebug() << "QVProcessingBlock::iterate(): RunningOneStep";
-                status = Paused;
-
-            case Running:
-                iterationTime.start();
-                foreach(QList<QVPropertyContainer *> level, slavesByLevel) // Iterate all its slaves (included itself)
-                    foreach(QVPropertyContainer * slave, level)
-                        if(dynamic_cast<QVProcessingBlock *>(slave) != NULL) ((QVProcessingBlock *)slave)->blockIterate();
-
-                curms = iterationTime.elapsed();
-                if(minms > curms)
-                    usleep(1000*(minms-curms));
-                /*if(numIterations!=1) // First iteration time is too noisy:
-                    acumms = (acumms*(numIterations-2) + curms) / (numIterations-1);
-                std::cout << "-----> curms=" << curms << " acumms=" << acumms << "\n";*/
-                break;
-
-            case Stopped:
-                // A stopped block should never block anybody, but keeps linked to
-                // other blocks (otherwise, it would simply be deleted). So, it must
-                // read its inputs an write its outputs always, even being stopped.
-                readInputProperties();
-                writeOutputProperties();
-                usleep(100); // This avoids spurious CPU consuming when stopped.
-                break;
-
-
-            case Paused:
-                qDebug() << "QVProcessingBlock::iterate(): Paused";
-                if(dynamic_cast<QVVideoReaderBlock*>(this) != NULL)
-                    {
-                    // A special pause case for camera blocks: we do not want paused cameras
-                    // to block linked blocks:
-                    readInputProperties();
-                    writeOutputProperties();
-                    }
-                usleep(100); // This avoids spurious CPU consuming when paused.
-                break;
-
-            case Finished:
-                qDebug() << "QVProcessingBlock::iterate(): Finished";
-                break;
-            }
-
-        if (maxIterations != -1 && numIterations >= maxIterations)
-            finish();
+        const int delay = groupStep();
+        if (delay > 0)
+            usleep(delay);
 
         qDebug() << "QVProcessingBlock::iterate() <- return";
         }
 
-
     foreach(QList<QVPropertyContainer *> level, slavesByLevel) // Return to the main thread all its slaves (included itselve)
         foreach(QVPropertyContainer * slave, level)
             if(dynamic_cast<QVProcessingBlock *>(slave) != NULL) ((QVProcessingBlock *)slave)->moveToThread(qvApp->thread());
 
+    groupFinish();
+
+    qApp->processEvents();
+
+    qDebug() << "QVProcessingBlock::run() <- return";
+    }
+
+QList<QVProcessingBlock *> QVProcessingBlock::getGroupBlocks() const
+    {
+    QList<QVProcessingBlock *> blocks;
+    foreach(QList<QVPropertyContainer *> level, slavesByLevel)
+        foreach(QVPropertyContainer * slave, level)
+            if(dynamic_cast<QVProcessingBlock *>(slave) != NULL) blocks << (QVProcessingBlock *)slave;
+    return blocks;
+    }
+
+bool QVProcessingBlock::isGroupReady() const
+    {
+    switch (status)
+        {
+        case Running:
+        case RunningOneStep:
+            {
+            // Synchronous links inside the group are written and read in the same step, so they are not checked.
+            const QList<QVProcessingBlock *> blocks = getGroupBlocks();
+            QSet<QVPropertyContainer *> group;
+            foreach(QVProcessingBlock *block, blocks)
+                group.insert(block);
+
+            foreach(QVProcessingBlock *block, blocks)
+                if (not block->areSynchronousInputsReady(group) or not block->areSynchronousOutputsFree(group))
+                    return false;
+            return true;
+            }
+
+        case Paused:
+            // Only paused cameras keep reading and writing their properties (see groupStep()).
+            if(dynamic_cast<const QVVideoReaderBlock*>(this) == NULL)
+                return false;
+
+        case Stopped:
+            return areSynchronousInputsReady() and areSynchronousOutputsFree();
+
+        case Finished:
+        default:
+            return false;
+        }
+    }
+
+int QVProcessingBlock::groupStep()
+    {
+    int delay = 0;
+
+    switch (status)
+        {
+        case RunningOneStep:
+            qDebug() << "QVProcessingBlock::iterate(): RunningOneStep";
+            status = Paused;
+
+        case Running:
+            iterationTime.start();
+            foreach(QList<QVPropertyContainer *> level, slavesByLevel) // Iterate all its slaves (included itself)
+                foreach(QVPropertyContainer * slave, level)
+                    if(dynamic_cast<QVProcessingBlock *>(slave) != NULL) ((QVProcessingBlock *)slave)->blockIterate();
+
+            curms = iterationTime.elapsed();
+            if(minms > curms)
+                delay = 1000*(minms-curms);
+            /*if(numIterations!=1) // First iteration time is too noisy:
+                acumms = (acumms*(numIterations-2) + curms) / (numIterations-1);
+            std::cout << "-----> curms=" << curms << " acumms=" << acumms << "\n";*/
+            break;
+
+        case Stopped:
+            // A stopped block should never block anybody, but keeps linked to
+            // other blocks (otherwise, it would simply be deleted). So, it must
+            // read its inputs an write its outputs always, even being stopped.
+            readInputProperties();
+            writeOutputProperties();
+            delay = 100; // This avoids spurious CPU consuming when stopped.
+            break;
+
+
+        case Paused:
+            qDebug() << "QVProcessingBlock::iterate(): Paused";
+            if(dynamic_cast<QVVideoReaderBlock*>(this) != NULL)
+                {
+                // A special pause case for camera blocks: we do not want paused cameras
+                // to block linked blocks:
+                readInputProperties();
+                writeOutputProperties();
+                }
+            delay = 100; // This avoids spurious CPU consuming when paused.
+            break;
+
+        case Finished:
+            qDebug() << "QVProcessingBlock::iterate(): Finished";
+            break;
+        }
+
+    if (maxIterations != -1 && numIterations >= maxIterations)
+        finish();
+
+    return delay;
+    }
+
+void QVProcessingBlock::groupFinish()
+    {
     foreach(QList<QVPropertyContainer *> level, slavesByLevel) // Unlink all its slaves (included itselve)
         foreach(QVPropertyContainer * slave, level)
             if(dynamic_cast<QVProcessingBlock *>(slave) != NULL) {
                 QMutexLocker locker(&qvApp->mutex); // in safe mode with other thread's unlinks and with the canvas viewer()
                 ((QVProcessingBlock *)slave)->unlink();
             }
-
-    qApp->processEvents();
-
-    qDebug() << "QVProcessingBlock::run() <- return";
     }
 
 void QVProcessingBlock::blockIterate()
@@ -215,6 +215,24 @@ class QVProcessingBlock: public QThread, public QVPropertyContainer
             if (statsEnabled) cpuStatControler->setFlag(flag);
             }
 
+        #ifndef DOXYGEN_IGNORE_THIS
+        // Execution of the sequential group of blocks mastered by this block. Used by the thread of the block, and by
+        // the QVBlockScheduler when the application runs in pool scheduling mode.
+
+        // Blocks of the sequential group of this block (including itself), sorted by level.
+        QList<QVProcessingBlock *> getGroupBlocks() const;
+
+        // Returns whether groupStep() can be called without blocking on any synchronous link, and has something to do.
+        bool isGroupReady() const;
+
+        // Iterates the blocks of the group once, according to the status of the block. Returns the minimum time (in
+        // microseconds) to wait before the next step.
+        int groupStep();
+
+        // Unlinks the blocks of the group once the block is finished.
+        void groupFinish();
+        #endif
+
     public slots:
         /// @brief Set block status to @ref QVProcessingBlock::Paused.
         ///
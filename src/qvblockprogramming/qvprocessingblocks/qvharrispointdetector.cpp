@@ -39,14 +39,19 @@ QVHarrisPointDetector::QVHarrisPointDetector(QString name): QVProcessingBlock(na
 	addProperty< int >("Max number of corners", inputFlag, 300, "Maximal number of corners to detect", 10, 1000);
 
 	addProperty< double >("Threshold", inputFlag, 1.0, "window size ", 0.0, 256.0);
+
+	inputImage = getPropertyHandle< QVImage<uChar,3> >("Input image");
+	featureLocations = getPropertyHandle< QList<QPointF> >("Feature locations");
+	maxCorners = getPropertyHandle<int>("Max number of corners");
+	threshold = getPropertyHandle<double>("Threshold");
 	}
 
 void QVHarrisPointDetector::iterate()
 	{
 	// 0. Read input parameters
-	const QVImage<uChar> image = getPropertyValue< QVImage<uChar,3> >("Input image");
-	const double threshold = getPropertyValue<double>("Threshold");
-	const int pointNumber = getPropertyValue<int>("Max number of corners");
+	const QVImage<uChar> image = getPropertyValue(inputImage);
+	const double thresholdValue = getPropertyValue(threshold);
+	const int pointNumber = getPropertyValue(maxCorners);
 	timeFlag("grab Frame");
 
 	// 1. Obtain corner response image.
@@ -55,11 +60,11 @@ void QVHarrisPointDetector::iterate()
 	timeFlag("Harris corner response image");
 
 	// 2. Local maximal filter.
-	const QList<QPointF> hotPoints = fastMaximalPoints(cornerResponseImage, threshold).values();
+	const QList<QPointF> hotPoints = fastMaximalPoints(cornerResponseImage, thresholdValue).values();
 	timeFlag("Point detection");
 
 	// 3. Output resulting data.
 	//setPropertyValue< QVImage<uChar,1> >("Output image", image);
-	setPropertyValue< QList<QPointF> >("Feature locations", hotPoints.mid(0,pointNumber));
+	setPropertyValue< QList<QPointF> >(featureLocations, hotPoints.mid(0,pointNumber));
 	}
 #endif
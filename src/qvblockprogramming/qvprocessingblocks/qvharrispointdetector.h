@@ -25,6 +25,8 @@
 #ifndef QVHARRISPOINTDETECTOR_H
 #define QVHARRISPOINTDETECTOR_H
 
+#include <QList>
+#include <QPointF>
 #include <QVImage>
 #include <QVProcessingBlock>
 
@@ -38,6 +40,12 @@ class QVHarrisPointDetector: public QVProcessingBlock
 	public:
 		QVHarrisPointDetector(QString name = QString());
 		void iterate();
+
+	private:
+		QVPropertyHandle< QVImage<uChar,3> > inputImage;
+		QVPropertyHandle< QList<QPointF> > featureLocations;
+		QVPropertyHandle<int> maxCorners;
+		QVPropertyHandle<double> threshold;
 	};
 
 #endif
@@ -52,7 +52,7 @@ template <typename T, int C> class QVImageRetarderBlock: public QVProcessingBloc
 		void iterate()
 			{
 			// 0. Read input property values.
-			const QVImage<T,C> image = getPropertyValue< QVImage<uChar,C> >("Input image");
+			const QVImage<T,C> image = getPropertyValue< QVImage<T,C> >("Input image");
 			const int secondImageDelay = getPropertyValue<int>("Second image delay");
 
 			// 2. Insert new image in image cache
@@ -29,7 +29,7 @@ uint QVPropertyContainer::maxIdent = 0;
 // QVPropertyContainerInformer QVPropertyContainer::globalInformer;
 
 QVPropertyContainer::QVPropertyContainer(const QString name):
-    name(name), errorString(), variants(), safelyCopiedVariants(), minimum(),
+    name(name), errorString(), propertySlots(), variants(), safelyCopiedVariants(), slotNames(), minimum(),
     maximum(), _info(), io_flags(), link_flags(), insertion_order(),
     inputLinks(), outputLinks(), master(this), deepLevel(0)
     {
@@ -54,8 +54,8 @@ QVPropertyContainer::QVPropertyContainer(const QString name):
     }
 
 QVPropertyContainer::QVPropertyContainer(const QVPropertyContainer &cont):
-    name(cont.name), ident(cont.ident), errorString(cont.errorString), variants(cont.variants),
-    safelyCopiedVariants(cont.safelyCopiedVariants), minimum(cont.minimum), maximum(cont.maximum),
+    name(cont.name), ident(cont.ident), errorString(cont.errorString), propertySlots(cont.propertySlots),
+    variants(cont.variants), safelyCopiedVariants(cont.safelyCopiedVariants), slotNames(cont.slotNames), minimum(cont.minimum), maximum(cont.maximum),
     _info(cont._info), io_flags(cont.io_flags), link_flags(cont.link_flags), insertion_order(cont.insertion_order),
     RWLock(), inputLinks(cont.inputLinks), outputLinks(cont.outputLinks), master(this), deepLevel(0)
     {
@@ -83,8 +83,10 @@ QVPropertyContainer & QVPropertyContainer::operator=(const QVPropertyContainer &
     name = cont.name;
     ident = cont.ident;
     errorString = cont.errorString;
+    propertySlots = cont.propertySlots;
     variants = cont.variants;
     safelyCopiedVariants = cont.safelyCopiedVariants;
+    slotNames = cont.slotNames;
     minimum = cont.minimum;
     maximum = cont.maximum;
     _info = cont._info;
@@ -126,10 +128,10 @@ bool QVPropertyContainer::operator==(const QVPropertyContainer &cont) const
     { return (ident == cont.ident); }
 
 QList<QString> QVPropertyContainer::getPropertyList() const
-    { return variants.keys(); }
+    { return propertySlots.keys(); }
 
 bool QVPropertyContainer::containsProperty(const QString name) const
-    { return variants.contains(name); }
+    { return propertySlots.contains(name); }
 
 int QVPropertyContainer::getPropertyType(const QString name, bool *ok) const
     {
@@ -139,16 +141,18 @@ int QVPropertyContainer::getPropertyType(const QString name, bool *ok) const
         return QVariant::Invalid;
         }
     if(ok != NULL) *ok = TRUE;
-    QVariant variant = variants.value(name);
-    return variant.userType();
+    return variants.at(propertySlots.value(name)).userType();
     }
 
 bool QVPropertyContainer::removeProperty(const QString name)
     {
     if(not checkExists(name,"QVPropertyContainer::removeProperty()"))
         return FALSE;
-    this->variants.remove(name);
-    this->safelyCopiedVariants.remove(name);
+    // The slot is left empty, and not reused by new properties:
+    const int slot = this->propertySlots.take(name);
+    this->variants[slot] = QVariant();
+    this->safelyCopiedVariants[slot] = QVariant();
+    this->slotNames[slot] = QString();
     this->minimum.remove(name);
     this->maximum.remove(name);
     this->_info.remove(name);
@@ -211,8 +215,9 @@ QVariant QVPropertyContainer::getPropertyQVariantValue(const QString name, bool
         if(ok != NULL) *ok = FALSE;
     } else {
         if(ok != NULL) *ok = TRUE;
+        return variants.at(propertySlots.value(name));
     }
-    return variants[name];
+    return QVariant();
     }
 
 QString QVPropertyContainer::getPropertyInfo(const QString name, bool *ok) const
@@ -329,7 +334,7 @@ bool QVPropertyContainer::correctRange(QString name, const int & value) const
 
 bool QVPropertyContainer::checkExists(const QString name, const QString methodname) const
     {
-    if(not variants.contains(name))
+    if(not propertySlots.contains(name))
         {
         QString str =  methodname + ": property " + name +
                        " doesn't exists in holder " + getName() + ".";
@@ -343,9 +348,24 @@ bool QVPropertyContainer::checkExists(const QString name, const QString methodna
         }
     }
 
+bool QVPropertyContainer::checkHandle(const int slot, const char *methodname) const
+    {
+    if(slot < 0 or slot >= slotNames.size() or slotNames.at(slot).isNull())
+        {
+        QString str =  QString(methodname) + ": invalid property handle for holder " + getName() + ".";
+        setLastError(str);
+        if(qvApp->isRunning()) {
+            std::cerr << qPrintable("Warning: " + str + "\n");
+        } // Otherwise, qApp will show the error and won't start the program.
+        return FALSE;
+        } else {
+        return TRUE;
+        }
+    }
+
 bool QVPropertyContainer::checkIsNewProperty(const QString name, const QString methodname) const
     {
-    if(variants.contains(name))
+    if(propertySlots.contains(name))
         {
         QString str =  methodname + "(): property " + name +
                        " already exists in holder " + getName() + ".";
@@ -436,12 +456,12 @@ bool QVPropertyContainer::linkProperty(QString prop_orig, QVPropertyContainer *q
         // Now, we initialize the shared state, simply protected by the
         // corresponding RWLock:
         this->RWLock.lockForWrite();
-        safelyCopiedVariants[prop_orig] = variants[prop_orig];
+        safelyCopiedVariants[link->slot_orig] = variants[link->slot_orig];
         this->RWLock.unlock();
 
         if (link_type == QVPropertyContainer::AsynchronousLink)
             informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::LinkAdd, this->getName(), this->getId(), prop_orig, qvp_dest->getName(), qvp_dest->getId(), prop_dest,FALSE,FALSE));
-        else if (link_type == QVPropertyContainer::SynchronousLink)
+        else if (link_type == QVPropertyContainer::SynchronousLink or link_type == QVPropertyContainer::BufferedLink)
             informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::LinkAdd, this->getName(), this->getId(), prop_orig, qvp_dest->getName(), qvp_dest->getId(), prop_dest,TRUE, FALSE));
         else
             informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::LinkAdd, this->getName(), this->getId(), prop_orig, qvp_dest->getName(), qvp_dest->getId(), prop_dest,FALSE, TRUE));
@@ -558,6 +578,7 @@ bool QVPropertyContainer::unlinkProperty(QString origName, QVPropertyContainer *
                 // Protect against a possible pending acquire() for our output
                 // in other holders:
                 link->SyncSemaphoreOut.release();
+                if (link->ringBuffer != NULL) link->ringBuffer->wake();
                 destCont->treatUnlinkInputProperty(destName, this, origName);
                 // This ProcessSequentialUnlink cannot generate a core for acceding to all group nodes
                 // because the two QVPropertyContainer's are in the same thread and its unlinks
@@ -590,6 +611,7 @@ void QVPropertyContainer::unlink()
             // Protect against a possible pending acquire() from our input
             // in other holders:
             link->SyncSemaphoreIn.release();
+            if (link->ringBuffer != NULL) link->ringBuffer->wake();
             // This ProcessSequentialUnlink cannot generate a core for acceding to all group nodes
             // because the two QVPropertyContainer's are in the same thread and its unlinks
             // are doing sequentialy
@@ -606,6 +628,7 @@ void QVPropertyContainer::unlink()
                 // Protect against a possible pending acquire() for our output
                 // in other holders:
                 link->SyncSemaphoreOut.release();
+                if (link->ringBuffer != NULL) link->ringBuffer->wake();
                 if (link->qvp_dest != NULL) link->qvp_dest->treatUnlinkInputProperty(link->prop_dest, this, link->prop_orig);
                 // This ProcessSequentialUnlink cannot generate a core for acceding to all group nodes
                 // because the two QVPropertyContainer's are in the same thread and its unlinks
@@ -629,6 +652,8 @@ void QVPropertyContainer::readInputProperties()
     // a new value if it needs to, because we have read the old value yet.
     // This is implemented by releasing the SyncSemaphoreIn associated to
     // the link.
+    // Buffered links do not use the shared copy: the value is taken from the
+    // queue of the link, waiting for the producer only if it is empty.
     QMutableMapIterator<QString, QVPropertyContainerLink*> i(inputLinks);
     while (i.hasNext()) {
         i.next();
@@ -639,6 +664,15 @@ void QVPropertyContainer::readInputProperties()
             i.remove();
             toDeleteLink(link);
         }
+        else if(link->link_type == BufferedLink) {
+            QVLinkRingBuffer *ring = link->ringBuffer;
+            if (ring->isEmpty())
+                {
+                ring->addConsumerStall();
+                ring->waitForData(link->markedForDeletion);
+                }
+            ring->tryPop(this->variants[link->slot_dest]);
+        }
         else {
             if(link->link_type == SynchronousLink) {
                 link->SyncSemaphoreOut.acquire();
@@ -646,7 +680,7 @@ void QVPropertyContainer::readInputProperties()
             if (link->link_type != SequentialLink)
                 link->qvp_orig->RWLock.lockForRead();
             //this->setPropertyValueQVariant(link->prop_dest,link->qvp_orig->safelyCopiedVariants[link->prop_orig]);
-            this->variants[link->prop_dest] = link->qvp_orig->safelyCopiedVariants[link->prop_orig];
+            this->variants[link->slot_dest] = link->qvp_orig->safelyCopiedVariants.at(link->slot_orig);
             if (link->link_type != SequentialLink)
                 link->qvp_orig->RWLock.unlock();
             if(link->link_type == SynchronousLink) {
@@ -655,6 +689,7 @@ void QVPropertyContainer::readInputProperties()
         }
     }
     informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::PropertiesValues));
+    informer.emitLinksUpdated();
 }
 
 void QVPropertyContainer::writeOutputProperties()
@@ -673,6 +708,11 @@ void QVPropertyContainer::writeOutputProperties()
             if(link->link_type == SynchronousLink and not link->markedForDeletion) {
                 link->SyncSemaphoreIn.acquire();
             }
+            else if(link->link_type == BufferedLink and not link->ringBuffer->hasRoom()) {
+                // The consumer is a whole queue behind, so we wait for it to read:
+                link->ringBuffer->addProducerStall();
+                link->ringBuffer->waitForRoom(link->markedForDeletion);
+            }
             else if(link->link_type == SequentialLink and not link->markedForDeletion) {
                 someSequential = true;
             }
@@ -686,8 +726,11 @@ void QVPropertyContainer::writeOutputProperties()
         this->RWLock.lockForWrite();
     while (i.hasNext()) {
         i.next();
-        QString prop_orig = i.key();
-        safelyCopiedVariants[prop_orig] = variants[prop_orig];
+        // Every link of an output property has the same source slot:
+        if (not i.value().isEmpty()) {
+            const int slot_orig = i.value().first()->slot_orig;
+            safelyCopiedVariants[slot_orig] = variants.at(slot_orig);
+        }
     }
     if (!someSequential)
         this->RWLock.unlock();
@@ -704,6 +747,9 @@ void QVPropertyContainer::writeOutputProperties()
             if(link->link_type == SynchronousLink and not link->markedForDeletion) {
                 link->SyncSemaphoreOut.release();
             }
+            else if(link->link_type == BufferedLink and not link->markedForDeletion) {
+                link->ringBuffer->tryPush(variants.at(link->slot_orig));
+            }
             // Possible link deletion:
             if(link->markedForDeletion) {
                 j.remove();
@@ -715,8 +761,50 @@ void QVPropertyContainer::writeOutputProperties()
             }
         }
     }
+    informer.emitLinksUpdated();
 }
 
+bool QVPropertyContainer::areSynchronousInputsReady(const QSet<QVPropertyContainer *> &ignored) const
+    {
+    // readInputProperties() only waits on the SyncSemaphoreOut of synchronous links, and only this container
+    // acquires it, so once available it will stay available until our next read.
+    foreach(QVPropertyContainerLink *link, inputLinks)
+        if (link->link_type == SynchronousLink and not link->markedForDeletion and not ignored.contains(link->qvp_orig)
+            and link->SyncSemaphoreOut.available() == 0)
+            return false;
+        else if (link->link_type == BufferedLink and not link->markedForDeletion and not ignored.contains(link->qvp_orig)
+            and link->ringBuffer->isEmpty())
+            return false;
+    return true;
+    }
+
+bool QVPropertyContainer::areSynchronousOutputsFree(const QSet<QVPropertyContainer *> &ignored) const
+    {
+    // Same for writeOutputProperties() and the SyncSemaphoreIn of the output synchronous links.
+    foreach(QList<QVPropertyContainerLink*> links, outputLinks)
+        foreach(QVPropertyContainerLink *link, links)
+            if (link->link_type == SynchronousLink and not link->markedForDeletion and not ignored.contains(link->qvp_dest)
+                and link->SyncSemaphoreIn.available() == 0)
+                return false;
+            else if (link->link_type == BufferedLink and not link->markedForDeletion and not ignored.contains(link->qvp_dest)
+                and not link->ringBuffer->hasRoom())
+                return false;
+    return true;
+    }
+
+QList<QVPropertyContainer *> QVPropertyContainer::getLinkedContainers() const
+    {
+    QSet<QVPropertyContainer *> containers;
+    foreach(QVPropertyContainerLink *link, inputLinks)
+        if (not link->markedForDeletion)
+            containers.insert(link->qvp_orig);
+    foreach(QList<QVPropertyContainerLink*> links, outputLinks)
+        foreach(QVPropertyContainerLink *link, links)
+            if (not link->markedForDeletion)
+                containers.insert(link->qvp_dest);
+    return containers.toList();
+    }
+
 void QVPropertyContainer::toDeleteLink(QVPropertyContainerLink* link)
     {
         if (link->qvp_orig == this) {
@@ -779,6 +867,57 @@ bool QVPropertyContainer::isSequential(const QString name) const
         return FALSE;
     }
 
+bool QVPropertyContainer::isBuffered(const QString name) const
+    {
+        const QMap<QString, QVPropertyContainerLink* > inLinks = getInputLinks();
+        if (inLinks.contains(name))
+            return (inLinks.value(name)->link_type == BufferedLink);
+
+        return FALSE;
+    }
+
+bool QVPropertyContainer::setBufferedLinkDepth(const QString sourcePropName, QVPropertyContainer *destinyContainer, const QString destinyPropName, const int depth)
+    {
+    if(qvApp->isRunning())
+        {
+        setLastError("QVPropertyContainer::setBufferedLinkDepth(): cannot change the depth of a link after launching QVApplication.\n");
+        return FALSE;
+        }
+    else if (depth < 1)
+        {
+        setLastError(QString("QVPropertyContainer::setBufferedLinkDepth(): invalid depth %1 for property %2 of holder %3.\n")
+                    .arg(depth).arg(sourcePropName).arg(getName()));
+        return FALSE;
+        }
+
+    foreach(QVPropertyContainerLink* link, outputLinks.value(sourcePropName))
+        if (link->qvp_dest == destinyContainer and link->prop_dest == destinyPropName and not link->markedForDeletion
+            and link->link_type == BufferedLink)
+            {
+            link->ringBuffer->setDepth(depth);
+            return TRUE;
+            }
+
+    setLastError(QString("QVPropertyContainer::setBufferedLinkDepth(): property %1 of holder %2 has no buffered link to property %3.\n")
+                .arg(sourcePropName).arg(getName()).arg(destinyPropName));
+    return FALSE;
+    }
+
+bool QVPropertyContainer::getBufferedLinkStats(const QString name, int &occupancy, int &maxOccupancy, int &producerStalls, int &consumerStalls) const
+    {
+    occupancy = maxOccupancy = producerStalls = consumerStalls = 0;
+
+    const QVPropertyContainerLink *link = inputLinks.value(name, NULL);
+    if (link == NULL or link->link_type != BufferedLink)
+        return FALSE;
+
+    occupancy = link->ringBuffer->getOccupancy();
+    maxOccupancy = link->ringBuffer->getMaxOccupancy();
+    producerStalls = link->ringBuffer->getProducerStalls();
+    consumerStalls = link->ringBuffer->getConsumerStalls();
+    return TRUE;
+    }
+
 bool QVPropertyContainer::areSynchronized(const QList<QVPropertyContainer *> conts)
     {
     QVDisjointSet dSet(conts.size());
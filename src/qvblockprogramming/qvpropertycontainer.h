@@ -29,10 +29,12 @@
 #include <QVariant>
 #include <QRegExp>
 #include <QSet>
+#include <QVector>
 #include <QReadWriteLock>
 #include <QSemaphore>
 #include <QDebug>
 #include <QVPropertyContainerChange>
+#include <qvblockprogramming/qvlinkringbuffer.h>
 
 #include <iostream>
 #include <QVApplication>
@@ -57,15 +59,65 @@ class QVPropertyContainerInformer : public QObject
             void emitChange(QVPropertyContainerChange change) {
                 emit changed(change);
             }
+
+            /// @brief Emit the signal linksUpdated.
+            void emitLinksUpdated() {
+                emit linksUpdated();
+            }
         signals:
             /// @brief Signal emited when the property container id changed.
             ///
             /// @param change Type of change done.
             void changed(QVPropertyContainerChange change);
+
+            /// @brief Signal emited when the property container reads its input properties, or writes its output
+            /// properties, so the containers linked to it can be ready to read or write theirs.
+            void linksUpdated();
     };
 
 #endif
 
+/*!
+@class QVPropertyHandle qvblockprogramming/qvpropertycontainer.h QVPropertyContainer
+@brief Typed reference to a property of a QVPropertyContainer.
+
+A handle identifies a property by the position where its value is stored in the container, so it can be used to
+read and write the property without looking up its name. Handles are obtained with
+QVPropertyContainer::getPropertyHandle(), usually in the constructor of a block, and used in its iterate() function:
+
+\code
+MyBlock::MyBlock(QString name): QVProcessingBlock(name)
+    {
+    addProperty< QVImage<uChar,1> >("Input image", inputFlag|outputFlag);
+    inputImage = getPropertyHandle< QVImage<uChar,1> >("Input image");
+    }
+
+void MyBlock::iterate()
+    {
+    const QVImage<uChar,1> image = getPropertyValue(inputImage);
+    [...]
+    }
+\endcode
+
+A handle is only valid for the container that returned it, and while the property is not removed.
+
+@ingroup qvblockprogramming
+*/
+template <class Type> class QVPropertyHandle
+    {
+    public:
+        /// @brief Constructs an invalid handle.
+        QVPropertyHandle(): slot(-1)        { }
+
+        /// @brief Tells if the handle refers to a property.
+        bool isValid() const                { return slot >= 0; }
+
+    private:
+        friend class QVPropertyContainer;
+        explicit QVPropertyHandle(const int slot): slot(slot)   { }
+        int slot;
+    };
+
 /*!
 @class QVPropertyContainer
 @brief Base class for dynamic property container objects.
@@ -124,8 +176,16 @@ class QVPropertyContainer
         /// QVPropertyContainer, and if they are QVProcessingBlocks they will be moved and executed
         /// by his master's thread.
         ///
+        /// Finally, a buffered link has the same semantics as a synchronous link (every data
+        /// produced by the source is consumed by the destination, in the same order), but the
+        /// values are passed through a bounded queue instead of a single shared copy, so the
+        /// source can run up to a given number of iterations ahead of the destination. Neither
+        /// side takes any lock or semaphore to pass the values, unless the queue is full or empty
+        /// and it has to wait for the other side. The depth of the queue can be changed with
+        /// setBufferedLinkDepth().
+        ///
         /// See also the QVPropertyContainer::linkProperty() method.
-        typedef enum {AsynchronousLink,SynchronousLink,SequentialLink} LinkType;
+        typedef enum {AsynchronousLink,SynchronousLink,SequentialLink,BufferedLink} LinkType;
 
         /// @brief Flags for each property.
         ///
@@ -197,7 +257,7 @@ class QVPropertyContainer
         template <class Type> QList<QString> getPropertyListByType() const
             {
             QList<QString> result;
-            QList<QString> names = variants.keys();
+            QList<QString> names = propertySlots.keys();
 
             for(QList<QString>::iterator i = names.begin();i != names.end();++i)
                 if(isType<Type>(*i))
@@ -222,10 +282,11 @@ class QVPropertyContainer
                 return FALSE;
                 }
             if(ok != NULL) *ok = TRUE;
+            const QVariant &variant = variants.at(propertySlots.value(name));
             QVariant::Type type = QVariant::fromValue(Type()).type();
-            if ((type != QVariant::UserType) && (variants[name].type() == type))
+            if ((type != QVariant::UserType) && (variant.type() == type))
                 return TRUE;
-            if (variants[name].userType() == QVariant::fromValue(Type()).userType())
+            if (variant.userType() == QVariant::fromValue(Type()).userType())
                 return TRUE;
             return FALSE;
             }
@@ -304,7 +365,11 @@ class QVPropertyContainer
             io_flags[name] = flags;
             link_flags[name] = noLinkFlag;
 
-            variants[name] = variant;
+            // Slots are never reused, so handles to removed properties do not point to a different property.
+            propertySlots[name] = variants.size();
+            variants.append(variant);
+            safelyCopiedVariants.append(QVariant());
+            slotNames.append(name);
 
             informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::PropertyAdd, name));
             return TRUE;
@@ -382,13 +447,35 @@ class QVPropertyContainer
                 return FALSE;
             else {
                 QVariant variant =  QVariant::fromValue<Type>(value);
-                variants[name] = variant;
+                variants[propertySlots.value(name)] = variant;
 
                 informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::PropertyValue, name, variant));
                 return TRUE;
                 }
             }
 
+        /// @brief Sets value for property, given a handle to it.
+        ///
+        /// Same as setPropertyValue(const QString, const Type &), but without looking up the property by its name.
+        /// @param handle Handle to the property, obtained with getPropertyHandle().
+        /// @param value Value to set the property with.
+        /// @return True if the value was set successfully.
+        template <class Type> bool setPropertyValue(const QVPropertyHandle<Type> &handle, const Type &value)
+            {
+            if(not checkHandle(handle.slot,"QVPropertyContainer::setPropertyValue()"))
+                return FALSE;
+
+            const QString &name = slotNames.at(handle.slot);
+            if (not correctRange(name,value))
+                return FALSE;
+
+            QVariant &variant = variants[handle.slot];
+            variant.setValue<Type>(value);
+
+            informer.emitChange(QVPropertyContainerChange(this->getName(), this->getId(), QVPropertyContainerChange::PropertyValue, name, variant));
+            return TRUE;
+            }
+
         /// @brief Method to get the actual value of a property.
         ///
         /// @param name Identifying QString for the property.
@@ -401,8 +488,40 @@ class QVPropertyContainer
                 if(ok != NULL) *ok = FALSE;
             } else {
                 if(ok != NULL) *ok = TRUE;
+                return variants.at(propertySlots.value(name)).value<Type>();
             }
-            return variants[name].value<Type>();
+            return Type();
+            }
+
+        /// @brief Method to get the actual value of a property, given a handle to it.
+        ///
+        /// Same as getPropertyValue(const QString, bool *), but without looking up the property by its name.
+        /// @param handle Handle to the property, obtained with getPropertyHandle().
+        /// @return Actual value for the property.
+        template <class Type> Type getPropertyValue(const QVPropertyHandle<Type> &handle) const
+            {
+            if(not checkHandle(handle.slot,"QVPropertyContainer::getPropertyValue()"))
+                return Type();
+            return variants.at(handle.slot).value<Type>();
+            }
+
+        /// @brief Gets a handle to a property.
+        ///
+        /// The handle can be used instead of the name of the property in getPropertyValue() and
+        /// setPropertyValue(), to avoid looking up the property each time it is accessed.
+        /// @param name Identifying QString for the property.
+        /// @return Handle to the property, or an invalid handle if the container has no property with that name and
+        ///         type.
+        template <class Type> QVPropertyHandle<Type> getPropertyHandle(const QString name) const
+            {
+            if(not isType<Type>(name))
+                {
+                if (containsProperty(name))
+                    setLastError("QVPropertyContainer::getPropertyHandle(): property " + name + " in holder " +
+                                 getName() + " is not of the requested type.");
+                return QVPropertyHandle<Type>();
+                }
+            return QVPropertyHandle<Type>(propertySlots.value(name));
             }
 
         /// @brief Method to get the value of a property as a QVariant.
@@ -606,10 +725,52 @@ class QVPropertyContainer
         /// @return TRUE if a property is linked Sequentialy, FALSE if is not linked.
         bool isSequential(const QString name) const;
 
+        /// @brief Check if a property is linked with a buffered link.
+        ///
+        /// @param name Name of the property.
+        /// @return TRUE if a property is linked with a buffered link, FALSE if is not linked.
+        bool isBuffered(const QString name) const;
+
+        /// @brief Sets the depth of a buffered link.
+        ///
+        /// Sets the maximum number of values the source of a buffered link can write before the destination reads
+        /// them. It must be called on the source container, before launching the QVApplication.
+        ///
+        /// @param sourcePropName Name of the source property.
+        /// @param destinyContainer Destination QVPropertyContainer.
+        /// @param destinyPropName Name of the destination property.
+        /// @param depth Number of values in the queue of the link. Must be positive.
+        /// @return TRUE if the depth was changed, FALSE if the link does not exist or is not a BufferedLink.
+        bool setBufferedLinkDepth(const QString sourcePropName, QVPropertyContainer *destinyContainer, const QString destinyPropName, const int depth);
+
+        /// @brief Gets the state of the queue of a buffered input link.
+        ///
+        /// All the counts are zero if the input property is not linked with a buffered link.
+        ///
+        /// @param name Name of the input property.
+        /// @param occupancy Number of values currently waiting in the queue.
+        /// @param maxOccupancy Maximum number of values that were waiting in the queue at the same time.
+        /// @param producerStalls Number of times the source had to wait because the queue was full.
+        /// @param consumerStalls Number of times the destination had to wait because the queue was empty.
+        /// @return TRUE if the property is linked with a buffered link.
+        bool getBufferedLinkStats(const QString name, int &occupancy, int &maxOccupancy, int &producerStalls, int &consumerStalls) const;
+
+        /// @brief Default depth for new buffered links.
+        static const int defaultBufferedLinkDepth = 4;
+
         #ifndef DOXYGEN_IGNORE_THIS
         virtual bool linkUnspecifiedInputProperty(QVPropertyContainer *sourceContainer, QString sourcePropName, LinkType linkType = AsynchronousLink);
         virtual bool linkUnspecifiedOutputProperty(QVPropertyContainer *destContainer, QString destPropName, LinkType linkType = AsynchronousLink);
         virtual bool treatUnlinkInputProperty(QString destPropName, QVPropertyContainer *sourceCont, QString sourcePropName);
+
+        // Non-blocking checks for the block scheduler. They return whether readInputProperties() and
+        // writeOutputProperties() can be called without waiting on a synchronous link. Links with the containers in
+        // 'ignored' are not checked.
+        bool areSynchronousInputsReady(const QSet<QVPropertyContainer *> &ignored = QSet<QVPropertyContainer *>()) const;
+        bool areSynchronousOutputsFree(const QSet<QVPropertyContainer *> &ignored = QSet<QVPropertyContainer *>()) const;
+
+        // Containers linked to any input or output property of this container.
+        QList<QVPropertyContainer *> getLinkedContainers() const;
         #endif
 
         bool isSequentialGroupMaster() const	{ return master == this; }
@@ -712,7 +873,10 @@ class QVPropertyContainer
         QString name;
         uint ident;
         mutable QString errorString;
-        QMap<QString, QVariant> variants,safelyCopiedVariants;
+        // Values of the properties, stored by slot. The slot of each property does not change once added.
+        QMap<QString, int> propertySlots;
+        QVector<QVariant> variants,safelyCopiedVariants;
+        QVector<QString> slotNames;
         QMap<QString, QVariant> minimum, maximum;
         QMap<QString, QString> _info;
         QMap<QString, PropertyFlags> io_flags;
@@ -726,20 +890,25 @@ class QVPropertyContainer
         QReadWriteLock RWLock;
         class QVPropertyContainerLink {
           public:
-            QVPropertyContainerLink(QVPropertyContainer *_qvp_orig,QString _prop_orig,QVPropertyContainer *_qvp_dest,QString _prop_dest,LinkType _link_type) : qvp_orig(_qvp_orig), prop_orig(_prop_orig), qvp_orig_name(_qvp_orig->getName()), qvp_orig_id(_qvp_orig->getId()), qvp_dest(_qvp_dest), prop_dest(_prop_dest), qvp_dest_name(_qvp_dest->getName()), qvp_dest_id(_qvp_dest->getId()), link_type(_link_type), markedForDeletion(FALSE) {
+            QVPropertyContainerLink(QVPropertyContainer *_qvp_orig,QString _prop_orig,QVPropertyContainer *_qvp_dest,QString _prop_dest,LinkType _link_type) : qvp_orig(_qvp_orig), prop_orig(_prop_orig), qvp_orig_name(_qvp_orig->getName()), qvp_orig_id(_qvp_orig->getId()), qvp_dest(_qvp_dest), prop_dest(_prop_dest), qvp_dest_name(_qvp_dest->getName()), qvp_dest_id(_qvp_dest->getId()), slot_orig(_qvp_orig->propertySlots.value(_prop_orig)), slot_dest(_qvp_dest->propertySlots.value(_prop_dest)), link_type(_link_type), markedForDeletion(FALSE),
+                ringBuffer(_link_type == BufferedLink? new QVLinkRingBuffer(defaultBufferedLinkDepth) : NULL) {
                 // SyncSemaphoreIn value must initially be 1:
                 SyncSemaphoreIn.release();
                 // SyncSemaphoreOut is simply initialized with 0 (default value).
             };
+            ~QVPropertyContainerLink() { delete ringBuffer; }
             QVPropertyContainer *qvp_orig;
             QString prop_orig, qvp_orig_name;
             uint qvp_orig_id;
             QVPropertyContainer *qvp_dest;
             QString prop_dest, qvp_dest_name;
             uint qvp_dest_id;
+            int slot_orig, slot_dest;
             LinkType link_type;
             QSemaphore SyncSemaphoreIn,SyncSemaphoreOut;
             bool markedForDeletion;
+            // Queue of values for buffered links, NULL for the other link types.
+            QVLinkRingBuffer *ringBuffer;
         };
         QMap<QString, QVPropertyContainerLink* > inputLinks;
         QMap<QString, QList<QVPropertyContainerLink*> > outputLinks;
@@ -865,6 +1034,7 @@ class QVPropertyContainer
         }
 
         bool checkExists(const QString name, const QString methodname) const;
+        bool checkHandle(const int slot, const char *methodname) const;
         bool checkIsNewProperty(const QString name, const QString methodname) const;
     };
 
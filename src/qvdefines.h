@@ -144,6 +144,32 @@ long long getMicroseconds();
 Q_DECLARE_METATYPE(IppiMaskSize);
 Q_DECLARE_METATYPE(IppCmpOp);
 Q_DECLARE_METATYPE(IppRoundMode);
+#else // QVIPP
+#ifndef DOXYGEN_IGNORE_THIS
+// Subset of the IPP types and constants used in the signatures of the image functions which are available without
+// the IPP. Their values are those of the IPP, so code using them does not change when the IPP is enabled.
+typedef enum {
+	ippMskSize1x3 = 13,
+	ippMskSize1x5 = 15,
+	ippMskSize3x1 = 31,
+	ippMskSize3x3 = 33,
+	ippMskSize5x1 = 51,
+	ippMskSize5x5 = 55
+} IppiMaskSize;
+
+typedef enum {
+	ippRndZero = 0,
+	ippRndNear = 1
+} IppRoundMode;
+
+enum {
+	IPPI_INTER_NN = 1,
+	IPPI_INTER_LINEAR = 2,
+	IPPI_INTER_CUBIC = 4,
+	IPPI_INTER_SUPER = 8,
+	IPPI_INTER_LANCZOS = 16
+};
+#endif // DOXYGEN_IGNORE_THIS
 #endif // QVIPP
 
 #ifndef DOXYGEN_IGNORE_THIS
@@ -25,11 +25,97 @@
 #include <QVDirReader>
 
 #include <QUrl>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QRunnable>
+#include <QThread>
+#include <QRegExp>
 
 #ifdef QVIPP
 #include <qvipp.h>
 #endif // QVIPP
 
+// Decodes an image file, splitting its pixels directly in the three channel planes (without the intermediate
+// QVImage<uChar,3> image). Files which can not be read give empty images, as the former QVImage<uChar,3> constructor.
+static void decodeImageFile(const QString &fileName, QVImage<uChar,1> &imgR, QVImage<uChar,1> &imgG, QVImage<uChar,1> &imgB)
+    {
+    QImage loaded;
+    loaded.load(fileName);
+    const QImage qimg = (loaded.format() == QImage::Format_RGB32 or loaded.format() == QImage::Format_ARGB32)?
+                        loaded: loaded.convertToFormat(QImage::Format_ARGB32);
+
+    const int cols = qimg.width(), rows = qimg.height();
+    imgR = QVImage<uChar>(cols, rows);
+    imgG = QVImage<uChar>(cols, rows);
+    imgB = QVImage<uChar>(cols, rows);
+
+    const int stepR = imgR.getStep(), stepG = imgG.getStep(), stepB = imgB.getStep();
+    uChar *dataR = imgR.getWriteData(), *dataG = imgG.getWriteData(), *dataB = imgB.getWriteData();
+    for(int row = 0; row < rows; row++)
+        {
+        const QRgb *line = reinterpret_cast<const QRgb *>(qimg.scanLine(row));
+        uChar *lineR = dataR + row*stepR, *lineG = dataG + row*stepG, *lineB = dataB + row*stepB;
+        for(int col = 0; col < cols; col++)
+            {
+            lineR[col] = qRed(line[col]);
+            lineG[col] = qGreen(line[col]);
+            lineB[col] = qBlue(line[col]);
+            }
+        }
+    }
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Decoding of one file, shared by the reader queue and the pool task. A job removed from the queue by a seek is
+// cancelled, so its task does not decode the file if it did not start yet.
+class QVDirReaderDecodeJob
+    {
+    public:
+        QVDirReaderDecodeJob(const QString &fileName, const int fileIndex):
+            fileName(fileName), fileIndex(fileIndex), done(false), cancelled(0)  { }
+
+        const QString fileName;
+        const int fileIndex;
+        QVImage<uChar,1> imgR, imgG, imgB;
+
+        void decode()
+            {
+            if(cancelled == 0)
+                decodeImageFile(fileName, imgR, imgG, imgB);
+
+            QMutexLocker locker(&mutex);
+            done = true;
+            finished.wakeAll();
+            }
+
+        void wait()
+            {
+            QMutexLocker locker(&mutex);
+            while(not done)
+                finished.wait(&mutex);
+            }
+
+        void cancel()   { cancelled.fetchAndStoreOrdered(1); }
+
+    private:
+        QMutex mutex;
+        QWaitCondition finished;
+        bool done;
+        QAtomicInt cancelled;
+    };
+
+class QVDirReaderDecodeTask : public QRunnable
+    {
+    public:
+        QVDirReaderDecodeTask(const QSharedPointer<QVDirReaderDecodeJob> &job): QRunnable(), job(job)   { }
+        void run()  { job->decode(); }
+
+    private:
+        QSharedPointer<QVDirReaderDecodeJob> job;
+    };
+#endif // DOXYGEN_IGNORE_THIS
+
 bool QVDirReader:: open(const QString & url_string,
                          unsigned int & suggested_cols, unsigned int & suggested_rows,
                          unsigned int & suggested_fps, QVVideoReader::OpenOptions & suggested_options,
@@ -40,9 +126,21 @@ bool QVDirReader:: open(const QString & url_string,
         source_mode = QVVideoReader::RGBMode;
 
         ended = false;
+        flushDecoding();
 
-        // Treat both isolated directory names and path to files (with possible wildcards):
+        // Number of files decoded ahead, optionally given with a '#decoders=N' suffix (0 decodes each file in
+        // the calling thread when grabbed):
         QString dir_string = url_string;
+        decoders = QThread::idealThreadCount();
+        QRegExp decoders_suffix("#decoders=(\\d+)$");
+        if(decoders_suffix.indexIn(dir_string) != -1)
+            {
+            decoders = decoders_suffix.cap(1).toInt();
+            dir_string.truncate(decoders_suffix.pos(0));
+            }
+        decodePool.setMaxThreadCount(qMax(decoders, 1));
+
+        // Treat both isolated directory names and path to files (with possible wildcards):
         dir_string.remove("dir://");
         QStringList filters;
         QFileInfo info(dir_string);
@@ -78,7 +176,7 @@ bool QVDirReader:: open(const QString & url_string,
         suggested_cols = suggested_rows = 0;
 
         if(filenames.size() > 0) {
-            index = 0;
+            index = nextIndex = 0;
             return true;
         } else
             return false;
@@ -86,19 +184,60 @@ bool QVDirReader:: open(const QString & url_string,
 
 bool QVDirReader::close()
 {
+    flushDecoding();
+    decodePool.waitForDone();
     return true;
 }
 
+// Keeps 'decoders' files following the last scheduled one being decoded in the pool.
+void QVDirReader::scheduleDecoding()
+{
+    while(decodeQueue.size() < decoders) {
+        if(nextIndex >= filenames.size()) {
+            if(noLoop)
+                break;
+            nextIndex = 0;
+        }
+        QSharedPointer<QVDirReaderDecodeJob> job(
+            new QVDirReaderDecodeJob(dir.absolutePath() + "/" + filenames.at(nextIndex), nextIndex));
+        decodeQueue.enqueue(job);
+        decodePool.start(new QVDirReaderDecodeTask(job));
+        nextIndex++;
+    }
+}
+
+// Discards the files being decoded ahead. Tasks already running finish in the pool, and their result is dropped.
+void QVDirReader::flushDecoding()
+{
+    while(not decodeQueue.isEmpty())
+        decodeQueue.dequeue()->cancel();
+}
+
 bool QVDirReader::grab(QVImage<uChar,1> &imgR, QVImage<uChar,1> &imgG, QVImage<uChar,1> &imgB)
 {
         if(ended)
             return false;
 
-        QString fullpathtofile = dir.absolutePath() + "/" + filenames.at(index);
+        if(decoders == 0) {
+            QString fullpathtofile = dir.absolutePath() + "/" + filenames.at(index);
+
+            //std::cout << "QVDirReader::grab: Read file " << qPrintable(fullpathtofile) << "\n";
 
-        //std::cout << "QVDirReader::grab: Read file " << qPrintable(fullpathtofile) << "\n";
+            decodeImageFile(fullpathtofile, imgR, imgG, imgB);
+        } else {
+            scheduleDecoding();
 
-        QVImage<uchar,3> ColorImage(fullpathtofile);
+            // Files are queued in presentation order, so the head of the queue is the file at the current position:
+            QSharedPointer<QVDirReaderDecodeJob> job = decodeQueue.dequeue();
+            Q_ASSERT(job->fileIndex == index);
+            job->wait();
+            imgR = job->imgR;
+            imgG = job->imgG;
+            imgB = job->imgB;
+
+            // Reuse the released slot for the next file:
+            scheduleDecoding();
+        }
 
         /* Not needed yet (all resizing in qvvideoreader.cpp):
         if((cols_out != 0 and rows_out !=0) || (ColorImage.getRows()%2==1) || (ColorImage.getCols()%2==1)) {
@@ -112,13 +251,6 @@ bool QVDirReader::grab(QVImage<uChar,1> &imgR, QVImage<uChar,1> &imgG, QVImage<u
             ColorImage = InterImage;
         }*/
 
-        imgR = QVImage<uChar>(ColorImage.getCols(),ColorImage.getRows());
-        imgG = QVImage<uChar>(ColorImage.getCols(),ColorImage.getRows());
-        imgB = QVImage<uChar>(ColorImage.getCols(),ColorImage.getRows());
-        Copy(ColorImage,0,imgR);
-        Copy(ColorImage,1,imgG);
-        Copy(ColorImage,2,imgB);
-
         index = index + 1;
         if(index == filenames.size()) {
             if(noLoop) {
@@ -142,6 +274,7 @@ int QVDirReader::getPos()
 
 bool QVDirReader::seek(int pos)
 {
-    index = pos;
+    flushDecoding();
+    index = nextIndex = pos;
     return true;
 }
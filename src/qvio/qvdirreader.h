@@ -26,15 +26,24 @@
 #define QVDIRREADER_H
 
 #include <QDir>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 #include <QVBaseReader>
 
+#ifndef DOXYGEN_IGNORE_THIS
+class QVDirReaderDecodeJob;
+#endif
+
+// Image files are decoded ahead on a private thread pool. Up to 'decoders' files following the current position
+// are being decoded at any time, and are handed out in presentation order by grab().
 class QVDirReader : public QVBaseReader
     {
     public:
-        QVDirReader() : QVBaseReader() { };
+        QVDirReader() : QVBaseReader(), decoders(0), nextIndex(0) { };
 
-        ~QVDirReader() { };
+        ~QVDirReader() { close(); };
 
     private:
         QDir dir;
@@ -43,6 +52,14 @@ class QVDirReader : public QVBaseReader
         bool ended;
         bool noLoop,realTime;
 
+        // Decode-ahead state:
+        QThreadPool decodePool;
+        QQueue< QSharedPointer<QVDirReaderDecodeJob> > decodeQueue;
+        int decoders, nextIndex;
+
+        void scheduleDecoding();
+        void flushDecoding();
+
     protected:
         bool open(const QString & url_string,
                   unsigned int & suggested_cols, unsigned int & suggested_rows,
@@ -28,6 +28,8 @@
 #include <QDir>
 #include <QThread>
 #include <QTime>
+#include <QQueue>
+#include <QWaitCondition>
 
 #ifdef QVIPP
 #include <qvipp.h>
@@ -73,14 +75,126 @@ void simulateDelay(int fps)
     last_time.start();
 }
 
+// Thread that decodes the frames of a QVVideoReader in advance, and keeps them in a bounded queue.
+class QVVideoReaderPrefetcher : public QThread
+{
+public:
+    QVVideoReaderPrefetcher(QVVideoReader *reader): QThread(), reader(reader), stopping(false),
+        source_ended(false), generation(0), latency(0), dropped(0)
+    { }
+
+    ~QVVideoReaderPrefetcher()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        mutex.lock();
+        stopping = true;
+        not_full.wakeAll();
+        not_empty.wakeAll();
+        mutex.unlock();
+        wait();
+    }
+
+    // Takes the next frame from the queue, waiting for the decoding thread if it is empty. Returns false at the
+    // end of the video source.
+    bool dequeue(QVVideoReader::Frame &frame)
+    {
+        QMutexLocker locker(&mutex);
+        while(queue.isEmpty() and not source_ended and not stopping)
+            not_empty.wait(&mutex);
+        if(queue.isEmpty())
+            return false;
+        frame = queue.dequeue();
+        not_full.wakeOne();
+        return true;
+    }
+
+    // Discards the queued frames (and the one being decoded), after moving the video source to a new position.
+    void flush()
+    {
+        QMutexLocker locker(&mutex);
+        queue.clear();
+        generation++;
+        source_ended = false;
+        not_full.wakeAll();
+    }
+
+    int getQueueLength() const  { QMutexLocker locker(&mutex); return queue.size(); }
+    int getLatency() const      { QMutexLocker locker(&mutex); return latency; }
+    int getDropped() const      { QMutexLocker locker(&mutex); return dropped; }
+
+protected:
+    void run()
+    {
+        forever {
+            mutex.lock();
+            while(reader->prefetch_policy == QVVideoReader::BlockWhenFull and
+                  queue.size() >= reader->prefetch_depth and not stopping)
+                not_full.wait(&mutex);
+            const bool stop_now = stopping;
+            mutex.unlock();
+
+            if(stop_now)
+                return;
+
+            QTime time;
+            time.start();
+            QVVideoReader::Frame frame;
+
+            // The generation is read with the source locked, so a seek can not happen between reading it and
+            // grabbing the frame (see QVVideoReader::seek()):
+            reader->source_mutex.lock();
+            mutex.lock();
+            const int frame_generation = generation;
+            mutex.unlock();
+            const bool grabbed = reader->grabFromSource(frame);
+            reader->source_mutex.unlock();
+
+            if(grabbed)
+                frame.convert(reader->prefetch_formats);
+
+            QMutexLocker locker(&mutex);
+            latency = time.elapsed();
+            // The source was moved to another position while decoding this frame:
+            if(frame_generation != generation)
+                continue;
+            if(not grabbed)
+                {
+                source_ended = true;
+                not_empty.wakeAll();
+                // The thread is kept alive at the end of the source, until it is moved to another position:
+                while(frame_generation == generation and not stopping)
+                    not_full.wait(&mutex);
+                continue;
+                }
+            while(queue.size() >= reader->prefetch_depth)
+                {
+                queue.dequeue();
+                dropped++;
+                }
+            queue.enqueue(frame);
+            not_empty.wakeOne();
+        }
+    }
+
+private:
+    QVVideoReader *reader;
+    mutable QMutex mutex;
+    QWaitCondition not_empty, not_full;
+    QQueue<QVVideoReader::Frame> queue;
+    bool stopping, source_ended;
+    int generation, latency, dropped;
+};
+
 QVVideoReader::QVVideoReader():
     url(QString()), scheme(QString()),changing_size(false),cols(0), rows(0), fps(0), frames_grabbed(0),
-    camera_opened(FALSE), live_camera(FALSE), end_of_video(FALSE),
-    availableGray(false), availableRGB3(false), availableYUV(false), availableRGB(false),
-    imgGray(QVImage<uChar>()), imgRGB(QVImage<uChar,3>()),
-    imgY(QVImage<uChar>()), imgU(QVImage<uChar>()), imgV(QVImage<uChar>()),
-    imgR(QVImage<uChar>()), imgG(QVImage<uChar>()), imgB(QVImage<uChar>()),
-    open_options(QVVideoReader::Default), source_mode(QVVideoReader::YUVMode), base_reader(0)
+    camera_opened(FALSE), live_camera(FALSE), end_of_video(FALSE), current(),
+    open_options(QVVideoReader::Default), source_mode(QVVideoReader::YUVMode), base_reader(0),
+    source_mutex(), prefetch_depth(0), prefetch_policy(QVVideoReader::BlockWhenFull),
+    prefetch_formats(PrefetchFormats()), prefetcher(0)
     {
     };
 
@@ -89,16 +203,63 @@ QVVideoReader::~QVVideoReader()
     if (camera_opened)
         close();
 
+    stopPrefetch();
+
     if (base_reader != 0)
         delete base_reader;
     }
 
 
+void QVVideoReader::setPrefetch(const int depth, const TPrefetchPolicy policy, const PrefetchFormats formats)
+    {
+    if(camera_opened)
+        {
+        std::cout << "QVVideoReader::setPrefetch(): Warning: the prefetch queue can not be changed while the source is opened." << std::endl;
+        return;
+        }
+    prefetch_depth = (depth > 0)? depth : 0;
+    prefetch_policy = policy;
+    prefetch_formats = formats;
+    }
+
+int QVVideoReader::getPrefetchQueueLength() const
+    {
+    return (prefetcher != 0)? prefetcher->getQueueLength() : 0;
+    }
+
+int QVVideoReader::getDecodeLatency() const
+    {
+    return (prefetcher != 0)? prefetcher->getLatency() : 0;
+    }
+
+int QVVideoReader::getDroppedFrames() const
+    {
+    return (prefetcher != 0)? prefetcher->getDropped() : 0;
+    }
+
+void QVVideoReader::startPrefetch()
+    {
+    if(prefetch_depth > 0)
+        {
+        prefetcher = new QVVideoReaderPrefetcher(this);
+        prefetcher->start();
+        }
+    }
+
+void QVVideoReader::stopPrefetch()
+    {
+    // Deleting the prefetcher waits for its thread to finish the frame it is decoding:
+    delete prefetcher;
+    prefetcher = 0;
+    }
+
 bool QVVideoReader::open(const QString & url_string, unsigned int & suggested_cols,
                          unsigned int & suggested_rows , unsigned int & suggested_fps,
                          QVVideoReader::OpenOptions & suggested_opts,
                          QVVideoReader::TSourceMode & suggested_source_mode)
     {
+    stopPrefetch();
+
     if (base_reader != 0)
         delete base_reader;
 
@@ -280,10 +441,11 @@ bool QVVideoReader::open(const QString & url_string, unsigned int & suggested_co
             camera_opened = true;
             // live_camera initialized before;
             end_of_video = false;
-            availableGray = availableRGB3 = availableYUV = availableRGB = false;
+            current = Frame();
             open_options = suggested_opts;
             source_mode = suggested_source_mode;
             // base_reader initialized before;
+            startPrefetch();
             emit sourceOpened();
             return true;
             }
@@ -304,7 +466,7 @@ end_with_fail:
     camera_opened = false;
     live_camera = false;
     end_of_video = true;
-    availableGray = availableRGB3 = availableYUV = availableRGB = false;
+    current = Frame();
     open_options = QVVideoReader::Default;
     source_mode = suggested_source_mode;
     delete base_reader;
@@ -312,115 +474,101 @@ end_with_fail:
     return false;
     }
 
-bool QVVideoReader::grab()
+bool QVVideoReader::grabFromSource(Frame &frame)
     {
-    availableGray = availableRGB3 = availableYUV = availableRGB = false;
-
     if(source_mode == QVVideoReader::GrayOnlyMode)
         {
         QVImage<uChar> imgDummy1,imgDummy2;
-        if(base_reader->grab(imgGray, imgDummy1, imgDummy2))
-            {
-            availableGray = true;
-            frames_grabbed++;
-            emit newGrab();
-            if(fps != 0) simulateDelay(fps);
-            // Update cols and rows (as for some video sources this could change from frame to frame; i.e. when
-            // reading image files from a directory). Force here even number of cols and rows too (for possible
-            // YUV conversions, with U and V half-sized):
-            if((imgGray.getCols()%2==1) or (imgGray.getRows()%2==1)) {
-                QVImage<uChar> inter = QVImage<uChar>(imgGray.getCols() & 0xfffffffe,imgGray.getRows() & 0xfffffffe);
-                Resize(imgGray,inter);
-                imgGray = inter;
-            }
-            if(changing_size) {
-                cols = imgGray.getCols();
-                rows = imgGray.getRows();
-            }
-            return true;
-            }
-        else
-            {
-            end_of_video = true;
-            if(fps != 0) simulateDelay(fps);
+        if(not base_reader->grab(frame.imgGray, imgDummy1, imgDummy2))
             return false;
-            }
+        frame.availableGray = true;
+        // Force even number of cols and rows (for possible YUV conversions, with U and V half-sized):
+        if((frame.imgGray.getCols()%2==1) or (frame.imgGray.getRows()%2==1)) {
+            QVImage<uChar> inter = QVImage<uChar>(frame.imgGray.getCols() & 0xfffffffe,frame.imgGray.getRows() & 0xfffffffe);
+            Resize(frame.imgGray,inter);
+            frame.imgGray = inter;
+        }
         }
     else if(source_mode == QVVideoReader::YUVMode)
         {
-        if(base_reader->grab(imgY, imgU, imgV))
-            {
-            availableYUV = true;
-            frames_grabbed++;
-            emit newGrab();
-            if(fps != 0) simulateDelay(fps);
-            // Update cols and rows (as for some video sources this could change from frame to frame; i.e. when
-            // reading image files from a directory). Force here even number of cols and rows too (for possible
-            // YUV conversions, with U and V half-sized):
-            if((imgY.getCols()%2==1) or (imgY.getRows()%2==1)) {
-                QVImage<uChar> inter = QVImage<uChar>(imgY.getCols() & 0xfffffffe,imgY.getRows() & 0xfffffffe);
-                Resize(imgY,inter);
-                imgY = inter;
-            }
-            if(changing_size) {
-                cols = imgY.getCols();
-                rows = imgY.getRows();
-            }
-            if(imgU.getRows() != imgY.getRows()/2 or imgU.getCols() != imgY.getCols()/2 or
-               imgV.getRows() != imgY.getRows()/2 or imgV.getCols() != imgY.getCols()/2 ) {
-                std::cout << "ERROR in QVVideoReader::grab(): Y, U and U channels have not a correct size!\n";
-                exit(1);
-            }
-            return true;
-            }
-        else
-            {
-            end_of_video = true;
-            if(fps != 0) simulateDelay(fps);
+        if(not base_reader->grab(frame.imgY, frame.imgU, frame.imgV))
             return false;
-            }
+        frame.availableYUV = true;
+        // Force even number of cols and rows (for possible YUV conversions, with U and V half-sized):
+        if((frame.imgY.getCols()%2==1) or (frame.imgY.getRows()%2==1)) {
+            QVImage<uChar> inter = QVImage<uChar>(frame.imgY.getCols() & 0xfffffffe,frame.imgY.getRows() & 0xfffffffe);
+            Resize(frame.imgY,inter);
+            frame.imgY = inter;
+        }
+        if(frame.imgU.getRows() != frame.imgY.getRows()/2 or frame.imgU.getCols() != frame.imgY.getCols()/2 or
+           frame.imgV.getRows() != frame.imgY.getRows()/2 or frame.imgV.getCols() != frame.imgY.getCols()/2 ) {
+            std::cout << "ERROR in QVVideoReader::grab(): Y, U and U channels have not a correct size!\n";
+            exit(1);
+        }
         }
     else // source_mode == RGBMode
         {
-        if(base_reader->grab(imgR, imgG, imgB))
-            {
-            availableRGB = true;
-            frames_grabbed++;
-            emit newGrab();
-            if(fps != 0) simulateDelay(fps);
-            // Update cols and rows (as for some video sources this could change from frame to frame; i.e. when
-            // reading image files from a directory). Force here even number of cols and rows too (for possible
-            // YUV conversions, with U and V half-sized):
-            if((imgR.getCols()%2==1) or (imgR.getRows()%2==1)) {
-                QVImage<uChar> inter = QVImage<uChar>(imgR.getCols() & 0xfffffffe,imgR.getRows() & 0xfffffffe);
-                Resize(imgR,inter);
-                imgR = inter;
-                Resize(imgG,inter);
-                imgG = inter;
-                Resize(imgB,inter);
-                imgB = inter;
-            }
-            if(changing_size) {
-                cols = imgR.getCols();
-                rows = imgR.getRows();
-            }
-            if(imgG.getRows() != imgR.getRows() or imgG.getCols() != imgR.getCols() or
-               imgB.getRows() != imgR.getRows() or imgB.getCols() != imgR.getCols() ) {
-                std::cout << "ERROR in QVVideoReader::grab(): R, G and B channels are not of the same size!\n";
-                exit(1);
-            }
-            return true;
-            }
-        else
-            {
-            end_of_video = true;
-            if(fps != 0) simulateDelay(fps);
+        if(not base_reader->grab(frame.imgR, frame.imgG, frame.imgB))
             return false;
-            }
+        frame.availableRGB = true;
+        // Force even number of cols and rows (for possible YUV conversions, with U and V half-sized):
+        if((frame.imgR.getCols()%2==1) or (frame.imgR.getRows()%2==1)) {
+            QVImage<uChar> inter = QVImage<uChar>(frame.imgR.getCols() & 0xfffffffe,frame.imgR.getRows() & 0xfffffffe);
+            Resize(frame.imgR,inter);
+            frame.imgR = inter;
+            Resize(frame.imgG,inter);
+            frame.imgG = inter;
+            Resize(frame.imgB,inter);
+            frame.imgB = inter;
+        }
+        if(frame.imgG.getRows() != frame.imgR.getRows() or frame.imgG.getCols() != frame.imgR.getCols() or
+           frame.imgB.getRows() != frame.imgR.getRows() or frame.imgB.getCols() != frame.imgR.getCols() ) {
+            std::cout << "ERROR in QVVideoReader::grab(): R, G and B channels are not of the same size!\n";
+            exit(1);
+        }
+        }
+
+    frame.pos = base_reader->getPos();
+    return true;
+    }
+
+bool QVVideoReader::grab()
+    {
+    // Frames are read in this thread, or taken from the prefetch queue if they are decoded in advance:
+    bool grabbed;
+    if(prefetcher != 0)
+        grabbed = prefetcher->dequeue(current);
+    else
+        {
+        QMutexLocker locker(&source_mutex);
+        current = Frame();
+        grabbed = grabFromSource(current);
+        }
+
+    if(grabbed)
+        {
+        frames_grabbed++;
+        emit newGrab();
+        if(fps != 0) simulateDelay(fps);
+        // Update cols and rows (as for some video sources this could change from frame to frame; i.e. when
+        // reading image files from a directory):
+        if(changing_size) {
+            const QVImage<uChar> &image = (source_mode == QVVideoReader::GrayOnlyMode)? current.imgGray :
+                                          (source_mode == QVVideoReader::YUVMode)? current.imgY : current.imgR;
+            cols = image.getCols();
+            rows = image.getRows();
+        }
+        return true;
+        }
+    else
+        {
+        end_of_video = true;
+        if(fps != 0) simulateDelay(fps);
+        return false;
         }
     }
 
-void QVVideoReader::getGrayImage(QVImage<uChar> &imageGray)
+void QVVideoReader::Frame::convertToGray()
     {
     if(not availableGray)
         {
@@ -443,17 +591,9 @@ void QVVideoReader::getGrayImage(QVImage<uChar> &imageGray)
             availableGray = true;
             }
         }
-
-    if( ( (imgGray.getRows() != rows) or (imgGray.getCols() != cols) ) )
-        {
-        imageGray = QVImage<uChar>(cols,rows);
-        Resize(imgGray,imageGray);
-        }
-    else
-        imageGray = imgGray;
     }
 
-void QVVideoReader::getRGBImage(QVImage<uChar,3> & imageRGB)
+void QVVideoReader::Frame::convertToRGB3()
     {
     if(not availableRGB3)
         {
@@ -473,17 +613,9 @@ void QVVideoReader::getRGBImage(QVImage<uChar,3> & imageRGB)
             imgRGB = QVImage<uChar,3>(imgGray,imgGray,imgGray);
             }
         }
-
-    if( ( (imgRGB.getRows() != rows) or (imgRGB.getCols() != cols) ) )
-        {
-        imageRGB = QVImage<uChar,3>(cols,rows);
-        Resize(imgRGB,imageRGB);
-        }
-    else
-        imageRGB = imgRGB;
     }
 
-void QVVideoReader::getRGBImage(QVImage<uChar> &imageR, QVImage<uChar> &imageG, QVImage<uChar> &imageB)
+void QVVideoReader::Frame::convertToRGB()
     {
     if(not availableRGB)
         {
@@ -514,27 +646,9 @@ void QVVideoReader::getRGBImage(QVImage<uChar> &imageR, QVImage<uChar> &imageG,
             availableRGB = true;
             }
         }
-
-    if(  ( (imgR.getRows() != rows) or (imgR.getCols() != cols) or
-           (imgG.getRows() != rows) or (imgG.getCols() != cols) or
-           (imgB.getRows() != rows) or (imgB.getCols() != cols) ) )
-        {
-        imageR = QVImage<uChar>(cols,rows);
-        imageG = QVImage<uChar>(cols,rows);
-        imageB = QVImage<uChar>(cols,rows);
-        Resize(imgR,imageR);
-        Resize(imgG,imageG);
-        Resize(imgB,imageB);
-        }
-    else
-        {
-        imageR = imgR;
-        imageG = imgG;
-        imageB = imgB;
-        }
     }
 
-void QVVideoReader::getYUVImage(QVImage<uChar> &imageY, QVImage<uChar> &imageU, QVImage<uChar> &imageV)
+void QVVideoReader::Frame::convertToYUV()
     {
     if(not availableYUV)
         {
@@ -564,6 +678,72 @@ void QVVideoReader::getYUVImage(QVImage<uChar> &imageY, QVImage<uChar> &imageU,
             availableYUV = true;
             }
         }
+    }
+
+void QVVideoReader::Frame::convert(const PrefetchFormats formats)
+    {
+    if(formats & PrefetchGray)          convertToGray();
+    if(formats & PrefetchRGB)           convertToRGB3();
+    if(formats & PrefetchRGBChannels)   convertToRGB();
+    if(formats & PrefetchYUV)           convertToYUV();
+    }
+
+void QVVideoReader::getGrayImage(QVImage<uChar> &imageGray)
+    {
+    current.convertToGray();
+    const QVImage<uChar> &imgGray = current.imgGray;
+
+    if( ( (imgGray.getRows() != rows) or (imgGray.getCols() != cols) ) )
+        {
+        imageGray = QVImage<uChar>(cols,rows);
+        Resize(imgGray,imageGray);
+        }
+    else
+        imageGray = imgGray;
+    }
+
+void QVVideoReader::getRGBImage(QVImage<uChar,3> & imageRGB)
+    {
+    current.convertToRGB3();
+    const QVImage<uChar,3> &imgRGB = current.imgRGB;
+
+    if( ( (imgRGB.getRows() != rows) or (imgRGB.getCols() != cols) ) )
+        {
+        imageRGB = QVImage<uChar,3>(cols,rows);
+        Resize(imgRGB,imageRGB);
+        }
+    else
+        imageRGB = imgRGB;
+    }
+
+void QVVideoReader::getRGBImage(QVImage<uChar> &imageR, QVImage<uChar> &imageG, QVImage<uChar> &imageB)
+    {
+    current.convertToRGB();
+    const QVImage<uChar> &imgR = current.imgR, &imgG = current.imgG, &imgB = current.imgB;
+
+    if(  ( (imgR.getRows() != rows) or (imgR.getCols() != cols) or
+           (imgG.getRows() != rows) or (imgG.getCols() != cols) or
+           (imgB.getRows() != rows) or (imgB.getCols() != cols) ) )
+        {
+        imageR = QVImage<uChar>(cols,rows);
+        imageG = QVImage<uChar>(cols,rows);
+        imageB = QVImage<uChar>(cols,rows);
+        Resize(imgR,imageR);
+        Resize(imgG,imageG);
+        Resize(imgB,imageB);
+        }
+    else
+        {
+        imageR = imgR;
+        imageG = imgG;
+        imageB = imgB;
+        }
+    }
+
+void QVVideoReader::getYUVImage(QVImage<uChar> &imageY, QVImage<uChar> &imageU, QVImage<uChar> &imageV)
+    {
+    current.convertToYUV();
+    const QVImage<uChar> &imgY = current.imgY, &imgU = current.imgU, &imgV = current.imgV;
 
     if( ( (imgY.getRows() != rows)   or (imgY.getCols() != cols)   or
           (imgU.getRows() != rows/2) or (imgU.getCols() != cols/2) or
@@ -586,6 +766,8 @@ void QVVideoReader::getYUVImage(QVImage<uChar> &imageY, QVImage<uChar> &imageU,
 
 bool QVVideoReader::close()
     {
+    stopPrefetch();
+
     if(base_reader != 0)
         {
         if(base_reader->close())
@@ -599,7 +781,7 @@ bool QVVideoReader::close()
             camera_opened = false;
             live_camera = false;
             end_of_video = true;
-            availableGray = availableRGB3 = availableYUV = availableRGB = false;
+            current = Frame();
             open_options = Default;
             source_mode = YUVMode;
             delete base_reader;
@@ -613,16 +795,28 @@ bool QVVideoReader::close()
 
 bool QVVideoReader::seek(int pos)
     {
+    QMutexLocker locker(&source_mutex);
+
+    // Frames decoded in advance are from the old position. They are discarded with the source locked, before
+    // moving it, so every frame decoded after this point is from the new position:
+    if(prefetcher != 0)
+        prefetcher->flush();
     return base_reader->seek(pos);
     }
 
 int QVVideoReader::getLength() const
     {
+    QMutexLocker locker(&source_mutex);
     return base_reader->getLength();
     }
 
 int QVVideoReader::getPos() const
     {
+    // When decoding in advance, the base reader is ahead of the frame returned by the last grab():
+    if(prefetcher != 0)
+        return current.pos;
+
+    QMutexLocker locker(&source_mutex);
     return base_reader->getPos();
     }
 
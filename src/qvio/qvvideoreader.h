@@ -26,9 +26,11 @@
 #define QVVIDEOREADER_H
 
 #include <QString>
+#include <QMutex>
 #include <QVImage>
 
 class QVBaseReader;
+class QVVideoReaderPrefetcher;
 
 /*!
 @class QVVideoReader src/qvio/qvvideoreader.h QVVideoReader
@@ -66,10 +68,18 @@ Any video source (video files, webcams, remote videos, etc...) is identified by
    include the typical * and ? wildcard characters. Example:
    \verbatim dir:///home/user/images/p*-???.jpg \endverbatim
 
+ Image files of a directory are decoded ahead in parallel, by as many threads as processor cores, and delivered in
+ name order. The number of files decoded ahead can be set with a @c \#decoders=N suffix (@c 0 decodes each file
+ when it is read, in the calling thread). Example:
+   \verbatim dir:///home/user/images/#decoders=2 \endverbatim
+
  - <b>Reading directly an uncompressed yuv4mpeg file</b>:
    \verbatim yuv4mpeg://[path-to-dir-of-videos/]video.yuv \endverbatim
    Again, path can be relative, or absolute, and absolute paths begin with an extra slash. Example:
    \verbatim yuv4mpeg:///home/user/videos/football.yuv \endverbatim
+   When the file can be mapped in memory, frames are read directly from the mapping: positions are indexed when
+   opening the file, so seeking is immediate, and the image planes whose width is a multiple of 8 use the mapped
+   memory instead of a copy (they are copied only if modified).
 
  - <b>Reading a local video file through OpenCV (needs the OpenCV library)</b>:
    \verbatim cvf://[path-to-dir-of-videos/]video.{avi, mpg, dv, ...} \endverbatim
@@ -154,6 +164,16 @@ after the URL for the device, and separated with <i>&</i> signs. Some example us
  - The same device and configuration using a simplified URL:
   \verbatim /dev/video0?height=480&width=640&brightness=-100&fps=25 \endverbatim
 
+\section VideoReaderPrefetch Decoding frames in advance
+
+By default, grab() reads and decodes the next frame when called, in the calling thread. Calling setPrefetch() before
+opening the source makes the reader decode frames in a separate thread instead, keeping up to a given number of them
+in a queue. The frames in the queue are already converted to even sizes and, optionally, to the color formats
+requested by the programmer, so grab() only has to take the first frame from the queue. When the queue is full, the
+decoding thread either waits (QVVideoReader::BlockWhenFull, intended for video files, where no frame should be lost)
+or discards the oldest frame in the queue (QVVideoReader::DropOldest, intended for live sources, where the most recent
+frames are preferred).
+
 @remarks Please take into account that setting the width and height for the images read from the input device using
 parameters <i>width</i> and <i>height</i> differs from using rows and cols parameters of the open() method. The
 former tries to configure the device to capture images using a higher or lesser resolution, while the latter
@@ -184,6 +204,31 @@ class QVVideoReader : public QObject
         typedef QFlags<OpenOption> OpenOptions;
         //Q_DECLARE_FLAGS(OpenOptions,OpenOption);
 
+        /// @brief Behaviour of the decoding thread when the prefetch queue is full.
+        /// @see setPrefetch()
+        typedef enum {
+            /// Wait until grab() takes a frame from the queue.
+            BlockWhenFull = 0,
+            /// Discard the oldest frame in the queue.
+            DropOldest = 1
+        } TPrefetchPolicy;
+
+        /// @brief Image formats the decoding thread converts the prefetched frames to. Combine them using OR (|).
+        /// @see setPrefetch()
+        enum PrefetchFormat {
+            /// Gray image, as returned by getGrayImage().
+            PrefetchGray = 0x1,
+            /// 3 channel RGB image, as returned by getRGBImage(QVImage<uChar,3> &).
+            PrefetchRGB = 0x2,
+            /// Separated R, G and B images, as returned by getRGBImage(QVImage<uChar> &, QVImage<uChar> &, QVImage<uChar> &).
+            PrefetchRGBChannels = 0x4,
+            /// Y, U and V images, as returned by getYUVImage().
+            PrefetchYUV = 0x8
+        };
+        /// @brief Image formats for prefetched frames.
+        /// @see QVVideoReader::PrefetchFormat
+        typedef QFlags<PrefetchFormat> PrefetchFormats;
+
         /// @brief Possible preferred modes for video sources.
         typedef enum {
             /// Source outputs YUV images by default.
@@ -253,6 +298,33 @@ class QVVideoReader : public QObject
         /// @return True if the video frame was successfully captured, false otherwise.
         bool grab();
 
+        /// @brief Sets the reader to decode frames in advance, in a separate thread.
+        ///
+        /// Must be called before opening the video source, and is kept for subsequent openings. See section
+        /// @ref VideoReaderPrefetch.
+        ///
+        /// @param depth Maximum number of decoded frames waiting in the queue (0 => decode each frame in grab(),
+        /// which is the default behaviour).
+        /// @param policy What the decoding thread does when the queue is full.
+        /// @param formats Color formats the frames are converted to in the decoding thread. The other formats are
+        /// still converted when requested, in the thread that calls the getXXXImage() methods.
+        void setPrefetch(const int depth, const TPrefetchPolicy policy = BlockWhenFull,
+                         const PrefetchFormats formats = PrefetchFormats());
+
+        /// @brief Gets the maximum number of frames decoded in advance.
+        ///
+        /// @return Depth of the prefetch queue, 0 if frames are not decoded in advance.
+        int getPrefetchDepth() const            { return prefetch_depth; };
+
+        /// @brief Gets the number of decoded frames currently waiting in the prefetch queue.
+        int getPrefetchQueueLength() const;
+
+        /// @brief Gets the time spent reading, decoding and converting the last frame, in milliseconds.
+        int getDecodeLatency() const;
+
+        /// @brief Gets the number of frames discarded by the QVVideoReader::DropOldest policy since the source was opened.
+        int getDroppedFrames() const;
+
         /// @brief Gets current frame in the form of a gray image.
         ///
         /// This method does NOT captures a new image; instead, it returns the last captured one. Use the
@@ -356,23 +428,58 @@ class QVVideoReader : public QObject
         unsigned int getFPS() const             { return fps; };
 
     private:
+        friend class QVVideoReaderPrefetcher;
+
+        // Images of a grabbed frame, in every format obtained for it up to now.
+        class Frame
+            {
+            public:
+                Frame(): availableGray(false), availableRGB3(false), availableYUV(false), availableRGB(false), pos(0) { };
+
+                // Obtain the images of a format from any of the available ones.
+                void convertToGray();
+                void convertToRGB3();
+                void convertToRGB();
+                void convertToYUV();
+                void convert(const PrefetchFormats formats);
+
+                bool availableGray,availableRGB3,availableYUV,availableRGB;
+
+                QVImage<uChar> imgGray;
+                QVImage<uChar, 3> imgRGB;
+                QVImage<uChar> imgY, imgU, imgV;
+                QVImage<uChar> imgR, imgG, imgB;
+
+                // Position in the video source after grabbing the frame.
+                int pos;
+            };
+
+        // Reads next frame from the base reader, with even number of cols and rows. The caller must lock source_mutex.
+        bool grabFromSource(Frame &frame);
+        void startPrefetch();
+        void stopPrefetch();
+
         QString url, scheme;
         bool changing_size;
         unsigned int cols, rows, fps, frames_grabbed;
         bool camera_opened, live_camera, end_of_video;
-        bool availableGray,availableRGB3,availableYUV,availableRGB;
 
-        QVImage<uChar> imgGray;
-        QVImage<uChar, 3> imgRGB;
-        QVImage<uChar> imgY, imgU, imgV;
-        QVImage<uChar> imgR, imgG, imgB;
+        Frame current;
 
         OpenOptions open_options;
         TSourceMode source_mode;
         QVBaseReader *base_reader;
+
+        // Protects the base reader, which is used by the decoding thread when prefetching.
+        mutable QMutex source_mutex;
+        int prefetch_depth;
+        TPrefetchPolicy prefetch_policy;
+        PrefetchFormats prefetch_formats;
+        QVVideoReaderPrefetcher *prefetcher;
     };
 
 // Opening flags | operator:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QVVideoReader::OpenOptions);
+Q_DECLARE_OPERATORS_FOR_FLAGS(QVVideoReader::PrefetchFormats);
 
 #endif //QVVIDEOREADER
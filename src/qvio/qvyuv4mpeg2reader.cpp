@@ -34,6 +34,33 @@
 
 #include <QVYUV4MPEG2Reader>
 
+#include <string.h>
+
+// Memory mapping of a video file, alive while the reader or any image aliasing it exists.
+class QVYUV4MPEG2Mapping: public QVImageBufferOwner
+    {
+    public:
+        QVYUV4MPEG2Mapping(const QString &fileName): file(fileName), data(NULL), size(0)
+            {
+            if (file.open(QIODevice::ReadOnly))
+                {
+                size = file.size();
+                data = file.map(0, size);
+                }
+            }
+
+        ~QVYUV4MPEG2Mapping()
+            {
+            if (data != NULL)
+                file.unmap(data);
+            file.close();
+            }
+
+        QFile file;
+        uchar *data;
+        qint64 size;
+    };
+
 bool QVYUV4MPEG2Reader::open(const QString & url_string,
                               unsigned int & suggested_cols, unsigned int & suggested_rows,
                               unsigned int & suggested_fps, QVVideoReader::OpenOptions & suggested_options,
@@ -80,6 +107,10 @@ bool QVYUV4MPEG2Reader::open(const QString & url_string,
         // Size of the header:
         header_size = videoFile.pos();
 
+        // Read frames from a memory mapping of the file if possible (the stream is no longer needed then):
+        if (mapFile(fileName))
+            videoFile.close();
+
         // Output cols and rows. Even rounding of out_rows and out_cols:
         // cols = cols + (cols%2);
         // rows = rows + (rows%2);
@@ -92,14 +123,81 @@ bool QVYUV4MPEG2Reader::open(const QString & url_string,
         }
     }
 
+bool QVYUV4MPEG2Reader::mapFile(const QString &fileName)
+    {
+    QSharedPointer<QVYUV4MPEG2Mapping> newMapping(new QVYUV4MPEG2Mapping(fileName));
+    if (newMapping->data == NULL)
+        return FALSE;
+
+    // Index the frames. Each one is a "FRAME[ parameters]\n" line followed by the Y, U and V planes:
+    const uChar *data = newMapping->data;
+    const qint64 size = newMapping->size, frame_size = qint64(cols)*rows + 2*qint64(cols/2)*(rows/2);
+    frame_offsets.clear();
+    for (qint64 offset = header_size; offset + 5 <= size and memcmp(data + offset, "FRAME", 5) == 0; )
+        {
+        const uChar *line_end = (const uChar *) memchr(data + offset, '\n', size - offset);
+        if (line_end == NULL or line_end + 1 - data + frame_size > size)
+            break;
+        frame_offsets.append(line_end + 1 - data);
+        offset = frame_offsets.last() + frame_size;
+        }
+
+    if (frame_offsets.isEmpty())
+        return FALSE;
+
+    mapping = newMapping;
+    mapped_data = data;
+    current_frame = 0;
+    return TRUE;
+    }
+
+QVImage<uChar,1> QVYUV4MPEG2Reader::mappedPlane(const qint64 offset, const int planeCols, const int planeRows) const
+    {
+    uChar *plane = const_cast<uChar *>(mapped_data) + offset;
+
+    // The planes are aliased if their rows keep the default 8 byte step padding of the images. They are usually not
+    // aligned to QVIMAGE_BUFFER_ALIGNMENT (they follow the stream header and the FRAME marker), but the pixel kernels
+    // use unaligned loads and stores. The image will copy them before any write, so the mapping is never modified.
+    // Other planes are copied to a buffer of their own:
+    if (planeCols % 8 == 0)
+        return QVImage<uChar,1>(planeCols, planeRows, planeCols, plane, mapping);
+
+    QVImage<uChar,1> image(planeCols, planeRows);
+    uChar *buffer = image.getWriteData();
+    for (int row = 0; row < planeRows; row++)
+        memcpy(buffer + row*image.getStep(), plane + row*planeCols, planeCols);
+    return image;
+    }
+
 bool QVYUV4MPEG2Reader::close()
     {
     videoFile.close();
+    // Images still aliasing the mapping keep it alive:
+    mapping.clear();
+    mapped_data = NULL;
+    frame_offsets.clear();
+    current_frame = 0;
     return TRUE;
     }
 
 bool QVYUV4MPEG2Reader::grab(QVImage<uChar,1> &imgY, QVImage<uChar,1> &imgU, QVImage<uChar,1> &imgV)
     {
+    if (mapped_data != NULL)
+        {
+        if (current_frame >= frame_offsets.size())
+            {
+            if (noLoop)
+                return FALSE;
+            current_frame = 0;
+            }
+
+        const qint64 offset = frame_offsets[current_frame++];
+        imgY = mappedPlane(offset, cols, rows);
+        imgU = mappedPlane(offset + qint64(cols)*rows, cols/2, rows/2);
+        imgV = mappedPlane(offset + qint64(cols)*rows + qint64(cols/2)*(rows/2), cols/2, rows/2);
+        return TRUE;
+        }
+
     QVImage<uChar,1> inp_imgY(cols,rows), inp_imgU(cols/2,rows/2), inp_imgV(cols/2,rows/2);
     bool ret_value = FALSE;
 
@@ -132,16 +230,27 @@ bool QVYUV4MPEG2Reader::grab(QVImage<uChar,1> &imgY, QVImage<uChar,1> &imgU, QVI
 
 int QVYUV4MPEG2Reader::getLength()
     {
+    if (mapped_data != NULL)
+        return frame_offsets.size();
     return (videoFile.size()-header_size)/(cols*rows + cols*rows/2 + 6);
     }
 
 int QVYUV4MPEG2Reader::getPos()
     {
+    if (mapped_data != NULL)
+        return current_frame;
     return (videoFile.pos()-header_size)/(cols*rows + cols*rows/2 + 6);
     }
 
 bool QVYUV4MPEG2Reader::seek(int pos)
     {
+    if (mapped_data != NULL)
+        {
+        if (pos < 0 or pos >= frame_offsets.size())
+            return FALSE;
+        current_frame = pos;
+        return TRUE;
+        }
     videoFile.seek(header_size+pos*(cols*rows + cols*rows/2 + 6));
     return TRUE;
     }
@@ -26,13 +26,15 @@
 #define QVYUV4MPEG2READER_H
 
 #include <QFile>
+#include <QVector>
+#include <QSharedPointer>
 
 #include <QVBaseReader>
 
 class QVYUV4MPEG2Reader : public QVBaseReader
     {
     public:
-        QVYUV4MPEG2Reader() : QVBaseReader() { };
+        QVYUV4MPEG2Reader() : QVBaseReader(), mapped_data(NULL), current_frame(0) { };
 
         ~QVYUV4MPEG2Reader() { };
 
@@ -42,6 +44,17 @@ class QVYUV4MPEG2Reader : public QVBaseReader
         bool noLoop,realTime;
         int header_size;
 
+        // When the file can be mapped in memory, frames are read from the mapping instead of videoFile, using an
+        // index with the offset of the planes of each frame. Images are aliased to the mapping when their rows are
+        // suitably aligned, so 'mapping' is kept alive by them after closing the reader.
+        QSharedPointer<QVImageBufferOwner> mapping;
+        const uChar *mapped_data;
+        QVector<qint64> frame_offsets;
+        int current_frame;
+
+        bool mapFile(const QString &fileName);
+        QVImage<uChar,1> mappedPlane(const qint64 offset, const int planeCols, const int planeRows) const;
+
     protected:
         bool open(const QString & url_string,
                   unsigned int & suggested_cols, unsigned int & suggested_rows,
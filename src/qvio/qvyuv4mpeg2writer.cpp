@@ -22,3 +22,362 @@
 /// @brief File from the QVision library.
 /// @author PARP Research Group. University of Murcia, Spain.
 
+#include <iostream>
+#include <cstring>
+
+#include <QVYUV4MPEG2Writer>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef QVIPP
+#include <qvipp.h>
+#endif
+
+// Alignment of the write buffer, and of the size of the blocks written to the file (required by O_DIRECT).
+#define QVYUV4MPEG2WRITER_ALIGNMENT 4096
+
+QVYUV4MPEG2Writer::QVYUV4MPEG2Writer(): QThread(), fd(-1), cols(0), rows(0), queueDepth(0), policy(BlockWhenFull),
+    opened(false), directIO(false), stopping(false), writeError(false), buffer(NULL), bufferSize(0), bufferUsed(0),
+    droppedFrames(0), writtenFrames(0), writtenBytes(0)
+    { }
+
+QVYUV4MPEG2Writer::~QVYUV4MPEG2Writer()
+    {
+    close();
+    }
+
+bool QVYUV4MPEG2Writer::open(const QString &fileName, const int cols, const int rows, const int fps, const int queueDepth,
+                             const TQueuePolicy policy, const int bufferSize, const bool directIO)
+    {
+    close();
+
+    this->cols = cols;
+    this->rows = rows;
+    this->queueDepth = qMax(queueDepth, 1);
+    this->policy = policy;
+    this->directIO = false;
+    this->fileName = fileName;
+
+    #ifdef Q_OS_UNIX
+    const QByteArray nativeName = QFile::encodeName(fileName);
+    #ifdef O_DIRECT
+    if (directIO)
+        {
+        fd = ::open(nativeName.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        this->directIO = (fd != -1);
+        }
+    #endif // O_DIRECT
+    if (fd == -1)
+        fd = ::open(nativeName.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    #else
+    file.setFileName(fileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    #endif // Q_OS_UNIX
+        {
+        std::cout << "QVYUV4MPEG2Writer::open(): error, can't create file " << qPrintable(fileName) << "." << std::endl;
+        return false;
+        }
+
+    // Round the buffer size up to a whole number of aligned blocks.
+    this->bufferSize = QVYUV4MPEG2WRITER_ALIGNMENT * qMax(1,
+                        (bufferSize + QVYUV4MPEG2WRITER_ALIGNMENT - 1) / QVYUV4MPEG2WRITER_ALIGNMENT);
+    buffer = (char *) qMallocAligned(this->bufferSize, QVYUV4MPEG2WRITER_ALIGNMENT);
+    bufferUsed = 0;
+
+    stopping = writeError = false;
+    droppedFrames = writtenFrames = 0;
+    writtenBytes = 0;
+
+    const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A0:0\x0a").arg(cols).arg(rows).arg(fps).toAscii();
+    append(header.constData(), header.size());
+
+    elapsed.start();
+    opened = true;
+    start();
+
+    return true;
+    }
+
+void QVYUV4MPEG2Writer::close()
+    {
+    if (not opened)
+        return;
+
+    mutex.lock();
+    stopping = true;
+    notEmpty.wakeAll();
+    notFull.wakeAll();
+    mutex.unlock();
+
+    // The writing thread empties the queue and the buffer before finishing.
+    wait();
+
+    #ifdef Q_OS_UNIX
+    ::close(fd);
+    fd = -1;
+    #else
+    file.close();
+    #endif
+
+    qFreeAligned(buffer);
+    buffer = NULL;
+    opened = false;
+    }
+
+bool QVYUV4MPEG2Writer::writeFrame(const QVImage<uChar,1> &imageY, const QVImage<uChar,1> &imageU, const QVImage<uChar,1> &imageV)
+    {
+    Frame frame;
+    frame.imageY = imageY;
+    frame.imageU = imageU;
+    frame.imageV = imageV;
+    return enqueue(frame);
+    }
+
+bool QVYUV4MPEG2Writer::writeFrame(const QVImage<uChar,1> &imageGray)
+    {
+    Frame frame;
+    frame.imageY = imageGray;
+    frame.gray = true;
+    return enqueue(frame);
+    }
+
+#ifdef QVIPP
+bool QVYUV4MPEG2Writer::writeFrame(const QVImage<uChar,3> &imageRGB)
+    {
+    Frame frame;
+    frame.imageRGB = imageRGB;
+    frame.rgb = true;
+    return enqueue(frame);
+    }
+#endif
+
+// Images are implicitly shared, so queueing a frame does not copy its pixels.
+bool QVYUV4MPEG2Writer::enqueue(const Frame &frame)
+    {
+    QMutexLocker locker(&mutex);
+
+    if (not opened or stopping)
+        return false;
+
+    if (queue.size() >= queueDepth)
+        {
+        if (policy == DropWhenFull)
+            {
+            droppedFrames++;
+            return false;
+            }
+        while (queue.size() >= queueDepth and not stopping)
+            notFull.wait(&mutex);
+
+        // The file could be closed while waiting.
+        if (stopping)
+            return false;
+        }
+
+    queue.enqueue(frame);
+    notEmpty.wakeOne();
+    return true;
+    }
+
+int QVYUV4MPEG2Writer::getQueueLength()
+    {
+    QMutexLocker locker(&mutex);
+    return queue.size();
+    }
+
+int QVYUV4MPEG2Writer::getDroppedFrames()
+    {
+    QMutexLocker locker(&mutex);
+    return droppedFrames;
+    }
+
+int QVYUV4MPEG2Writer::getWrittenFrames()
+    {
+    QMutexLocker locker(&mutex);
+    return writtenFrames;
+    }
+
+double QVYUV4MPEG2Writer::getWriteThroughput()
+    {
+    QMutexLocker locker(&mutex);
+    const int msecs = opened? elapsed.elapsed() : 0;
+    return (msecs > 0)? (writtenBytes / (1024.0 * 1024.0)) / (msecs / 1000.0) : 0.0;
+    }
+
+void QVYUV4MPEG2Writer::run()
+    {
+    forever
+        {
+        mutex.lock();
+        while (queue.isEmpty() and not stopping)
+            notEmpty.wait(&mutex);
+        if (queue.isEmpty())
+            {
+            mutex.unlock();
+            break;
+            }
+        const Frame frame = queue.dequeue();
+        notFull.wakeOne();
+        mutex.unlock();
+
+        writeFrameData(frame);
+
+        mutex.lock();
+        writtenFrames++;
+        mutex.unlock();
+        }
+
+    flushBuffer(true);
+    }
+
+void QVYUV4MPEG2Writer::writeFrameData(const Frame &frame)
+    {
+    append("FRAME\x0a", 6);
+
+    #ifdef QVIPP
+    if (frame.rgb)
+        {
+        QVImage<uChar, 3> storedImage(cols, rows);
+        const uChar zero[3] = {0,0,0};
+        Set(zero, storedImage);
+        Copy(frame.imageRGB, storedImage);
+
+        QVImage<uChar, 1> imageY(cols, rows), imageU(cols/2, rows/2), imageV(cols/2, rows/2);
+        RGBToYUV420(storedImage, imageY, imageU, imageV);
+
+        appendPlane(imageY, cols, rows, 0);
+        appendPlane(imageU, cols/2, rows/2, 128);
+        appendPlane(imageV, cols/2, rows/2, 128);
+        return;
+        }
+    #endif
+
+    appendPlane(frame.imageY, cols, rows, 0);
+    if (frame.gray)
+        {
+        appendFill(128, 2 * (cols/2) * (rows/2));
+        return;
+        }
+    appendPlane(frame.imageU, cols/2, rows/2, 128);
+    appendPlane(frame.imageV, cols/2, rows/2, 128);
+    }
+
+// Appends the rows of the image to the buffer, cropped or padded to the given plane size.
+void QVYUV4MPEG2Writer::appendPlane(const QVImage<uChar,1> &image, const int planeCols, const int planeRows, const uChar padding)
+    {
+    const int imageCols = qMin(planeCols, (int) image.getCols()), imageRows = qMin(planeRows, (int) image.getRows());
+    const int step = image.getStep();
+    const uChar *data = image.getReadData();
+
+    for (int row = 0; row < imageRows; row++)
+        {
+        append((const char *) data + row*step, imageCols);
+        appendFill(padding, planeCols - imageCols);
+        }
+    appendFill(padding, (planeRows - imageRows) * planeCols);
+    }
+
+void QVYUV4MPEG2Writer::appendFill(const uChar value, const int size)
+    {
+    int pending = size;
+    while (pending > 0)
+        {
+        const int chunk = qMin(pending, bufferSize - bufferUsed);
+        memset(buffer + bufferUsed, value, chunk);
+        bufferUsed += chunk;
+        pending -= chunk;
+        if (bufferUsed == bufferSize)
+            flushBuffer(false);
+        }
+    }
+
+void QVYUV4MPEG2Writer::append(const char *data, const int size)
+    {
+    int pending = size;
+    while (pending > 0)
+        {
+        const int chunk = qMin(pending, bufferSize - bufferUsed);
+        memcpy(buffer + bufferUsed, data + size - pending, chunk);
+        bufferUsed += chunk;
+        pending -= chunk;
+        if (bufferUsed == bufferSize)
+            flushBuffer(false);
+        }
+    }
+
+// Writes the buffer to the file. Only the last write (when closing) can have a size which is not a multiple of the
+// alignment, so O_DIRECT is disabled before it.
+bool QVYUV4MPEG2Writer::flushBuffer(const bool final)
+    {
+    if (bufferUsed == 0)
+        return true;
+
+    #ifdef Q_OS_UNIX
+    if (final and directIO and bufferUsed % QVYUV4MPEG2WRITER_ALIGNMENT != 0)
+        disableDirectIO();
+
+    qint64 written = writeError? -1 : writeBuffer();
+
+    // Some file systems accept O_DIRECT when the file is opened, but reject the writes.
+    if (written == -1 and errno == EINVAL and directIO and disableDirectIO())
+        written = writeBuffer();
+    #else
+    Q_UNUSED(final);
+    const qint64 written = writeError? -1 : file.write(buffer, bufferUsed);
+    #endif // Q_OS_UNIX
+
+    if (written != bufferUsed and not writeError)
+        {
+        std::cout << "QVYUV4MPEG2Writer: error writing to file " << qPrintable(fileName) << "." << std::endl;
+        writeError = true;
+        }
+
+    mutex.lock();
+    if (written > 0)
+        writtenBytes += written;
+    mutex.unlock();
+
+    bufferUsed = 0;
+    return not writeError;
+    }
+
+#ifdef Q_OS_UNIX
+// Writes the contents of the buffer, returning the number of bytes written, or -1 if the first write fails.
+qint64 QVYUV4MPEG2Writer::writeBuffer()
+    {
+    qint64 written = 0;
+    while (written < bufferUsed)
+        {
+        const ssize_t result = ::write(fd, buffer + written, bufferUsed - written);
+        if (result == -1 and errno == EINTR)
+            continue;
+        if (result <= 0)
+            return (written > 0)? written : -1;
+        written += result;
+        }
+    return written;
+    }
+
+// Opens the file again without O_DIRECT, at the current position.
+bool QVYUV4MPEG2Writer::disableDirectIO()
+    {
+    const off_t offset = lseek(fd, 0, SEEK_CUR);
+    const int newFd = ::open(QFile::encodeName(fileName).constData(), O_WRONLY);
+    if (offset == -1 or newFd == -1 or lseek(newFd, offset, SEEK_SET) != offset)
+        {
+        if (newFd != -1)
+            ::close(newFd);
+        return false;
+        }
+
+    ::close(fd);
+    fd = newFd;
+    directIO = false;
+    return true;
+    }
+#endif // Q_OS_UNIX
@@ -25,4 +25,150 @@
 #ifndef QVYUV4MPEG2WRITER_H
 #define QVYUV4MPEG2WRITER_H
 
+#include <QFile>
+#include <QQueue>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTime>
+
+#include <QVImage>
+
+/*!
+@class QVYUV4MPEG2Writer src/qvio/qvyuv4mpeg2writer.h QVYUV4MPEG2Writer
+@brief Writes uncompressed YUV4MPEG2 video files from a background thread.
+
+Frames passed to writeFrame() are stored in a bounded queue, and returned immediately. A separate thread takes them
+from the queue, converts them to the YUV 4:2:0 format when needed, and writes them to the file through a large memory
+aligned buffer, so the thread calling writeFrame() does not wait for the disk unless the queue is full. When the
+queue is full, the calling thread either waits for the writing thread (QVYUV4MPEG2Writer::BlockWhenFull, where no
+frame is lost), or the new frame is discarded (QVYUV4MPEG2Writer::DropWhenFull, intended for real time recording).
+
+Frames larger than the size given to open() are cropped, and smaller frames are padded with black pixels.
+
+@code
+QVYUV4MPEG2Writer writer;
+writer.open("video.yuv", 640, 480, 25);
+while(...)
+	writer.writeFrame(imageY);
+writer.close();
+@endcode
+
+On Linux, the file can be opened with the @c O_DIRECT flag (see open()), to avoid filling the page cache with video
+data when recording long sequences. The writer falls back to regular writes if the file system does not support it.
+*/
+class QVYUV4MPEG2Writer : public QThread
+    {
+    public:
+        /// @brief Behaviour of writeFrame() when the queue is full.
+        typedef enum {
+            /// @brief Wait until the writing thread takes a frame from the queue.
+            BlockWhenFull,
+            /// @brief Discard the frame being written.
+            DropWhenFull
+        } TQueuePolicy;
+
+        /// @brief Default size of the write buffer (in bytes).
+        static const int defaultBufferSize = 4*1024*1024;
+
+        QVYUV4MPEG2Writer();
+
+        ~QVYUV4MPEG2Writer();
+
+        /// @brief Creates the video file, writes its header and starts the writing thread.
+        ///
+        /// @param fileName name of the video file.
+        /// @param cols width of the video frames.
+        /// @param rows height of the video frames.
+        /// @param fps frame rate stored in the header.
+        /// @param queueDepth maximal number of frames waiting to be written.
+        /// @param policy behaviour of writeFrame() when the queue is full.
+        /// @param bufferSize size of the write buffer. It is rounded up to a multiple of 4096 bytes.
+        /// @param directIO open the file with the @c O_DIRECT flag, if available.
+        /// @returns true if the file was created.
+        bool open(const QString &fileName, const int cols, const int rows, const int fps, const int queueDepth = 8,
+                  const TQueuePolicy policy = BlockWhenFull, const int bufferSize = defaultBufferSize,
+                  const bool directIO = false);
+
+        /// @brief Writes the queued frames and closes the file.
+        void close();
+
+        /// @brief Returns true if the file is open.
+        bool isOpen() const                 { return opened; }
+
+        /// @brief Queues a frame given by its Y, U and V planes (U and V planes with half the size of the Y plane).
+        /// @returns false if the frame was discarded, or the file is not open.
+        bool writeFrame(const QVImage<uChar,1> &imageY, const QVImage<uChar,1> &imageU, const QVImage<uChar,1> &imageV);
+
+        /// @brief Queues a gray level frame. Chrominance planes are written with the value 128.
+        /// @returns false if the frame was discarded, or the file is not open.
+        bool writeFrame(const QVImage<uChar,1> &imageGray);
+
+        #ifdef QVIPP
+        /// @brief Queues a RGB frame. It is converted to the YUV 4:2:0 format in the writing thread.
+        /// @returns false if the frame was discarded, or the file is not open.
+        bool writeFrame(const QVImage<uChar,3> &imageRGB);
+        #endif
+
+        /// @brief Number of frames waiting in the queue.
+        int getQueueLength();
+
+        /// @brief Number of frames discarded because the queue was full.
+        int getDroppedFrames();
+
+        /// @brief Number of frames written to the file.
+        int getWrittenFrames();
+
+        /// @brief Average write throughput since the file was opened, in megabytes per second.
+        double getWriteThroughput();
+
+    protected:
+        void run();
+
+    private:
+        #ifndef DOXYGEN_IGNORE_THIS
+        class Frame
+            {
+            public:
+                QVImage<uChar,1> imageY, imageU, imageV;
+                #ifdef QVIPP
+                QVImage<uChar,3> imageRGB;
+                #endif
+                bool gray, rgb;
+                Frame(): gray(false), rgb(false) { }
+            };
+        #endif // DOXYGEN_IGNORE_THIS
+
+        int fd, cols, rows, queueDepth;
+        TQueuePolicy policy;
+        bool opened, directIO, stopping, writeError;
+        QString fileName;
+        #ifndef Q_OS_UNIX
+        QFile file;
+        #endif
+
+        // Aligned write buffer. Only whole buffers are written while the file is open, so writes are aligned when
+        // using O_DIRECT.
+        char *buffer;
+        int bufferSize, bufferUsed;
+
+        QMutex mutex;
+        QWaitCondition notEmpty, notFull;
+        QQueue<Frame> queue;
+        int droppedFrames, writtenFrames;
+        qint64 writtenBytes;
+        QTime elapsed;
+
+        bool enqueue(const Frame &frame);
+        void writeFrameData(const Frame &frame);
+        void append(const char *data, const int size);
+        void appendPlane(const QVImage<uChar,1> &image, const int planeCols, const int planeRows, const uChar padding);
+        void appendFill(const uChar value, const int size);
+        bool flushBuffer(const bool final);
+        #ifdef Q_OS_UNIX
+        qint64 writeBuffer();
+        bool disableDirectIO();
+        #endif
+    };
+
 #endif // QVYUV4MPEG2WRITER_H
@@ -33,6 +33,8 @@
                 $$PWD/qvip/qvimagebuffer.h   		\
                 $$PWD/qvip/qvgenericimage.h  		\
                 $$PWD/qvip/qvimage.h         		\
+                $$PWD/qvip/qvimageview.h     		\
+                $$PWD/qvip/qvsimd.h          		\
                 $$PWD/qvip/qvpolyline.h      		\
                 $$PWD/qvip/qvpolylinef.h     		\
                 $$PWD/qvip/qvcomponenttree.h 		\
@@ -40,6 +42,9 @@
                 $$PWD/qvip/qvsiftfeature.h   		\
                 $$PWD/qvip/qvmser.h					\
                 $$PWD/qvip/qvbriefdetector.h		\
+                $$PWD/qvip/qvfastdetector.h			\
+                $$PWD/qvip/qvbinarydescriptormatcher.h	\
+                $$PWD/qvip/qvorientedbriefextractor.h	\
 				$$PWD/qvip/fast-C-src-2.1/fast.h
 
     SOURCES +=  $$PWD/qvip/qvip.cpp            			\
@@ -47,12 +52,16 @@
                 $$PWD/qvip/qvimagebuffer.cpp   			\
                 $$PWD/qvip/qvgenericimage.cpp  			\
                 $$PWD/qvip/qvimage.cpp         			\
+                $$PWD/qvip/qvsimd.cpp          			\
                 $$PWD/qvip/qvpolyline.cpp      			\
                 $$PWD/qvip/qvpolylinef.cpp     			\
                 $$PWD/qvip/qvcomponenttree.cpp 			\
                 $$PWD/qvip/qvsiftfeature.cpp   			\
                 $$PWD/qvip/qvmser.cpp					\
                 $$PWD/qvip/qvbriefdetector.cpp			\
+                $$PWD/qvip/qvfastdetector.cpp			\
+                $$PWD/qvip/qvbinarydescriptormatcher.cpp	\
+                $$PWD/qvip/qvorientedbriefextractor.cpp	\
 				$$PWD/qvip/fast-C-src-2.1/fast_10.cpp	\
 				$$PWD/qvip/fast-C-src-2.1/fast_11.cpp	\
 				$$PWD/qvip/fast-C-src-2.1/fast_12.cpp	\
@@ -0,0 +1,401 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <string.h>
+#include <limits>
+
+#include <QThread>
+
+#include <qvmath.h>
+#include <qvmath/qvparallelranges.h>
+#include <qvip/qvbinarydescriptormatcher.h>
+#include <qvip/qvsimd.h>
+
+// Minimal number of query descriptors searched by each thread.
+#define	MATCHER_MIN_QUERIES_PER_THREAD	32
+
+// The brute force search compares blocks of query descriptors with blocks of database descriptors, so the database
+// block is kept in the cache while it is compared with every query of the block.
+#define	MATCHER_QUERY_BLOCK		32
+#define	MATCHER_DATABASE_BLOCK	512
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Hamming distance kernels. The block kernels evaluate the distance between a descriptor and 'count' contiguous
+// descriptors of 'ints' integers each.
+typedef int (*THammingDistanceKernel)(const unsigned int *a, const unsigned int *b, const int ints);
+typedef void (*THammingBlockKernel)(const unsigned int *query, const unsigned int *descriptors, const int count, const int ints, int *distances);
+
+static int hammingDistance(const unsigned int *a, const unsigned int *b, const int ints)
+	{
+	int distance = 0;
+	for(int i = 0; i < ints; i++)
+		distance += qvNiftyParallelBitCount(a[i] xor b[i]);
+	return distance;
+	}
+
+static void hammingDistances(const unsigned int *query, const unsigned int *descriptors, const int count, const int ints, int *distances)
+	{
+	for(int j = 0; j < count; j++)
+		distances[j] = hammingDistance(query, descriptors + j * ints, ints);
+	}
+
+#ifdef QVSIMD_X86
+static bool popcntSupported()
+	{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("popcnt");
+	}
+
+// Descriptors are read as 64 bit words with 'memcpy', as their arrays are only aligned to 4 bytes.
+QVSIMD_TARGET_POPCNT static int hammingDistance_POPCNT(const unsigned int *a, const unsigned int *b, const int ints)
+	{
+	int distance = 0, i = 0;
+	for(; i + 2 <= ints; i += 2)
+		{
+		quint64 wordA, wordB;
+		memcpy(&wordA, a + i, sizeof(quint64));
+		memcpy(&wordB, b + i, sizeof(quint64));
+		distance += __builtin_popcountll(wordA xor wordB);
+		}
+	if (i < ints)
+		distance += __builtin_popcount(a[i] xor b[i]);
+	return distance;
+	}
+
+QVSIMD_TARGET_POPCNT static void hammingDistances_POPCNT(const unsigned int *query, const unsigned int *descriptors, const int count, const int ints, int *distances)
+	{
+	for(int j = 0; j < count; j++)
+		{
+		const unsigned int *descriptor = descriptors + j * ints;
+		int distance = 0, i = 0;
+		for(; i + 2 <= ints; i += 2)
+			{
+			quint64 wordA, wordB;
+			memcpy(&wordA, query + i, sizeof(quint64));
+			memcpy(&wordB, descriptor + i, sizeof(quint64));
+			distance += __builtin_popcountll(wordA xor wordB);
+			}
+		if (i < ints)
+			distance += __builtin_popcount(query[i] xor descriptor[i]);
+		distances[j] = distance;
+		}
+	}
+
+// AVX2 kernels, for descriptors of 4 integers (two descriptors in each register) and of a multiple of 8 integers.
+// Bits are counted with a lookup table of 4 bits indexed by 'shuffle', and the byte counts are added with 'sad'.
+QVSIMD_TARGET_AVX2_POPCNT static void hammingDistances_AVX2(const unsigned int *query, const unsigned int *descriptors, const int count, const int ints, int *distances)
+	{
+	if (ints != 4 and ints % 8 != 0)
+		{
+		hammingDistances_POPCNT(query, descriptors, count, ints, distances);
+		return;
+		}
+
+	const __m256i	lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4),
+					lowNibbles = _mm256_set1_epi8(0x0f), zero = _mm256_setzero_si256();
+
+	#define	BYTE_SUMS(X)	_mm256_sad_epu8(_mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(X, lowNibbles)),		\
+										_mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(X, 4), lowNibbles))), zero)
+
+	int j = 0;
+	if (ints == 4)
+		{
+		const __m256i q = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) query));
+		for(; j + 4 <= count; j += 4)
+			{
+			const __m256i	x1 = _mm256_xor_si256(q, _mm256_loadu_si256((const __m256i *) (descriptors + j * 4))),
+							x2 = _mm256_xor_si256(q, _mm256_loadu_si256((const __m256i *) (descriptors + j * 4 + 8))),
+							sums1 = BYTE_SUMS(x1), sums2 = BYTE_SUMS(x2);
+			// Lanes of the sum: distances of descriptors j, j+2, j+1 and j+3.
+			quint64 sums[4];
+			_mm256_storeu_si256((__m256i *) sums, _mm256_add_epi64(_mm256_unpacklo_epi64(sums1, sums2), _mm256_unpackhi_epi64(sums1, sums2)));
+			distances[j] = int(sums[0]);
+			distances[j+1] = int(sums[2]);
+			distances[j+2] = int(sums[1]);
+			distances[j+3] = int(sums[3]);
+			}
+		}
+	else
+		for(; j < count; j++)
+			{
+			const unsigned int *descriptor = descriptors + j * ints;
+			__m256i sums = zero;
+			for(int i = 0; i < ints; i += 8)
+				sums = _mm256_add_epi64(sums, BYTE_SUMS(_mm256_xor_si256(	_mm256_loadu_si256((const __m256i *) (query + i)),
+																			_mm256_loadu_si256((const __m256i *) (descriptor + i)))));
+			quint64 lanes[4];
+			_mm256_storeu_si256((__m256i *) lanes, sums);
+			distances[j] = int(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+			}
+
+	#undef BYTE_SUMS
+
+	if (j < count)
+		hammingDistances_POPCNT(query, descriptors + j * ints, count - j, ints, distances + j);
+	}
+#endif // QVSIMD_X86
+
+static void selectHammingKernels(THammingDistanceKernel &distanceKernel, THammingBlockKernel &blockKernel)
+	{
+	distanceKernel = hammingDistance;
+	blockKernel = hammingDistances;
+
+	#ifdef QVSIMD_X86
+	static const bool popcnt = popcntSupported();
+	const TQVSimdLevel level = qvSimdLevel();
+	if (level == QVSIMD_SCALAR or not popcnt)
+		return;
+
+	distanceKernel = hammingDistance_POPCNT;
+	blockKernel = (level == QVSIMD_AVX2)? hammingDistances_AVX2: hammingDistances_POPCNT;
+	#endif // QVSIMD_X86
+	}
+
+// Keeps the lowest and second lowest distances. For equal distances, the first descriptor compared is the nearest one.
+static inline void updateNearest(const int index, const int distance, int &nearestIndex, int &nearestDistance, int &secondDistance)
+	{
+	if (distance < nearestDistance)
+		{
+		secondDistance = nearestDistance;
+		nearestDistance = distance;
+		nearestIndex = index;
+		}
+	else if (distance < secondDistance)
+		secondDistance = distance;
+	}
+
+// Key of a descriptor in one of the LSH tables.
+static inline int lshKey(const unsigned int *descriptor, const int *bits, const int keyBits)
+	{
+	int key = 0;
+	for(int b = 0; b < keyBits; b++)
+		key |= ((descriptor[bits[b] >> 5] >> (bits[b] & 31)) & 1) << b;
+	return key;
+	}
+
+// Searches a range of query descriptors, with the visited marks of the range.
+class MatcherRangeTask
+	{
+	public:
+		MatcherRangeTask(QVBinaryDescriptorMatcher &matcher, const unsigned int *queries, QVector<int> *visited, int *stamps):
+			matcher(matcher), queries(queries), visited(visited), stamps(stamps)	{ }
+
+		void operator()(const int range, const int first, const int last)
+			{ matcher.searchRange(first, last, queries, visited[range], stamps[range]); }
+
+	private:
+		QVBinaryDescriptorMatcher &matcher;
+		const unsigned int *queries;
+		QVector<int> *visited;
+		int *stamps;
+	};
+#endif // DOXYGEN_IGNORE_THIS
+
+QVBinaryDescriptorMatcher::QVBinaryDescriptorMatcher(const int descriptorInts):
+	descriptorInts(descriptorInts), numThreads(0), multiProbeLevel(1), lshTables(0), lshKeyBits(0)
+	{
+	if (descriptorInts <= 0)
+		qFatal("QVBinaryDescriptorMatcher: the number of integers of the descriptors must be positive.");
+	}
+
+void QVBinaryDescriptorMatcher::setDatabase(const QVector<unsigned int> &descriptors)
+	{
+	if (descriptors.size() % descriptorInts != 0)
+		qFatal("QVBinaryDescriptorMatcher::setDatabase(): the size of the descriptor array is not a multiple of the descriptor size.");
+
+	database = descriptors;
+	clearLSHIndex();
+	visitedBuffers.clear();
+	visitedStamps.clear();
+	}
+
+void QVBinaryDescriptorMatcher::buildLSHIndex(const int numTables, const int keyBits, const unsigned int seed)
+	{
+	const int	databaseSize = getDatabaseSize(), descriptorBits = 32 * descriptorInts;
+
+	lshTables = MAX(1, numTables);
+	lshKeyBits = MAX(1, MIN(24, MIN(keyBits, descriptorBits)));
+
+	const int numBuckets = 1 << lshKeyBits;
+
+	// Random bits for the key of each table, selected with a partial Fisher-Yates shuffle. A local xorshift generator
+	// is used, so the index does not depend on, nor modify, the state of the global random number generator.
+	lshBits.resize(lshTables * lshKeyBits);
+	QVector<int> permutation(descriptorBits);
+	unsigned int state = (seed != 0)? seed: 1;
+	for(int t = 0; t < lshTables; t++)
+		{
+		for(int i = 0; i < descriptorBits; i++)
+			permutation[i] = i;
+		for(int b = 0; b < lshKeyBits; b++)
+			{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			const int other = b + int(state % (unsigned int)(descriptorBits - b));
+			qSwap(permutation[b], permutation[other]);
+			lshBits[t * lshKeyBits + b] = permutation[b];
+			}
+		}
+
+	// Counting sort of the database descriptors by their key, for each table.
+	lshBucketStart.fill(0, lshTables * (numBuckets + 1));
+	lshEntries.resize(lshTables * databaseSize);
+	QVector<int> keys(databaseSize);
+	for(int t = 0; t < lshTables; t++)
+		{
+		int *bucketStart = lshBucketStart.data() + t * (numBuckets + 1), *entries = lshEntries.data() + t * databaseSize;
+		const int *bits = lshBits.constData() + t * lshKeyBits;
+
+		for(int i = 0; i < databaseSize; i++)
+			{
+			keys[i] = lshKey(database.constData() + i * descriptorInts, bits, lshKeyBits);
+			bucketStart[keys[i] + 1]++;
+			}
+		for(int k = 0; k < numBuckets; k++)
+			bucketStart[k+1] += bucketStart[k];
+
+		QVector<int> position(numBuckets);
+		for(int k = 0; k < numBuckets; k++)
+			position[k] = bucketStart[k];
+		for(int i = 0; i < databaseSize; i++)
+			entries[position[keys[i]]++] = i;
+		}
+	}
+
+void QVBinaryDescriptorMatcher::searchRange(const int first, const int last, const unsigned int *queries, QVector<int> &visited, int &stamp)
+	{
+	THammingDistanceKernel distanceKernel;
+	THammingBlockKernel blockKernel;
+	selectHammingKernels(distanceKernel, blockKernel);
+
+	const int	databaseSize = getDatabaseSize(), noDistance = 32 * descriptorInts + 1;
+	const unsigned int *databaseData = database.constData();
+
+	int *nearestIndex = nearestIndexes.data(), *nearestDistance = nearestDistances.data(), *secondDistance = secondDistances.data();
+	for(int q = first; q < last; q++)
+		{
+		nearestIndex[q] = -1;
+		nearestDistance[q] = secondDistance[q] = noDistance;
+		}
+
+	if (not hasLSHIndex())
+		{
+		int distances[MATCHER_DATABASE_BLOCK];
+		for(int firstQuery = first; firstQuery < last; firstQuery += MATCHER_QUERY_BLOCK)
+			for(int firstDescriptor = 0; firstDescriptor < databaseSize; firstDescriptor += MATCHER_DATABASE_BLOCK)
+				{
+				const int count = MIN(MATCHER_DATABASE_BLOCK, databaseSize - firstDescriptor);
+				for(int q = firstQuery; q < MIN(last, firstQuery + MATCHER_QUERY_BLOCK); q++)
+					{
+					blockKernel(queries + q * descriptorInts, databaseData + firstDescriptor * descriptorInts, count, descriptorInts, distances);
+					for(int j = 0; j < count; j++)
+						updateNearest(firstDescriptor + j, distances[j], nearestIndex[q], nearestDistance[q], secondDistance[q]);
+					}
+				}
+		return;
+		}
+
+	if (visited.size() != databaseSize)
+		visited.fill(-1, databaseSize);
+	int *visitedData = visited.data();
+
+	const int numBuckets = 1 << lshKeyBits;
+	for(int q = first; q < last; q++)
+		{
+		// Each query marks the database descriptors it compares with a different stamp.
+		if (stamp == std::numeric_limits<int>::max())
+			{
+			visited.fill(-1);
+			stamp = 0;
+			}
+		stamp++;
+
+		const unsigned int *query = queries + q * descriptorInts;
+		for(int t = 0; t < lshTables; t++)
+			{
+			const int	*bucketStart = lshBucketStart.constData() + t * (numBuckets + 1),
+						*entries = lshEntries.constData() + t * databaseSize,
+						key = lshKey(query, lshBits.constData() + t * lshKeyBits, lshKeyBits);
+
+			// Probes the bucket of the query key, and those whose keys differ in one or two bits.
+			const int numProbes = 1 + ((multiProbeLevel >= 1)? lshKeyBits: 0) + ((multiProbeLevel >= 2)? lshKeyBits * (lshKeyBits - 1) / 2: 0);
+			for(int probe = 0, bit1 = 0, bit2 = 1; probe < numProbes; probe++)
+				{
+				int probeKey = key;
+				if (probe > 0 and probe <= lshKeyBits)
+					probeKey ^= 1 << (probe - 1);
+				else if (probe > lshKeyBits)
+					{
+					probeKey ^= (1 << bit1) | (1 << bit2);
+					if (++bit2 == lshKeyBits)
+						{
+						bit1++;
+						bit2 = bit1 + 1;
+						}
+					}
+
+				for(int e = bucketStart[probeKey]; e < bucketStart[probeKey + 1]; e++)
+					{
+					const int index = entries[e];
+					if (visitedData[index] == stamp)
+						continue;
+					visitedData[index] = stamp;
+					updateNearest(index, distanceKernel(query, databaseData + index * descriptorInts, descriptorInts),
+						nearestIndex[q], nearestDistance[q], secondDistance[q]);
+					}
+				}
+			}
+		}
+	}
+
+int QVBinaryDescriptorMatcher::match(const QVector<unsigned int> &queries, const double ratio, const int maxDistance)
+	{
+	if (queries.size() % descriptorInts != 0)
+		qFatal("QVBinaryDescriptorMatcher::match(): the size of the descriptor array is not a multiple of the descriptor size.");
+
+	const int	numQueries = queries.size() / descriptorInts,
+				maxThreads = (numThreads > 0)? numThreads: QThread::idealThreadCount(),
+				ranges = MAX(1, MIN(maxThreads, numQueries / MATCHER_MIN_QUERIES_PER_THREAD));
+
+	nearestIndexes.resize(numQueries);
+	nearestDistances.resize(numQueries);
+	secondDistances.resize(numQueries);
+
+	if (visitedBuffers.size() < ranges)
+		{
+		visitedBuffers.resize(ranges);
+		visitedStamps.resize(ranges);
+		}
+
+	MatcherRangeTask task(*this, queries.constData(), visitedBuffers.data(), visitedStamps.data());
+	qvParallelRanges(task, numQueries, ranges);
+
+	matchings.clear();
+	for(int q = 0; q < numQueries; q++)
+		if (nearestIndexes[q] >= 0 and nearestDistances[q] <= maxDistance and nearestDistances[q] < ratio * secondDistances[q])
+			matchings << QVIndexPair(q, nearestIndexes[q]);
+
+	return matchings.size();
+	}
@@ -0,0 +1,153 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVBINARYDESCRIPTORMATCHER_H
+#define QVBINARYDESCRIPTORMATCHER_H
+
+#include <QVector>
+#include <QVIndexPair>
+
+/*!
+@class QVBinaryDescriptorMatcher qvip/qvbinarydescriptormatcher.h QVBinaryDescriptorMatcher
+@brief Matching engine for binary descriptors, such as those obtained with @ref QVBRIEFDetector.
+
+This class stores a set of binary descriptors (the database), and finds for each descriptor of a query set the
+database descriptors with the lowest and second lowest Hamming distance. A query descriptor is matched to its nearest
+database descriptor if it passes the ratio test proposed by Lowe: the distance to the nearest descriptor must be lower
+than a ratio of the distance to the second nearest one.
+
+Descriptors are stored as contiguous arrays of unsigned integers, in the same format returned by
+@ref QVBRIEFDetector::getDescriptors. The Hamming distances between a query descriptor and the database are evaluated
+with the POPCNT instruction, or with AVX2 kernels for descriptors of 4 or 8 integers, when the processor supports
+them (see @ref qvSimdLevel). The query descriptors are split between the threads of the global thread pool.
+
+By default the matcher compares every query descriptor with every database descriptor. For large databases, an
+approximate search can be enabled with @ref buildLSHIndex. The index hashes the descriptors in several tables, using a
+random subset of their bits as the key for each table. Only the database descriptors stored in the buckets of the
+query descriptor are compared with it. With multi-probe search, the buckets whose keys differ in one or two bits
+from the key of the query descriptor are also visited, to increase the probability of finding the nearest descriptor
+with fewer tables.
+
+The following code shows an example usage:
+
+@code
+QVBRIEFDetector BRIEFDetector(4, 16);
+QVBinaryDescriptorMatcher matcher(BRIEFDetector.getDescriptorInts());
+
+matcher.setDatabase(BRIEFDetector.getDescriptors(imageA, keypointsA));
+matcher.match(BRIEFDetector.getDescriptors(imageB, keypointsB), 0.8);
+
+// Each pair contains the index of a keypoint in B, and the index of its matching keypoint in A.
+foreach(QVIndexPair matching, matcher.getMatchings())
+	...
+@endcode
+
+@ingroup qvip
+*/
+class QVBinaryDescriptorMatcher
+	{
+	public:
+		/// @brief Constructs a matcher.
+		/// @param descriptorInts Number of integers in each descriptor.
+		QVBinaryDescriptorMatcher(const int descriptorInts = 4);
+
+		/// @brief Returns the number of integers in each descriptor.
+		int getDescriptorInts() const					{ return descriptorInts; }
+
+		/// @brief Sets the database descriptors.
+		///
+		/// Any previous LSH index is discarded.
+		/// @param descriptors concatenated database descriptors.
+		void setDatabase(const QVector<unsigned int> &descriptors);
+
+		/// @brief Returns the number of descriptors in the database.
+		int getDatabaseSize() const						{ return database.size() / descriptorInts; }
+
+		/// @brief Builds an LSH index for the database descriptors.
+		/// @param numTables number of hash tables.
+		/// @param keyBits number of bits of the descriptors used as key in each table, between 1 and 24.
+		/// @param seed seed for the random selection of the bits of the keys.
+		void buildLSHIndex(const int numTables = 6, const int keyBits = 16, const unsigned int seed = 1);
+
+		/// @brief Discards the LSH index, so the following searches compare every pair of descriptors.
+		void clearLSHIndex()							{ lshTables = 0; lshBits.clear(); lshBucketStart.clear(); lshEntries.clear(); }
+
+		/// @brief Returns true if the matcher has an LSH index.
+		bool hasLSHIndex() const						{ return lshTables > 0; }
+
+		/// @brief Sets the number of bits in which the keys of the buckets visited by the LSH search can differ from the key of the query.
+		/// @param value 0, 1 or 2.
+		void setMultiProbeLevel(const int value)		{ multiProbeLevel = value; }
+
+		/// @brief Sets the maximal number of threads used by the search.
+		/// @param value number of threads. A value of zero uses QThread::idealThreadCount().
+		void setNumThreads(const int value)				{ numThreads = value; }
+
+		/// @brief Finds the nearest database descriptors for a set of query descriptors.
+		///
+		/// A query descriptor is matched if the distance to its nearest database descriptor is not larger than
+		/// <i>maxDistance</i>, and it is lower than <i>ratio</i> times the distance to its second nearest database descriptor.
+		/// @param queries concatenated query descriptors.
+		/// @param ratio ratio for the ratio test. A value of 1.0 accepts every nearest descriptor with a distance strictly
+		/// lower than the distance to the second nearest one. If only one database descriptor is compared with a query
+		/// descriptor, the distance to the second nearest one is considered to be the number of bits of the descriptors plus one.
+		/// @param maxDistance maximal Hamming distance for a matching.
+		/// @return number of query descriptors matched.
+		int match(const QVector<unsigned int> &queries, const double ratio = 0.8, const int maxDistance = 256 * 32);
+
+		/// @brief Matchings found by the last call to @ref match, as pairs (query index, database index).
+		const QVector<QVIndexPair> & getMatchings() const	{ return matchings; }
+
+		/// @brief Index of the nearest database descriptor for each query descriptor, or -1 if it was not found.
+		const QVector<int> & getNearestIndexes() const		{ return nearestIndexes; }
+		/// @brief Distance to the nearest database descriptor for each query descriptor.
+		const QVector<int> & getNearestDistances() const	{ return nearestDistances; }
+		/// @brief Distance to the second nearest database descriptor for each query descriptor.
+		///
+		/// If only one database descriptor was compared with a query descriptor, this distance is the number of bits
+		/// of the descriptors plus one.
+		const QVector<int> & getSecondDistances() const		{ return secondDistances; }
+
+	#ifndef DOXYGEN_IGNORE_THIS
+		void searchRange(const int first, const int last, const unsigned int *queries, QVector<int> &visited, int &stamp);
+	#endif // DOXYGEN_IGNORE_THIS
+
+	private:
+		int descriptorInts, numThreads, multiProbeLevel;
+		QVector<unsigned int> database;
+
+		// LSH index. For each table, the bits of the key, the start of each bucket in the entries of the table, and the
+		// database indexes sorted by bucket.
+		int lshTables, lshKeyBits;
+		QVector<int> lshBits, lshBucketStart, lshEntries;
+
+		// Buffers used to avoid comparing twice a database descriptor in the LSH search, one for each thread.
+		QVector< QVector<int> > visitedBuffers;
+		QVector<int> visitedStamps;
+
+		QVector<int> nearestIndexes, nearestDistances, secondDistances;
+		QVector<QVIndexPair> matchings;
+	};
+
+#endif // QVBINARYDESCRIPTORMATCHER_H
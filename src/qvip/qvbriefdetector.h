@@ -81,6 +81,9 @@ for(int i = 0; i < keypointsA.count(); i++)
 
 @endcode
 
+To find the nearest descriptors between two large sets of descriptors, the class @ref QVBinaryDescriptorMatcher is much
+faster than evaluating the distances pair by pair.
+
 @ingroup qvip
 */
 class QVBRIEFDetector
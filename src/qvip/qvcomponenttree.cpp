@@ -24,7 +24,6 @@
 
 #include <qvdefines.h>
 
-#include <QVDisjointSet>
 #include <QVComponentTree>
 
 QVComponentTree::QVComponentTree(const QVImage<uChar,1> &image, bool inverseTree, bool /*useAlternative*/): numNodes(0), freePoints(0), inverseTree(inverseTree)
@@ -35,159 +34,241 @@ QVComponentTree::QVComponentTree(const QVImage<uChar,1> &image, bool inverseTree
 	this->leafNodes = 0;
 	this->freePoints = 0;
 	this->totalPoints = 0;
-	this->maxNodes = cols * rows;
-	this->nodes.resize(maxNodes/10);	// 10 factor is an heuristic value, estimated from several tries.
+	this->maxNodes = 0;
+	this->rootNodeID = NULL_NODE;
+	resizeNodePool(MAX(256, cols * rows / 10));	// 10 factor is an heuristic value, estimated from several tries.
 
-	if (inverseTree)
+	getComponentTree(image);
+	}
+
+void QVComponentTree::resizeNodePool(const uInt capacity)
+	{
+	nodeSeedX.resize(capacity);
+	nodeSeedY.resize(capacity);
+	nodeChild.resize(capacity);
+	nodeSibling.resize(capacity);
+	nodeNumChilds.resize(capacity);
+	nodeFirstThreshold.resize(capacity);
+	nodeLastThreshold.resize(capacity);
+	nodeClosed.resize(capacity);
+	this->maxNodes = capacity;
+	}
+
+// The area histograms are not known until the tree is finished, because the last threshold of a node is only known
+// when it is joined to its parent node. During the construction of the tree every change in the area histogram of a node
+// is appended to a log, as a triplet (node, threshold, area). This function allocates the histograms with their final
+// size, and replays that log in order to fill them.
+void QVComponentTree::buildAreaPool(const QVector<uInt> &areaLog)
+	{
+	nodeAreaOffset.resize(numNodes);
+
+	// The pool starts with 256 unused cells, so the offset of the histogram of every node is a valid position of the array.
+	uInt poolSize = 256;
+	for (uInt node = 0; node < numNodes; node++)
 		{
-		QVImage<uChar> notImage(cols, rows);
+		nodeAreaOffset[node] = poolSize - nodeFirstThreshold[node];
+		poolSize += nodeLastThreshold[node] - nodeFirstThreshold[node] + 1;
+		}
 
-		QVIMAGE_INIT_READ(uChar,image);
-		QVIMAGE_INIT_WRITE(uChar,notImage);
-		for (uInt col = 0; col < cols; col++)
-			for (uInt row = 0; row < rows; row++)
-				QVIMAGE_PIXEL(notImage, col, row,0) = 255 - QVIMAGE_PIXEL(image, col, row,0);
+	areas.fill(0, poolSize);
+
+	uInt *areasData = areas.data();
+	const uInt *offsets = nodeAreaOffset.constData(), *log = areaLog.constData(), logSize = areaLog.size();
+	for (uInt i = 0; i < logSize; i += 3)
+		areasData[offsets[log[i]] + log[i+1]] = log[i+2];
+	}
 
-		getComponentTree(notImage);
+// Canonical element of the subset containing an element. Uses path halving to compress the paths of the forest.
+static inline uInt findCanonicalElement(uInt *parent, uInt index)
+	{
+	while (parent[index] != index)
+		{
+		parent[index] = parent[parent[index]];
+		index = parent[index];
 		}
-	else
-		getComponentTree(image);
+	return index;
 	}
 
 void QVComponentTree::getComponentTree(const QVImage<uChar> &image)
 	{
-	qDebug() << "getComponentTree()";
 	const uInt cols = image.getCols(), rows = image.getRows();
 
+	if (cols == 0 or rows == 0)
+		return;
+
+	// The image is copied to an array with a border of one pixel. Border pixels have value 256, which is higher than any
+	// gray-scale value, so they are never joined to a region and the neighbourhood of a pixel can be transversed
+	// without bound checks.
+	const uInt	paddedCols = cols + 2, paddedRows = rows + 2, paddedSize = paddedCols * paddedRows;
+	QVector<uShort> levels(paddedSize, 256);
+	uShort *levelsData = levels.data();
+
+	// Counting sort of the pixels by their gray-scale value, to a single array of indexes in the padded image.
+	// Pixels with the same gray-scale value keep their row-major order.
+	uInt histogram[257];
+	for (int k = 0; k < 257; k++)
+		histogram[k] = 0;
+
 	QVIMAGE_INIT_READ(uChar,image);
+	for (uInt row = 0; row < rows; row++)
+		{
+		const uChar *imageRow = &QVIMAGE_PIXEL(image, 0, row, 0);
+		uShort *levelsRow = levelsData + (row+1) * paddedCols + 1;
+		for (uInt col = 0; col < cols; col++)
+			{
+			const uShort value = inverseTree? 255 - imageRow[col]: imageRow[col];
+			levelsRow[col] = value;
+			histogram[value+1]++;
+			}
+		}
 
-	const QVector< QVector< QPoint > > points = CountingSort(image);
-	QVDisjointSet disjointSet(cols, rows);
+	for (int k = 1; k < 257; k++)
+		histogram[k] += histogram[k-1];
 
-	uInt *nodeID = new uInt[maxNodes];
-	for(uInt i=0; i<maxNodes; i++)
-		nodeID[i] = NULL_NODE;
+	QVector<uInt> sortedPixels(cols * rows);
+	uInt *sortedPixelsData = sortedPixels.data();
+	{
+	uInt position[256];
+	for (int k = 0; k < 256; k++)
+		position[k] = histogram[k];
 
-	// This loop creates the structure of the component tree, using the disjoint set, transversiong the pixels of the image
-	// ordered by their gray-scale value, sorted thanks to 'CountingSort' function.
-	for (int threshold = 0; threshold < points.size(); threshold++)
+	for (uInt row = 0; row < rows; row++)
+		for (uInt index = (row+1) * paddedCols + 1, last = index + cols; index < last; index++)
+			sortedPixelsData[position[levelsData[index]]++] = index;
+	}
+
+	// Union-find structure, defined over the padded image. Joins are made by rank, like in QVDisjointSet.
+	QVector<uInt> parent(paddedSize), cardinality(paddedSize, 1), nodeID(paddedSize, NULL_NODE);
+	QVector<uChar> rank(paddedSize, 0);
+	uInt *parentData = parent.data(), *cardinalityData = cardinality.data(), *nodeIDData = nodeID.data();
+	uChar *rankData = rank.data();
+	for (uInt index = 0; index < paddedSize; index++)
+		parentData[index] = index;
+
+	// Offsets for the 8 neighbours of a pixel in the padded image.
+	const int neighbourOffsets[8] =
 		{
+		- (int)paddedCols - 1,	-1,	(int)paddedCols - 1,
+		- (int)paddedCols,		(int)paddedCols,
+		- (int)paddedCols + 1,	+1,	(int)paddedCols + 1
+		};
+
+	// Changes in the area histograms of the nodes, stored as triplets (node, threshold, area).
+	QVector<uInt> areaLog;
+	areaLog.reserve(3 * cols * rows / 4);
+
+	// This loop creates the structure of the component tree, using the disjoint set, transversing the pixels of the image
+	// ordered by their gray-scale value.
+	for (int threshold = 0; threshold < 256; threshold++)
+		{
+		const uInt firstPixel = histogram[threshold], lastPixel = histogram[threshold+1];
+
 		// We join in the disjoint set pixels with gray-scale equal to threshold, with adjacent regions, or pixels, with
 		// a gray-scale value equal or lesser than threshold. This is done here only for the disjoint set.
 		//
 		// Also, here are also joined component tree nodes which have in common one of the processed points.
-		for (int n=0; n< points[threshold].size(); n++)
+		for (uInt n = firstPixel; n < lastPixel; n++)
 			{
-			const uInt	col = points[threshold][n].x(),  
-					row = points[threshold][n].y();			// coordinates of the current pixel
-			const uChar	actualPixel = QVIMAGE_PIXEL(image, col, row,0); // Value of the current pixel
-			uInt		actualSet = disjointSet.find(col, row);		// canonical element of the subset
+			const uInt	actualIndex = sortedPixelsData[n];			// index of the current pixel
+			uInt		actualSet = findCanonicalElement(parentData, actualIndex);	// canonical element of the subset
 
 			// Transverse neighbourhood of a pixel looking for close pixels to join with
 			// (those with gray-scale level lower or equal to that of the actual pixel)
-			for (uInt i = (uInt) MAX(0,(int)col-1); i< MIN(cols, col+2); i++)  // we look at the 8 rounding neighbours
-				for (uInt j = (uInt) MAX(0,(int)row-1); j< MIN(rows, row+2); j++)
-					if ((col != i) || (row != j))
+			for (int k = 0; k < 8; k++)
+				{
+				const uInt vecinoIndex = actualIndex + neighbourOffsets[k];
+				if (levelsData[vecinoIndex] > threshold)
+					continue;
+
+				const uInt vecinoSet = findCanonicalElement(parentData, vecinoIndex);  // neighbour's canonical element
+				if (vecinoSet == actualSet)
+					continue;
+
+				// We should join this pixel to the set of the neighbour
+				// Each canonical element of a subset has a nodeID element which contains information about the region.
+				const uInt actualNodeID = nodeIDData[actualSet], vecinoNodeID = nodeIDData[vecinoSet];
+
+				// Both subsets are unified.
+				{
+				uInt root1 = actualSet, root2 = vecinoSet;
+				if (rankData[root1] > rankData[root2])
+					{
+					root1 = vecinoSet;
+					root2 = actualSet;
+					}
+				if (rankData[root1] == rankData[root2])
+					rankData[root2]++;
+				parentData[root1] = root2;
+				cardinalityData[root2] += cardinalityData[root1];
+				actualSet = root2;
+				}
+
+				// If actual point is not in a node already, we associate it with the point that is
+				// associated to a node.
+				if (vecinoNodeID == NULL_NODE)
+					nodeIDData[actualSet] = actualNodeID;
+				else if (actualNodeID == NULL_NODE)
+					nodeIDData[actualSet] = vecinoNodeID;
+				else	// Otherwise, both actual and neighbour are associated to a node already.
+					// We create a new node, and join both nodes of actual and neighbour pixels to
+					// that one.
 					{
-					const uChar vecinoPixel = QVIMAGE_PIXEL(image, i, j, 0);  // neighbour's gray-level 
-					if (vecinoPixel <= actualPixel)
+					// We check that no one of the nodes of actual and neighbour pixels
+					// is new. In that case it will be parent node.
+					if (!closedNode(actualNodeID) && closedNode(vecinoNodeID))
+						// We just add the node...
 						{
-						const uInt vecinoSet = disjointSet.find(i,j);  // neighbour's canonical element
-						if (vecinoSet != actualSet)
-							{
-							// We should join this pixel to the set of the neighbour
-							// Each canonical element of a subset has a nodeID element which contains information about the region.
-							const uInt actualNodeID = nodeID[actualSet], vecinoNodeID = nodeID[vecinoSet];
-	
-							actualSet = disjointSet.unify(col, row, i, j); // both subsets are unified.
-	
-							Q_ASSERT(disjointSet.find(disjointSet.index(col, row)) == disjointSet.find(disjointSet.index(i, j)));
-	
-							// If actual point is not in a node already, we associate it with the point that is
-							// associated to a node.
-							if (vecinoNodeID == NULL_NODE)
-								nodeID[actualSet] = actualNodeID;
-							else if (actualNodeID == NULL_NODE)
-								nodeID[actualSet] = vecinoNodeID;
-							else	// Otherwise, both actual and neighbour are associated to a node already.
-								// We create a new node, and join both nodes of actual and neighbour pixels to
-								// that one.
-								{
-								// We check that no one of the nodes of actual and neighbour pixels
-								// is new. In that case it will be parent node.
-								if (!closedNode(actualNodeID) && closedNode(vecinoNodeID))
-									// We just add the node...
-									{
-									addChild(actualNodeID, vecinoNodeID);
-									nodeID[actualSet] = actualNodeID;
-									}
-								else if (closedNode(actualNodeID) && !closedNode(vecinoNodeID))
-									// We just add the other node...
-									{
-									addChild(vecinoNodeID, actualNodeID);
-									nodeID[actualSet] = vecinoNodeID;
-									}
-								else if (closedNode(actualNodeID) && closedNode(vecinoNodeID))
-									// We have two old nodes, and create a parent to unify them.
-									{
-									const uInt newNodeID = newNode(col, row, threshold);
-									addChild(newNodeID, actualNodeID);
-									addChild(newNodeID, vecinoNodeID);
-	
-									//nodeID[actualIndex] = newNodeID;
-									nodeID[actualSet] = newNodeID;
-									}
-								else // if ( !NODE(actualNodeID).closed and !NODE(vecinoNodeID).closed )
-									// We have two parent nodes, we leave things as they are.
-									// No, we should unify both, passing childs of one of them to the
-									// other.
-									{
-									Q_ASSERT(closedNode(actualNodeID) == false);
-									Q_ASSERT(closedNode(vecinoNodeID) == false);
-									Q_ASSERT(numChilds(actualNodeID) > 0);
-									Q_ASSERT(numChilds(vecinoNodeID) > 0);
-	
-									mergeNodes(actualNodeID, vecinoNodeID);
-									nodeID[actualSet] = actualNodeID;
-									}
-								}
-	
-							// Actualize areas for the resulting parent node.
-							if (nodeID[actualSet] != NULL_NODE)
-								{
-								/// @TODO Repasar este assert, que si se descomenta protesta de un QVector "index out of range"
-								//Q_ASSERT(area(actualNodeID)[lastThreshold(actualNodeID)]
-								//	<= disjointSet.getSetCardinality(actualIndex));
-								lastThreshold(nodeID[actualSet]) = threshold;
-								area(nodeID[actualSet])[threshold] = disjointSet.getSetCardinality(actualSet);
-								}
-	
-							Q_ASSERT(nodeID[disjointSet.find(disjointSet.index(col, row))] ==
-								nodeID[disjointSet.find(disjointSet.index(i, j))]);
-							}
+						addChild(actualNodeID, vecinoNodeID);
+						nodeIDData[actualSet] = actualNodeID;
+						}
+					else if (closedNode(actualNodeID) && !closedNode(vecinoNodeID))
+						// We just add the other node...
+						{
+						addChild(vecinoNodeID, actualNodeID);
+						nodeIDData[actualSet] = vecinoNodeID;
+						}
+					else if (closedNode(actualNodeID) && closedNode(vecinoNodeID))
+						// We have two old nodes, and create a parent to unify them.
+						{
+						const uInt	col = actualIndex % paddedCols - 1,
+								row = actualIndex / paddedCols - 1;
+						const uInt newNodeID = newNode(col, row, threshold);
+						addChild(newNodeID, actualNodeID);
+						addChild(newNodeID, vecinoNodeID);
+						nodeIDData[actualSet] = newNodeID;
+						}
+					else // if ( !NODE(actualNodeID).closed and !NODE(vecinoNodeID).closed )
+						// We have two parent nodes, we should unify both, passing childs of one of them to the
+						// other.
+						{
+						Q_ASSERT(numChilds(actualNodeID) > 0);
+						Q_ASSERT(numChilds(vecinoNodeID) > 0);
+
+						mergeNodes(actualNodeID, vecinoNodeID);
+						nodeIDData[actualSet] = actualNodeID;
 						}
 					}
+
+				// Actualize areas for the resulting parent node.
+				const uInt resultNodeID = nodeIDData[actualSet];
+				if (resultNodeID != NULL_NODE)
+					{
+					lastThreshold(resultNodeID) = threshold;
+					areaLog << resultNodeID << threshold << cardinalityData[actualSet];
+					}
+				}
 			}
 
-		// In this loop we actualize areas for the gray-level of the threshold of the two old nodes, and create new nodes, 
-		// case we find a set of one or several pixels of gray-scale value equal to threshold value, which are not joined
-		// to any connected set represented already in a node of the component tree.
+		// In this loop we create new nodes, case we find a set of one or several pixels of gray-scale value equal to
+		// threshold value, which are not joined to any connected set represented already in a node of the component tree.
 		//
 		// In this point, we have processed all pixels with gray-scale value equal or lesser to threshold. All of them are
 		// grouped to a group of pixels with same gray-scale level, in which case we have the vertex of a node, or well
-		// or well joined to a previously created node.
-		//
-		// Then we creater for the former case new nodes, and in any case we actualize areas for nodes with new points
-		// in them.
-		for (int n=0; n< points[threshold].size(); n++)
+		// joined to a previously created node.
+		for (uInt n = firstPixel; n < lastPixel; n++)
 			{
-			const uInt	col = points[threshold][n].x(),
-					row = points[threshold][n].y(),
-					actualIndex = disjointSet.index(col, row),
-					actualSet = disjointSet.find(actualIndex);
-
-			Q_ASSERT_X(threshold < 256, "getComponentTree", "out of bounds 4");
-			Q_ASSERT_X(actualIndex < cols * rows, "getComponentTree", "out of bounds 5");
+			const uInt	actualIndex = sortedPixelsData[n],
+					actualSet = findCanonicalElement(parentData, actualIndex);
 
 			// We have a pixel with gray-scale level equal to threshold, and disjoint set identifier equal to
 			// himself.
@@ -195,49 +276,28 @@ void QVComponentTree::getComponentTree(const QVImage<uChar> &image)
 			// that he is in a connected set of pixels, all of them with exactly gray-scale level value of threshold
 			// (and we hill be the only one of that set, with disjoint set identifier equal to himself).
 			// Either case we create a new node, with seed point equal to this node.
-			if (actualIndex == actualSet)
+			if (actualIndex == actualSet and nodeIDData[actualIndex] == NULL_NODE)
 				{
-				if (nodeID[actualIndex] == NULL_NODE)
-					// We have a header point for the new component tree node.
-					// We initialize the values for his node.
-					{
-					nodeID[actualSet] = newNode(col, row, threshold);
-					area(nodeID[actualSet])[threshold] = disjointSet.getSetCardinality(actualSet);
+				const uInt	col = actualIndex % paddedCols - 1,
+						row = actualIndex / paddedCols - 1;
+				const uInt newNodeID = newNode(col, row, threshold);
+				nodeIDData[actualSet] = newNodeID;
+				areaLog << newNodeID << threshold << cardinalityData[actualSet];
 
-					this->leafNodes++;
-					}
-				else	// Actual pixel is associated to a node, but this one was created for other pixel.
-					// We count as a free pixel the one that created the node that contains actual pixel.
-					this->freePoints++;
+				this->leafNodes++;
 				}
-			else	// Actual pixel is not its group head
+			else	// Actual pixel is not its group head, or it is associated to a node created for other pixel.
 				this->freePoints++;
 
-			const uInt actualNodeID = nodeID[actualSet];
-
+			// Close node for the actual pixel, if open.
+			const uInt actualNodeID = nodeIDData[actualSet];
 			if (actualNodeID != NULL_NODE)
-				{
-				// Actualize histogram for the node of the actual pixel.
-				//lastThreshold(actualNodeID) = threshold;
-				//area(actualNodeID)[threshold] = disjointSet.getSetCardinality(actualIndex);
-
-				// Close node for the actual pixel, if open.
 				closedNode(actualNodeID) = true;
-				}
-
-			// Actualize total number of points processed.
-			this->totalPoints++;
 			}
 		}
 
-	rootNode() = nodeID[disjointSet.find(0)];
-
-	// Component tree finished, performing some tests....
-	#ifndef QT_NO_DEBUG
-	//testComponentTree(image, disjointSet);
-	#endif
-
-	delete nodeID;
+	this->totalPoints = cols * rows;
+	rootNode() = nodeIDData[findCanonicalElement(parentData, paddedCols + 1)];
 
-	qDebug() << "getComponentTree() <~ return";
+	buildAreaPool(areaLog);
 	}
@@ -47,10 +47,13 @@ vision for task like image segmentation, filtering, scale and rotation invariant
 extraction (like MSER, see [<a href="#matas">Matas</a>]), amongst other.
 
 For a wider explanation about component trees, you can read paper [<a href="#rjones">Jones</a>].
-The former implementation of component trees is very efficient, so that it can be used with regular
-sized images (320x240 to 640x480, depending on the computer speed) in real-time programs.
+The former implementation of component trees is very efficient, so that it can be used with large
+images (up to 1920x1080, depending on the computer speed) in real-time programs.
 It is based in the algorithm described in the paper [<a href="#najman">Najman</a>], which is supposed
-to obtain the component tree in quasi-linear time.
+to obtain the component tree in quasi-linear time. The pixels are sorted by their gray-scale value with
+a counting sort in a single flat array, and joined with a path-compressed union-find structure defined
+over a copy of the image padded with a one pixel border, so the neighbourhood of every pixel can be
+transversed without bound checks.
 
 There's a main difference between this implementation and that described in the paper. While the latter
 constructs a node for each gray-level in a level set, this implementation compacts every gray-level
@@ -139,7 +142,7 @@ class QVComponentTree
 		/// first coordinate of that point.
 		/// @param index index for a node.
 		/// @returns horizontal coordinate for seed point of that node.
-		uInt & seedX(uInt index) 		{ return nodes[index].seedX; }
+		uInt & seedX(uInt index) 		{ return nodeSeedX[index]; }
 
 		/// @brief Returns vertical coordinate for the seed point of a node, given it's index.
 		///
@@ -150,7 +153,7 @@ class QVComponentTree
 		/// second coordinate of that point.
 		/// @param index index for a node.
 		/// @returns vertical coordinate for seed point of that node.
-		uInt & seedY(uInt index) 		{ return nodes[index].seedY; }
+		uInt & seedY(uInt index) 		{ return nodeSeedY[index]; }
 
 		/// @brief Returns gray-scale value of the points at the vertex of a node.
 		///
@@ -158,7 +161,7 @@ class QVComponentTree
 		/// gray-scale value of the pixels contained in it.
 		/// @param node index for a node.
 		/// @returns gray-scale value of the points at the vertex of a node.
-		uChar & firstThreshold(uInt index)	{ return nodes[index].firstThreshold; }
+		uChar & firstThreshold(uInt index)	{ return nodeFirstThreshold[index]; }
 
 		/// @brief Returns gray-scale value of the points at the base of a node.
 		///
@@ -166,22 +169,22 @@ class QVComponentTree
 		/// gray-scale value of the pixels contained in it.
 		/// @param node index for a node.
 		/// @returns gray-scale value of the points at the base of a node.
-		uChar & lastThreshold(uInt index) 	{ return nodes[index].lastThreshold; }
+		uChar & lastThreshold(uInt index) 	{ return nodeLastThreshold[index]; }
 
 		/// @brief Returns the number of child nodes for a node.
 		/// @param node index for a node.
 		/// @returns number of child nodes that a node has got.
-		uInt & numChilds(uInt index) 		{ return nodes[index].numChilds; }
+		uInt & numChilds(uInt index) 		{ return nodeNumChilds[index]; }
 
 		/// @brief Returns the index for the first of the childs of a node.
 		/// @param node index for a node.
 		/// @returns index to the first of the childs of a node.
-		uInt & firstChild(uInt index)	 	{ return nodes[index].child; }
+		uInt & firstChild(uInt index)	 	{ return nodeChild[index]; }
 
 		/// @brief Returns the index for the next node in the list of childs, for a node.
 		/// @param node index for a node.
 		/// @returns index for the next node in the list of childs, for a node.
-		uInt & nextSibling(uInt index) 		{ return nodes[index].sibling; }
+		uInt & nextSibling(uInt index) 		{ return nodeSibling[index]; }
 
 		/// @brief Returns the accumulative histogram of the gray-level values of the pixels,
 		/// for a node.
@@ -200,7 +203,7 @@ class QVComponentTree
 		/// cells containing the value zero, that means we have the keep the previous value in the array.
 		/// @param node index for a node.
 		/// @returns array of areas of the slides of the concave surface defined by the pixels in the node.
-		uInt *area(uInt index) 			{ return nodes[index].area; }
+		uInt *area(uInt index) 			{ return areas.data() + nodeAreaOffset[index]; }
 
 		/// @brief Gets the number of total nodes in the tree.
 		/// @returns the number of total nodes in the tree.
@@ -218,15 +221,20 @@ class QVComponentTree
 
 	private:
 		void getComponentTree(const QVImage<uChar> &image);
+		void resizeNodePool(const uInt capacity);
+		void buildAreaPool(const QVector<uInt> &areaLog);
 
 		uInt numNodes, freePoints, totalPoints, leafNodes, rootNodeID, maxNodes;
 		bool inverseTree;
 
 		/// @brief Checks if a node has been closed. This means it has all the childs it should have.
- 		bool & closedNode(uInt index) 		{ return nodes[index].closed; }
+ 		bool & closedNode(uInt index) 		{ return nodeClosed[index]; }
 
 		uInt newNode(uInt SeedX, uInt SeedY, uChar Threshold)
 			{
+			if (this->numNodes == this->maxNodes)
+				resizeNodePool(2 * this->maxNodes);
+
 			uInt newNodeID = this->numNodes++;
 
 			seedX(newNodeID) = SeedX;
@@ -234,7 +242,6 @@ class QVComponentTree
 			firstThreshold(newNodeID) = lastThreshold(newNodeID) = Threshold;
 			firstChild(newNodeID) =	 nextSibling(newNodeID) = NULL_NODE;
 			numChilds(newNodeID) = 0;
-			area(newNodeID)[Threshold] = 0;
 			closedNode(newNodeID) = false;
 			
 			return newNodeID;
@@ -257,41 +264,14 @@ class QVComponentTree
 			nextSibling(lastActualChildNodeID) = firstChild(vecinoNodeID);
 			}
 
-		class QVComponentTreeNode
-			{
-			public:
-				uInt seedX, seedY;
-				uInt child, sibling, numChilds;
-				uChar firstThreshold, lastThreshold;
-				uInt area[256];
-				bool closed;
-
-				/*bool operator==(const QVComponentTreeNode &other) const
-					{
-					if (seedX != other.seedX)
-						return false;
-					if (seedY != other.seedY)
-						return false;
-					//if (child != other.child)
-					//	return false;
-					//if (sibling != other.sibling)
-					//	return false;
-					if (numChilds != other.numChilds)
-						return false;
-					if (firstThreshold != other.firstThreshold)
-						return false;
-					if (lastThreshold != other.lastThreshold)
-						return false;
-					for (int i = firstThreshold; i < lastThreshold; i++)
-						if (area[i] != other.area[i])
-							return false;
-					return true;
-					}*/
-			};
-
-		QVector<QVComponentTreeNode> nodes;
-
-		//void testComponentTree(const QVImage<uChar,1> &image, QVDisjointSet &disjointSet);
+		// Node pool, stored as a structure of arrays indexed by the node index.
+		QVector<uInt> nodeSeedX, nodeSeedY, nodeChild, nodeSibling, nodeNumChilds, nodeAreaOffset;
+		QVector<uChar> nodeFirstThreshold, nodeLastThreshold;
+		QVector<bool> nodeClosed;
+
+		// Area histograms of the nodes. The histogram of a node only stores the cells from its first to its last threshold,
+		// and nodeAreaOffset[node] + threshold is the position in this array of the cell for a given threshold.
+		QVector<uInt> areas;
 	};
 
 #endif //IFNDEF
@@ -0,0 +1,443 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <algorithm>
+
+#include <QThread>
+
+#include <qvmath/qvparallelranges.h>
+#include <qvip/qvfastdetector.h>
+#include <qvip/qvsimd.h>
+#include <qvip/fast-C-src-2.1/fast.h>
+
+// Minimal number of rows of the image processed by each thread.
+#define	FAST_MIN_ROWS_PER_BAND	32
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Offsets of the 16 pixels of the Bresenham circle of radius 3, in the same order used by the corner score functions
+// of Rosten's implementation.
+static void makeCircleOffsets(int pixel[16], const int step)
+	{
+	const int circleX[16] = { 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1 },
+			  circleY[16] = { 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1, 0, 1, 2, 3 };
+	for(int k = 0; k < 16; k++)
+		pixel[k] = circleX[k] + step * circleY[k];
+	}
+
+// Segment test kernels. They look for an arc of at least 'n' contiguous pixels of the circle, all of them brighter than
+// the center plus 'b', or darker than the center minus 'b', and append to 'corners' the horizontal coordinate of each
+// pixel in [x, x + count) passing the test.
+//
+// The vectorised versions use saturated arithmetic on the center pixel: when the center plus 'b' exceeds 255 no pixel can
+// be brighter, and when the center minus 'b' is negative no pixel can be darker, as in the scalar test. The length of
+// the current arc of brighter and darker pixels is kept in a byte for each pixel, iterating 16 + n - 1 positions of the
+// circle to account for the arcs crossing its first position.
+static int segmentTestRow(const uChar *row, const int pixel[16], const int b, const int n, const int x, const int count, int *corners)
+	{
+	int numCorners = 0;
+	for(int i = 0; i < count; i++)
+		{
+		const uChar *p = row + x + i;
+		const int cb = *p + b, c_b = *p - b;
+
+		// Quick rejection: an arc of 9 or more pixels contains two consecutive pixels out of 0, 4, 8 and 12.
+		const int	p0 = p[pixel[0]], p4 = p[pixel[4]], p8 = p[pixel[8]], p12 = p[pixel[12]];
+		const bool	b0 = p0 > cb, b4 = p4 > cb, b8 = p8 > cb, b12 = p12 > cb,
+					d0 = p0 < c_b, d4 = p4 < c_b, d8 = p8 < c_b, d12 = p12 < c_b;
+		if (not ((b0 and b4) or (b4 and b8) or (b8 and b12) or (b12 and b0) or
+				 (d0 and d4) or (d4 and d8) or (d8 and d12) or (d12 and d0)))
+			continue;
+
+		int brighter = 0, darker = 0, maxBrighter = 0, maxDarker = 0;
+		for(int k = 0; k < 16 + n - 1; k++)
+			{
+			const int value = p[pixel[k & 15]];
+			brighter = (value > cb)? brighter + 1: 0;
+			darker = (value < c_b)? darker + 1: 0;
+			maxBrighter = MAX(maxBrighter, brighter);
+			maxDarker = MAX(maxDarker, darker);
+			}
+		if (maxBrighter >= n or maxDarker >= n)
+			corners[numCorners++] = x + i;
+		}
+	return numCorners;
+	}
+
+#ifdef QVSIMD_X86
+QVSIMD_TARGET_SSE2 static int segmentTestRow_SSE2(const uChar *row, const int pixel[16], const int b, const int n, const int x, const int count, int *corners)
+	{
+	const __m128i	threshold = _mm_set1_epi8(char(b)), minLength = _mm_set1_epi8(char(n)), zero = _mm_setzero_si128();
+
+	int numCorners = 0, i = 0;
+	for(; i + 16 <= count; i += 16)
+		{
+		const uChar *p = row + x + i;
+		const __m128i	center = _mm_loadu_si128((const __m128i *) p),
+						cb = _mm_adds_epu8(center, threshold),
+						c_b = _mm_subs_epu8(center, threshold);
+
+		#define BRIGHTER(K)	_mm_cmpeq_epi8(_mm_subs_epu8(_mm_loadu_si128((const __m128i *) (p + pixel[K])), cb), zero)
+		#define DARKER(K)	_mm_cmpeq_epi8(_mm_subs_epu8(c_b, _mm_loadu_si128((const __m128i *) (p + pixel[K]))), zero)
+
+		// Quick rejection, as in the scalar test. Masks are inverted here: a zero byte means that the pixel is brighter (or darker).
+		{
+		const __m128i	notB0 = BRIGHTER(0), notB4 = BRIGHTER(4), notB8 = BRIGHTER(8), notB12 = BRIGHTER(12),
+						notD0 = DARKER(0), notD4 = DARKER(4), notD8 = DARKER(8), notD12 = DARKER(12);
+		const __m128i	notBrighter = _mm_and_si128(_mm_and_si128(_mm_or_si128(notB0, notB4), _mm_or_si128(notB4, notB8)),
+												_mm_and_si128(_mm_or_si128(notB8, notB12), _mm_or_si128(notB12, notB0))),
+						notDarker = _mm_and_si128(_mm_and_si128(_mm_or_si128(notD0, notD4), _mm_or_si128(notD4, notD8)),
+												_mm_and_si128(_mm_or_si128(notD8, notD12), _mm_or_si128(notD12, notD0)));
+		if (_mm_movemask_epi8(_mm_and_si128(notBrighter, notDarker)) == 0xFFFF)
+			continue;
+		}
+
+		__m128i brighter = zero, darker = zero, maxBrighter = zero, maxDarker = zero;
+		for(int k = 0; k < 16 + n - 1; k++)
+			{
+			const __m128i	notB = BRIGHTER(k & 15), notD = DARKER(k & 15);
+			// Adding one is subtracting the all-ones mask of the pixels which are brighter (or darker).
+			brighter = _mm_andnot_si128(notB, _mm_sub_epi8(brighter, _mm_cmpeq_epi8(notB, zero)));
+			darker = _mm_andnot_si128(notD, _mm_sub_epi8(darker, _mm_cmpeq_epi8(notD, zero)));
+			maxBrighter = _mm_max_epu8(maxBrighter, brighter);
+			maxDarker = _mm_max_epu8(maxDarker, darker);
+			}
+
+		#undef BRIGHTER
+		#undef DARKER
+
+		const __m128i maxLength = _mm_max_epu8(maxBrighter, maxDarker);
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(maxLength, minLength), maxLength));
+		while(mask != 0)
+			{
+			corners[numCorners++] = x + i + __builtin_ctz(mask);
+			mask &= mask - 1;
+			}
+		}
+
+	return numCorners + segmentTestRow(row, pixel, b, n, x + i, count - i, corners + numCorners);
+	}
+
+QVSIMD_TARGET_AVX2 static int segmentTestRow_AVX2(const uChar *row, const int pixel[16], const int b, const int n, const int x, const int count, int *corners)
+	{
+	const __m256i	threshold = _mm256_set1_epi8(char(b)), minLength = _mm256_set1_epi8(char(n)), zero = _mm256_setzero_si256();
+
+	int numCorners = 0, i = 0;
+	for(; i + 32 <= count; i += 32)
+		{
+		const uChar *p = row + x + i;
+		const __m256i	center = _mm256_loadu_si256((const __m256i *) p),
+						cb = _mm256_adds_epu8(center, threshold),
+						c_b = _mm256_subs_epu8(center, threshold);
+
+		#define BRIGHTER(K)	_mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_loadu_si256((const __m256i *) (p + pixel[K])), cb), zero)
+		#define DARKER(K)	_mm256_cmpeq_epi8(_mm256_subs_epu8(c_b, _mm256_loadu_si256((const __m256i *) (p + pixel[K]))), zero)
+
+		{
+		const __m256i	notB0 = BRIGHTER(0), notB4 = BRIGHTER(4), notB8 = BRIGHTER(8), notB12 = BRIGHTER(12),
+						notD0 = DARKER(0), notD4 = DARKER(4), notD8 = DARKER(8), notD12 = DARKER(12);
+		const __m256i	notBrighter = _mm256_and_si256(_mm256_and_si256(_mm256_or_si256(notB0, notB4), _mm256_or_si256(notB4, notB8)),
+												_mm256_and_si256(_mm256_or_si256(notB8, notB12), _mm256_or_si256(notB12, notB0))),
+						notDarker = _mm256_and_si256(_mm256_and_si256(_mm256_or_si256(notD0, notD4), _mm256_or_si256(notD4, notD8)),
+												_mm256_and_si256(_mm256_or_si256(notD8, notD12), _mm256_or_si256(notD12, notD0)));
+		if (_mm256_movemask_epi8(_mm256_and_si256(notBrighter, notDarker)) == -1)
+			continue;
+		}
+
+		__m256i brighter = zero, darker = zero, maxBrighter = zero, maxDarker = zero;
+		for(int k = 0; k < 16 + n - 1; k++)
+			{
+			const __m256i	notB = BRIGHTER(k & 15), notD = DARKER(k & 15);
+			brighter = _mm256_andnot_si256(notB, _mm256_sub_epi8(brighter, _mm256_cmpeq_epi8(notB, zero)));
+			darker = _mm256_andnot_si256(notD, _mm256_sub_epi8(darker, _mm256_cmpeq_epi8(notD, zero)));
+			maxBrighter = _mm256_max_epu8(maxBrighter, brighter);
+			maxDarker = _mm256_max_epu8(maxDarker, darker);
+			}
+
+		#undef BRIGHTER
+		#undef DARKER
+
+		const __m256i maxLength = _mm256_max_epu8(maxBrighter, maxDarker);
+		unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(maxLength, minLength), maxLength));
+		while(mask != 0)
+			{
+			corners[numCorners++] = x + i + __builtin_ctz(mask);
+			mask &= mask - 1;
+			}
+		}
+
+	return numCorners + segmentTestRow_SSE2(row, pixel, b, n, x + i, count - i, corners + numCorners);
+	}
+#endif // QVSIMD_X86
+
+// Empties a vector keeping its allocated memory. Reserving the current capacity prevents QVector::resize() from
+// releasing it.
+static inline void clearBuffer(QVector<int> &buffer)
+	{
+	buffer.reserve(buffer.capacity());
+	buffer.resize(0);
+	}
+
+static int cornerScore(const FASTDetectionAlgorithm algorithm, const uChar *p, const int pixel[16], const int b)
+	{
+	switch(algorithm)
+		{
+		case Fast10:	return fast10_corner_score(p, pixel, b);
+		case Fast11:	return fast11_corner_score(p, pixel, b);
+		case Fast12:	return fast12_corner_score(p, pixel, b);
+		default:		return fast9_corner_score(p, pixel, b);
+		}
+	}
+
+// Detects the corners of the rows [band.firstRow, band.lastRow) of the image.
+//
+// With non-maximal suppression, the corners of the rows above and below the band are also detected, and a corner is
+// discarded if any of its 8 neighbours is a corner with an equal or higher score, as in Rosten's 'nonmax_suppression'.
+// The scores are written to a buffer with one row for each detected row, storing 'score + 1' for the corners and zero
+// for the rest of the pixels. Only the cells written are cleared afterwards, so the buffer is reused without clearing it.
+static void detectBandFeatures(const uChar *imageData, const int step, const int cols, const int rows, const int b,
+	const FASTDetectionAlgorithm algorithm, const bool nonMaximalSuppression, const TQVSimdLevel simdLevel, QVFASTDetector::Band &band)
+	{
+	const int	n = int(algorithm),
+				firstRow = nonMaximalSuppression? MAX(3, band.firstRow - 1): band.firstRow,
+				lastRow = nonMaximalSuppression? MIN(rows - 3, band.lastRow + 1): band.lastRow,
+				firstCol = 3, rowCount = cols - 6;
+
+	int pixel[16];
+	makeCircleOffsets(pixel, step);
+
+	clearBuffer(band.featuresX);
+	clearBuffer(band.featuresY);
+	clearBuffer(band.scores);
+	clearBuffer(band.candidatesX);
+	clearBuffer(band.candidatesY);
+	clearBuffer(band.candidateScores);
+
+	if (lastRow <= firstRow or rowCount <= 0)
+		return;
+
+	if (band.rowCorners.size() < rowCount)
+		band.rowCorners.resize(rowCount);
+	int *rowCornersData = band.rowCorners.data();
+
+	if (nonMaximalSuppression and band.scoreBuffer.size() < (lastRow - firstRow) * cols)
+		band.scoreBuffer.resize((lastRow - firstRow) * cols);
+	int *scoreBuffer = band.scoreBuffer.data();
+
+	for(int y = firstRow; y < lastRow; y++)
+		{
+		const uChar *row = imageData + y * step;
+
+		int numCorners;
+		#ifdef QVSIMD_X86
+		if (simdLevel == QVSIMD_AVX2)
+			numCorners = segmentTestRow_AVX2(row, pixel, b, n, firstCol, rowCount, rowCornersData);
+		else if (simdLevel == QVSIMD_SSE2)
+			numCorners = segmentTestRow_SSE2(row, pixel, b, n, firstCol, rowCount, rowCornersData);
+		else
+		#endif // QVSIMD_X86
+			numCorners = segmentTestRow(row, pixel, b, n, firstCol, rowCount, rowCornersData);
+		Q_UNUSED(simdLevel);
+
+		QVector<int>	&cornersX = nonMaximalSuppression? band.candidatesX: band.featuresX,
+						&cornersY = nonMaximalSuppression? band.candidatesY: band.featuresY,
+						&cornerScores = nonMaximalSuppression? band.candidateScores: band.scores;
+
+		for(int i = 0; i < numCorners; i++)
+			{
+			const int x = rowCornersData[i], score = cornerScore(algorithm, row + x, pixel, b);
+			cornersX << x;
+			cornersY << y;
+			cornerScores << score;
+			if (nonMaximalSuppression)
+				scoreBuffer[(y - firstRow) * cols + x] = score + 1;
+			}
+		}
+
+	if (not nonMaximalSuppression)
+		return;
+
+	const int *candidatesX = band.candidatesX.constData(), *candidatesY = band.candidatesY.constData(),
+			  *candidateScores = band.candidateScores.constData();
+	for(int i = 0; i < band.candidatesX.size(); i++)
+		{
+		const int x = candidatesX[i], y = candidatesY[i], score = candidateScores[i] + 1;
+		if (y < band.firstRow or y >= band.lastRow)
+			continue;
+
+		const int *center = scoreBuffer + (y - firstRow) * cols + x;
+		bool maximal = center[-1] < score and center[+1] < score;
+		if (maximal and y > firstRow)
+			maximal = center[-cols-1] < score and center[-cols] < score and center[-cols+1] < score;
+		if (maximal and y < lastRow - 1)
+			maximal = center[cols-1] < score and center[cols] < score and center[cols+1] < score;
+
+		if (maximal)
+			{
+			band.featuresX << x;
+			band.featuresY << y;
+			band.scores << score - 1;
+			}
+		}
+
+	for(int i = 0; i < band.candidatesX.size(); i++)
+		scoreBuffer[(candidatesY[i] - firstRow) * cols + candidatesX[i]] = 0;
+	}
+
+// Detects the corners of the bands of candidate rows, splitting the rows evenly between the bands.
+class FASTBandTask
+	{
+	public:
+		FASTBandTask(const uChar *imageData, const int step, const int cols, const int rows, const int b,
+			const FASTDetectionAlgorithm algorithm, const bool nonMaximalSuppression, const TQVSimdLevel simdLevel,
+			QVFASTDetector::Band *bands):
+			imageData(imageData), step(step), cols(cols), rows(rows), b(b), algorithm(algorithm),
+			nonMaximalSuppression(nonMaximalSuppression), simdLevel(simdLevel), bands(bands)	{ }
+
+		void operator()(const int i, const int first, const int last)
+			{
+			QVFASTDetector::Band &band = bands[i];
+			band.firstRow = 3 + first;
+			band.lastRow = 3 + last;
+			detectBandFeatures(imageData, step, cols, rows, b, algorithm, nonMaximalSuppression, simdLevel, band);
+			}
+
+	private:
+		const uChar *imageData;
+		const int step, cols, rows, b;
+		const FASTDetectionAlgorithm algorithm;
+		const bool nonMaximalSuppression;
+		const TQVSimdLevel simdLevel;
+		QVFASTDetector::Band *bands;
+	};
+
+// Orders the corners of a cell by decreasing score, and by raster scan order for equal scores.
+class FASTScoreGreaterThan
+	{
+	public:
+		FASTScoreGreaterThan(const int *scores): scores(scores)	{ }
+		bool operator()(const int i, const int j) const
+			{ return (scores[i] > scores[j]) or (scores[i] == scores[j] and i < j); }
+	private:
+		const int *scores;
+	};
+#endif // DOXYGEN_IGNORE_THIS
+
+QVFASTDetector::QVFASTDetector(const int threshold, const FASTDetectionAlgorithm algorithm, const bool nonMaximalSuppression):
+	threshold(threshold), gridCellSize(0), gridMaxFeatures(0), numThreads(0), algorithm(algorithm), nonMaximalSuppression(nonMaximalSuppression)
+	{ }
+
+int QVFASTDetector::detect(const QVImage<uChar, 1> &image)
+	{
+	const int	cols = image.getCols(), rows = image.getRows(), step = image.getStep(),
+				b = MAX(0, MIN(255, threshold)),
+				candidateRows = MAX(0, rows - 6),
+				maxThreads = (numThreads > 0)? numThreads: QThread::idealThreadCount(),
+				numBands = MAX(1, MIN(maxThreads, candidateRows / FAST_MIN_ROWS_PER_BAND));
+	const uChar *imageData = image.getReadData();
+	const TQVSimdLevel simdLevel = qvSimdLevel();
+
+	if (bands.size() < numBands)
+		bands.resize(numBands);
+
+	FASTBandTask task(imageData, step, cols, rows, b, algorithm, nonMaximalSuppression, simdLevel, bands.data());
+	qvParallelRanges(task, candidateRows, numBands);
+
+	// Concatenate the corners of the bands, in raster scan order.
+	int numFeatures = 0;
+	for(int i = 0; i < numBands; i++)
+		numFeatures += bands[i].featuresX.size();
+
+	featuresX.resize(numFeatures);
+	featuresY.resize(numFeatures);
+	scores.resize(numFeatures);
+
+	for(int i = 0, index = 0; i < numBands; i++)
+		{
+		const Band &band = bands[i];
+		const int size = band.featuresX.size();
+		qCopy(band.featuresX.constBegin(), band.featuresX.constEnd(), featuresX.begin() + index);
+		qCopy(band.featuresY.constBegin(), band.featuresY.constEnd(), featuresY.begin() + index);
+		qCopy(band.scores.constBegin(), band.scores.constEnd(), scores.begin() + index);
+		index += size;
+		}
+
+	if (gridCellSize > 0 and gridMaxFeatures >= 0)
+		selectGridFeatures(cols, rows);
+
+	return featuresX.size();
+	}
+
+void QVFASTDetector::selectGridFeatures(const int cols, const int rows)
+	{
+	const int	gridCols = (cols + gridCellSize - 1) / gridCellSize,
+				gridRows = (rows + gridCellSize - 1) / gridCellSize,
+				numCells = gridCols * gridRows,
+				numFeatures = featuresX.size();
+
+	int *x = featuresX.data(), *y = featuresY.data(), *score = scores.data();
+
+	// Counting sort of the corners by cell. 'cellCounts[c]' is the position in 'cellOrder' of the first corner of cell 'c'.
+	cellCounts.fill(0, numCells + 1);
+	cellOrder.resize(numFeatures);
+	int *counts = cellCounts.data(), *order = cellOrder.data();
+
+	for(int i = 0; i < numFeatures; i++)
+		counts[(y[i] / gridCellSize) * gridCols + x[i] / gridCellSize + 1]++;
+	for(int c = 0; c < numCells; c++)
+		counts[c+1] += counts[c];
+	for(int i = 0; i < numFeatures; i++)
+		order[counts[(y[i] / gridCellSize) * gridCols + x[i] / gridCellSize]++] = i;
+
+	// After the previous loop 'counts[c]' is the end of cell 'c'. Corners discarded are marked with a negative score.
+	for(int c = 0, first = 0; c < numCells; first = counts[c++])
+		if (counts[c] - first > gridMaxFeatures)
+			{
+			std::partial_sort(order + first, order + first + gridMaxFeatures, order + counts[c], FASTScoreGreaterThan(score));
+			for(int i = first + gridMaxFeatures; i < counts[c]; i++)
+				score[order[i]] = -1;
+			}
+
+	int numSelected = 0;
+	for(int i = 0; i < numFeatures; i++)
+		if (score[i] >= 0)
+			{
+			x[numSelected] = x[i];
+			y[numSelected] = y[i];
+			score[numSelected] = score[i];
+			numSelected++;
+			}
+
+	featuresX.resize(numSelected);
+	featuresY.resize(numSelected);
+	scores.resize(numSelected);
+	}
+
+QList<QPointF> QVFASTDetector::getFeatures() const
+	{
+	QList<QPointF> result;
+	result.reserve(featuresX.size());
+	for(int i = 0; i < featuresX.size(); i++)
+		result << QPointF(featuresX[i], featuresY[i]);
+	return result;
+	}
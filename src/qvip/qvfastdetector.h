@@ -0,0 +1,152 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVFASTDETECTOR_H
+#define QVFASTDETECTOR_H
+
+#include <QVector>
+#include <QList>
+#include <QPointF>
+
+#include <qvip.h>
+
+/*!
+@class QVFASTDetector qvip/qvfastdetector.h QVFASTDetector
+@brief Multithreaded FAST corner detector.
+
+This class detects FAST corners (see [<a href="#rosten">Rosten</a>]) on gray-scale images. It obtains the same corners
+and scores as Edward Rosten's implementation used by the function @ref FASTFeatures, but:
+
+- The image is split in horizontal bands, which are processed in parallel by the threads of the global thread pool.
+Consecutive bands overlap in one row, so the non-maximal suppression does not depend on the number of bands.
+- The segment test is evaluated for 16 or 32 pixels at once, using the SSE2 or AVX2 instruction sets when the
+processor supports them (see @ref qvSimdLevel).
+- The buffers used by the detection are kept in the object, and reused in the following calls to @ref detect.
+The detected corners are stored in three arrays, containing their coordinates and scores.
+
+The detector can also select the corners with the highest scores in every cell of a regular grid (see
+@ref setGridSelection). This bounds the number of corners obtained, and distributes them evenly over the image.
+
+The following code shows an example usage:
+
+@code
+QVFASTDetector fastDetector(20, Fast9);
+fastDetector.setGridSelection(32, 4);	// At most 4 corners in each cell of 32x32 pixels.
+
+while(...)
+	{
+	QVImage<uChar> image = ...;
+	fastDetector.detect(image);
+	const QList<QPointF> corners = fastDetector.getFeatures();
+	...
+	}
+@endcode
+
+Corners are returned in raster scan order.
+
+@section References
+<ul>
+<li><a name="rosten"><i>Machine learning for high-speed corner detection</i></a>. E. Rosten and T. Drummond.</li>
+</ul>
+@ingroup qvip
+*/
+class QVFASTDetector
+	{
+	public:
+		/// @brief Constructs a FAST detector.
+		/// @param threshold Threshold value for the segment test.
+		/// @param algorithm One of the four versions of the FAST detector.
+		/// @param nonMaximalSuppression If true, only corners with a score higher than that of their 8 neighbour corners are detected.
+		QVFASTDetector(const int threshold = 20, const FASTDetectionAlgorithm algorithm = Fast9, const bool nonMaximalSuppression = true);
+
+		/// @brief Sets the threshold value for the segment test.
+		void setThreshold(const int value)				{ threshold = value; }
+		/// @brief Returns the threshold value for the segment test.
+		int getThreshold() const						{ return threshold; }
+
+		/// @brief Sets the version of the FAST detector.
+		void setAlgorithm(const FASTDetectionAlgorithm value)	{ algorithm = value; }
+		/// @brief Returns the version of the FAST detector.
+		FASTDetectionAlgorithm getAlgorithm() const		{ return algorithm; }
+
+		/// @brief Enables or disables the non-maximal suppression of the corners.
+		void setNonMaximalSuppression(const bool value)	{ nonMaximalSuppression = value; }
+		/// @brief Returns whether the non-maximal suppression of the corners is enabled.
+		bool getNonMaximalSuppression() const			{ return nonMaximalSuppression; }
+
+		/// @brief Enables the selection of the best corners in every cell of a grid.
+		///
+		/// The image is divided in square cells of a given size. For each cell, only the corners with the highest scores
+		/// are kept. Corners with the same score are selected in raster scan order.
+		/// @param cellSize size in pixels of the cells. A value of zero disables the selection.
+		/// @param maxFeaturesPerCell maximal number of corners kept in each cell.
+		void setGridSelection(const int cellSize, const int maxFeaturesPerCell)
+			{ gridCellSize = cellSize; gridMaxFeatures = maxFeaturesPerCell; }
+
+		/// @brief Sets the maximal number of threads used by the detector.
+		/// @param value number of threads. A value of zero uses QThread::idealThreadCount().
+		void setNumThreads(const int value)				{ numThreads = value; }
+
+		/// @brief Detects the corners in an image.
+		/// @param image Input image.
+		/// @return number of corners detected.
+		int detect(const QVImage<uChar, 1> &image);
+
+		/// @brief Returns the number of corners found by the last call to @ref detect.
+		int getNumFeatures() const						{ return featuresX.size(); }
+
+		/// @brief Horizontal coordinates of the corners found by the last call to @ref detect.
+		const QVector<int> & getFeaturesX() const		{ return featuresX; }
+		/// @brief Vertical coordinates of the corners found by the last call to @ref detect.
+		const QVector<int> & getFeaturesY() const		{ return featuresY; }
+		/// @brief Scores of the corners found by the last call to @ref detect.
+		///
+		/// The score of a corner is the highest threshold for which it is still detected by the segment test.
+		const QVector<int> & getScores() const			{ return scores; }
+
+		/// @brief Returns the locations of the corners found by the last call to @ref detect.
+		QList<QPointF> getFeatures() const;
+
+	#ifndef DOXYGEN_IGNORE_THIS
+		// Buffers of one of the horizontal bands of the image.
+		class Band
+			{
+			public:
+				int firstRow, lastRow;
+				QVector<int> rowCorners, candidatesX, candidatesY, candidateScores, scoreBuffer, featuresX, featuresY, scores;
+			};
+	#endif // DOXYGEN_IGNORE_THIS
+
+	private:
+		void selectGridFeatures(const int cols, const int rows);
+
+		int threshold, gridCellSize, gridMaxFeatures, numThreads;
+		FASTDetectionAlgorithm algorithm;
+		bool nonMaximalSuppression;
+
+		QVector<Band> bands;
+		QVector<int> featuresX, featuresY, scores, cellCounts, cellOrder;
+	};
+
+#endif // QVFASTDETECTOR_H
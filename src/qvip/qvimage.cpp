@@ -26,6 +26,7 @@
 #include <QVImage>
 
 #include <iostream>
+#include <qvip/qvsimd.h>
 
 template <> const char * QVImage<uChar,1>::getTypeQString()		const	{ return "QVImage<uChar,1>"; }
 template <> const char * QVImage<uChar,3>::getTypeQString()		const	{ return "QVImage<uChar,3>"; }
@@ -47,6 +48,7 @@ template <> const char * QVImage<sFloat,3>::getTypeQString()	const	{ return "QVI
 template <> QVImage<TYPE, C>::QVImage(QVImage<TYPE, C> const &img):QVGenericImage(img)		\
 	{																	\
 	imageBuffer = img.imageBuffer;										\
+	detachWritableViews();												\
 	step_div_type_size = getStep()/sizeof(TYPE);						\
 	}
 
@@ -70,6 +72,7 @@ CREATE_COPY_CONSTRUCTOR(sFloat, 3);
 template <> QVImage<TYPE,C> & QVImage<TYPE, C>::operator=(const QVImage<TYPE, C> &img) 	\
 	{														\
 	imageBuffer = img.imageBuffer;							\
+	detachWritableViews();									\
 	setROI(img.getROI()); setAnchor(img.getAnchor());		\
 	step_div_type_size = getStep()/sizeof(TYPE);			\
 	return *this;											\
@@ -1360,10 +1363,10 @@ template<typename Type> void CopyC1x3C3(	const QVImage<Type, 1> &src1,
 				*src3Data = src3.getReadData();
 
 	Type *dstData = dst.getWriteData();
-	const uInt	src1Step = src1.getStep(),
-				src2Step = src2.getStep(),
-				src3Step = src3.getStep(),
-				dstStep = dst.getStep();
+	const uInt	src1Step = src1.getStep() / sizeof(Type),
+				src2Step = src2.getStep() / sizeof(Type),
+				src3Step = src3.getStep() / sizeof(Type),
+				dstStep = dst.getStep() / sizeof(Type);
 
 	for(uInt i = 0; i < rows; i++)
 		{
@@ -1390,8 +1393,8 @@ template<typename Type> void ConvertC1C3(const QVImage<Type, 1> &src, QVImage<Ty
 
 	Type const *srcData = src.getReadData();
 	Type *dstData = dst.getWriteData();
-	const int	srcStep = src.getStep(),
-				dstStep = dst.getStep();
+	const int	srcStep = src.getStep() / sizeof(Type),
+				dstStep = dst.getStep() / sizeof(Type);
 
 	for(int i = 0; i < rows; i++)
 		{
@@ -1411,8 +1414,8 @@ template<typename Type> void ConvertC3C1(const QVImage<Type, 3> &src, QVImage<Ty
 
 	Type const *srcData = src.getReadData();
 	Type *dstData = dst.getWriteData();
-	const int	srcStep = src.getStep(),
-				dstStep = dst.getStep();
+	const int	srcStep = src.getStep() / sizeof(Type),
+				dstStep = dst.getStep() / sizeof(Type);
 
 	for(int i = 0; i < rows; i++)
 		{
@@ -1432,8 +1435,8 @@ template<typename Type1, typename Type2, int C> void ConvertType(const QVImage<T
 
 	Type1 const *srcData = src.getReadData();
 	Type2 *dstData = dst.getWriteData();
-	const int	srcStep = src.getStep(),
-				dstStep = dst.getStep();
+	const int	srcStep = src.getStep() / sizeof(Type1),
+				dstStep = dst.getStep() / sizeof(Type2);
 
 	for(int i = 0; i < rows; i++)
 		{
@@ -1453,8 +1456,8 @@ template<typename Type> void CopyC3C1(const QVImage<Type, 3> &src, const uChar c
 
 	Type const *srcData = src.getReadData();
 	Type *dstData = dst.getWriteData();
-	const int	srcStep = src.getStep(),
-				dstStep = dst.getStep();
+	const int	srcStep = src.getStep() / sizeof(Type),
+				dstStep = dst.getStep() / sizeof(Type);
 
 	for(int i = 0; i < rows; i++)
 		{
@@ -1468,6 +1471,49 @@ template<typename Type> void CopyC3C1(const QVImage<Type, 3> &src, const uChar c
 #endif // DOXYGEN_IGNORE_THIS
 
 #ifndef QVIPP
+#ifndef DOXYGEN_IGNORE_THIS
+// Row access and ROI composition for the substitute functions, equivalent to the macros PDATA_READ_MARGIN,
+// PDATA_WRITE and COMPOSE_ROI used by the IPP wrappers.
+template <typename Type, int C> inline const Type * roiReadRow(const QVImage<Type, C> &image, const int row, const int marginCols = 0)
+	{
+	return image.getReadData() + (image.getROI().y() + row) * (image.getStep() / sizeof(Type)) + C * (image.getROI().x() + marginCols);
+	}
+
+template <typename Type, int C> inline Type * roiWriteRow(Type *data, const QVImage<Type, C> &image, const int row)
+	{
+	return data + (image.getROI().y() + row) * (image.getStep() / sizeof(Type)) + C * image.getROI().x();
+	}
+
+template <typename Type, int C> bool composeROI(QVImage<Type, C> &dest, const QRect &srcROI, const QPoint &destROIOffset, const int incW, const int incH)
+	{
+	const int	roiX = destROIOffset.x(), roiY = destROIOffset.y(),
+				roiWidth = srcROI.width() - incW, roiHeight = srcROI.height() - incH;
+
+	if (roiWidth <= 0 or roiHeight <= 0 or roiX < 0 or roiY < 0)
+		return false;
+
+	dest.resize(roiX + roiWidth, roiY + roiHeight);
+	dest.setROI(roiX, roiY, roiWidth, roiHeight);
+	return true;
+	}
+#endif // DOXYGEN_IGNORE_THIS
+
+void Set(const uChar value, QVImage<uChar, 1> &image)
+	{
+	uChar *data = image.getWriteData();
+	const int step = image.getStep();
+	for(uInt row = 0; row < image.getRows(); row++)
+		qvSimdSet_8u(value, data + row * step, image.getCols());
+	}
+
+void Set(const sFloat value, QVImage<sFloat, 1> &image)
+	{
+	sFloat *data = image.getWriteData();
+	const int step = image.getStep() / sizeof(sFloat);
+	for(uInt row = 0; row < image.getRows(); row++)
+		qvSimdSet_32f(value, data + row * step, image.getCols());
+	}
+
 #define	CREATE_SET_NO_IPP_C1(TYPE)								\
 void Set(const TYPE value, QVImage<TYPE, 1> &image)				\
 	{															\
@@ -1479,8 +1525,6 @@ void Set(const TYPE value, QVImage<TYPE, 1> &image)				\
 			QVIMAGE_PIXEL(image, col, row, 0) = value;			\
 	}
 
-CREATE_SET_NO_IPP_C1(uChar);
-CREATE_SET_NO_IPP_C1(sFloat);
 CREATE_SET_NO_IPP_C1(sInt);
 CREATE_SET_NO_IPP_C1(uInt);
 CREATE_SET_NO_IPP_C1(sShort);
@@ -1508,10 +1552,16 @@ CREATE_SET_NO_IPP_C3(uInt);
 CREATE_SET_NO_IPP_C3(sShort);
 CREATE_SET_NO_IPP_C3(uShort);
 
-#define	CREATE_COPY_NO_IPP(TYPE, C)								\
-void Copy(const QVImage<TYPE, C> &src, QVImage<TYPE, C> &dest)	\
-	{															\
-	dest = src;													\
+#define	CREATE_COPY_NO_IPP(TYPE, C)														\
+void Copy(const QVImage<TYPE, C> &src, QVImage<TYPE, C> &dest, const QPoint &destROIOffset)	\
+	{																					\
+	if (not composeROI(dest, src.getROI(), destROIOffset, 0, 0))						\
+		return;																			\
+																						\
+	TYPE *destData = dest.getWriteData();												\
+	const int cols = dest.getROI().width(), rows = dest.getROI().height();				\
+	for(int row = 0; row < rows; row++)													\
+		memcpy(roiWriteRow(destData, dest, row), roiReadRow(src, row), C * cols * sizeof(TYPE));	\
 	}
 
 CREATE_COPY_NO_IPP(uChar, 1);
@@ -1537,9 +1587,37 @@ void Copy(const QVImage<sShort, 3> &src, const uChar channel, QVImage<sShort, 1>
 void Copy(const QVImage<uShort, 3> &src, const uChar channel, QVImage<uShort, 1> &dst)	{ CopyC3C1<uShort>(src, channel, dst); }
 
 // Convert method.
+// uChar <-> sFloat conversions use the pixel kernels. Conversions to uChar saturate, as in the IPP.
+#define	CREATE_CONVERT_SIMD_NO_IPP(C)																	\
+void Convert(const QVImage<uChar, C> &src, QVImage<sFloat, C> &dst)									\
+	{																								\
+	const int cols = src.getCols(), rows = src.getRows();											\
+	dst = QVImage<sFloat, C>(cols, rows);															\
+	dst.setROI(src.getROI());																		\
+																									\
+	const uChar *srcData = src.getReadData();														\
+	sFloat *dstData = dst.getWriteData();															\
+	for(int row = 0; row < rows; row++)																\
+		qvSimdConvert_8u32f(srcData + row * src.getStep(), dstData + row * (dst.getStep() / sizeof(sFloat)), C * cols);	\
+	}																								\
+																									\
+void Convert(const QVImage<sFloat, C> &src, QVImage<uChar, C> &dst, const IppRoundMode roundMode)	\
+	{																								\
+	const int cols = src.getCols(), rows = src.getRows();											\
+	dst = QVImage<uChar, C>(cols, rows);															\
+	dst.setROI(src.getROI());																		\
+																									\
+	const sFloat *srcData = src.getReadData();														\
+	uChar *dstData = dst.getWriteData();															\
+	for(int row = 0; row < rows; row++)																\
+		qvSimdConvert_32f8u(srcData + row * (src.getStep() / sizeof(sFloat)), dstData + row * dst.getStep(), C * cols, roundMode == ippRndNear);	\
+	}
+
+CREATE_CONVERT_SIMD_NO_IPP(1);
+CREATE_CONVERT_SIMD_NO_IPP(3);
+
 // sFloat
 //void Convert(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst)	{ ConvertType<sFloat, sFloat, 1>(src, dst); }
-void Convert(const QVImage<sFloat, 1> &src, QVImage<uChar, 1> &dst)	{ ConvertType<sFloat, uChar, 1>(src, dst); }
 void Convert(const QVImage<sFloat, 1> &src, QVImage<sChar, 1> &dst)	{ ConvertType<sFloat, sChar, 1>(src, dst); }
 void Convert(const QVImage<sFloat, 1> &src, QVImage<sInt, 1> &dst)	{ ConvertType<sFloat, sInt, 1>(src, dst); }
 void Convert(const QVImage<sFloat, 1> &src, QVImage<uInt, 1> &dst)	{ ConvertType<sFloat, uInt, 1>(src, dst); }
@@ -1547,7 +1625,6 @@ void Convert(const QVImage<sFloat, 1> &src, QVImage<sShort, 1> &dst)	{ ConvertTy
 void Convert(const QVImage<sFloat, 1> &src, QVImage<uShort, 1> &dst)	{ ConvertType<sFloat, uShort, 1>(src, dst); }
 
 //void Convert(const QVImage<sFloat, 3> &src, QVImage<sFloat, 3> &dst)	{ ConvertType<sFloat, sFloat, 3>(src, dst); }
-void Convert(const QVImage<sFloat, 3> &src, QVImage<uChar, 3> &dst)	{ ConvertType<sFloat, uChar, 3>(src, dst); }
 void Convert(const QVImage<sFloat, 3> &src, QVImage<sChar, 3> &dst)	{ ConvertType<sFloat, sChar, 3>(src, dst); }
 void Convert(const QVImage<sFloat, 3> &src, QVImage<sInt, 3> &dst)	{ ConvertType<sFloat, sInt, 3>(src, dst); }
 void Convert(const QVImage<sFloat, 3> &src, QVImage<uInt, 3> &dst)	{ ConvertType<sFloat, uInt, 3>(src, dst); }
@@ -1555,7 +1632,6 @@ void Convert(const QVImage<sFloat, 3> &src, QVImage<sShort, 3> &dst)	{ ConvertTy
 void Convert(const QVImage<sFloat, 3> &src, QVImage<uShort, 3> &dst)	{ ConvertType<sFloat, uShort, 3>(src, dst); }
 
 // uChar
-void Convert(const QVImage<uChar, 1> &src, QVImage<sFloat, 1> &dst)	{ ConvertType<uChar, sFloat, 1>(src, dst); }
 //void Convert(const QVImage<uChar, 1> &src, QVImage<uChar, 1> &dst)	{ ConvertType<uChar, uChar, 1>(src, dst); }
 void Convert(const QVImage<uChar, 1> &src, QVImage<sChar, 1> &dst)	{ ConvertType<uChar, sChar, 1>(src, dst); }
 void Convert(const QVImage<uChar, 1> &src, QVImage<sInt, 1> &dst)	{ ConvertType<uChar, sInt, 1>(src, dst); }
@@ -1563,7 +1639,6 @@ void Convert(const QVImage<uChar, 1> &src, QVImage<uInt, 1> &dst)	{ ConvertType<
 void Convert(const QVImage<uChar, 1> &src, QVImage<sShort, 1> &dst)	{ ConvertType<uChar, sShort, 1>(src, dst); }
 void Convert(const QVImage<uChar, 1> &src, QVImage<uShort, 1> &dst)	{ ConvertType<uChar, uShort, 1>(src, dst); }
 
-void Convert(const QVImage<uChar, 3> &src, QVImage<sFloat, 3> &dst)	{ ConvertType<uChar, sFloat, 3>(src, dst); }
 //void Convert(const QVImage<uChar, 3> &src, QVImage<uChar, 3> &dst)	{ ConvertType<uChar, uChar, 3>(src, dst); }
 void Convert(const QVImage<uChar, 3> &src, QVImage<sChar, 3> &dst)	{ ConvertType<uChar, sChar, 3>(src, dst); }
 void Convert(const QVImage<uChar, 3> &src, QVImage<sInt, 3> &dst)	{ ConvertType<uChar, sInt, 3>(src, dst); }
@@ -1689,19 +1764,329 @@ void Copy(const QVImage<sInt, 1> &src1, const QVImage<sInt, 1> &src2, const QVIm
 void Copy(const QVImage<uShort, 1> &src1, const QVImage<uShort, 1> &src2, const QVImage<uShort, 1> &src3, QVImage<uShort, 3> &dst)	{ CopyC1x3C3<uShort>(src1, src2, src3, dst); }
 void Copy(const QVImage<sShort, 1> &src1, const QVImage<sShort, 1> &src2, const QVImage<sShort, 1> &src3, QVImage<sShort, 3> &dst)	{ CopyC1x3C3<sShort>(src1, src2, src3, dst); }
 
-// Unimplemented functions.
-void Resize(const QVImage<uChar> &src, QVImage<uChar> &dest)
+// Arithmetic functions.
+#ifndef DOXYGEN_IGNORE_THIS
+template <int C> void binaryOperation8u(	const QVImage<uChar, C> &src1, const QVImage<uChar, C> &src2, QVImage<uChar, C> &dst,
+											void (*kernel)(const uChar *, const uChar *, uChar *, const int, const int),
+											const int scaleFactor, const QPoint &destROIOffset)
+	{
+	Q_ASSERT_X(src1.getROI().size() == src2.getROI().size(), "binaryOperation8u", "different ROI sizes for source images");
+	if (not composeROI(dst, src1.getROI(), destROIOffset, 0, 0))
+		return;
+
+	uChar *dstData = dst.getWriteData();
+	const int cols = dst.getROI().width(), rows = dst.getROI().height();
+	for(int row = 0; row < rows; row++)
+		kernel(roiReadRow(src1, row), roiReadRow(src2, row), roiWriteRow(dstData, dst, row), C * cols, scaleFactor);
+	}
+
+template <int C> void binaryOperation32f(	const QVImage<sFloat, C> &src1, const QVImage<sFloat, C> &src2, QVImage<sFloat, C> &dst,
+											void (*kernel)(const sFloat *, const sFloat *, sFloat *, const int),
+											const QPoint &destROIOffset)
 	{
-	std::cout << "Warning: Resize function without IPP is to be implemented soon." << std::endl;
-	dest = src;
+	Q_ASSERT_X(src1.getROI().size() == src2.getROI().size(), "binaryOperation32f", "different ROI sizes for source images");
+	if (not composeROI(dst, src1.getROI(), destROIOffset, 0, 0))
+		return;
+
+	sFloat *dstData = dst.getWriteData();
+	const int cols = dst.getROI().width(), rows = dst.getROI().height();
+	for(int row = 0; row < rows; row++)
+		kernel(roiReadRow(src1, row), roiReadRow(src2, row), roiWriteRow(dstData, dst, row), C * cols);
 	}
+#endif // DOXYGEN_IGNORE_THIS
 
-void Resize(const QVImage<uChar,3> &src, QVImage<uChar,3> &dest)
+// The IPP subtraction functions store src2 - src1, so the source images are swapped when calling the kernels.
+#define	CREATE_ARITHMETIC_NO_IPP(C)																												\
+void Add(const QVImage<uChar, C> &src1, const QVImage<uChar, C> &src2, QVImage<uChar, C> &dst, const int scaleFactor, const QPoint &destROIOffset)	\
+	{ binaryOperation8u<C>(src1, src2, dst, qvSimdAdd_8u, scaleFactor, destROIOffset); }															\
+void Sub(const QVImage<uChar, C> &src1, const QVImage<uChar, C> &src2, QVImage<uChar, C> &dst, const int scaleFactor, const QPoint &destROIOffset)	\
+	{ binaryOperation8u<C>(src2, src1, dst, qvSimdSub_8u, scaleFactor, destROIOffset); }															\
+void Mul(const QVImage<uChar, C> &src1, const QVImage<uChar, C> &src2, QVImage<uChar, C> &dst, const int scaleFactor, const QPoint &destROIOffset)	\
+	{ binaryOperation8u<C>(src1, src2, dst, qvSimdMul_8u, scaleFactor, destROIOffset); }															\
+void Add(const QVImage<sFloat, C> &src1, const QVImage<sFloat, C> &src2, QVImage<sFloat, C> &dst, const QPoint &destROIOffset)						\
+	{ binaryOperation32f<C>(src1, src2, dst, qvSimdAdd_32f, destROIOffset); }																	\
+void Sub(const QVImage<sFloat, C> &src1, const QVImage<sFloat, C> &src2, QVImage<sFloat, C> &dst, const QPoint &destROIOffset)						\
+	{ binaryOperation32f<C>(src2, src1, dst, qvSimdSub_32f, destROIOffset); }																	\
+void Mul(const QVImage<sFloat, C> &src1, const QVImage<sFloat, C> &src2, QVImage<sFloat, C> &dst, const QPoint &destROIOffset)						\
+	{ binaryOperation32f<C>(src1, src2, dst, qvSimdMul_32f, destROIOffset); }
+
+CREATE_ARITHMETIC_NO_IPP(1);
+CREATE_ARITHMETIC_NO_IPP(3);
+
+// Filtering functions. The masks are applied as two separable passes: a vertical one over the rows covered by the
+// mask, and a horizontal one over the resulting row. As in the IPP, the destination ROI is smaller than the source ROI
+// by the size of the mask minus one.
+#ifndef DOXYGEN_IGNORE_THIS
+static int maskSizeNoIPP(const IppiMaskSize mask)
 	{
-	std::cout << "Warning: Resize function without IPP is to be implemented soon." << std::endl;
-	dest = src;
+	switch(mask)
+		{
+		case ippMskSize3x3:	return 3;
+		case ippMskSize5x5:	return 5;
+		default:
+			qWarning() << "Only 3x3 and 5x5 masks are supported without the IPP. Using a 3x3 mask.";
+			return 3;
+		}
 	}
 
+static void separableFilter8u(const QVImage<uChar, 1> &src, QVImage<uChar, 1> &dst, const uShort *verticalWeights, const uShort *horizontalWeights,
+						const int size, const int shift, const QPoint &destROIOffset)
+	{
+	if (not composeROI(dst, src.getROI(), destROIOffset, size-1, size-1))
+		return;
+
+	uChar *dstData = dst.getWriteData();
+	const int cols = dst.getROI().width(), rows = dst.getROI().height();
+	QVector<uShort> buffer(cols + size - 1);
+	const uChar *srcRows[5];
+
+	for(int row = 0; row < rows; row++)
+		{
+		for(int r = 0; r < size; r++)
+			srcRows[r] = roiReadRow(src, row + r);
+		qvSimdVerticalFilter_8u16u(srcRows, verticalWeights, size, buffer.data(), cols + size - 1);
+		qvSimdHorizontalFilter_16u8u(buffer.data(), horizontalWeights, size, shift, roiWriteRow(dstData, dst, row), cols);
+		}
+	}
+
+static void separableFilter32f(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const sFloat *verticalWeights, const sFloat *horizontalWeights,
+						const int size, const QPoint &destROIOffset)
+	{
+	if (not composeROI(dst, src.getROI(), destROIOffset, size-1, size-1))
+		return;
+
+	sFloat *dstData = dst.getWriteData();
+	const int cols = dst.getROI().width(), rows = dst.getROI().height();
+	QVector<sFloat> buffer(cols + size - 1);
+	const sFloat *srcRows[5];
+
+	for(int row = 0; row < rows; row++)
+		{
+		for(int r = 0; r < size; r++)
+			srcRows[r] = roiReadRow(src, row + r);
+		qvSimdVerticalFilter_32f(srcRows, verticalWeights, size, buffer.data(), cols + size - 1);
+		qvSimdHorizontalFilter_32f(buffer.data(), horizontalWeights, size, roiWriteRow(dstData, dst, row), cols);
+		}
+	}
+#endif // DOXYGEN_IGNORE_THIS
+
+void FilterGauss(const QVImage<uChar, 1> &src, QVImage<uChar, 1> &dst, const IppiMaskSize mask, const QPoint &destROIOffset)
+	{
+	static const uShort	gauss3[3] = { 1, 2, 1 },
+						gauss5[5] = { 1, 4, 6, 4, 1 };
+
+	if (maskSizeNoIPP(mask) == 3)
+		separableFilter8u(src, dst, gauss3, gauss3, 3, 4, destROIOffset);
+	else
+		separableFilter8u(src, dst, gauss5, gauss5, 5, 8, destROIOffset);
+	}
+
+void FilterGauss(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask, const QPoint &destROIOffset)
+	{
+	static const sFloat	gauss3[3] = { 0.25, 0.5, 0.25 },
+						gauss5[5] = { 1.0/16.0, 4.0/16.0, 6.0/16.0, 4.0/16.0, 1.0/16.0 };
+
+	if (maskSizeNoIPP(mask) == 3)
+		separableFilter32f(src, dst, gauss3, gauss3, 3, destROIOffset);
+	else
+		separableFilter32f(src, dst, gauss5, gauss5, 5, destROIOffset);
+	}
+
+void FilterSobelHorizMask(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask, const QPoint &destROIOffset)
+	{
+	static const sFloat	smooth3[3] = { 1, 2, 1 }, derivative3[3] = { 1, 0, -1 },
+						smooth5[5] = { 1, 4, 6, 4, 1 }, derivative5[5] = { 1, 2, 0, -2, -1 };
+
+	if (maskSizeNoIPP(mask) == 3)
+		separableFilter32f(src, dst, derivative3, smooth3, 3, destROIOffset);
+	else
+		separableFilter32f(src, dst, derivative5, smooth5, 5, destROIOffset);
+	}
+
+void FilterSobelVertMask(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask, const QPoint &destROIOffset)
+	{
+	static const sFloat	smooth3[3] = { 1, 2, 1 }, derivative3[3] = { -1, 0, 1 },
+						smooth5[5] = { 1, 4, 6, 4, 1 }, derivative5[5] = { -1, -2, 0, 2, 1 };
+
+	if (maskSizeNoIPP(mask) == 3)
+		separableFilter32f(src, dst, smooth3, derivative3, 3, destROIOffset);
+	else
+		separableFilter32f(src, dst, smooth5, derivative5, 5, destROIOffset);
+	}
+
+// Resize functions.
+#ifndef DOXYGEN_IGNORE_THIS
+// Maps the destination coordinates to the source image, aligning the centers of the pixels. Returns, for each
+// destination coordinate, the first source coordinate and the weight of the next one, in the range [0, 1].
+static void resizeCoordinates(const int srcSize, const int dstSize, QVector<int> &indexes, QVector<sFloat> &weights)
+	{
+	indexes.resize(dstSize);
+	weights.resize(dstSize);
+
+	const double scale = double(srcSize) / double(dstSize);
+	for(int i = 0; i < dstSize; i++)
+		{
+		const double position = qBound(0.0, (i + 0.5) * scale - 0.5, double(srcSize - 1));
+		indexes[i] = qMin(int(position), srcSize - 1);
+		weights[i] = (indexes[i] == srcSize - 1)? 0.0 : position - indexes[i];
+		}
+	}
+
+// Returns true for the nearest neighbour mode. Without the IPP, the remaining modes use linear interpolation.
+static bool resizeNearestNoIPP(const int interpolation)
+	{
+	if (interpolation != IPPI_INTER_NN and interpolation != IPPI_INTER_LINEAR)
+		qWarning() << "Only nearest neighbour and linear interpolations are supported by Resize without the IPP. Using linear interpolation.";
+	return interpolation == IPPI_INTER_NN;
+	}
+
+template <typename Type, int C> void resizeNearest(const QVImage<Type, C> &src, QVImage<Type, C> &dest)
+	{
+	const int	srcCols = src.getROI().width(), srcRows = src.getROI().height(),
+				cols = dest.getROI().width(), rows = dest.getROI().height();
+
+	QVector<int> xIndexes(cols);
+	for(int col = 0; col < cols; col++)
+		xIndexes[col] = qMin(int((col + 0.5) * srcCols / cols), srcCols - 1);
+
+	Type *destData = dest.getWriteData();
+	for(int row = 0; row < rows; row++)
+		{
+		const Type *srcRow = roiReadRow(src, qMin(int((row + 0.5) * srcRows / rows), srcRows - 1));
+		Type *destRow = roiWriteRow(destData, dest, row);
+		for(int col = 0; col < cols; col++)
+			for(int c = 0; c < C; c++)
+				destRow[C*col+c] = srcRow[C*xIndexes[col]+c];
+		}
+	}
+
+// Bilinear interpolation for uChar images: the vertical pass interpolates two source rows with 8 bits of precision
+// using the pixel kernels, and the horizontal pass interpolates the resulting row with another 8 bits.
+template <int C> void resizeLinear8u(const QVImage<uChar, C> &src, QVImage<uChar, C> &dest)
+	{
+	const int	srcCols = src.getROI().width(), srcRows = src.getROI().height(),
+				cols = dest.getROI().width(), rows = dest.getROI().height();
+
+	QVector<int> xIndexes, yIndexes;
+	QVector<sFloat> xWeights, yWeights;
+	resizeCoordinates(srcCols, cols, xIndexes, xWeights);
+	resizeCoordinates(srcRows, rows, yIndexes, yWeights);
+
+	QVector<int> xFixedWeights(cols);
+	for(int col = 0; col < cols; col++)
+		xFixedWeights[col] = qRound(xWeights[col] * 256);
+
+	QVector<uShort> buffer(C * srcCols);
+	uChar *destData = dest.getWriteData();
+	for(int row = 0; row < rows; row++)
+		{
+		const int y = yIndexes[row];
+		qvSimdLerpRows_8u16u(roiReadRow(src, y), roiReadRow(src, qMin(y + 1, srcRows - 1)), qRound(yWeights[row] * 256), buffer.data(), C * srcCols);
+
+		uChar *destRow = roiWriteRow(destData, dest, row);
+		for(int col = 0; col < cols; col++)
+			{
+			const int x = C * xIndexes[col], nextX = C * qMin(xIndexes[col] + 1, srcCols - 1), weight = xFixedWeights[col];
+			for(int c = 0; c < C; c++)
+				destRow[C*col+c] = (buffer[x+c] * (256 - weight) + buffer[nextX+c] * weight + 32768) >> 16;
+			}
+		}
+	}
+
+template <typename Type> void resizeLinear(const QVImage<Type, 1> &src, QVImage<Type, 1> &dest)
+	{
+	const int	srcCols = src.getROI().width(), srcRows = src.getROI().height(),
+				cols = dest.getROI().width(), rows = dest.getROI().height();
+
+	QVector<int> xIndexes, yIndexes;
+	QVector<sFloat> xWeights, yWeights;
+	resizeCoordinates(srcCols, cols, xIndexes, xWeights);
+	resizeCoordinates(srcRows, rows, yIndexes, yWeights);
+
+	QVector<sFloat> row1(srcCols), row2(srcCols), buffer(srcCols);
+	Type *destData = dest.getWriteData();
+	for(int row = 0; row < rows; row++)
+		{
+		const int y = yIndexes[row];
+		const Type	*srcRow1 = roiReadRow(src, y), *srcRow2 = roiReadRow(src, qMin(y + 1, srcRows - 1));
+		for(int col = 0; col < srcCols; col++)
+			{
+			row1[col] = srcRow1[col];
+			row2[col] = srcRow2[col];
+			}
+		qvSimdLerpRows_32f(row1.data(), row2.data(), yWeights[row], buffer.data(), srcCols);
+
+		Type *destRow = roiWriteRow(destData, dest, row);
+		for(int col = 0; col < cols; col++)
+			{
+			const int x = xIndexes[col];
+			const sFloat value = buffer[x] * (1.0f - xWeights[col]) + buffer[qMin(x + 1, srcCols - 1)] * xWeights[col];
+			destRow[col] = std::numeric_limits<Type>::is_integer? Type(value + 0.5f) : Type(value);
+			}
+		}
+	}
+
+template <> void resizeLinear(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dest)
+	{
+	const int	srcCols = src.getROI().width(), srcRows = src.getROI().height(),
+				cols = dest.getROI().width(), rows = dest.getROI().height();
+
+	QVector<int> xIndexes, yIndexes;
+	QVector<sFloat> xWeights, yWeights;
+	resizeCoordinates(srcCols, cols, xIndexes, xWeights);
+	resizeCoordinates(srcRows, rows, yIndexes, yWeights);
+
+	QVector<sFloat> buffer(srcCols);
+	sFloat *destData = dest.getWriteData();
+	for(int row = 0; row < rows; row++)
+		{
+		const int y = yIndexes[row];
+		qvSimdLerpRows_32f(roiReadRow(src, y), roiReadRow(src, qMin(y + 1, srcRows - 1)), yWeights[row], buffer.data(), srcCols);
+
+		sFloat *destRow = roiWriteRow(destData, dest, row);
+		for(int col = 0; col < cols; col++)
+			{
+			const int x = xIndexes[col];
+			destRow[col] = buffer[x] * (1.0f - xWeights[col]) + buffer[qMin(x + 1, srcCols - 1)] * xWeights[col];
+			}
+		}
+	}
+#endif // DOXYGEN_IGNORE_THIS
+
+void Resize(const QVImage<uChar> &src, QVImage<uChar> &dest, int interpolation)
+	{
+	if (resizeNearestNoIPP(interpolation))
+		resizeNearest(src, dest);
+	else
+		resizeLinear8u(src, dest);
+	}
+
+void Resize(const QVImage<uChar, 3> &src, QVImage<uChar, 3> &dest, int interpolation)
+	{
+	if (resizeNearestNoIPP(interpolation))
+		resizeNearest(src, dest);
+	else
+		resizeLinear8u(src, dest);
+	}
+
+void Resize(const QVImage<sFloat> &src, QVImage<sFloat> &dest, int interpolation)
+	{
+	if (resizeNearestNoIPP(interpolation))
+		resizeNearest(src, dest);
+	else
+		resizeLinear(src, dest);
+	}
+
+void Resize(const QVImage<uShort> &src, QVImage<uShort> &dest, int interpolation)
+	{
+	if (resizeNearestNoIPP(interpolation))
+		resizeNearest(src, dest);
+	else
+		resizeLinear(src, dest);
+	}
+
+// Unimplemented functions.
+
 void YUV420ToRGB(const QVImage<uChar, 1> &srcY, const QVImage<uChar, 1> &srcU, const QVImage<uChar, 1> &srcV,
 	QVImage<uChar, 3> &destRGB)
 	{
@@ -204,6 +204,20 @@ template <typename Type = uChar, int Channels = 1> class QVImage: public QVGener
         uInt step_div_type_size;
         QSharedDataPointer< QVImageBuffer<Type> > imageBuffer;
 
+        // Images aliasing external memory (see QVImageBufferOwner) copy it to a buffer of their own before writing.
+        void detachExternal()
+            {
+            if (imageBuffer.constData()->isExternal())
+                imageBuffer = new QVImageBuffer<Type>(*imageBuffer.constData());
+            }
+
+        // Buffers aliased by writable views are not shared, so copies of the image get a buffer of their own.
+        void detachWritableViews()
+            {
+            if (imageBuffer.constData()->hasWritableViews())
+                imageBuffer.detach();
+            }
+
     public:
 /*        /// @brief Default constructor.
         ///
@@ -226,6 +240,16 @@ template <typename Type = uChar, int Channels = 1> class QVImage: public QVGener
             setROI(0,0, cols, rows);
             setAnchor(0,0);
             this->step_div_type_size = getStep()/sizeof(Type);
+            }
+
+		// External buffer constructor. Only for internal QVision usage. The image reads its pixels directly from
+		// 'buffer', which is kept alive by 'owner', and copies them to a buffer of its own before any write.
+        QVImage(uInt cols, uInt rows, uInt step, Type * buffer, const QSharedPointer<QVImageBufferOwner> &owner):QVGenericImage()
+            {
+            this->imageBuffer = new QVImageBuffer<Type>(Channels*cols, rows, step, buffer, owner);
+            setROI(0,0, cols, rows);
+            setAnchor(0,0);
+            this->step_div_type_size = getStep()/sizeof(Type);
             }
 		#endif
 
@@ -400,7 +424,38 @@ template <typename Type = uChar, int Channels = 1> class QVImage: public QVGener
         /// Thus can be slower than getReadData() method to access image pixels, but will ensure avoiding side
         /// effects on modifying shared buffers with other images.
         ///
-        Type * getWriteData()		{ return imageBuffer->getWriteData(); }
+        Type * getWriteData()		{ detachExternal(); return imageBuffer->getWriteData(); }
+
+        /// @brief Checks whether the data buffer of the image is shared with other QVImage objects.
+        ///
+        /// When this method returns true, the next call to @ref getWriteData(), or to the non-const pixel access
+        /// operators, will make a deep copy of the whole data buffer, regardless of the region of interest of the image.
+        ///
+        /// @returns true if other images share the data buffer of this image.
+        /// @see detach()
+        bool isShared() const		{ return imageBuffer.constData()->ref != 1 or imageBuffer.constData()->isExternal(); }
+
+        /// @brief Makes the data buffer of the image unshared.
+        ///
+        /// This method performs explicitly the copy on write operation, if the data buffer is shared with other
+        /// images. It can be used to decide where the copy of the buffer takes place, instead of having it hidden in
+        /// the first call to @ref getWriteData(). Does nothing if the buffer is not shared.
+        ///
+        /// Implicit and explicit copies are both accounted in the counter @ref QVImageBufferPool::Statistics::deepCopies.
+        /// @see isShared()
+        void detach()				{ detachExternal(); imageBuffer.detach(); }
+
+		#ifndef DOXYGEN_IGNORE_THIS
+		// Only for QVImageView. Detaches the data buffer, and keeps it unshared until the view calls
+		// removeWritableView() on the returned buffer.
+        QVImageBuffer<Type> * addWritableView()
+            {
+            detach();
+            QVImageBuffer<Type> *buffer = imageBuffer.data();
+            buffer->addWritableView();
+            return buffer;
+            }
+		#endif
 
         /// @brief Sets pixel values for an image, to a given value.
         ///
@@ -461,6 +516,7 @@ template <typename Type = uChar, int Channels = 1> class QVImage: public QVGener
             Q_ASSERT_X(idx >= 0,"QVImage::operator()","accessing below data");
             Q_ASSERT_X((uint)idx < getDataSize(),"QVImage::operator()","accessing above data");
 
+            detachExternal();
             return imageBuffer->getWriteData()[idx];
             }
 
@@ -491,6 +547,7 @@ template <typename Type = uChar, int Channels = 1> class QVImage: public QVGener
             Q_ASSERT_X(idx >= 0,"QVImage::operator()","accessing below data");
             Q_ASSERT_X((uint)idx < getDataSize(),"QVImage::operator()","accessing above data");
 
+            detachExternal();
             return imageBuffer->getWriteData()[idx];
             }
 
@@ -1039,11 +1096,20 @@ void Set(const uInt value[3], QVImage<uInt, 3> &image);
 void Set(const sShort value[3], QVImage<sShort, 3> &image);
 void Set(const uShort value[3], QVImage<uShort, 3> &image);
 
-void Copy(const QVImage<sFloat, 1> &, QVImage<sFloat, 1> &);
-void Copy(const QVImage<sInt, 1> &, QVImage<sInt, 1> &);
-void Copy(const QVImage<uInt, 1> &, QVImage<uInt, 1> &);
-void Copy(const QVImage<sShort, 1> &, QVImage<sShort, 1> &);
-void Copy(const QVImage<uShort, 1> &, QVImage<uShort, 1> &);
+// Copies the region of interest of the source image to the destination image, as the IPP wrapper does.
+void Copy(const QVImage<uChar, 1> &, QVImage<uChar, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sFloat, 1> &, QVImage<sFloat, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sInt, 1> &, QVImage<sInt, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<uInt, 1> &, QVImage<uInt, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sShort, 1> &, QVImage<sShort, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<uShort, 1> &, QVImage<uShort, 1> &, const QPoint &destROIOffset = QPoint(0,0));
+
+void Copy(const QVImage<uChar, 3> &, QVImage<uChar, 3> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sFloat, 3> &, QVImage<sFloat, 3> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sInt, 3> &, QVImage<sInt, 3> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<uInt, 3> &, QVImage<uInt, 3> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<sShort, 3> &, QVImage<sShort, 3> &, const QPoint &destROIOffset = QPoint(0,0));
+void Copy(const QVImage<uShort, 3> &, QVImage<uShort, 3> &, const QPoint &destROIOffset = QPoint(0,0));
 
 void Copy(const QVImage<sFloat, 3> &, const uChar channel, QVImage<sFloat, 1> &);
 void Copy(const QVImage<sChar, 3> &, const uChar channel, QVImage<sChar, 1> &);
@@ -1064,7 +1130,7 @@ void Copy(const QVImage<sShort, 1> &src1, const QVImage<sShort, 1> &src2, const
 // Pixel type convertions
 // sFloat
 //void Convert(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst);	
-void Convert(const QVImage<sFloat, 1> &src, QVImage<uChar, 1> &dst);	
+void Convert(const QVImage<sFloat, 1> &src, QVImage<uChar, 1> &dst, const IppRoundMode roundMode = ippRndNear);	
 void Convert(const QVImage<sFloat, 1> &src, QVImage<sChar, 1> &dst);	
 void Convert(const QVImage<sFloat, 1> &src, QVImage<sInt, 1> &dst);	
 void Convert(const QVImage<sFloat, 1> &src, QVImage<uInt, 1> &dst);	
@@ -1072,7 +1138,7 @@ void Convert(const QVImage<sFloat, 1> &src, QVImage<sShort, 1> &dst);
 void Convert(const QVImage<sFloat, 1> &src, QVImage<uShort, 1> &dst);	
 
 //void Convert(const QVImage<sFloat, 3> &src, QVImage<sFloat, 3> &dst);	
-void Convert(const QVImage<sFloat, 3> &src, QVImage<uChar, 3> &dst);	
+void Convert(const QVImage<sFloat, 3> &src, QVImage<uChar, 3> &dst, const IppRoundMode roundMode = ippRndNear);	
 void Convert(const QVImage<sFloat, 3> &src, QVImage<sChar, 3> &dst);	
 void Convert(const QVImage<sFloat, 3> &src, QVImage<sInt, 3> &dst);	
 void Convert(const QVImage<sFloat, 3> &src, QVImage<uInt, 3> &dst);	
@@ -1208,10 +1274,41 @@ void Convert(const QVImage<uInt, 1> &, QVImage<uInt, 3> &);
 void Convert(const QVImage<sShort, 1> &, QVImage<sShort, 3> &);
 void Convert(const QVImage<uShort, 1> &, QVImage<uShort, 3> &);
 
+// Arithmetic, filtering and resizing functions. They have the signatures and default parameters of the IPP wrappers,
+// and are implemented with the pixel kernels of qvip/qvsimd.h.
+// Note that, as in the IPP, Sub(src1, src2, dst) stores src2 - src1 in the destination image.
+void Add(const QVImage<uChar, 1> &src1, const QVImage<uChar, 1> &src2, QVImage<uChar, 1> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Add(const QVImage<uChar, 3> &src1, const QVImage<uChar, 3> &src2, QVImage<uChar, 3> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Add(const QVImage<sFloat, 1> &src1, const QVImage<sFloat, 1> &src2, QVImage<sFloat, 1> &dst, const QPoint &destROIOffset = QPoint(0,0));
+void Add(const QVImage<sFloat, 3> &src1, const QVImage<sFloat, 3> &src2, QVImage<sFloat, 3> &dst, const QPoint &destROIOffset = QPoint(0,0));
+
+void Sub(const QVImage<uChar, 1> &src1, const QVImage<uChar, 1> &src2, QVImage<uChar, 1> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Sub(const QVImage<uChar, 3> &src1, const QVImage<uChar, 3> &src2, QVImage<uChar, 3> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Sub(const QVImage<sFloat, 1> &src1, const QVImage<sFloat, 1> &src2, QVImage<sFloat, 1> &dst, const QPoint &destROIOffset = QPoint(0,0));
+void Sub(const QVImage<sFloat, 3> &src1, const QVImage<sFloat, 3> &src2, QVImage<sFloat, 3> &dst, const QPoint &destROIOffset = QPoint(0,0));
+
+void Mul(const QVImage<uChar, 1> &src1, const QVImage<uChar, 1> &src2, QVImage<uChar, 1> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Mul(const QVImage<uChar, 3> &src1, const QVImage<uChar, 3> &src2, QVImage<uChar, 3> &dst, const int scaleFactor = 1, const QPoint &destROIOffset = QPoint(0,0));
+void Mul(const QVImage<sFloat, 1> &src1, const QVImage<sFloat, 1> &src2, QVImage<sFloat, 1> &dst, const QPoint &destROIOffset = QPoint(0,0));
+void Mul(const QVImage<sFloat, 3> &src1, const QVImage<sFloat, 3> &src2, QVImage<sFloat, 3> &dst, const QPoint &destROIOffset = QPoint(0,0));
+
+// Only the 3x3 and 5x5 masks are supported. The 5x5 mask of the uChar version is the binomial kernel
+// [1 4 6 4 1]/16, which differs from the IPP kernel in at most one gray level.
+void FilterGauss(const QVImage<uChar, 1> &src, QVImage<uChar, 1> &dst, const IppiMaskSize mask = ippMskSize3x3, const QPoint &destROIOffset = QPoint(0,0));
+void FilterGauss(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask = ippMskSize3x3, const QPoint &destROIOffset = QPoint(0,0));
+
+void FilterSobelHorizMask(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask = ippMskSize3x3, const QPoint &destROIOffset = QPoint(0,0));
+void FilterSobelVertMask(const QVImage<sFloat, 1> &src, QVImage<sFloat, 1> &dst, const IppiMaskSize mask = ippMskSize3x3, const QPoint &destROIOffset = QPoint(0,0));
+
+// Scales the region of interest of the source image to fit the region of interest of the destination image.
+// Supports the IPPI_INTER_NN and IPPI_INTER_LINEAR modes. Other modes print a warning, and use linear interpolation.
+void Resize(const QVImage<uChar> &src, QVImage<uChar> &dest, int interpolation = IPPI_INTER_LINEAR);
+void Resize(const QVImage<sFloat> &src, QVImage<sFloat> &dest, int interpolation = IPPI_INTER_LINEAR);
+void Resize(const QVImage<uShort> &src, QVImage<uShort> &dest, int interpolation = IPPI_INTER_LINEAR);
+void Resize(const QVImage<uChar, 3> &src, QVImage<uChar, 3> &dest, int interpolation = IPPI_INTER_LINEAR);
+
 #ifndef DOXYGEN_IGNORE_THIS
 // Unimplemented functions
-void Resize(const QVImage<uChar> &src, QVImage<uChar> &dest);
-void Resize(const QVImage<uChar, 3> &src, QVImage<uChar, 3> &dest);
 void YUV420ToRGB(const QVImage<uChar, 1> &srcY, const QVImage<uChar, 1> &srcU, const QVImage<uChar, 1> &srcV, QVImage<uChar, 3> &destRGB);
 void RGBToYUV420(const QVImage<uChar, 3> &src, QVImage<uChar, 1> &dstY, QVImage<uChar, 1> &dstU, QVImage<uChar, 1> &dstV);
 #endif // DOXYGEN_IGNORE_THIS
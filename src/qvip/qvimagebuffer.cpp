@@ -33,3 +33,141 @@ uInt paddedStep(const uInt size, const uInt padding)
 
 	return step;
 	}
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QList>
+
+#ifdef Q_OS_WIN
+	#define QV_ALIGNED_MALLOC(ptr, size)	ptr = _aligned_malloc(size, QVIMAGE_BUFFER_ALIGNMENT)
+	#define QV_ALIGNED_FREE(ptr)			_aligned_free(ptr)
+#else
+	#define QV_ALIGNED_MALLOC(ptr, size)	if (posix_memalign(&ptr, QVIMAGE_BUFFER_ALIGNMENT, size) != 0) ptr = NULL
+	#define QV_ALIGNED_FREE(ptr)			free(ptr)
+#endif
+
+// Shared state of the image buffer pool. Free lists are indexed by buffer size in bytes, which is rows * step for
+// images with the same type.
+namespace
+	{
+	QMutex								qvImageBufferPoolMutex;
+	QHash<size_t, QList<void *> >		qvImageBufferPoolFreeLists;
+	QVImageBufferPool::Statistics		qvImageBufferPoolStats;
+	bool								qvImageBufferPoolEnabled = true;
+	quint64								qvImageBufferPoolMaxCachedBytes = 256 * 1024 * 1024;
+
+	void updatePeakBytes()
+		{
+		const quint64 totalBytes = qvImageBufferPoolStats.liveBytes + qvImageBufferPoolStats.cachedBytes;
+		if (totalBytes > qvImageBufferPoolStats.peakBytes)
+			qvImageBufferPoolStats.peakBytes = totalBytes;
+		}
+
+	// Must be called with the pool mutex locked.
+	void freeCachedBuffers()
+		{
+		foreach(const size_t size, qvImageBufferPoolFreeLists.keys())
+			foreach(void *data, qvImageBufferPoolFreeLists[size])
+				{
+				QV_ALIGNED_FREE(data);
+				qvImageBufferPoolStats.frees++;
+				qvImageBufferPoolStats.cachedBytes -= size;
+				}
+		qvImageBufferPoolFreeLists.clear();
+		}
+	}
+
+void * QVImageBufferPool::allocate(const size_t size)
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+
+	qvImageBufferPoolStats.requests++;
+	qvImageBufferPoolStats.liveBytes += size;
+
+	QHash<size_t, QList<void *> >::iterator freeList = qvImageBufferPoolFreeLists.find(size);
+	if (freeList != qvImageBufferPoolFreeLists.end() and not freeList.value().isEmpty())
+		{
+		qvImageBufferPoolStats.hits++;
+		qvImageBufferPoolStats.cachedBytes -= size;
+		return freeList.value().takeLast();
+		}
+
+	qvImageBufferPoolStats.misses++;
+	updatePeakBytes();
+
+	void *data = NULL;
+	QV_ALIGNED_MALLOC(data, size);
+	if (data == NULL)
+		qFatal("QVImageBufferPool::allocate(): could not allocate %lu bytes", (unsigned long) size);
+
+	return data;
+	}
+
+void QVImageBufferPool::release(void *data, const size_t size)
+	{
+	if (data == NULL)
+		return;
+
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+
+	qvImageBufferPoolStats.liveBytes -= size;
+
+	if (qvImageBufferPoolEnabled and qvImageBufferPoolStats.cachedBytes + size <= qvImageBufferPoolMaxCachedBytes)
+		{
+		qvImageBufferPoolFreeLists[size].append(data);
+		qvImageBufferPoolStats.cachedBytes += size;
+		}
+	else	{
+		QV_ALIGNED_FREE(data);
+		qvImageBufferPoolStats.frees++;
+		}
+	}
+
+void QVImageBufferPool::registerDeepCopy(const size_t size)
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	qvImageBufferPoolStats.deepCopies++;
+	qvImageBufferPoolStats.deepCopiedBytes += size;
+	}
+
+void QVImageBufferPool::clear()
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	freeCachedBuffers();
+	}
+
+void QVImageBufferPool::setEnabled(const bool enabled)
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	qvImageBufferPoolEnabled = enabled;
+	if (not enabled)
+		freeCachedBuffers();
+	}
+
+bool QVImageBufferPool::isEnabled()
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	return qvImageBufferPoolEnabled;
+	}
+
+void QVImageBufferPool::setMaxCachedBytes(const quint64 bytes)
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	qvImageBufferPoolMaxCachedBytes = bytes;
+	}
+
+QVImageBufferPool::Statistics QVImageBufferPool::getStatistics()
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	return qvImageBufferPoolStats;
+	}
+
+void QVImageBufferPool::resetStatistics()
+	{
+	QMutexLocker locker(&qvImageBufferPoolMutex);
+	qvImageBufferPoolStats.requests = qvImageBufferPoolStats.hits = qvImageBufferPoolStats.misses = qvImageBufferPoolStats.frees = 0;
+	qvImageBufferPoolStats.deepCopies = qvImageBufferPoolStats.deepCopiedBytes = 0;
+	qvImageBufferPoolStats.peakBytes = qvImageBufferPoolStats.liveBytes + qvImageBufferPoolStats.cachedBytes;
+	}
+
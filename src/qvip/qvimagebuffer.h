@@ -28,13 +28,139 @@
 #include <math.h>
 #include <QObject>
 #include <QDebug>
+#include <QAtomicInt>
 #include <QSharedData>
+#include <QSharedPointer>
 #include <qvdefines.h>
 
 //#include <stdlib.h>
 #include <malloc.h>
+#include <string.h>
+
+/// @brief Byte alignment of the pixel buffers allocated by QVImageBuffer.
+///
+/// Defaults to 32 bytes, which is the alignment required by AVX loads and stores. Can be redefined to 64 at compile
+/// time (for example, adding <i>DEFINES += QVIMAGE_BUFFER_ALIGNMENT=64</i> in the <i>config.pri</i> file).
+/// @ingroup qvip
+#ifndef QVIMAGE_BUFFER_ALIGNMENT
+#define QVIMAGE_BUFFER_ALIGNMENT	32
+#endif
+
+/*!
+@class QVImageBufferPool qvip/qvimagebuffer.h QVImageBufferPool
+@brief Recycling pool for the pixel buffers of the QVImage objects.
+
+Every QVImage stores its pixels in a buffer allocated through this pool. When the last image sharing a buffer is
+destroyed, the buffer is not returned to the system. Instead, it is kept in a free list indexed by its size in bytes
+(which depends on the number of rows and the step of the image), and it will be handed to the next image created
+with the same rows and step.
+
+Thus, a processing pipeline which creates and destroys images of the same sizes at each frame reaches a steady state
+in which no memory is allocated nor freed. Buffers are allocated with an alignment of @ref QVIMAGE_BUFFER_ALIGNMENT
+bytes, suitable for SSE and AVX kernels.
+
+The pool keeps a set of counters which can be used to check that steady state:
+
+@code
+QVImageBufferPool::resetStatistics();
+[...] // Process some frames.
+const QVImageBufferPool::Statistics stats = QVImageBufferPool::getStatistics();
+std::cout << "Hit rate: " << stats.hitRate() << ", allocations: " << stats.misses
+          << ", peak bytes: " << stats.peakBytes << std::endl;
+@endcode
+
+All the methods of this class are thread safe.
+
+@ingroup qvip
+*/
+class QVImageBufferPool
+    {
+    public:
+        /// @brief Usage counters of the buffer pool.
+        class Statistics
+            {
+            public:
+                /// @brief Number of buffers requested to the pool.
+                quint64 requests;
+                /// @brief Number of requests served with a recycled buffer.
+                quint64 hits;
+                /// @brief Number of requests which allocated a new buffer from the system.
+                quint64 misses;
+                /// @brief Number of buffers returned to the system (pool trimming, or pool disabled).
+                quint64 frees;
+                /// @brief Bytes currently used by live images.
+                quint64 liveBytes;
+                /// @brief Bytes currently kept in the free lists of the pool.
+                quint64 cachedBytes;
+                /// @brief Maximum value reached by the sum of live and cached bytes.
+                quint64 peakBytes;
+                /// @brief Number of deep copies of image buffers made by copy on write.
+                ///
+                /// These copies happen when writing to an image that shares its buffer with other images. They always
+                /// copy the whole buffer, even if the image is only modified inside its region of interest.
+                /// @see QVImage::isShared()
+                quint64 deepCopies;
+                /// @brief Number of bytes copied in the @ref deepCopies.
+                quint64 deepCopiedBytes;
+
+                Statistics(): requests(0), hits(0), misses(0), frees(0), liveBytes(0), cachedBytes(0), peakBytes(0),
+                    deepCopies(0), deepCopiedBytes(0) { }
+
+                /// @brief Ratio of requests served with a recycled buffer.
+                double hitRate() const	{ return (requests == 0)? 0.0 : double(hits) / double(requests); }
+            };
+
+        /// @brief Obtains an aligned buffer of a given size.
+        ///
+        /// @param size size of the buffer, in bytes.
+        /// @return a recycled buffer of the same size, or a new one if the free list for that size is empty.
+        static void * allocate(const size_t size);
+
+        /// @brief Returns a buffer to the pool.
+        ///
+        /// @param data buffer obtained with @ref allocate.
+        /// @param size size of the buffer, in bytes. It must be the value used to allocate it.
+        static void release(void *data, const size_t size);
+
+        #ifndef DOXYGEN_IGNORE_THIS
+        // Accounts a deep copy of an image buffer. Called from the copy constructor of QVImageBuffer, which is only
+        // used by the copy on write of the QVImage objects.
+        static void registerDeepCopy(const size_t size);
+        #endif
+
+        /// @brief Returns every cached buffer to the system.
+        static void clear();
+
+        /// @brief Enables or disables buffer recycling.
+        ///
+        /// When disabled, released buffers are freed immediately. Cached buffers are freed when disabling the pool.
+        static void setEnabled(const bool enabled);
+
+        /// @brief Returns whether buffer recycling is enabled.
+        static bool isEnabled();
+
+        /// @brief Sets the maximal amount of memory kept in the free lists.
+        ///
+        /// Buffers released while the cached bytes exceed this value are freed. Default value is 256 MB.
+        /// @param bytes maximal size of the cached buffers, in bytes.
+        static void setMaxCachedBytes(const quint64 bytes);
+
+        /// @brief Gets the usage counters of the pool.
+        static Statistics getStatistics();
+
+        /// @brief Resets the request, hit, miss, free and deep copy counters, and sets the peak bytes to the current usage.
+        static void resetStatistics();
+    };
 
 #ifndef DOXYGEN_IGNORE_THIS
+// Owner of memory which is not allocated by the pool, but aliased by image buffers (for example, a memory mapped
+// file). It is destroyed when the last of those buffers, and any other reference to it, is destroyed.
+class QVImageBufferOwner
+    {
+    public:
+        virtual ~QVImageBufferOwner()	{ }
+    };
+
 template <typename Type = uChar> class QVImageBuffer: public QSharedData
     {
     public:
@@ -44,11 +170,16 @@ template <typename Type = uChar> class QVImageBuffer: public QSharedData
         // Buffer constructor
         QVImageBuffer(uInt cols, uInt rows, uInt step, const Type * buffer = NULL);
 
-        // Copy constructor
+        // External buffer constructor. The buffer aliases memory kept alive by 'owner', which must not be modified
+        // through it, so images using it must copy it before writing (see isExternal()). Unlike the buffers
+        // allocated by the pool, it does not need to be aligned to QVIMAGE_BUFFER_ALIGNMENT.
+        QVImageBuffer(uInt cols, uInt rows, uInt step, Type * buffer, const QSharedPointer<QVImageBufferOwner> &owner);
+
+        // Copy constructor. The copy is never external.
         QVImageBuffer(const QVImageBuffer<Type> &);
 
         // Destructor
-        ~QVImageBuffer()	{ if (_data != NULL) delete _data; }
+        ~QVImageBuffer()	{ if (_data != NULL and not isExternal()) QVImageBufferPool::release(_data, allocSize()); }
 
         uInt getRows()				const	{ return rows; }
         uInt getCols()				const	{ return cols; }
@@ -56,10 +187,23 @@ template <typename Type = uChar> class QVImageBuffer: public QSharedData
         int getDataSize()			const	{ return dataSize; }
         const Type *getReadData()	const	{ return _data; }
         Type * getWriteData()		const	{ return _data; }
+        bool isExternal()			const	{ return not owner.isNull(); }
+
+        // Writable views (see QVImageView) aliasing the buffer. Images never share a buffer which has writable views,
+        // so the pixels written through the views can not be seen by copies of the image.
+        void addWritableView()				{ writableViews.ref(); }
+        void removeWritableView()			{ writableViews.deref(); }
+        bool hasWritableViews()		const	{ return writableViews.fetchAndAddAcquire(0) != 0; }
 
     private:
         const uInt cols, rows, step, dataSize;
         Type * _data;
+        const QSharedPointer<QVImageBufferOwner> owner;
+        mutable QAtomicInt writableViews;
+
+        // Size in bytes of the pooled buffer. Keeps the capacity of the former 'new Type[dataSize]' allocation.
+        size_t allocSize()			const	{ return size_t(dataSize) * sizeof(Type); }
+        Type * allocData()			const	{ return (dataSize > 0)? (Type *) QVImageBufferPool::allocate(allocSize()): NULL; }
     };
 
 // Gets the closest value to 'size' that is also:
@@ -72,10 +216,9 @@ template <typename Type>
 QVImageBuffer<Type>::QVImageBuffer(uInt cols, uInt rows, uInt stepPadding): QSharedData(),
     cols(cols), rows(rows), step( stepPadding*(uInt)ceil((double)(sizeof(Type) * cols)/stepPadding) ),
     dataSize(rows * step),
-	_data( (dataSize > 0)? new Type[dataSize]: NULL )
+	_data( allocData() )
     {
-	// Check 32-byte aligned memory allocation
-	//Q_WARNING( ((unsigned int *)_data % 16u) == 0 );
+	Q_ASSERT_X( ((quintptr)_data % QVIMAGE_BUFFER_ALIGNMENT) == 0, "QVImageBuffer::QVImageBuffer()", "unaligned buffer");
 
     Q_ASSERT_X(step % stepPadding == 0, "QVImageBuffer::QVImageBuffer()","step % stepPadding != 0");
     Q_ASSERT_X(step >= cols, "QVImageBuffer::allocData()", "0 < step < cols");
@@ -86,10 +229,9 @@ QVImageBuffer<Type>::QVImageBuffer(uInt cols, uInt rows, uInt stepPadding): QSha
 template <typename Type>
 QVImageBuffer<Type>::QVImageBuffer(uInt cols, uInt rows, uInt step, const Type *buffer): QSharedData(),
     cols(cols), rows(rows), step(step), dataSize(rows * step),
-    _data( (dataSize > 0)? new Type[dataSize]: NULL )
+    _data( allocData() )
     {
-	// Check 32-byte aligned memory allocation
-	//Q_WARNING( ((uintptr_t)_data % 16u) == 0 );
+	Q_ASSERT_X( ((quintptr)_data % QVIMAGE_BUFFER_ALIGNMENT) == 0, "QVImageBuffer::QVImageBuffer()", "unaligned buffer");
 
     if ( (buffer != NULL) and (dataSize > 0) )
         memcpy(_data,buffer, dataSize);
@@ -97,17 +239,28 @@ QVImageBuffer<Type>::QVImageBuffer(uInt cols, uInt rows, uInt step, const Type *
     Q_ASSERT_X(step >= cols, "QVImageBuffer::allocData()", "0 < step < cols");
     }
 
+// External buffer constructor
+template <typename Type>
+QVImageBuffer<Type>::QVImageBuffer(uInt cols, uInt rows, uInt step, Type *buffer,
+                                   const QSharedPointer<QVImageBufferOwner> &owner): QSharedData(),
+    cols(cols), rows(rows), step(step), dataSize(rows * step), _data(buffer), owner(owner)
+    {
+    Q_ASSERT_X(not owner.isNull(), "QVImageBuffer::QVImageBuffer()", "external buffer without owner");
+    Q_ASSERT_X(step >= cols, "QVImageBuffer::QVImageBuffer()", "0 < step < cols");
+    }
+
 // Copy constructor
 template <typename Type>
 QVImageBuffer<Type>::QVImageBuffer(const QVImageBuffer<Type> &imageBuffer): QSharedData(imageBuffer),
     cols(imageBuffer.cols), rows(imageBuffer.rows), step(imageBuffer.step), dataSize(imageBuffer.dataSize),
-    _data( (dataSize > 0)? new Type[dataSize]: NULL )
+    _data( allocData() )
     {
-	// Check 32-byte aligned memory allocation
-	//Q_WARNING( ((uintptr_t)_data % 16u) == 0 );
+	Q_ASSERT_X( ((quintptr)_data % QVIMAGE_BUFFER_ALIGNMENT) == 0, "QVImageBuffer::QVImageBuffer()", "unaligned buffer");
 
     if (dataSize > 0)
         memcpy(_data, imageBuffer.getReadData(), dataSize);
+
+    QVImageBufferPool::registerDeepCopy(dataSize);
     }
 
 #endif // DOXYGEN_IGNORE_THIS
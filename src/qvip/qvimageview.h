@@ -0,0 +1,237 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVIMAGEVIEW_H
+#define QVIMAGEVIEW_H
+
+#include <QRect>
+#include <QVImage>
+
+/*!
+@class QVImageView qvip/qvimageview.h QVImageView
+@brief Rectangular window over the pixels of a QVImage, which does not copy them.
+
+A QVImageView object aliases a rectangle of the data buffer of a parent image. Reading or writing pixels through
+the view reads or writes the pixels of the parent image directly. Creating a view never allocates nor copies pixel
+data, so it can be used to process sub-images of large frames without the overhead of creating a new image for
+them:
+
+@code
+QVImage<uChar> frame = [...];
+
+// Writable view over the top-left quarter of the frame.
+QVImageView<uChar> quarter(frame, QRect(0, 0, frame.getCols()/2, frame.getRows()/2));
+for (uInt row = 0; row < quarter.getRows(); row++)
+	for (uInt col = 0; col < quarter.getCols(); col++)
+		quarter(col, row) = 255 - quarter(col, row);
+@endcode
+
+Writable views are created from non-const images. Their constructor detaches the parent image, so if its buffer is
+shared with other images it is copied at that point. While a writable view (or a copy of it) exists, the buffer of
+the parent image is not shared: images copied from the parent get a copy of the pixels, so they do not see the
+pixels later written through the view. Read-only views are created from const images and never copy the parent buffer.
+
+The view does not hold a reference to the data buffer. The parent image must not be destroyed, resized or assigned
+while the view exists.
+
+@see QVImage::isShared()
+@see QVImage::detach()
+@ingroup qvip
+*/
+template <typename Type = uChar, int Channels = 1> class QVImageView
+    {
+    public:
+        /// @brief Creates a read-only view over a rectangle of an image.
+        ///
+        /// @param image parent image.
+        /// @param rect rectangle of the parent image to alias. It is clipped to the image bounds.
+        QVImageView(const QVImage<Type, Channels> &image, const QRect &rect):
+            rect(rect & QRect(0, 0, image.getCols(), image.getRows())), step(image.getStep()),
+            readData(image.getReadData()), writeData(NULL), buffer(NULL)
+            {
+            readData = pixelPointer(readData);
+            }
+
+        /// @brief Creates a read-only view over the region of interest of an image.
+        ///
+        /// @param image parent image.
+        QVImageView(const QVImage<Type, Channels> &image):
+            rect(image.getROI() & QRect(0, 0, image.getCols(), image.getRows())), step(image.getStep()),
+            readData(image.getReadData()), writeData(NULL), buffer(NULL)
+            {
+            readData = pixelPointer(readData);
+            }
+
+        /// @brief Creates a writable view over a rectangle of an image.
+        ///
+        /// @param image parent image. Its data buffer is detached here if shared with other images, and it is not shared
+        /// with other images until the view is destroyed.
+        /// @param rect rectangle of the parent image to alias. It is clipped to the image bounds.
+        QVImageView(QVImage<Type, Channels> &image, const QRect &rect):
+            rect(rect & QRect(0, 0, image.getCols(), image.getRows())), step(image.getStep()),
+            readData(NULL), writeData(NULL), buffer(image.addWritableView())
+            {
+            writeData = pixelPointer(buffer->getWriteData());
+            readData = writeData;
+            }
+
+        /// @brief Creates a writable view over the region of interest of an image.
+        ///
+        /// @param image parent image. Its data buffer is detached here if shared with other images, and it is not shared
+        /// with other images until the view is destroyed.
+        QVImageView(QVImage<Type, Channels> &image):
+            rect(image.getROI() & QRect(0, 0, image.getCols(), image.getRows())), step(image.getStep()),
+            readData(NULL), writeData(NULL), buffer(image.addWritableView())
+            {
+            writeData = pixelPointer(buffer->getWriteData());
+            readData = writeData;
+            }
+
+        /// @brief Copy constructor. The copy aliases the same pixels as the original view.
+        QVImageView(const QVImageView<Type, Channels> &view):
+            rect(view.rect), step(view.step), readData(view.readData), writeData(view.writeData), buffer(view.buffer)
+            {
+            if (buffer != NULL)
+                buffer->addWritableView();
+            }
+
+        ~QVImageView()
+            {
+            if (buffer != NULL)
+                buffer->removeWritableView();
+            }
+
+        /// @brief Copy operator. The view aliases the same pixels as the other view.
+        QVImageView<Type, Channels> & operator=(const QVImageView<Type, Channels> &view)
+            {
+            if (view.buffer != NULL)
+                view.buffer->addWritableView();
+            if (buffer != NULL)
+                buffer->removeWritableView();
+
+            rect = view.rect;
+            step = view.step;
+            readData = view.readData;
+            writeData = view.writeData;
+            buffer = view.buffer;
+            return *this;
+            }
+
+        /// @brief Creates a view over a rectangle of this view.
+        ///
+        /// @param rect rectangle of this view, in view coordinates. It is clipped to the view bounds.
+        QVImageView<Type, Channels> subView(const QRect &rect) const
+            {
+            QVImageView<Type, Channels> result(*this);
+            result.rect = (rect & QRect(0, 0, getCols(), getRows())).translated(this->rect.topLeft());
+            const int offset = (result.rect.y() - this->rect.y()) * (step / sizeof(Type)) + Channels * (result.rect.x() - this->rect.x());
+            result.readData = readData + offset;
+            result.writeData = (writeData == NULL)? NULL : writeData + offset;
+            return result;
+            }
+
+        /// @brief Number of columns of the view.
+        uInt getCols()				const	{ return rect.width(); }
+
+        /// @brief Number of rows of the view.
+        uInt getRows()				const	{ return rect.height(); }
+
+        /// @brief Number of channels of the view.
+        uInt getChannels()			const	{ return Channels; }
+
+        /// @brief Distance in bytes between the starts of consecutive lines. It is the step of the parent image.
+        uInt getStep()				const	{ return step; }
+
+        /// @brief Rectangle of the parent image aliased by the view.
+        const QRect & getRect()		const	{ return rect; }
+
+        /// @brief Returns whether pixels can be written through the view.
+        bool isWritable()			const	{ return writeData != NULL; }
+
+        /// @brief Pointer to the top-left pixel of the view, in read mode.
+        const Type * getReadData()	const	{ return readData; }
+
+        /// @brief Pointer to the top-left pixel of the view, in read/write mode.
+        ///
+        /// Must only be used with writable views. Unlike @ref QVImage::getWriteData(), it never copies data.
+        Type * getWriteData()		const
+            {
+            Q_ASSERT_X(writeData != NULL, "QVImageView::getWriteData()", "view is read-only");
+            return writeData;
+            }
+
+        /// @brief Access to a pixel channel of the view, in read/write mode.
+        ///
+        /// @param col column of the pixel, relative to the view.
+        /// @param row row of the pixel, relative to the view.
+        /// @param channel channel of the pixel.
+        inline Type &operator()(const uInt col, const uInt row, const uInt channel = 0) const
+            {
+            Q_ASSERT_X(writeData != NULL, "QVImageView::operator()", "view is read-only");
+            Q_ASSERT_X(col < getCols(), "QVImageView::operator()", "col beyond upper bound");
+            Q_ASSERT_X(row < getRows(), "QVImageView::operator()", "row beyond upper bound");
+            return writeData[(step / sizeof(Type)) * row + Channels * col + channel];
+            }
+
+        /// @brief Read a pixel channel of the view.
+        ///
+        /// @param col column of the pixel, relative to the view.
+        /// @param row row of the pixel, relative to the view.
+        /// @param channel channel of the pixel.
+        inline Type pixel(const uInt col, const uInt row, const uInt channel = 0) const
+            {
+            Q_ASSERT_X(col < getCols(), "QVImageView::pixel()", "col beyond upper bound");
+            Q_ASSERT_X(row < getRows(), "QVImageView::pixel()", "row beyond upper bound");
+            return readData[(step / sizeof(Type)) * row + Channels * col + channel];
+            }
+
+        /// @brief Creates a new image containing a copy of the pixels of the view.
+        ///
+        /// This is the only method of the class which copies pixel data.
+        QVImage<Type, Channels> toImage() const
+            {
+            QVImage<Type, Channels> result(getCols(), getRows());
+            Type *destination = result.getWriteData();
+            const uInt destinationStep = result.getStep() / sizeof(Type), sourceStep = step / sizeof(Type);
+
+            for (uInt row = 0; row < getRows(); row++)
+                memcpy(destination + row * destinationStep, readData + row * sourceStep, Channels * getCols() * sizeof(Type));
+
+            return result;
+            }
+
+    private:
+        QRect rect;
+        uInt step;
+        const Type *readData;
+        Type *writeData;
+        QVImageBuffer<Type> *buffer;	// Buffer of the parent image, for writable views.
+
+        template <typename PointerType> PointerType * pixelPointer(PointerType *data) const
+            {
+            return (data == NULL or rect.isEmpty())? data : data + rect.y() * (step / sizeof(Type)) + Channels * rect.x();
+            }
+    };
+
+#endif // QVIMAGEVIEW_H
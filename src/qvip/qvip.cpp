@@ -35,7 +35,7 @@
 #include <QVPolylineF>
 #include <QList>
 
-#include<qvip/fast-C-src-2.1/fast.h>
+#include <QVFASTDetector>
 
 #ifdef QVIPP
 #include <qvipp.h>
@@ -554,38 +554,9 @@ QMap<sFloat, QPointF>  maximalPoints(const QVImage<sFloat> &cornerResponseImage,
 
 QList<QPointF> FASTFeatures(const QVImage<uChar, 1> & image, const int threshold, const FASTDetectionAlgorithm &fastAlgorithm)
 	{
-	// Convert QVImage to CVD Image
-	const int	cols = image.getCols(),
-				rows = image.getRows(),
-				step = image.getStep();
-	const byte *imgData = image.getReadData();
-
-	int num_corners;
-	xy *points;
-
-	switch(fastAlgorithm)
-		{
-		case Fast9:
-			points = fast9_detect_nonmax(imgData, cols, rows, step, threshold, &num_corners);
-			break;
-		case Fast10:
-			points = fast10_detect_nonmax(imgData, cols, rows, step, threshold, &num_corners);
-			break;
-		case Fast11:
-			points = fast11_detect_nonmax(imgData, cols, rows, step, threshold, &num_corners);
-			break;
-		case Fast12:
-			points = fast12_detect_nonmax(imgData, cols, rows, step, threshold, &num_corners);
-			break;
-		}
-
-	QList<QPointF> result;
-	for (int i = 0; i < num_corners; i++)
-		result << QPointF(points[i].x, points[i].y);
-
-	free(points);
-
-	return result;
+	QVFASTDetector fastDetector(threshold, fastAlgorithm);
+	fastDetector.detect(image);
+	return fastDetector.getFeatures();
 	}
 
 
@@ -314,7 +314,9 @@ enum FASTDetectionAlgorithm {
 
 /*!
 @brief Obtains FAST features on an image-
-@note This function is a wrapper function for Edward Rosten's <a href="http://www.edwardrosten.com/work/fast.html">FAST detector implementation</a>.
+@note This function obtains the same features as Edward Rosten's <a href="http://www.edwardrosten.com/work/fast.html">FAST detector implementation</a>,
+using a @ref QVFASTDetector object. Programs detecting features on a sequence of images should use that class directly,
+to reuse its buffers between the images.
 
 @param image Input image.
 @param threshold Threshold value for the FAST algorithm.
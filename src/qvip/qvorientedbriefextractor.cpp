@@ -0,0 +1,301 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <math.h>
+#include <string.h>
+
+#include <QThread>
+
+#include <qvmath.h>
+#include <qvmath/qvparallelranges.h>
+#include <qvip/qvorientedbriefextractor.h>
+
+#ifdef QVIPP
+#include <qvipp.h>
+#endif
+
+// Minimal number of keypoints described by each thread.
+#define	EXTRACTOR_MIN_KEYPOINTS_PER_THREAD	64
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Describes a range of keypoints.
+class ExtractorRangeTask
+	{
+	public:
+		ExtractorRangeTask(QVOrientedBRIEFExtractor &extractor, const QVector<QVKeypoint> &keypoints):
+			extractor(extractor), keypoints(keypoints)	{ }
+
+		void operator()(const int range, const int first, const int last)
+			{
+			Q_UNUSED(range);
+			extractor.extractRange(keypoints, first, last);
+			}
+
+	private:
+		QVOrientedBRIEFExtractor &extractor;
+		const QVector<QVKeypoint> &keypoints;
+	};
+#endif // DOXYGEN_IGNORE_THIS
+
+QVOrientedBRIEFExtractor::QVOrientedBRIEFExtractor(const unsigned int descriptorInts, const unsigned int windowRadius, const int numLevels,
+	const double scaleFactor, const int orientationBins):
+	pattern(descriptorInts, windowRadius), orientationBins(orientationBins), orientation(true), numThreads(0), builtLevels(0)
+	{
+	if (numLevels <= 0)
+		qFatal("QVOrientedBRIEFExtractor: the number of levels of the pyramid must be positive.");
+	if (scaleFactor <= 1.0)
+		qFatal("QVOrientedBRIEFExtractor: the scale factor of the pyramid must be greater than one.");
+	if (orientationBins <= 0)
+		qFatal("QVOrientedBRIEFExtractor: the number of orientation bins must be positive.");
+
+	levelScales.resize(numLevels);
+	for(int l = 0; l < numLevels; l++)
+		levelScales[l] = pow(scaleFactor, l);
+
+	levelImages.resize(numLevels);
+	smoothedImages.resize(numLevels);
+	levelOffsets.resize(numLevels);
+	levelSteps.fill(-1, numLevels);
+
+	// Rotate the test pattern for each orientation bin. The rotated coordinates are rounded to the nearest pixel, so
+	// they lie at most one pixel outside the testing window.
+	const int numTests = pattern.getNumTests();
+	rotatedCoordinates.resize(orientationBins * numTests * 4);
+	for(int bin = 0; bin < orientationBins; bin++)
+		{
+		const double	angle = 2.0 * PI * bin / orientationBins,
+						c = cos(angle), s = sin(angle);
+		int *rotated = rotatedCoordinates.data() + bin * numTests * 4;
+		for(int i = 0; i < numTests * 4; i += 2)
+			{
+			const double	x = pattern.coordinates[i+0],
+							y = pattern.coordinates[i+1];
+			rotated[i+0] = qRound(c * x - s * y);
+			rotated[i+1] = qRound(s * x + c * y);
+			}
+		}
+
+	const int radius = windowRadius;
+	patchHalfWidths.resize(2 * radius + 1);
+	for(int dy = -radius; dy <= radius; dy++)
+		patchHalfWidths[dy + radius] = int(floor(sqrt(double(radius * radius - dy * dy))));
+	}
+
+void QVOrientedBRIEFExtractor::setImage(const QVImage<uChar, 1> &image)
+	{
+	const int	cols = image.getCols(),
+				rows = image.getRows(),
+				minSize = 2 * margin() + 1;
+
+	builtLevels = 0;
+	for(int l = 0; l < levelScales.size(); l++)
+		{
+		const int	levelCols = qRound(cols / levelScales[l]),
+					levelRows = qRound(rows / levelScales[l]);
+
+		if (levelCols < minSize or levelRows < minSize)
+			break;
+
+		// The first level shares the data of the input image. The images of the other levels are only reallocated
+		// when the size of the input images changes.
+		if (l == 0)
+			{
+			levelImages[0] = image;
+			levelImages[0].resetROI();
+			}
+		else
+			{
+			if (levelImages[l].getCols() != levelCols or levelImages[l].getRows() != levelRows)
+				levelImages[l] = QVImage<uChar, 1>(levelCols, levelRows);
+			Resize(levelImages[l-1], levelImages[l], IPPI_INTER_LINEAR);
+			}
+
+		// The binary tests are evaluated on the smoothed image. Its two pixel border is not filtered, but it lies
+		// outside the margin required to describe a keypoint.
+		FilterGauss(levelImages[l], smoothedImages[l], ippMskSize5x5, QPoint(2,2));
+		builtLevels++;
+		}
+	}
+
+QVector<QVKeypoint> QVOrientedBRIEFExtractor::detect(QVFASTDetector &fastDetector) const
+	{
+	const int border = margin();
+
+	QVector<QVKeypoint> keypoints;
+	for(int l = 0; l < builtLevels; l++)
+		{
+		const QVImage<uChar, 1> &level = levelImages[l];
+		const double scale = levelScales[l];
+		const int	numFeatures = fastDetector.detect(level),
+					cols = level.getCols(),
+					rows = level.getRows();
+
+		const QVector<int>	&featuresX = fastDetector.getFeaturesX(),
+							&featuresY = fastDetector.getFeaturesY();
+
+		for(int i = 0; i < numFeatures; i++)
+			{
+			const int x = featuresX[i], y = featuresY[i];
+			if (x >= border and y >= border and x < cols - border and y < rows - border)
+				keypoints << QVKeypoint(x * scale, y * scale, scale);
+			}
+		}
+
+	return keypoints;
+	}
+
+int QVOrientedBRIEFExtractor::levelForScale(const double scale) const
+	{
+	if (scale <= 0.0)
+		return 0;
+
+	int best = 0;
+	double bestDistance = fabs(log(scale / levelScales[0]));
+	for(int l = 1; l < builtLevels; l++)
+		{
+		const double distance = fabs(log(scale / levelScales[l]));
+		if (distance < bestDistance)
+			{
+			best = l;
+			bestDistance = distance;
+			}
+		}
+	return best;
+	}
+
+void QVOrientedBRIEFExtractor::updateOffsets()
+	{
+	const int numTests = pattern.getNumTests();
+	for(int l = 0; l < builtLevels; l++)
+		{
+		const int step = smoothedImages[l].getStep();
+		if (levelSteps[l] == step)
+			continue;
+
+		// Offsets of the two pixels of each test, relative to the pixel of the keypoint.
+		QVector<int> &offsets = levelOffsets[l];
+		offsets.resize(orientationBins * numTests * 2);
+		for(int i = 0; i < orientationBins * numTests * 2; i++)
+			offsets[i] = rotatedCoordinates[2*i+1] * step + rotatedCoordinates[2*i+0];
+		levelSteps[l] = step;
+		}
+	}
+
+int QVOrientedBRIEFExtractor::extract(const QVector<QVKeypoint> &keypoints)
+	{
+	const int	numKeypoints = keypoints.size(),
+				maxThreads = (numThreads > 0)? numThreads: QThread::idealThreadCount(),
+				ranges = MAX(1, MIN(maxThreads, numKeypoints / EXTRACTOR_MIN_KEYPOINTS_PER_THREAD));
+
+	updateOffsets();
+
+	descriptors.resize(numKeypoints * pattern.getDescriptorInts());
+	orientations.resize(numKeypoints);
+	valid.resize(numKeypoints);
+
+	ExtractorRangeTask task(*this, keypoints);
+	qvParallelRanges(task, numKeypoints, ranges);
+
+	int described = 0;
+	for(int k = 0; k < numKeypoints; k++)
+		if (valid[k])
+			described++;
+
+	return described;
+	}
+
+void QVOrientedBRIEFExtractor::extractRange(const QVector<QVKeypoint> &keypoints, const int first, const int last)
+	{
+	const int	descriptorInts = pattern.getDescriptorInts(),
+				numTests = pattern.getNumTests(),
+				radius = pattern.getWindowRadius(),
+				border = margin();
+
+	for(int k = first; k < last; k++)
+		{
+		unsigned int *descriptor = descriptors.data() + k * descriptorInts;
+		orientations[k] = 0.0;
+		valid[k] = false;
+
+		if (builtLevels == 0)
+			{
+			memset(descriptor, 0, descriptorInts * sizeof(unsigned int));
+			continue;
+			}
+
+		const int l = levelForScale(keypoints[k].scale());
+		const double scale = levelScales[l];
+		const int	x = qRound(keypoints[k].x() / scale),
+					y = qRound(keypoints[k].y() / scale);
+
+		if (x < border or y < border or x >= levelImages[l].getCols() - border or y >= levelImages[l].getRows() - border)
+			{
+			memset(descriptor, 0, descriptorInts * sizeof(unsigned int));
+			continue;
+			}
+
+		const int step = smoothedImages[l].getStep();
+		const uChar *center = smoothedImages[l].getReadData() + y * step + x;
+
+		// Orientation of the keypoint, given by the intensity centroid of a circular patch.
+		int bin = 0;
+		if (orientation)
+			{
+			int m10 = 0, m01 = 0;
+			for(int dy = -radius; dy <= radius; dy++)
+				{
+				const uChar *row = center + dy * step;
+				const int halfWidth = patchHalfWidths[dy + radius];
+				int rowSum = 0, rowMoment = 0;
+				for(int dx = -halfWidth; dx <= halfWidth; dx++)
+					{
+					rowSum += row[dx];
+					rowMoment += dx * row[dx];
+					}
+				m10 += rowMoment;
+				m01 += dy * rowSum;
+				}
+
+			const double angle = atan2(double(m01), double(m10));
+			orientations[k] = angle;
+			bin = qRound(angle * orientationBins / (2.0 * PI)) % orientationBins;
+			if (bin < 0)
+				bin += orientationBins;
+			}
+
+		// Binary tests, with the same bit order used by QVBRIEFDetector.
+		const int *offsets = levelOffsets[l].constData() + bin * numTests * 2;
+		for(int b = 0; b < descriptorInts; b++)
+			{
+			unsigned int binaryDescriptor = 0;
+			for(int i = 0; i < 32; i++, offsets += 2)
+				{
+				binaryDescriptor <<= 1;
+				binaryDescriptor |= center[offsets[0]] > center[offsets[1]];
+				}
+			descriptor[b] = binaryDescriptor;
+			}
+		valid[k] = true;
+		}
+	}
@@ -0,0 +1,181 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVORIENTEDBRIEFEXTRACTOR_H
+#define QVORIENTEDBRIEFEXTRACTOR_H
+
+#include <QVector>
+#include <QPointF>
+
+#include <QVImage>
+#include <QVKeypoint>
+#include <QVBRIEFDetector>
+#include <QVFASTDetector>
+
+/*!
+@class QVOrientedBRIEFExtractor qvip/qvorientedbriefextractor.h QVOrientedBRIEFExtractor
+@brief Rotation and scale invariant BRIEF descriptors, evaluated over an image pyramid.
+
+This class extracts binary descriptors similar to those of the ORB detector (see [<a href="#rublee">Rublee</a>]), using
+the random test pattern of a @ref QVBRIEFDetector object:
+
+- For each input image, a pyramid is built once with @ref setImage. Each level is obtained by resizing the previous one
+by a constant scale factor, and is smoothed with a 5x5 Gaussian mask before the binary tests are evaluated on it.
+- The orientation of each keypoint is the direction of the intensity centroid of a circular patch around it.
+- The test pattern is rotated at construction for a fixed number of quantized orientations. The descriptor of a
+keypoint is evaluated with the pattern of the orientation closest to its own, so no coordinates are rotated per keypoint.
+The pixel offsets of the rotated patterns are computed once for each pyramid level, and only updated when the size
+of the input images changes.
+- The keypoints are split between the threads of the global thread pool, and the descriptors are stored in a contiguous
+array, with the same format used by @ref QVBRIEFDetector::getDescriptors and @ref QVBinaryDescriptorMatcher.
+
+The keypoints can be detected on every level of the pyramid with @ref detect. The following code shows an example usage:
+
+@code
+QVOrientedBRIEFExtractor extractor(8, 15, 4, 1.2);
+QVFASTDetector fastDetector(20);
+fastDetector.setGridSelection(32, 2);
+
+QVBinaryDescriptorMatcher matcher(extractor.getDescriptorInts());
+while(...)
+	{
+	extractor.setImage(image);
+	QVector<QVKeypoint> keypoints = extractor.detect(fastDetector);
+	extractor.extract(keypoints);
+
+	// Match the descriptors of the current frame with those of the previous frame.
+	matcher.match(extractor.getDescriptors());
+	matcher.setDatabase(extractor.getDescriptors());
+	...
+	}
+@endcode
+
+@section References
+<ul>
+<li><a name="rublee"><i>ORB: an efficient alternative to SIFT or SURF</i></a>. E. Rublee, V. Rabaud, K. Konolige and G. Bradski.</li>
+</ul>
+@ingroup qvip
+*/
+class QVOrientedBRIEFExtractor
+	{
+	public:
+		/// @brief Constructs an extractor.
+		/// @param descriptorInts Size of the descriptor. Each element of the descriptor is an integer containing 32 bit tests.
+		/// @param windowRadius Max radius for the testing window around the keypoints, also used for the orientation patch.
+		/// @param numLevels Number of levels of the pyramid.
+		/// @param scaleFactor Ratio between the size of consecutive levels of the pyramid.
+		/// @param orientationBins Number of quantized orientations of the test pattern.
+		QVOrientedBRIEFExtractor(const unsigned int descriptorInts = 8, const unsigned int windowRadius = 15, const int numLevels = 4,
+			const double scaleFactor = 1.2, const int orientationBins = 30);
+
+		/// @brief Returns the number of integers in each descriptor.
+		int getDescriptorInts() const					{ return pattern.getDescriptorInts(); }
+
+		/// @brief Enables or disables the evaluation of the orientation of the keypoints.
+		///
+		/// If disabled, the descriptors are evaluated with the unrotated test pattern, and the orientation of every keypoint is zero.
+		void setOrientation(const bool value)			{ orientation = value; }
+
+		/// @brief Sets the maximal number of threads used by @ref extract.
+		/// @param value number of threads. A value of zero uses QThread::idealThreadCount().
+		void setNumThreads(const int value)				{ numThreads = value; }
+
+		/// @brief Builds the pyramid for an input image.
+		///
+		/// The region of interest of the image is ignored.
+		void setImage(const QVImage<uChar, 1> &image);
+
+		/// @brief Returns the number of levels of the pyramid built for the last image.
+		///
+		/// Levels too small to contain the testing window of a keypoint are not built, so this number can be lower than the
+		/// number of levels given at construction.
+		int getNumLevels() const						{ return builtLevels; }
+
+		/// @brief Returns the scale of a level of the pyramid, relative to the input image.
+		double getLevelScale(const int level) const		{ return levelScales[level]; }
+
+		/// @brief Returns the image of a level of the pyramid, before smoothing.
+		const QVImage<uChar, 1> & getLevelImage(const int level) const	{ return levelImages[level]; }
+
+		/// @brief Detects keypoints on every level of the pyramid.
+		///
+		/// The detector is applied to the image of each level. Keypoints too close to the border of their level to be
+		/// described are discarded. The location of the keypoints is given in coordinates of the input image, and their
+		/// scale is that of the level where they were detected.
+		/// @param fastDetector detector used on each level.
+		/// @return keypoints detected.
+		QVector<QVKeypoint> detect(QVFASTDetector &fastDetector) const;
+
+		/// @brief Evaluates the orientation and the descriptor for a set of keypoints.
+		///
+		/// Each keypoint is described at the level of the pyramid whose scale is closest to the scale of the keypoint.
+		/// A keypoint with a scale of zero is described at the first level.
+		/// @param keypoints keypoints, with their location in coordinates of the input image.
+		/// @return number of keypoints described. The rest were too close to the border of their level.
+		int extract(const QVector<QVKeypoint> &keypoints);
+
+		/// @brief Descriptors of the keypoints given to the last call to @ref extract.
+		///
+		/// The descriptor of the keypoints which could not be described contains zeros.
+		const QVector<unsigned int> & getDescriptors() const	{ return descriptors; }
+
+		/// @brief Orientation in radians of the keypoints given to the last call to @ref extract.
+		const QVector<double> & getOrientations() const	{ return orientations; }
+
+		/// @brief Indicates which keypoints given to the last call to @ref extract were described.
+		const QVector<bool> & getValid() const			{ return valid; }
+
+	#ifndef DOXYGEN_IGNORE_THIS
+		void extractRange(const QVector<QVKeypoint> &keypoints, const int first, const int last);
+	#endif // DOXYGEN_IGNORE_THIS
+
+	private:
+		void updateOffsets();
+		int levelForScale(const double scale) const;
+		int margin() const								{ return int(pattern.getWindowRadius()) + 3; }
+
+		const QVBRIEFDetector pattern;
+		const int orientationBins;
+		bool orientation;
+		int numThreads;
+
+		// Pyramid.
+		int builtLevels;
+		QVector<double> levelScales;
+		QVector< QVImage<uChar, 1> > levelImages, smoothedImages;
+
+		// Rotated test coordinates for each orientation bin, and their pixel offsets for each level of the pyramid.
+		QVector<int> rotatedCoordinates;
+		QVector< QVector<int> > levelOffsets;
+		QVector<int> levelSteps;
+
+		// Half width of each row of the circular patch used to evaluate the orientation.
+		QVector<int> patchHalfWidths;
+
+		QVector<unsigned int> descriptors;
+		QVector<double> orientations;
+		QVector<bool> valid;
+	};
+
+#endif // QVORIENTEDBRIEFEXTRACTOR_H
@@ -0,0 +1,732 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <math.h>
+#include <string.h>
+#include <QAtomicInt>
+
+#include <qvip/qvsimd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar kernels. They are the reference for the SIMD ones, and process the
+// remaining elements at the end of each row.
+
+// Divides by 2^scaleFactor rounding half to even, and saturates to [0, 255]. Negative values saturate to zero.
+static inline uChar scaleSaturate8u(int value, const int scaleFactor)
+	{
+	if (value <= 0)
+		return 0;
+
+	if (scaleFactor > 0)
+		{
+		const int	half = 1 << (scaleFactor - 1),
+					remainder = value & ((1 << scaleFactor) - 1);
+		value >>= scaleFactor;
+		if (remainder > half or (remainder == half and (value & 1)))
+			value++;
+		}
+	else if (scaleFactor < 0)
+		value = (-scaleFactor >= 8)? 256 : value << (-scaleFactor);
+
+	return (value > 255)? 255 : value;
+	}
+
+static inline uChar saturate8u(const sFloat value, const bool roundNear)
+	{
+	if (not (value > 0.0f))
+		return 0;
+	if (value >= 255.0f)
+		return 255;
+	return roundNear? (uChar) lrintf(value) : (uChar) value;
+	}
+
+static void add8uScalar(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = scaleSaturate8u(int(src1[i]) + int(src2[i]), scaleFactor);
+	}
+
+static void sub8uScalar(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = scaleSaturate8u(int(src1[i]) - int(src2[i]), scaleFactor);
+	}
+
+static void mul8uScalar(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = scaleSaturate8u(int(src1[i]) * int(src2[i]), scaleFactor);
+	}
+
+static void add32fScalar(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = src1[i] + src2[i];
+	}
+
+static void sub32fScalar(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = src1[i] - src2[i];
+	}
+
+static void mul32fScalar(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = src1[i] * src2[i];
+	}
+
+static void set8uScalar(const uChar value, uChar *dst, const int count)
+	{
+	memset(dst, value, count);
+	}
+
+static void set32fScalar(const sFloat value, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = value;
+	}
+
+static void convert8u32fScalar(const uChar *src, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = src[i];
+	}
+
+static void convert32f8uScalar(const sFloat *src, uChar *dst, const int count, const bool roundNear)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = saturate8u(src[i], roundNear);
+	}
+
+static void verticalFilter8u16uScalar(const uChar * const *rows, const uShort *weights, const int nRows, uShort *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		{
+		uShort accum = 0;
+		for (int r = 0; r < nRows; r++)
+			accum += weights[r] * rows[r][i];
+		dst[i] = accum;
+		}
+	}
+
+static void horizontalFilter16u8uScalar(const uShort *src, const uShort *weights, const int size, const int shift, uChar *dst, const int count)
+	{
+	const int rounding = (shift > 0)? 1 << (shift - 1) : 0;
+	for (int i = 0; i < count; i++)
+		{
+		uShort accum = rounding;
+		for (int k = 0; k < size; k++)
+			accum += weights[k] * src[i+k];
+		accum >>= shift;
+		dst[i] = (accum > 255)? 255 : accum;
+		}
+	}
+
+static void verticalFilter32fScalar(const sFloat * const *rows, const sFloat *weights, const int nRows, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		{
+		sFloat accum = weights[0] * rows[0][i];
+		for (int r = 1; r < nRows; r++)
+			accum += weights[r] * rows[r][i];
+		dst[i] = accum;
+		}
+	}
+
+static void horizontalFilter32fScalar(const sFloat *src, const sFloat *weights, const int size, sFloat *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		{
+		sFloat accum = weights[0] * src[i];
+		for (int k = 1; k < size; k++)
+			accum += weights[k] * src[i+k];
+		dst[i] = accum;
+		}
+	}
+
+static void lerpRows8u16uScalar(const uChar *src1, const uChar *src2, const int weight, uShort *dst, const int count)
+	{
+	for (int i = 0; i < count; i++)
+		dst[i] = src1[i] * (256 - weight) + src2[i] * weight;
+	}
+
+static void lerpRows32fScalar(const sFloat *src1, const sFloat *src2, const sFloat weight, sFloat *dst, const int count)
+	{
+	const sFloat weight1 = 1.0f - weight;
+	for (int i = 0; i < count; i++)
+		dst[i] = src1[i] * weight1 + src2[i] * weight;
+	}
+
+#ifdef QVSIMD_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels
+
+// 16-bit lanes version of scaleSaturate8u. Input lanes hold unsigned values.
+QVSIMD_TARGET_SSE2 static inline __m128i scaleSaturate8uSSE2(__m128i value, const int scaleFactor)
+	{
+	if (scaleFactor > 0)
+		{
+		const __m128i	one = _mm_set1_epi16(1),
+						half = _mm_set1_epi16(1 << (scaleFactor - 1)),
+						remainder = _mm_and_si128(value, _mm_set1_epi16((1 << scaleFactor) - 1));
+		value = _mm_srli_epi16(value, scaleFactor);
+		const __m128i roundUp = _mm_or_si128(	_mm_cmpgt_epi16(remainder, half),
+												_mm_and_si128(_mm_cmpeq_epi16(remainder, half), _mm_cmpeq_epi16(_mm_and_si128(value, one), one)) );
+		value = _mm_add_epi16(value, _mm_and_si128(roundUp, one));
+		}
+
+	// Values above 255 are set to 255, so the signed pack below does not wrap around.
+	const __m128i fits = _mm_cmpeq_epi16(_mm_srli_epi16(value, 8), _mm_setzero_si128());
+	return _mm_or_si128(_mm_and_si128(fits, value), _mm_andnot_si128(fits, _mm_set1_epi16(255)));
+	}
+
+// Applies a 16-bit operation to 16 pixels, and packs the scaled result.
+#define QVSIMD_ARITHMETIC_8U_SSE2(NAME, OPERATION, FALLBACK)																		\
+QVSIMD_TARGET_SSE2 static void NAME(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)	\
+	{																														\
+	if (scaleFactor < 0 or scaleFactor > 15)																				\
+		{																													\
+		FALLBACK(src1, src2, dst, count, scaleFactor);																\
+		return;																												\
+		}																													\
+	const __m128i zero = _mm_setzero_si128();																				\
+	int i = 0;																												\
+	for (; i + 16 <= count; i += 16)																						\
+		{																													\
+		const __m128i	a = _mm_loadu_si128((const __m128i *) (src1 + i)),													\
+						b = _mm_loadu_si128((const __m128i *) (src2 + i)),													\
+						aLo = _mm_unpacklo_epi8(a, zero), aHi = _mm_unpackhi_epi8(a, zero),									\
+						bLo = _mm_unpacklo_epi8(b, zero), bHi = _mm_unpackhi_epi8(b, zero);									\
+		const __m128i	lo = scaleSaturate8uSSE2(OPERATION(aLo, bLo), scaleFactor),											\
+						hi = scaleSaturate8uSSE2(OPERATION(aHi, bHi), scaleFactor);											\
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));												\
+		}																													\
+	FALLBACK(src1 + i, src2 + i, dst + i, count - i, scaleFactor);													\
+	}
+
+QVSIMD_ARITHMETIC_8U_SSE2(add8uSSE2, _mm_add_epi16, add8uScalar)
+QVSIMD_ARITHMETIC_8U_SSE2(sub8uSSE2, _mm_subs_epu16, sub8uScalar)
+QVSIMD_ARITHMETIC_8U_SSE2(mul8uSSE2, _mm_mullo_epi16, mul8uScalar)
+
+#define QVSIMD_ARITHMETIC_32F_SSE2(NAME, OPERATION, FALLBACK)										\
+QVSIMD_TARGET_SSE2 static void NAME(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)	\
+	{																								\
+	int i = 0;																						\
+	for (; i + 4 <= count; i += 4)																	\
+		_mm_storeu_ps(dst + i, OPERATION(_mm_loadu_ps(src1 + i), _mm_loadu_ps(src2 + i)));			\
+	FALLBACK(src1 + i, src2 + i, dst + i, count - i);												\
+	}
+
+QVSIMD_ARITHMETIC_32F_SSE2(add32fSSE2, _mm_add_ps, add32fScalar)
+QVSIMD_ARITHMETIC_32F_SSE2(sub32fSSE2, _mm_sub_ps, sub32fScalar)
+QVSIMD_ARITHMETIC_32F_SSE2(mul32fSSE2, _mm_mul_ps, mul32fScalar)
+
+QVSIMD_TARGET_SSE2 static void set32fSSE2(const sFloat value, sFloat *dst, const int count)
+	{
+	const __m128 v = _mm_set1_ps(value);
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(dst + i, v);
+	set32fScalar(value, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void convert8u32fSSE2(const uChar *src, sFloat *dst, const int count)
+	{
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		const __m128i	v = _mm_loadu_si128((const __m128i *) (src + i)),
+						lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+		_mm_storeu_ps(dst + i,		_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+		_mm_storeu_ps(dst + i + 4,	_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+		_mm_storeu_ps(dst + i + 8,	_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+		_mm_storeu_ps(dst + i + 12,	_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+		}
+	convert8u32fScalar(src + i, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static inline __m128i convert32fToInt32SSE2(const __m128 value, const bool roundNear)
+	{
+	// Clamping before the conversion keeps NaN and huge values inside the destination range (NaN goes to zero).
+	const __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+	return roundNear? _mm_cvtps_epi32(clamped) : _mm_cvttps_epi32(clamped);
+	}
+
+QVSIMD_TARGET_SSE2 static void convert32f8uSSE2(const sFloat *src, uChar *dst, const int count, const bool roundNear)
+	{
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		const __m128i	a = convert32fToInt32SSE2(_mm_loadu_ps(src + i), roundNear),
+						b = convert32fToInt32SSE2(_mm_loadu_ps(src + i + 4), roundNear),
+						c = convert32fToInt32SSE2(_mm_loadu_ps(src + i + 8), roundNear),
+						d = convert32fToInt32SSE2(_mm_loadu_ps(src + i + 12), roundNear);
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+	convert32f8uScalar(src + i, dst + i, count - i, roundNear);
+	}
+
+QVSIMD_TARGET_SSE2 static void verticalFilter8u16uSSE2(const uChar * const *rows, const uShort *weights, const int nRows, uShort *dst, const int count)
+	{
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		__m128i lo = zero, hi = zero;
+		for (int r = 0; r < nRows; r++)
+			{
+			const __m128i	w = _mm_set1_epi16(weights[r]),
+							v = _mm_loadu_si128((const __m128i *) (rows[r] + i));
+			lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), w));
+			hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), w));
+			}
+		_mm_storeu_si128((__m128i *) (dst + i), lo);
+		_mm_storeu_si128((__m128i *) (dst + i + 8), hi);
+		}
+
+	const uChar *remainingRows[8];
+	for (int r = 0; r < nRows and r < 8; r++)
+		remainingRows[r] = rows[r] + i;
+	verticalFilter8u16uScalar(remainingRows, weights, nRows, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void horizontalFilter16u8uSSE2(const uShort *src, const uShort *weights, const int size, const int shift, uChar *dst, const int count)
+	{
+	const __m128i rounding = _mm_set1_epi16((shift > 0)? 1 << (shift - 1) : 0);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		__m128i lo = rounding, hi = rounding;
+		for (int k = 0; k < size; k++)
+			{
+			const __m128i w = _mm_set1_epi16(weights[k]);
+			lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_loadu_si128((const __m128i *) (src + i + k)), w));
+			hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_loadu_si128((const __m128i *) (src + i + k + 8)), w));
+			}
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(	scaleSaturate8uSSE2(_mm_srli_epi16(lo, shift), 0),
+																	scaleSaturate8uSSE2(_mm_srli_epi16(hi, shift), 0)) );
+		}
+	horizontalFilter16u8uScalar(src + i, weights, size, shift, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void verticalFilter32fSSE2(const sFloat * const *rows, const sFloat *weights, const int nRows, sFloat *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		{
+		__m128 accum = _mm_mul_ps(_mm_set1_ps(weights[0]), _mm_loadu_ps(rows[0] + i));
+		for (int r = 1; r < nRows; r++)
+			accum = _mm_add_ps(accum, _mm_mul_ps(_mm_set1_ps(weights[r]), _mm_loadu_ps(rows[r] + i)));
+		_mm_storeu_ps(dst + i, accum);
+		}
+
+	const sFloat *remainingRows[8];
+	for (int r = 0; r < nRows and r < 8; r++)
+		remainingRows[r] = rows[r] + i;
+	verticalFilter32fScalar(remainingRows, weights, nRows, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void horizontalFilter32fSSE2(const sFloat *src, const sFloat *weights, const int size, sFloat *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		{
+		__m128 accum = _mm_mul_ps(_mm_set1_ps(weights[0]), _mm_loadu_ps(src + i));
+		for (int k = 1; k < size; k++)
+			accum = _mm_add_ps(accum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + i + k)));
+		_mm_storeu_ps(dst + i, accum);
+		}
+	horizontalFilter32fScalar(src + i, weights, size, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void lerpRows8u16uSSE2(const uChar *src1, const uChar *src2, const int weight, uShort *dst, const int count)
+	{
+	const __m128i	zero = _mm_setzero_si128(),
+					w1 = _mm_set1_epi16(256 - weight),
+					w2 = _mm_set1_epi16(weight);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		const __m128i	a = _mm_loadu_si128((const __m128i *) (src1 + i)),
+						b = _mm_loadu_si128((const __m128i *) (src2 + i));
+		_mm_storeu_si128((__m128i *) (dst + i),		_mm_add_epi16(	_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w1),
+																	_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w2)) );
+		_mm_storeu_si128((__m128i *) (dst + i + 8),	_mm_add_epi16(	_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w1),
+																	_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w2)) );
+		}
+	lerpRows8u16uScalar(src1 + i, src2 + i, weight, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_SSE2 static void lerpRows32fSSE2(const sFloat *src1, const sFloat *src2, const sFloat weight, sFloat *dst, const int count)
+	{
+	const __m128 w1 = _mm_set1_ps(1.0f - weight), w2 = _mm_set1_ps(weight);
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src1 + i), w1), _mm_mul_ps(_mm_loadu_ps(src2 + i), w2)));
+	lerpRows32fScalar(src1 + i, src2 + i, weight, dst + i, count - i);
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels. Integer kernels widen 16 pixels to 16-bit lanes with
+// _mm256_cvtepu8_epi16, and narrow them back with a 128-bit pack, which avoids
+// the lane interleaving of the 256-bit pack instructions.
+
+QVSIMD_TARGET_AVX2 static inline __m256i scaleSaturate8uAVX2(__m256i value, const int scaleFactor)
+	{
+	if (scaleFactor > 0)
+		{
+		const __m256i	one = _mm256_set1_epi16(1),
+						half = _mm256_set1_epi16(1 << (scaleFactor - 1)),
+						remainder = _mm256_and_si256(value, _mm256_set1_epi16((1 << scaleFactor) - 1));
+		value = _mm256_srli_epi16(value, scaleFactor);
+		const __m256i roundUp = _mm256_or_si256(	_mm256_cmpgt_epi16(remainder, half),
+													_mm256_and_si256(_mm256_cmpeq_epi16(remainder, half), _mm256_and_si256(value, one)) );
+		value = _mm256_add_epi16(value, _mm256_and_si256(roundUp, one));
+		}
+	return _mm256_min_epu16(value, _mm256_set1_epi16(255));
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m128i pack16uTo8uAVX2(const __m256i value)
+	{
+	return _mm_packus_epi16(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256i load8uTo16uAVX2(const uChar *src)
+	{
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) src));
+	}
+
+#define QVSIMD_ARITHMETIC_8U_AVX2(NAME, OPERATION, FALLBACK)																\
+QVSIMD_TARGET_AVX2 static void NAME(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)	\
+	{																														\
+	if (scaleFactor < 0 or scaleFactor > 15)																				\
+		{																													\
+		FALLBACK(src1, src2, dst, count, scaleFactor);																		\
+		return;																												\
+		}																													\
+	int i = 0;																												\
+	for (; i + 16 <= count; i += 16)																						\
+		_mm_storeu_si128((__m128i *) (dst + i), pack16uTo8uAVX2(scaleSaturate8uAVX2(										\
+			OPERATION(load8uTo16uAVX2(src1 + i), load8uTo16uAVX2(src2 + i)), scaleFactor)));								\
+	FALLBACK(src1 + i, src2 + i, dst + i, count - i, scaleFactor);															\
+	}
+
+QVSIMD_ARITHMETIC_8U_AVX2(add8uAVX2, _mm256_add_epi16, add8uScalar)
+QVSIMD_ARITHMETIC_8U_AVX2(sub8uAVX2, _mm256_subs_epu16, sub8uScalar)
+QVSIMD_ARITHMETIC_8U_AVX2(mul8uAVX2, _mm256_mullo_epi16, mul8uScalar)
+
+#define QVSIMD_ARITHMETIC_32F_AVX2(NAME, OPERATION, FALLBACK)										\
+QVSIMD_TARGET_AVX2 static void NAME(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)	\
+	{																								\
+	int i = 0;																						\
+	for (; i + 8 <= count; i += 8)																	\
+		_mm256_storeu_ps(dst + i, OPERATION(_mm256_loadu_ps(src1 + i), _mm256_loadu_ps(src2 + i)));	\
+	FALLBACK(src1 + i, src2 + i, dst + i, count - i);												\
+	}
+
+QVSIMD_ARITHMETIC_32F_AVX2(add32fAVX2, _mm256_add_ps, add32fScalar)
+QVSIMD_ARITHMETIC_32F_AVX2(sub32fAVX2, _mm256_sub_ps, sub32fScalar)
+QVSIMD_ARITHMETIC_32F_AVX2(mul32fAVX2, _mm256_mul_ps, mul32fScalar)
+
+QVSIMD_TARGET_AVX2 static void set32fAVX2(const sFloat value, sFloat *dst, const int count)
+	{
+	const __m256 v = _mm256_set1_ps(value);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dst + i, v);
+	set32fScalar(value, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void convert8u32fAVX2(const uChar *src, sFloat *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (src + i)))));
+	convert8u32fScalar(src + i, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256i convert32fToInt32AVX2(const __m256 value, const bool roundNear)
+	{
+	const __m256 clamped = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+	return roundNear? _mm256_cvtps_epi32(clamped) : _mm256_cvttps_epi32(clamped);
+	}
+
+QVSIMD_TARGET_AVX2 static void convert32f8uAVX2(const sFloat *src, uChar *dst, const int count, const bool roundNear)
+	{
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		// Lane-wise pack gives the order a0 b0 a1 b1 (128-bit halves), restored by the permutation.
+		const __m256i	a = convert32fToInt32AVX2(_mm256_loadu_ps(src + i), roundNear),
+						b = convert32fToInt32AVX2(_mm256_loadu_ps(src + i + 8), roundNear),
+						packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+		_mm_storeu_si128((__m128i *) (dst + i), pack16uTo8uAVX2(packed));
+		}
+	convert32f8uScalar(src + i, dst + i, count - i, roundNear);
+	}
+
+QVSIMD_TARGET_AVX2 static void verticalFilter8u16uAVX2(const uChar * const *rows, const uShort *weights, const int nRows, uShort *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		__m256i accum = _mm256_setzero_si256();
+		for (int r = 0; r < nRows; r++)
+			accum = _mm256_add_epi16(accum, _mm256_mullo_epi16(load8uTo16uAVX2(rows[r] + i), _mm256_set1_epi16(weights[r])));
+		_mm256_storeu_si256((__m256i *) (dst + i), accum);
+		}
+
+	const uChar *remainingRows[8];
+	for (int r = 0; r < nRows and r < 8; r++)
+		remainingRows[r] = rows[r] + i;
+	verticalFilter8u16uScalar(remainingRows, weights, nRows, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void horizontalFilter16u8uAVX2(const uShort *src, const uShort *weights, const int size, const int shift, uChar *dst, const int count)
+	{
+	const __m256i rounding = _mm256_set1_epi16((shift > 0)? 1 << (shift - 1) : 0);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		{
+		__m256i accum = rounding;
+		for (int k = 0; k < size; k++)
+			accum = _mm256_add_epi16(accum, _mm256_mullo_epi16(_mm256_loadu_si256((const __m256i *) (src + i + k)), _mm256_set1_epi16(weights[k])));
+		_mm_storeu_si128((__m128i *) (dst + i), pack16uTo8uAVX2(scaleSaturate8uAVX2(_mm256_srli_epi16(accum, shift), 0)));
+		}
+	horizontalFilter16u8uScalar(src + i, weights, size, shift, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void verticalFilter32fAVX2(const sFloat * const *rows, const sFloat *weights, const int nRows, sFloat *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		{
+		__m256 accum = _mm256_mul_ps(_mm256_set1_ps(weights[0]), _mm256_loadu_ps(rows[0] + i));
+		for (int r = 1; r < nRows; r++)
+			accum = _mm256_add_ps(accum, _mm256_mul_ps(_mm256_set1_ps(weights[r]), _mm256_loadu_ps(rows[r] + i)));
+		_mm256_storeu_ps(dst + i, accum);
+		}
+
+	const sFloat *remainingRows[8];
+	for (int r = 0; r < nRows and r < 8; r++)
+		remainingRows[r] = rows[r] + i;
+	verticalFilter32fScalar(remainingRows, weights, nRows, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void horizontalFilter32fAVX2(const sFloat *src, const sFloat *weights, const int size, sFloat *dst, const int count)
+	{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		{
+		__m256 accum = _mm256_mul_ps(_mm256_set1_ps(weights[0]), _mm256_loadu_ps(src + i));
+		for (int k = 1; k < size; k++)
+			accum = _mm256_add_ps(accum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(src + i + k)));
+		_mm256_storeu_ps(dst + i, accum);
+		}
+	horizontalFilter32fScalar(src + i, weights, size, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void lerpRows8u16uAVX2(const uChar *src1, const uChar *src2, const int weight, uShort *dst, const int count)
+	{
+	const __m256i w1 = _mm256_set1_epi16(256 - weight), w2 = _mm256_set1_epi16(weight);
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+		_mm256_storeu_si256((__m256i *) (dst + i), _mm256_add_epi16(	_mm256_mullo_epi16(load8uTo16uAVX2(src1 + i), w1),
+																		_mm256_mullo_epi16(load8uTo16uAVX2(src2 + i), w2)) );
+	lerpRows8u16uScalar(src1 + i, src2 + i, weight, dst + i, count - i);
+	}
+
+QVSIMD_TARGET_AVX2 static void lerpRows32fAVX2(const sFloat *src1, const sFloat *src2, const sFloat weight, sFloat *dst, const int count)
+	{
+	const __m256 w1 = _mm256_set1_ps(1.0f - weight), w2 = _mm256_set1_ps(weight);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src1 + i), w1), _mm256_mul_ps(_mm256_loadu_ps(src2 + i), w2)));
+	lerpRows32fScalar(src1 + i, src2 + i, weight, dst + i, count - i);
+	}
+#endif // QVSIMD_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// Run time dispatch
+
+typedef struct
+	{
+	void (*add8u)(const uChar *, const uChar *, uChar *, const int, const int);
+	void (*sub8u)(const uChar *, const uChar *, uChar *, const int, const int);
+	void (*mul8u)(const uChar *, const uChar *, uChar *, const int, const int);
+	void (*add32f)(const sFloat *, const sFloat *, sFloat *, const int);
+	void (*sub32f)(const sFloat *, const sFloat *, sFloat *, const int);
+	void (*mul32f)(const sFloat *, const sFloat *, sFloat *, const int);
+	void (*set32f)(const sFloat, sFloat *, const int);
+	void (*convert8u32f)(const uChar *, sFloat *, const int);
+	void (*convert32f8u)(const sFloat *, uChar *, const int, const bool);
+	void (*verticalFilter8u16u)(const uChar * const *, const uShort *, const int, uShort *, const int);
+	void (*horizontalFilter16u8u)(const uShort *, const uShort *, const int, const int, uChar *, const int);
+	void (*verticalFilter32f)(const sFloat * const *, const sFloat *, const int, sFloat *, const int);
+	void (*horizontalFilter32f)(const sFloat *, const sFloat *, const int, sFloat *, const int);
+	void (*lerpRows8u16u)(const uChar *, const uChar *, const int, uShort *, const int);
+	void (*lerpRows32f)(const sFloat *, const sFloat *, const sFloat, sFloat *, const int);
+	} QVSimdKernelTable;
+
+static const QVSimdKernelTable scalarKernels =
+	{
+	add8uScalar, sub8uScalar, mul8uScalar, add32fScalar, sub32fScalar, mul32fScalar, set32fScalar,
+	convert8u32fScalar, convert32f8uScalar, verticalFilter8u16uScalar, horizontalFilter16u8uScalar,
+	verticalFilter32fScalar, horizontalFilter32fScalar, lerpRows8u16uScalar, lerpRows32fScalar
+	};
+
+#ifdef QVSIMD_X86
+static const QVSimdKernelTable sse2Kernels =
+	{
+	add8uSSE2, sub8uSSE2, mul8uSSE2, add32fSSE2, sub32fSSE2, mul32fSSE2, set32fSSE2,
+	convert8u32fSSE2, convert32f8uSSE2, verticalFilter8u16uSSE2, horizontalFilter16u8uSSE2,
+	verticalFilter32fSSE2, horizontalFilter32fSSE2, lerpRows8u16uSSE2, lerpRows32fSSE2
+	};
+
+static const QVSimdKernelTable avx2Kernels =
+	{
+	add8uAVX2, sub8uAVX2, mul8uAVX2, add32fAVX2, sub32fAVX2, mul32fAVX2, set32fAVX2,
+	convert8u32fAVX2, convert32f8uAVX2, verticalFilter8u16uAVX2, horizontalFilter16u8uAVX2,
+	verticalFilter32fAVX2, horizontalFilter32fAVX2, lerpRows8u16uAVX2, lerpRows32fAVX2
+	};
+#endif // QVSIMD_X86
+
+static TQVSimdLevel detectSimdLevel()
+	{
+	#ifdef QVSIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return QVSIMD_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return QVSIMD_SSE2;
+	#endif
+	return QVSIMD_SCALAR;
+	}
+
+static const QVSimdKernelTable * kernelTable(const TQVSimdLevel level)
+	{
+	#ifdef QVSIMD_X86
+	switch(level)
+		{
+		case QVSIMD_AVX2:	return &avx2Kernels;
+		case QVSIMD_SSE2:	return &sse2Kernels;
+		default:			break;
+		}
+	#else
+	Q_UNUSED(level);
+	#endif
+	return &scalarKernels;
+	}
+
+// The level can be changed while other threads run the kernels, so it is accessed atomically.
+static QAtomicInt activeSimdLevel(detectSimdLevel());
+
+static inline const QVSimdKernelTable * activeKernels()
+	{
+	return kernelTable(qvSimdLevel());
+	}
+
+TQVSimdLevel qvSimdSupportedLevel()
+	{
+	static const TQVSimdLevel supportedLevel = detectSimdLevel();
+	return supportedLevel;
+	}
+
+TQVSimdLevel qvSimdLevel()
+	{
+	return TQVSimdLevel(activeSimdLevel.fetchAndAddAcquire(0));
+	}
+
+TQVSimdLevel qvSetSimdLevel(const TQVSimdLevel level)
+	{
+	const TQVSimdLevel selectedLevel = (level > qvSimdSupportedLevel())? qvSimdSupportedLevel() : level;
+	activeSimdLevel.fetchAndStoreRelease(selectedLevel);
+	return selectedLevel;
+	}
+
+const char * qvSimdLevelName(const TQVSimdLevel level)
+	{
+	switch(level)
+		{
+		case QVSIMD_AVX2:	return "AVX2";
+		case QVSIMD_SSE2:	return "SSE2";
+		default:			return "scalar";
+		}
+	}
+
+void qvSimdAdd_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{ activeKernels()->add8u(src1, src2, dst, count, scaleFactor); }
+
+void qvSimdSub_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{ activeKernels()->sub8u(src1, src2, dst, count, scaleFactor); }
+
+void qvSimdMul_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor)
+	{ activeKernels()->mul8u(src1, src2, dst, count, scaleFactor); }
+
+void qvSimdAdd_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{ activeKernels()->add32f(src1, src2, dst, count); }
+
+void qvSimdSub_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{ activeKernels()->sub32f(src1, src2, dst, count); }
+
+void qvSimdMul_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count)
+	{ activeKernels()->mul32f(src1, src2, dst, count); }
+
+void qvSimdSet_8u(const uChar value, uChar *dst, const int count)
+	{ set8uScalar(value, dst, count); }
+
+void qvSimdSet_32f(const sFloat value, sFloat *dst, const int count)
+	{ activeKernels()->set32f(value, dst, count); }
+
+void qvSimdConvert_8u32f(const uChar *src, sFloat *dst, const int count)
+	{ activeKernels()->convert8u32f(src, dst, count); }
+
+void qvSimdConvert_32f8u(const sFloat *src, uChar *dst, const int count, const bool roundNear)
+	{ activeKernels()->convert32f8u(src, dst, count, roundNear); }
+
+void qvSimdVerticalFilter_8u16u(const uChar * const *rows, const uShort *weights, const int nRows, uShort *dst, const int count)
+	{
+	Q_ASSERT_X(nRows <= 8, "qvSimdVerticalFilter_8u16u", "more than 8 rows");
+	activeKernels()->verticalFilter8u16u(rows, weights, nRows, dst, count);
+	}
+
+void qvSimdHorizontalFilter_16u8u(const uShort *src, const uShort *weights, const int size, const int shift, uChar *dst, const int count)
+	{ activeKernels()->horizontalFilter16u8u(src, weights, size, shift, dst, count); }
+
+void qvSimdVerticalFilter_32f(const sFloat * const *rows, const sFloat *weights, const int nRows, sFloat *dst, const int count)
+	{
+	Q_ASSERT_X(nRows <= 8, "qvSimdVerticalFilter_32f", "more than 8 rows");
+	activeKernels()->verticalFilter32f(rows, weights, nRows, dst, count);
+	}
+
+void qvSimdHorizontalFilter_32f(const sFloat *src, const sFloat *weights, const int size, sFloat *dst, const int count)
+	{ activeKernels()->horizontalFilter32f(src, weights, size, dst, count); }
+
+void qvSimdLerpRows_8u16u(const uChar *src1, const uChar *src2, const int weight, uShort *dst, const int count)
+	{ activeKernels()->lerpRows8u16u(src1, src2, weight, dst, count); }
+
+void qvSimdLerpRows_32f(const sFloat *src1, const sFloat *src2, const sFloat weight, sFloat *dst, const int count)
+	{ activeKernels()->lerpRows32f(src1, src2, weight, dst, count); }
@@ -0,0 +1,119 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVSIMD_H
+#define QVSIMD_H
+
+#include <qvdefines.h>
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Per-function target attributes for the SIMD kernels of the library, so it does not need global -msse2 or -mavx2
+// flags. Code compiled with them must only be executed after checking the processor at run time (see qvSimdLevel).
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define QVSIMD_X86
+	#include <immintrin.h>
+	#define QVSIMD_TARGET_SSE2			__attribute__((target("sse2")))
+	#define QVSIMD_TARGET_AVX2			__attribute__((target("avx2")))
+	#define QVSIMD_TARGET_POPCNT		__attribute__((target("popcnt")))
+	#define QVSIMD_TARGET_AVX2_POPCNT	__attribute__((target("avx2,popcnt")))
+#endif
+#endif // DOXYGEN_IGNORE_THIS
+
+/*!
+@brief Instruction sets available for the built-in pixel kernels.
+
+The pixel kernels declared in this file are used by the image functions (@ref Add, @ref Mul, @ref Convert,
+@ref FilterGauss, @ref Resize, and others) when the QVision is compiled without the Intel IPP. Each kernel has a scalar
+version, and SSE2 and AVX2 versions which are selected at run time depending on the processor.
+
+@see qvSimdLevel
+@see qvSetSimdLevel
+@ingroup qvip
+*/
+typedef enum {
+	QVSIMD_SCALAR = 0,	/*!< Plain C++ loops. */
+	QVSIMD_SSE2 = 1,	/*!< 128-bit SSE2 kernels. */
+	QVSIMD_AVX2 = 2		/*!< 256-bit AVX2 kernels. */
+} TQVSimdLevel;
+
+/// @brief Returns the most advanced instruction set supported by the processor and the compiler.
+/// @ingroup qvip
+TQVSimdLevel qvSimdSupportedLevel();
+
+/// @brief Returns the instruction set currently used by the pixel kernels.
+///
+/// By default it is the value returned by @ref qvSimdSupportedLevel.
+/// @ingroup qvip
+TQVSimdLevel qvSimdLevel();
+
+/// @brief Selects the instruction set used by the pixel kernels.
+///
+/// This function is intended for benchmarking and testing. Levels above @ref qvSimdSupportedLevel are lowered to
+/// the supported level. The level is stored atomically, so it can be changed while other threads use the kernels:
+/// each call to a kernel uses either the previous or the new level.
+/// @return the level effectively selected.
+/// @ingroup qvip
+TQVSimdLevel qvSetSimdLevel(const TQVSimdLevel level);
+
+/// @brief Returns a readable name for an instruction set level.
+/// @ingroup qvip
+const char * qvSimdLevelName(const TQVSimdLevel level);
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Row kernels. Each one processes 'count' contiguous elements, with no alignment requirements.
+//
+// Integer arithmetic kernels follow the IPP 'Sfs' convention: the result is divided by 2^scaleFactor, rounded to
+// the nearest integer (half to even), and saturated to the range of the destination type.
+void qvSimdAdd_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor);
+void qvSimdSub_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor);	// src1 - src2
+void qvSimdMul_8u(const uChar *src1, const uChar *src2, uChar *dst, const int count, const int scaleFactor);
+void qvSimdAdd_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count);
+void qvSimdSub_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count);	// src1 - src2
+void qvSimdMul_32f(const sFloat *src1, const sFloat *src2, sFloat *dst, const int count);
+
+void qvSimdSet_8u(const uChar value, uChar *dst, const int count);
+void qvSimdSet_32f(const sFloat value, sFloat *dst, const int count);
+
+void qvSimdConvert_8u32f(const uChar *src, sFloat *dst, const int count);
+// Rounds to nearest (half to even) if 'roundNear' is true, towards zero otherwise. Saturates to [0, 255].
+void qvSimdConvert_32f8u(const sFloat *src, uChar *dst, const int count, const bool roundNear);
+
+// Separable filter passes.
+// - Vertical pass: dst[i] = sum_r weights[r] * rows[r][i]
+// - Horizontal pass: dst[i] = sum_k weights[k] * src[i + k]. 'src' must hold count + size - 1 elements.
+// The integer passes require that every partial sum fits in 16 bits. The horizontal one rounds and shifts the result
+// right by 'shift' bits, and saturates it to [0, 255].
+void qvSimdVerticalFilter_8u16u(const uChar * const *rows, const uShort *weights, const int nRows, uShort *dst, const int count);
+void qvSimdHorizontalFilter_16u8u(const uShort *src, const uShort *weights, const int size, const int shift, uChar *dst, const int count);
+void qvSimdVerticalFilter_32f(const sFloat * const *rows, const sFloat *weights, const int nRows, sFloat *dst, const int count);
+void qvSimdHorizontalFilter_32f(const sFloat *src, const sFloat *weights, const int size, sFloat *dst, const int count);
+
+// Linear interpolation between two rows, used by the vertical pass of the bilinear resize.
+// - 8u version: dst[i] = src1[i] * (256 - weight) + src2[i] * weight, with weight in [0, 256].
+// - 32f version: dst[i] = src1[i] * (1 - weight) + src2[i] * weight.
+void qvSimdLerpRows_8u16u(const uChar *src1, const uChar *src2, const int weight, uShort *dst, const int count);
+void qvSimdLerpRows_32f(const sFloat *src1, const sFloat *src2, const sFloat weight, sFloat *dst, const int count);
+#endif // DOXYGEN_IGNORE_THIS
+
+#endif // QVSIMD_H
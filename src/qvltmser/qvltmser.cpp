@@ -22,11 +22,18 @@
 /// @brief Functions to get image regions using the linear time MSER algorithm by Nister and Stewanius (ECCV 2008)
 /// @author PARP Research Group. University of Murcia, Spain.
 
+#include <QThread>
+#include <QThreadStorage>
+
+#include <qvmath/qvparallelranges.h>
 #include <qvltmser/qvltmser.h>
 #include <qvip.h>
 #include <qvipp.h>
 #include <qvltmser/qvltmser_ds.h>
 
+// Minimal number of seeds whose contours are obtained by each thread:
+#define LTMSER_MIN_SEEDS_PER_THREAD 16
+
 // "ProcessStack" function of original algorithm. It uses the component stack and the gray level of the last
 // unstacked pixel in the boundary.
 void processStack(QVLtmserComponentStack &theQVLtmserComponentStack, uInt levelGreyBoundary)
@@ -37,15 +44,15 @@ void processStack(QVLtmserComponentStack &theQVLtmserComponentStack, uInt levelG
     while(true) {
         top = theQVLtmserComponentStack.getPosTop();
         if(top != 0)
-            theComponent2 = (*theQVLtmserComponentStack.components)[top-1];
+            theComponent2 = &theQVLtmserComponentStack.component(top-1);
         else {
             // Just one element in stack -> uprise graylevel of stack to levelGreyBoundary and return:
-            theComponentTop = (*theQVLtmserComponentStack.components)[top];
+            theComponentTop = &theQVLtmserComponentStack.component(top);
             theComponentTop->upGreyLevel(levelGreyBoundary);
             break;
         }
         greyLevel2 = theComponent2->greyLevel;
-        theComponentTop = (*theQVLtmserComponentStack.components)[top];
+        theComponentTop = &theQVLtmserComponentStack.component(top);
         if (levelGreyBoundary < (uInt)greyLevel2) {
             theComponentTop->upGreyLevel(levelGreyBoundary);
             break;
@@ -58,68 +65,20 @@ void processStack(QVLtmserComponentStack &theQVLtmserComponentStack, uInt levelG
     }
 }
 
-// Linear-Time MSER fuction to get the list of seeds:
-QList<QVMSER> getLTMSER(QVImage< uChar > &input_image,
-                        const int minArea, const int maxArea, const int delta,
-                        const float delta_threshold, const unsigned int downscaling)
+// Main loop of the linear time MSER algorithm. The image is stored without padding (step equal to cols), and its
+// least significant bits must be cleared, as they are used as visited pixel mask. The boundary heap must be
+// initialized from the histogram of the image. Resulting seeds are stored in the seed list of the component stack.
+void processLTMSER(uChar *pimage, const uInt cols, const uInt rows,
+                   QVLtmserBoundary &theQVLtmserBoundary, QVLtmserComponentStack &theQVLtmserComponentStack)
 {
-    static QVLtmserBoundary *theQVLtmserBoundary = NULL; // Structure for goundary pixels
-    static QVLtmserComponentStack *theQVLtmserComponentStack = NULL;
-    static uInt former_width = 0, former_height = 0; // Size of former image (if they change, resize structures).
-    static const uInt greyLevels=256; // Number of gray levels.
     uChar valueOfPixel;
     bool visited;
     uInt currentGreyLevel, greyLevelNeighbor, indexNeighbor;
     int levelGreyBoundary, col = 0, row = 0, cPixel_x, cPixel_y;
     uInt currentPixel, neighbor, pixelBoundary;
     QVLtmserComponent *theComponentTop;
-    QVPolyline aContour;
-    QVImage<uChar> image;
-    int minAreaScaled=minArea, maxAreaScaled=maxArea;
 
-    if(downscaling != 1) {
-        QVImage<uChar> resized(input_image.getCols()/downscaling,input_image.getRows()/downscaling);
-        Resize(input_image,resized);
-        image = resized;
-        minAreaScaled = minArea/(downscaling*downscaling);
-        maxAreaScaled = maxArea/(downscaling*downscaling);
-    } else {
-        image = input_image;
-    }
-
-    const uInt cols = image.getCols(), rows = image.getRows();
-
-    if(cols != former_width or rows != former_height) {
-        // New image size; resize structures:
-        if (theQVLtmserBoundary != NULL)
-            delete theQVLtmserBoundary;
-        theQVLtmserBoundary = new QVLtmserBoundary(cols, rows, greyLevels);
-        if (theQVLtmserComponentStack != NULL)
-            delete theQVLtmserComponentStack;
-        theQVLtmserComponentStack = new QVLtmserComponentStack(greyLevels);
-        former_width = cols;
-        former_height = rows;
-    }
-
-    theQVLtmserComponentStack->initComponents();
-
-    // Initialize static variables of QVLtmserComponent class (to avoid unneeded intensive passing of parameters)
-    QVLtmserComponent::theSeedList = QHash<QPoint,QVMSER>();
-    QVLtmserComponent::minArea = minAreaScaled;
-    QVLtmserComponent::maxArea = maxAreaScaled;
-    QVLtmserComponent::delta = delta;
-    QVLtmserComponent::delta_threshold = delta_threshold;
-
-    uChar *pimage = image.getWriteData();
-
-    // Initialize visited pixels mask. For efficiency, it will be embedded in the same image (LSB of each pixel):
-    AndC(image,0xFE,image);
-
-    int imageStep = image.getStep();
-
-    // Initialize heap from histogram:
-    QVector< int > histogram = HistogramRange(image);
-    theQVLtmserBoundary->initHeap(histogram);
+    theQVLtmserComponentStack.initComponents();
 
     // First visited pixel:
     currentGreyLevel = pimage[0] & 0xFE;
@@ -127,7 +86,7 @@ QList<QVMSER> getLTMSER(QVImage< uChar > &input_image,
     valueOfPixel = pimage[0];
     pimage[0] = valueOfPixel | 0x01;
 
-    theQVLtmserComponentStack->pushComponent(currentGreyLevel,0,0);
+    theQVLtmserComponentStack.pushComponent(currentGreyLevel,0,0);
     while(true) { // Infinite loop (until break):
         cPixel_y = (int)(currentPixel / cols);
         cPixel_x = currentPixel - (cPixel_y * cols);
@@ -147,67 +106,149 @@ QList<QVMSER> getLTMSER(QVImage< uChar > &input_image,
             }
             if (row < 0 || col < 0 || static_cast<uInt>(row) >= rows || static_cast<uInt>(col) >= cols)
                 continue;
-            indexNeighbor = (row*imageStep) + col;
+            indexNeighbor = (row*cols) + col;
             valueOfPixel = pimage[indexNeighbor];
             visited = valueOfPixel & 0x01;
             if (visited)
                 continue;
             else {
-                greyLevelNeighbor = pimage[indexNeighbor] & 0xFE;
-                valueOfPixel = pimage[indexNeighbor];
+                greyLevelNeighbor = valueOfPixel & 0xFE;
                 pimage[indexNeighbor] = valueOfPixel | 0x01;
                 if (greyLevelNeighbor >= currentGreyLevel) {
                     // If graylevel(neighbour) >= graylevel(current) -> move to boundary heap:
-                    neighbor = (row * cols) + col;
-                    theQVLtmserBoundary->pushPixel(greyLevelNeighbor, neighbor);
+                    neighbor = indexNeighbor;
+                    theQVLtmserBoundary.pushPixel(greyLevelNeighbor, neighbor);
                 } else {
                     // If graylevel(neighbour) < graylevel(current) -> move current pixel to heap and
                     // make neighbour the current pixel. This will add a new element to the components stack,
                     // and to start checking the neighbours of the new current pixel (nn=0 in next iteration):
-                   theQVLtmserBoundary->pushPixel(currentGreyLevel, currentPixel);
-                   currentPixel = (row * cols) + col;
+                   theQVLtmserBoundary.pushPixel(currentGreyLevel, currentPixel);
+                   currentPixel = indexNeighbor;
                    cPixel_y = row;
                    cPixel_x = col;
                    currentGreyLevel = greyLevelNeighbor;
-                   theQVLtmserComponentStack->pushComponent(currentGreyLevel,row,col);
+                   theQVLtmserComponentStack.pushComponent(currentGreyLevel,row,col);
                    nn = -1;
                 }
             }
         }
         // We have run through every neighbour of current pixel without moving, so we must "fill" the pixel
         // (add it to the component on the top of the stack)...
-        theComponentTop = (*theQVLtmserComponentStack->components)[theQVLtmserComponentStack->getPosTop()];
+        theComponentTop = &theQVLtmserComponentStack.component(theQVLtmserComponentStack.getPosTop());
         theComponentTop->addPixel(currentGreyLevel);
         // ... then get the next pixel from the boundary heap...
-        levelGreyBoundary = theQVLtmserBoundary->maxStackPr;
-        if (levelGreyBoundary == -1 or not theQVLtmserBoundary->popPixel(levelGreyBoundary, pixelBoundary)) {
-            int acum=0;
-            for(uInt i=theComponentTop->greyLevelMin;i<=theComponentTop->greyLevel;i++) {
-                acum += (*theComponentTop->history)[i];
-            }
-
-            theQVLtmserComponentStack->popComponent(); // To delete last component of stack.
+        levelGreyBoundary = theQVLtmserBoundary.maxStackPr;
+        if (levelGreyBoundary == -1 or not theQVLtmserBoundary.popPixel(levelGreyBoundary, pixelBoundary)) {
+            theQVLtmserComponentStack.popComponent(); // To test last component of stack.
             break; // Get out of main "while" loop.
         }
         // ... and, if it applies (only if the new pixel popped out of the heap is greater than current), we
         // call processStack (which keeps on filling the current "hole" with water):
         if (levelGreyBoundary > (int)currentGreyLevel)
-            processStack(*theQVLtmserComponentStack, levelGreyBoundary);
+            processStack(theQVLtmserComponentStack, levelGreyBoundary);
         currentPixel = pixelBoundary;
         currentGreyLevel = levelGreyBoundary;
     }
+}
 
-    QList<QVMSER> mser_list;
+#ifndef DOXYGEN_IGNORE_THIS
+// Obtains the MSER- seeds in the first range, and the MSER+ seeds in the second one.
+class LTMSERSeedsTask
+{
+    public:
+        LTMSERSeedsTask(QVLTMSERExtractor &extractor): extractor(extractor)    { }
+
+        void operator()(const int range, const int, const int)
+        {
+            extractor.detectSeeds(range == 0);
+        }
+
+    private:
+        QVLTMSERExtractor &extractor;
+};
+
+class LTMSERContoursTask
+{
+    public:
+        LTMSERContoursTask(QVLTMSERExtractor &extractor): extractor(extractor) { }
+
+        void operator()(const int, const int first, const int last)
+        {
+            extractor.extractContours(first, last);
+        }
+
+    private:
+        QVLTMSERExtractor &extractor;
+};
+#endif // DOXYGEN_IGNORE_THIS
+
+QVLTMSERExtractor::QVLTMSERExtractor(const int minArea, const int maxArea, const int delta,
+                                     const float delta_threshold, const unsigned int downscaling):
+    numThreads(0), contoursRequested(false)
+{
+    setParameters(minArea, maxArea, delta, delta_threshold, downscaling);
+}
+
+void QVLTMSERExtractor::setParameters(const int minArea, const int maxArea, const int delta,
+                                      const float delta_threshold, const unsigned int downscaling)
+{
+    if (downscaling == 0)
+        qFatal("QVLTMSERExtractor: downscaling factor must be positive.");
+
+    this->minArea = minArea;
+    this->maxArea = maxArea;
+    this->delta = delta;
+    this->delta_threshold = delta_threshold;
+    this->downscaling = downscaling;
+}
+
+// Obtains the seeds of one polarity from the (possibly downscaled) seed image. MSER- seeds are obtained from the
+// negated image, which is computed while copying the image to the working buffer of the pass.
+void QVLTMSERExtractor::detectSeeds(const bool negate)
+{
+    Pass &pass = negate? passMinus: passPlus;
+
+    const uInt cols = seedImage.getCols(), rows = seedImage.getRows(), step = seedImage.getStep();
+    const uChar *data = seedImage.getReadData();
+    const uChar mask = negate? 0xFF: 0x00;
+
+    // Copy image to working buffer, clearing the least significant bit (visited pixel mask), and get its histogram:
+    pass.buffer.resize(cols * rows);
+    pass.histogram.fill(0, 256);
+    uChar *pimage = pass.buffer.data();
+    int *histogram = pass.histogram.data();
+    for(uInt row = 0; row < rows; row++)
+        for(uInt col = 0; col < cols; col++) {
+            const uChar value = (data[row*step + col] ^ mask) & 0xFE;
+            pimage[row*cols + col] = value;
+            histogram[value]++;
+        }
+
+    pass.boundary.resize(cols, rows);
+    pass.boundary.initHeap(pass.histogram);
+
+    pass.stack.parameters.minArea = minArea/(downscaling*downscaling);
+    pass.stack.parameters.maxArea = maxArea/(downscaling*downscaling);
+    pass.stack.parameters.delta = delta;
+    pass.stack.parameters.delta_threshold = delta_threshold;
+
+    processLTMSER(pimage, cols, rows, pass.boundary, pass.stack);
+
+    QList<QVMSER> &mser_list = negate? msersMinus: msersPlus;
+    mser_list.clear();
     if(downscaling != 1) {
-        foreach(QVMSER mser, QVLtmserComponent::theSeedList.values()) {
-            int tx=downscaling*mser.seed.x(), ty=downscaling*mser.seed.y();
-            int minvalue = input_image(tx,ty);
+        // Rescale seeds back to the original size, moving each one to the darkest pixel of its cell:
+        const uChar *inputData = input.getReadData();
+        const uInt inputStep = input.getStep();
+        foreach(QVMSER mser, pass.stack.seedList.values()) {
+            uInt tx=downscaling*mser.seed.x(), ty=downscaling*mser.seed.y();
+            int minvalue = inputData[ty*inputStep + tx] ^ mask;
             for(unsigned int i=0;i<downscaling;i++) {
                 for(unsigned int j=0;j<downscaling;j++) {
-                    if(tx+i>=input_image.getCols() or ty+j>=input_image.getRows())
+                    if(tx+i>=input.getCols() or ty+j>=input.getRows())
                         continue;
-                    if(input_image(tx+i,ty+j)<minvalue) {
-                        minvalue = input_image(tx+i,ty+j);
+                    if((inputData[(ty+j)*inputStep + tx+i] ^ mask)<minvalue) {
+                        minvalue = inputData[(ty+j)*inputStep + tx+i] ^ mask;
                         tx = tx+i;
                         ty = ty+j;
                     }
@@ -217,11 +258,98 @@ QList<QVMSER> getLTMSER(QVImage< uChar > &input_image,
                                            mser.area*downscaling*downscaling));
         }
     } else {
-        mser_list = QVLtmserComponent::theSeedList.values();
+        mser_list = pass.stack.seedList.values();
+    }
+
+    // Contours of MSER+ regions are obtained from the negated input image:
+    if(not negate and contoursRequested)
+        Not(input, negatedInput);
+}
+
+// Obtains the contours for a range of seeds. Seeds of MSER+ regions are numbered first, then those of MSER- regions.
+void QVLTMSERExtractor::extractContours(const int first, const int last)
+{
+    const int numPlus = msersPlus.size();
+    for(int i = first; i < last; i++)
+        if (i < numPlus) {
+            const QVMSER &mser = msersPlus.at(i);
+            contours[i] = getConnectedSetBorderContourThreshold(negatedInput, mser.seed, 255-mser.threshold);
+        } else {
+            const QVMSER &mser = msersMinus.at(i - numPlus);
+            contours[i] = getConnectedSetBorderContourThreshold(input, mser.seed, 255-mser.threshold);
+        }
+}
+
+int QVLTMSERExtractor::detect(const QVImage<uChar> &input_image, const Polarity polarity, const bool computeContours)
+{
+    input = input_image;
+    input.resetROI();
+    contoursRequested = computeContours;
+
+    if(downscaling != 1) {
+        const uInt cols = input.getCols()/downscaling, rows = input.getRows()/downscaling;
+        if (seedImage.getCols() != cols or seedImage.getRows() != rows)
+            seedImage = QVImage<uChar>(cols, rows);
+        Resize(input, seedImage);
+    } else {
+        seedImage = input;
     }
 
+    msersPlus.clear();
+    msersMinus.clear();
+    contoursPlus.clear();
+    contoursMinus.clear();
+
+    // When both polarities are requested, MSER- seeds are obtained in the global thread pool, while the calling
+    // thread obtains MSER+ seeds (and the negated input image for their contours):
+    if (polarity == Both) {
+        LTMSERSeedsTask task(*this);
+        qvParallelRanges(task, 2, 2);
+    } else
+        detectSeeds(polarity == Minus);
+
+    const int numSeeds = msersPlus.size() + msersMinus.size();
+    if (not computeContours)
+        return numSeeds;
+
+    const int maxThreads = (numThreads > 0)? numThreads: QThread::idealThreadCount(),
+              ranges = MAX(1, MIN(maxThreads, numSeeds / LTMSER_MIN_SEEDS_PER_THREAD));
+
+    contours.resize(numSeeds);
+
+    LTMSERContoursTask task(*this);
+    qvParallelRanges(task, numSeeds, ranges);
+
+    const int numPlus = msersPlus.size();
+    for(int i = 0; i < numSeeds; i++)
+        if (i < numPlus)
+            contoursPlus.append(contours[i]);
+        else
+            contoursMinus.append(contours[i]);
+    contours.clear();
+
+    return numSeeds;
+}
+
+// Extractors used by getLTMSER in each thread:
+static QThreadStorage<QVLTMSERExtractor *> ltmserExtractors;
+
+// Linear-Time MSER fuction to get the list of seeds:
+QList<QVMSER> getLTMSER(QVImage< uChar > &input_image,
+                        const int minArea, const int maxArea, const int delta,
+                        const float delta_threshold, const unsigned int downscaling)
+{
+    // Each thread keeps its own extractor between calls, so its structures are only reallocated when the image
+    // size grows:
+    if (not ltmserExtractors.hasLocalData())
+        ltmserExtractors.setLocalData(new QVLTMSERExtractor());
+    QVLTMSERExtractor &extractor = *ltmserExtractors.localData();
+
+    extractor.setParameters(minArea, maxArea, delta, delta_threshold, downscaling);
+    extractor.detect(input_image, QVLTMSERExtractor::Plus, false);
+
     // Return seeds:
-    return mser_list;
+    return extractor.getMSERPlus();
 }
 
 // Function to get MSER contours from seeds, using IPP floodfill on input image:
@@ -25,15 +25,19 @@
 #ifndef QVLTMSER_H
 #define QVLTMSER_H
 
+#include <QVector>
+#include <QVImage>
 #include <QVPolyline>
 #include <QVMSER>
+#include <qvltmser/qvltmser_ds.h>
 
 /*!
 @brief Obtains the MSER (linear time MSER) contours from a QVImage<uChar>.
 
 The obtained MSER are in fact only the MSER+ (regions darker than background). If you want to
 detect MSER- regions, you should manually negate the input image (using Not function, for example),
-and calling again this function. Besides the typical parameters (minArea, maxArea, delta and
+and calling again this function, or use the @ref QVLTMSERExtractor class, which obtains both kinds of regions
+concurrently. Besides the typical parameters (minArea, maxArea, delta and
 delta_threshold; see paper), the last parameter to this function allows to downscale the input image
 used to obtain the (intermediate) MSER seeds, though the final seed position values are returned
 rescaled back to the original size. This can be used to accelerate seed extraction (of course at the
@@ -104,4 +108,119 @@ corresponding to a list of given QVMSER structures.
 */
 QList<QVPolyline> getLTMSERContours(QVImage< uChar > &input_image,QList<QVMSER> mser_list);
 
+/*!
+@class QVLTMSERExtractor qvltmser/qvltmser.h
+@brief Persistent linear time MSER extractor, for MSER+ and MSER- regions.
+
+This class obtains the same regions as the functions @ref getLTMSER and @ref getLTMSERContours, but keeps its
+boundary heaps and component stacks between calls, so processing a video sequence does not allocate memory for each
+new frame (as long as the frame size does not grow).
+
+Besides, the MSER+ regions (darker than background) and the MSER- regions (brighter than background) can be
+obtained from the same input image, without negating it manually. When both are requested, each one is computed
+in a different thread of the global thread pool. The contours of the regions are then obtained in parallel, splitting
+the list of seeds between several threads.
+
+The following code shows an example usage:
+
+@code
+QVLTMSERExtractor extractor(20, 100000, 15, 0.03);
+while(...)
+    {
+    extractor.detect(image, QVLTMSERExtractor::Both);
+    const QList<QVPolyline> &darkContours = extractor.getContoursPlus(),
+                            &brightContours = extractor.getContoursMinus();
+    ...
+    }
+@endcode
+
+The downscaling parameter has the same meaning as in the @ref getLTMSER function: seeds are obtained from the
+downscaled image, but the contours are obtained from the original image.
+
+@ingroup qvmser
+*/
+class QVLTMSERExtractor {
+    public:
+        /// @brief Kinds of regions detected.
+        enum Polarity {
+            /// Only MSER+ regions (darker than background).
+            Plus = 1,
+            /// Only MSER- regions (brighter than background).
+            Minus = 2,
+            /// Both MSER+ and MSER- regions.
+            Both = 3
+        };
+
+        /// @brief Constructs an extractor.
+        /// @param minArea Minimum area for each MSER.
+        /// @param maxArea Maximal area for each MSER.
+        /// @param delta Delta value for MSER algorithm (see paper).
+        /// @param delta_threshold Delta threshold value for MSER algorithm.
+        /// @param downscaling Initial scaling performed of input image; by default, no downscaling is performed
+        QVLTMSERExtractor(const int minArea=20, const int maxArea=100000,
+                          const int delta=15, const float delta_threshold=0.03,
+                          const unsigned int downscaling=1);
+
+        /// @brief Changes the parameters of the extractor.
+        ///
+        /// See the constructor for the meaning of the parameters.
+        void setParameters(const int minArea, const int maxArea, const int delta, const float delta_threshold,
+                           const unsigned int downscaling=1);
+
+        /// @brief Sets the maximal number of threads used to obtain the contours of the regions.
+        /// @param value number of threads. A value of zero uses QThread::idealThreadCount().
+        void setNumThreads(const int value)                 { numThreads = value; }
+
+        /// @brief Obtains the MSER regions of an image.
+        /// @param input_image Image to obtain MSERs from.
+        /// @param polarity Kind of regions to detect.
+        /// @param computeContours If false, only the seeds of the regions are obtained.
+        /// @returns Number of regions detected.
+        int detect(const QVImage<uChar> &input_image, const Polarity polarity = Plus, const bool computeContours = true);
+
+        /// @brief MSER+ regions obtained in the last call to @ref detect.
+        const QList<QVMSER> & getMSERPlus() const           { return msersPlus; }
+
+        /// @brief MSER- regions obtained in the last call to @ref detect.
+        ///
+        /// The threshold of these regions refers to the negated image, as if it were obtained calling @ref getLTMSER
+        /// with the negated input image.
+        const QList<QVMSER> & getMSERMinus() const          { return msersMinus; }
+
+        /// @brief Contours of the MSER+ regions obtained in the last call to @ref detect.
+        const QList<QVPolyline> & getContoursPlus() const   { return contoursPlus; }
+
+        /// @brief Contours of the MSER- regions obtained in the last call to @ref detect.
+        const QList<QVPolyline> & getContoursMinus() const  { return contoursMinus; }
+
+    #ifndef DOXYGEN_IGNORE_THIS
+        void detectSeeds(const bool negate);
+        void extractContours(const int first, const int last);
+    #endif // DOXYGEN_IGNORE_THIS
+
+    private:
+        // Structures used to obtain the regions of one polarity. They are kept between calls to detect().
+        class Pass {
+            public:
+                Pass(): boundary(0, 0, 256), stack(256), histogram(256)  { }
+                QVLtmserBoundary boundary;
+                QVLtmserComponentStack stack;
+                QVector<uChar> buffer;
+                QVector<int> histogram;
+        };
+
+        int minArea, maxArea, delta;
+        float delta_threshold;
+        unsigned int downscaling;
+        int numThreads;
+        bool contoursRequested;
+
+        QVImage<uChar> input, seedImage, negatedInput;
+        Pass passPlus, passMinus;
+
+        QList<QVMSER> msersPlus, msersMinus;
+        QList<QVPolyline> contoursPlus, contoursMinus;
+        QVector<QVPolyline> contours;
+};
+
 #endif
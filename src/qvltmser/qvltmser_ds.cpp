@@ -22,31 +22,40 @@
 /// @brief File from the QVision library.
 /// @author PARP Research Group. University of Murcia, Spain.
 
+#include <string.h>
+
 #include <QVImageCanvas>
 #include <qvltmser/qvltmser_ds.h>
 
 QVLtmserBoundary::QVLtmserBoundary(uInt pWidth, uInt pHeight, uInt pGreyLevels)
 {
-    width = pWidth;
-    height = pHeight;
+    width = 0;
+    height = 0;
+    numPixels = 0;
     greyLevels = pGreyLevels;
     if (greyLevels == 0)
         greyLevels = 256;
-    if (greyLevels > 0 && width >0 && height > 0)
-        numPixels = width * height;
-    else
-        numPixels = 0;
     maxStackPr = 9999;
-    heap = QVector<uInt>(numPixels,0);
     stackLength = QVector<int>(greyLevels,0);
     stackStart = QVector<int>(greyLevels,-1);
+    resize(pWidth, pHeight);
 }
 
-void QVLtmserBoundary::initHeap(QVector<int> &histogram)
+void QVLtmserBoundary::resize(uInt pWidth, uInt pHeight)
+{
+    width = pWidth;
+    height = pHeight;
+    if (width > 0 && height > 0)
+        numPixels = width * height;
+    else
+        numPixels = 0;
+    if ((uInt)heap.size() < numPixels)
+        heap = QVector<uInt>(numPixels,0);
+}
+
+void QVLtmserBoundary::initHeap(const QVector<int> &histogram)
 {
     int index = 0;
-    /*for (uInt i = 0; i<numPixels; i++)
-        heap[i] = 0; */
     for (uInt i = 0; i < greyLevels; i++) {
         if (histogram[i] > 0) {
             stackStart[i] = index;
@@ -72,16 +81,16 @@ bool QVLtmserBoundary::popPixel(uInt greyLevel, uInt &pixel)
         stackLength[greyLevel]--;
         pixel = heap[stackStart[greyLevel] + stackLength[greyLevel]];
         if (stackLength[greyLevel] == 0)
-            maxStackPr = getMaxStackPr();
+            maxStackPr = getMaxStackPr(greyLevel+1);
         return true;
     } else
         return false;
 }
 
-int QVLtmserBoundary::getMaxStackPr()
+int QVLtmserBoundary::getMaxStackPr(uInt fromGreyLevel)
 {
     int resp = -1;
-    for (uInt i=0; i < greyLevels; i++) {
+    for (uInt i=fromGreyLevel; i < greyLevels; i++) {
         if (stackLength[i] > 0) {
             resp = i;
             break;
@@ -90,28 +99,24 @@ int QVLtmserBoundary::getMaxStackPr()
     return resp;
 }
 
-QHash<QPoint,QVMSER> QVLtmserComponent::theSeedList;
-uInt QVLtmserComponent::minArea;
-uInt QVLtmserComponent::maxArea;
-uChar QVLtmserComponent::delta;
-float QVLtmserComponent::delta_threshold;
-
-QVLtmserComponent::QVLtmserComponent(uInt pGreyLevel)
+QVLtmserComponent::QVLtmserComponent()
 {
-    greyLevel = pGreyLevel;
-    greyLevelMin = greyLevel;
+    greyLevel = 0;
+    greyLevelMin = 0;
+    seedX = 0;
+    seedY = 0;
     numPixels = 0;
-    history = new QVector<uInt>(256,0);
-    countRefsHistory = 1;
+    history = NULL;
 }
 
-QVLtmserComponent::~QVLtmserComponent()
+void QVLtmserComponent::init(uInt pGreyLevel, uInt r, uInt c, uInt *pHistory)
 {
-    countRefsHistory--;
-    if(countRefsHistory == 0) {
-        testMSER();
-        delete history;
-    }
+    greyLevel = pGreyLevel;
+    greyLevelMin = greyLevel;
+    numPixels = 0;
+    history = pHistory;
+    memset(history, 0, 256 * sizeof(uInt));
+    setSeed(r,c);
 }
 
 void QVLtmserComponent::setSeed(uInt r, uInt c)
@@ -124,25 +129,25 @@ void QVLtmserComponent::addPixel(uChar pGreyLevel)
 {
     numPixels++;
     greyLevel = pGreyLevel;
-    (*history)[greyLevel]++;
+    history[greyLevel]++;
 }
 
-void QVLtmserComponent::testMSER()
+void QVLtmserComponent::testMSER(const QVLtmserParameters &parameters, QHash<QPoint,QVMSER> &seedList) const
 {
-    uInt hist_acum[256],acum=0,val/*,i2*/;
-    float /*dif,*/merit[256];
+    uInt hist_acum[256],acum=0,val;
+    float merit[256];
+    const int delta = parameters.delta;
 
     // Compute accumulated histogram of component, from history (which was incremental):
-    for(uChar i=greyLevelMin;i<=greyLevel;i++) {
-        if ((val=(*history)[i]) != 0)
+    for(int i=greyLevelMin;i<=greyLevel;i++) {
+        if ((val=history[i]) != 0)
             acum += val;
         hist_acum[i] = acum;
     }
 
-
     float min = 1E10;
     int indmin = -1;
-    for(uChar i=greyLevelMin+delta;i<=greyLevel-delta;i++) {
+    for(int i=greyLevelMin+delta;i<=greyLevel-delta;i++) {
         merit[i] = ((float)hist_acum[i+delta] - (float)hist_acum[i-delta]) / (float)hist_acum[i];
         if(merit[i]<min) {
             min = merit[i];
@@ -153,13 +158,13 @@ void QVLtmserComponent::testMSER()
     if(indmin == -1)
         return;
 
-    if (min <= delta_threshold) {
+    if (min <= parameters.delta_threshold) {
             uInt area_mser = hist_acum[indmin];
-            if(area_mser >= minArea and area_mser <= maxArea) {
-                if(theSeedList.contains(QPoint(seedX,seedY)))
-                    if(theSeedList[QPoint(seedX,seedY)].merit < min)
+            if(area_mser >= parameters.minArea and area_mser <= parameters.maxArea) {
+                if(seedList.contains(QPoint(seedX,seedY)))
+                    if(seedList[QPoint(seedX,seedY)].merit < min)
                         return;
-                theSeedList[QPoint(seedX,seedY)] = QVMSER(seedX,seedY,indmin,min,area_mser);
+                seedList[QPoint(seedX,seedY)] = QVMSER(seedX,seedY,indmin,min,area_mser);
             }
      }
 }
@@ -172,12 +177,11 @@ void QVLtmserComponent::upGreyLevel(uInt newGreyLevel)
 void QVLtmserComponent::addComponent(QVLtmserComponent &otherComponent, uInt newlevel)
 {
     for(int i=otherComponent.greyLevelMin;i<=otherComponent.greyLevel;i++) {
-        (*history)[i] += (*otherComponent.history)[i];
+        history[i] += otherComponent.history[i];
     }
    // We set graylevel of the component to delete (other) to the same as the other one (for it to be taken
    // into account when testing for MSER before deletion);
    otherComponent.greyLevel = greyLevel-1;
-   // (*history)[greyLevel] += otherComponent.numPixels;
    // Finally, we update number of pixels, grayLevelMin and seed coordinates:
    numPixels += otherComponent.numPixels;
    if (otherComponent.greyLevelMin < greyLevelMin) {
@@ -187,89 +191,42 @@ void QVLtmserComponent::addComponent(QVLtmserComponent &otherComponent, uInt new
    }
 
    greyLevel = newlevel;
-
-
-
-
-
-/*   uInt cur_size = (*history)[greyLevel];
-   // The current component (this) is the second from the stack. The otherComponent is in the top of the
-   // stack. We consider current component total number of pixel minus the ones at the current gray level.
-   // If the other component (on top of stack, and which does not contain that current gray level) has more
-   // pixels, then before deleting the "absorbed" component (current one), we test for MSERs, and "inherit" the
-   // other component's history; otherwise, the absorbed component will be the other, and it will be tested for
-   // MSERs in its posterior deletion (theQVLtmserComponentStack.popComponent()). In both cases, we conveniently
-   // update history:
-
-    if (otherComponent.numPixels > numPixels-cur_size) {
-        // Test for MSER before deleting absorbed component (this), without having into account current greyLevel:
-        greyLevel--;
-        testMSER();
-        greyLevel++;
-        // Finally we delete history, and continue with the other one:
-        delete history;
-        history = otherComponent.history;
-        otherComponent.countRefsHistory++;
-        (*history)[greyLevel] += numPixels;
-    } else {
-        // We set graylevel of the component to delete (other) to the same as the other one (for it to be taken
-        // into account when testing for MSER before deletion);
-        otherComponent.greyLevel = greyLevel-1;
-        (*history)[greyLevel] += otherComponent.numPixels;
-    }
-    // Finally, we update number of pixels, grayLevelMin and seed coordinates:
-    numPixels += otherComponent.numPixels;
-    if (otherComponent.greyLevelMin < greyLevelMin) {
-        greyLevelMin = otherComponent.greyLevelMin;
-        seedX = otherComponent.seedX;
-        seedY = otherComponent.seedY;
-    }*/
 };
 
 QVLtmserComponentStack::QVLtmserComponentStack(uInt pGreyLevels)
 {
     greyLevels = pGreyLevels;
     posTop = -1;
-    components = new QVector< QVLtmserComponent *>(greyLevels,NULL);
-}
-
-QVLtmserComponentStack::~QVLtmserComponentStack()
-{
-    (*components).clear();
-    delete components;
+    components = QVector<QVLtmserComponent>(greyLevels);
+    histories = QVector<uInt>(greyLevels * 256, 0);
+    parameters.minArea = 0;
+    parameters.maxArea = 0;
+    parameters.delta = 0;
+    parameters.delta_threshold = 0.0;
 }
 
 void QVLtmserComponentStack::initComponents()
 {
-    for (uInt i = 0; i < greyLevels; i++)
-        if ((*components)[i] != NULL) {
-            delete (*components)[i];
-            (*components)[i] = NULL;
-        }
     posTop = -1;
+    seedList.clear();
 }
 
 void QVLtmserComponentStack::pushComponent(uInt aGreyLevel, int r, int c)
 {
-    QVLtmserComponent *aComponent;
     if (posTop != -1)
-        if(aGreyLevel >= (*components)[posTop]-> greyLevel) {
+        if(aGreyLevel >= components[posTop].greyLevel) {
             qFatal("Error in QVLtmserComponentStack::pushComponent");
         }
-    aComponent = new QVLtmserComponent(aGreyLevel);
-    aComponent->setSeed(r,c);
     posTop++;
-    (*components)[posTop] = aComponent;
+    components[posTop].init(aGreyLevel, r, c, histories.data() + 256 * posTop);
 }
 
 void QVLtmserComponentStack::popComponent()
 {
     if (posTop == -1)
         qFatal("Error in QVLtmserComponentStack::popComponent");
-    QVLtmserComponent *component = (*components)[posTop];
-    (*components)[posTop] = NULL;
+    components[posTop].testMSER(parameters, seedList);
     posTop--;
-    delete component;
 }
 
 int QVLtmserComponentStack::getPosTop()
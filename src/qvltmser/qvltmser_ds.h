@@ -27,8 +27,17 @@
 
 #include <QVImage>
 #include <QVector>
+#include <QHash>
 #include <QVMSER>
 
+// Parameters of the MSER stability test:
+struct QVLtmserParameters {
+    uInt minArea;
+    uInt maxArea;
+    uChar delta;
+    float delta_threshold;
+};
+
 // Class for boundary pixels (it is a priority queue of stacks, with high priority for darker gray levels:
 class QVLtmserBoundary {
   public:
@@ -40,8 +49,11 @@ class QVLtmserBoundary {
     // * pWidth, pHeight: image dimensions.
     QVLtmserBoundary(uInt pWidth, uInt pHeight, uInt pGreyLevels);
 
+    // Change image dimensions (the heap is only reallocated if the number of pixels grows):
+    void resize(uInt pWidth, uInt pHeight);
+
     // Heap initialization:
-    void initHeap(QVector< int > &histogram);
+    void initHeap(const QVector< int > &histogram);
 
     // Push a new pixel in boundary, for a given gray level:
     void pushPixel(uInt greyLevel, uInt pixel);
@@ -71,18 +83,16 @@ class QVLtmserBoundary {
     // Note: Coordinates of pixels have been previously transformed to ints (int_value=(y*num_cols)+x).
     QVector<uInt> heap;
 
-    // Get index of stack with greater priority (-1 if heap is empty)
-    int getMaxStackPr();
+    // Get index of stack with greater priority, starting from a given gray level (-1 if heap is empty). Pixels
+    // are only popped from the stack with maximum priority, so every stack below it is always empty:
+    int getMaxStackPr(uInt fromGreyLevel);
 };
 
 // Class for each individual component of the component stack:
 class QVLtmserComponent {
   public:
     // Constructor:
-    QVLtmserComponent(uInt pGreyLevel);
-
-    // Destructor.
-    ~QVLtmserComponent();
+    QVLtmserComponent();
 
     // Current and minimum gray levels of component:
     uChar greyLevel, greyLevelMin;
@@ -93,15 +103,11 @@ class QVLtmserComponent {
     // Number of pixels that the component has in the current grayLevel:
     uInt numPixels;
 
-    // History of areas of the component:
-    QVector<uInt> *history;
+    // History of areas of the component (256 gray levels, stored in the buffer of the component stack):
+    uInt *history;
 
-    // Static class members: pointer to result seed list and algorithm parameters:
-    static QHash<QPoint,QVMSER> theSeedList;
-    static uInt minArea;
-    static uInt maxArea;
-    static uChar delta;
-    static float delta_threshold;
+    // Initialize component for a new gray level and seed, using (and clearing) the given history buffer:
+    void init(uInt pGreyLevel, uInt r, uInt c, uInt *pHistory);
 
     // Set seed of component:
     void setSeed(uInt r, uInt c);
@@ -109,32 +115,27 @@ class QVLtmserComponent {
     // Add a new pixel to component:
     void addPixel(uChar pGreyLevel);
 
-    // Test if component is a MSER:
-    void testMSER();
-                   
+    // Test if component is a MSER, storing it in the seed list if so:
+    void testMSER(const QVLtmserParameters &parameters, QHash<QPoint,QVMSER> &seedList) const;
+
     // Raise gray level to "newGreyLevel", updating variables "greyLevel" and "numPixels", and history of component:
     void upGreyLevel(uInt newGreyLevel);
 
     // Add another component to this component:
     void addComponent(QVLtmserComponent &otherComponent, uInt newlevel);
-
-    private:
-    // Reference counter to history (to delete it in destructor when counter reaches zero):
-    uInt countRefsHistory;
 };
 
-// Class for component stack:
+// Class for component stack. Components and their histories are preallocated for every position of the stack,
+// so the same stack can be reused for several images without allocating memory:
 class QVLtmserComponentStack {
   public:
     // Constructor:
     // * pGreyLevels: Number of possible gray levels:
     QVLtmserComponentStack(uInt pGreyLevels);
 
-    // Destructor:
-    ~QVLtmserComponentStack();
-
-    // Components of stack are stored as pointers in a vector:
-    QVector<QVLtmserComponent*> *components;
+    // Parameters of the MSER test, and resulting seed list:
+    QVLtmserParameters parameters;
+    QHash<QPoint,QVMSER> seedList;
 
     // Initialize component stack:
     void initComponents();
@@ -143,12 +144,15 @@ class QVLtmserComponentStack {
     // was until now in the top):
     void pushComponent(uInt aGreyLevel, int r, int c);
 
-    // Pop and destroy the component in the top of the stack:
+    // Pop the component in the top of the stack, testing it for MSER:
     void popComponent();
 
     // Get index in vector corresponding to top (returns -1 if empty):
     int getPosTop();
 
+    // Get component at a given position of the stack:
+    QVLtmserComponent &component(int pos)    { return components[pos]; }
+
   protected:
 
     // Number of gray levels:
@@ -156,6 +160,10 @@ class QVLtmserComponentStack {
 
     // Position of top in "components". If empty, posTop=-1:
     int posTop;
+
+    // Components of the stack, and their histories (256 values for each position of the stack):
+    QVector<QVLtmserComponent> components;
+    QVector<uInt> histories;
 };
 
 #endif
@@ -38,6 +38,11 @@
                 $$PWD/qvmath/qvvector.h              \
                 $$PWD/qvmath/qvcomplex.h             \
                 $$PWD/qvmath/qvsparseblockmatrix.h   \
+                $$PWD/qvmath/qvbsrmatrix.h           \
+                $$PWD/qvmath/qvconjugategradientsolver.h \
+                $$PWD/qvmath/qvfixedmatrix.h         \
+                $$PWD/qvmath/qvmatrixexpression.h    \
+                $$PWD/qvmath/qvbatcheddecomposition.h \
                 $$PWD/qvmath/qvquaternion.h          \
                 $$PWD/qvmath/qv2dmap.h               \
                 $$PWD/qvmath/qvfunction.h            \
@@ -45,6 +50,9 @@
                 $$PWD/qvmath/qvcombinationiterator.h \
                 $$PWD/qvmath/qvvectormap.h           \
                 $$PWD/qvmath/qvsampleconsensus.h     \
+                $$PWD/qvmath/qvparallelsampleconsensus.h \
+                $$PWD/qvmath/qvparallelranges.h      \
+                $$PWD/qvmath/qvpointfmatchingset.h   \
                 $$PWD/qvmath/qvnumericalanalysis.h   \
                 $$PWD/qvmath/qv3dpointf.h            \
                 $$PWD/qvmath/qv3dpolylinef.h         \
@@ -56,9 +64,12 @@
                 $$PWD/qvmath/qvrationalnumber.cpp      \
                 $$PWD/qvmath/qvblasdatabuffer.cpp      \
                 $$PWD/qvmath/qvmatrix.cpp              \
+                $$PWD/qvmath/qvmatrixexpression.cpp    \
                 $$PWD/qvmath/qvvector.cpp              \
                 $$PWD/qvmath/qvcomplex.cpp             \
                 $$PWD/qvmath/qvsparseblockmatrix.cpp   \
+                $$PWD/qvmath/qvconjugategradientsolver.cpp \
+                $$PWD/qvmath/qvbatcheddecomposition.cpp \
                 $$PWD/qvmath/qvquaternion.cpp          \
                 $$PWD/qvmath/qv2dmap.cpp               \
                 $$PWD/qvmath/qvfunction.cpp            \
@@ -66,6 +77,8 @@
                 $$PWD/qvmath/qvcombinationiterator.cpp \
                 $$PWD/qvmath/qvvectormap.cpp           \
                 $$PWD/qvmath/qvsampleconsensus.cpp     \
+                $$PWD/qvmath/qvparallelsampleconsensus.cpp \
+                $$PWD/qvmath/qvpointfmatchingset.cpp \
                 $$PWD/qvmath/qvnumericalanalysis.cpp   \
                 $$PWD/qvmath/qvdirectedgraph.cpp       \
                 $$PWD/qvmath/qvbitcount.cpp
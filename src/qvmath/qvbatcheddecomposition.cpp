@@ -0,0 +1,334 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <iostream>
+#include <cmath>
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVarLengthArray>
+
+#include <qvmath/qvbatcheddecomposition.h>
+
+// Number of matrices decomposed simultaneously by the Jacobi kernels. Their elements are interleaved, so the
+// innermost loops of the kernels run over the lanes, and can be vectorized by the compiler.
+#define QVBATCH_LANES					4
+
+// Maximal number of sweeps of the cyclic Jacobi method. Convergence is quadratic, so few sweeps are usually needed.
+#define QVBATCH_MAX_SWEEPS				24
+
+// Minimal number of matrices for each thread. Smaller batches do not pay the synchronization of the threads.
+#define QVBATCH_MIN_MATRICES_PER_THREAD	256
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Description of a batch of problems. If 'rows' is zero, the input matrices are the symmetric size x size matrices
+// to decompose. Otherwise, they are rows x size matrices A, and the decomposed matrices are the products A^T A.
+class QVBatchedProblem
+    {
+    public:
+        int size, rows;
+        const double *matrices;
+        double *eigenvalues, *eigenvectors, *nullVectors;
+        bool singularValues;
+    };
+
+// Decomposes the matrices of the problem from 'first' to 'first + lanes - 1' (lanes <= QVBATCH_LANES).
+// The template parameter N is the size of the matrices, or zero for sizes without a specialized kernel.
+template <int N> static void jacobiEigenGroup(const QVBatchedProblem &problem, const int first, const int lanes)
+    {
+    const int n = (N > 0)? N: problem.size, W = QVBATCH_LANES;
+    const bool computeVectors = (problem.eigenvectors != NULL) or (problem.nullVectors != NULL);
+
+    // Element (i,j) of the matrix in lane l is stored at position (i*n + j)*W + l.
+    QVarLengthArray<double, 9*9*QVBATCH_LANES> S(n*n*W), V(n*n*W);
+
+    // Load the matrices. Unused lanes are filled with the identity, which needs no rotations.
+    for(int i = 0; i < n; i++)
+        for(int j = 0; j < n; j++)
+            for(int l = 0; l < W; l++)
+                {
+                S[(i*n + j)*W + l] = (i == j)? 1.0: 0.0;
+                V[(i*n + j)*W + l] = (i == j)? 1.0: 0.0;
+                }
+
+    for(int l = 0; l < lanes; l++)
+        if (problem.rows == 0)
+            {
+            const double *m = problem.matrices + (first + l) * n * n;
+            for(int i = 0; i < n*n; i++)
+                S[i*W + l] = m[i];
+            }
+        else
+            {
+            const int rows = problem.rows;
+            const double *a = problem.matrices + (first + l) * rows * n;
+            for(int i = 0; i < n; i++)
+                for(int j = i; j < n; j++)
+                    {
+                    double accum = 0.0;
+                    for(int r = 0; r < rows; r++)
+                        accum += a[r*n + i] * a[r*n + j];
+                    S[(i*n + j)*W + l] = S[(j*n + i)*W + l] = accum;
+                    }
+            }
+
+    for(int sweep = 0; sweep < QVBATCH_MAX_SWEEPS; sweep++)
+        {
+        // Stop when the off-diagonal elements of every lane are negligible.
+        double offDiagonal[QVBATCH_LANES], diagonal[QVBATCH_LANES];
+        for(int l = 0; l < W; l++)
+            offDiagonal[l] = diagonal[l] = 0.0;
+        for(int p = 0; p < n; p++)
+            {
+            for(int l = 0; l < W; l++)
+                diagonal[l] += S[(p*n + p)*W + l] * S[(p*n + p)*W + l];
+            for(int q = p+1; q < n; q++)
+                for(int l = 0; l < W; l++)
+                    offDiagonal[l] += S[(p*n + q)*W + l] * S[(p*n + q)*W + l];
+            }
+
+        bool converged = true;
+        for(int l = 0; l < W; l++)
+            if (offDiagonal[l] > 1e-30 * diagonal[l])
+                converged = false;
+        if (converged)
+            break;
+
+        for(int p = 0; p < n; p++)
+            for(int q = p+1; q < n; q++)
+                {
+                // Rotation annihilating the element (p,q) in each lane:
+                //	t = 2 S(p,q) sign(S(q,q) - S(p,p)) / ( |S(q,q) - S(p,p)| + sqrt( (S(q,q) - S(p,p))^2 + 4 S(p,q)^2 ) )
+                // This form has no division by zero when S(p,q) is zero, so there are no branches in the lanes.
+                double c[QVBATCH_LANES], s[QVBATCH_LANES];
+                for(int l = 0; l < W; l++)
+                    {
+                    const double	apq = S[(p*n + q)*W + l],
+                                    difference = S[(q*n + q)*W + l] - S[(p*n + p)*W + l],
+                                    denominator = fabs(difference) + sqrt(difference * difference + 4.0 * apq * apq),
+                                    t = (denominator > 0.0)? 2.0 * apq * ((difference >= 0.0)? 1.0: -1.0) / denominator: 0.0;
+                    c[l] = 1.0 / sqrt(t * t + 1.0);
+                    s[l] = t * c[l];
+                    }
+
+                for(int k = 0; k < n; k++)
+                    for(int l = 0; l < W; l++)
+                        {
+                        double &skp = S[(k*n + p)*W + l], &skq = S[(k*n + q)*W + l];
+                        const double kp = skp, kq = skq;
+                        skp = c[l] * kp - s[l] * kq;
+                        skq = s[l] * kp + c[l] * kq;
+                        }
+
+                for(int k = 0; k < n; k++)
+                    for(int l = 0; l < W; l++)
+                        {
+                        double &spk = S[(p*n + k)*W + l], &sqk = S[(q*n + k)*W + l];
+                        const double pk = spk, qk = sqk;
+                        spk = c[l] * pk - s[l] * qk;
+                        sqk = s[l] * pk + c[l] * qk;
+                        }
+
+                if (computeVectors)
+                    for(int k = 0; k < n; k++)
+                        for(int l = 0; l < W; l++)
+                            {
+                            double &vkp = V[(k*n + p)*W + l], &vkq = V[(k*n + q)*W + l];
+                            const double kp = vkp, kq = vkq;
+                            vkp = c[l] * kp - s[l] * kq;
+                            vkq = s[l] * kp + c[l] * kq;
+                            }
+                }
+        }
+
+    // Store the results, sorting the eigenvalues in decreasing order.
+    QVarLengthArray<int, 9> order(n);
+    for(int l = 0; l < lanes; l++)
+        {
+        for(int i = 0; i < n; i++)
+            order[i] = i;
+        for(int i = 0; i < n; i++)
+            for(int j = i+1; j < n; j++)
+                if (S[(order[j]*n + order[j])*W + l] > S[(order[i]*n + order[i])*W + l])
+                    qSwap(order[i], order[j]);
+
+        const int problemIndex = first + l;
+        if (problem.eigenvalues != NULL)
+            for(int i = 0; i < n; i++)
+                {
+                const double lambda = S[(order[i]*n + order[i])*W + l];
+                problem.eigenvalues[problemIndex * n + i] = problem.singularValues? sqrt(qMax(lambda, 0.0)): lambda;
+                }
+
+        if (problem.eigenvectors != NULL)
+            for(int i = 0; i < n; i++)
+                for(int j = 0; j < n; j++)
+                    problem.eigenvectors[problemIndex * n * n + i*n + j] = V[(i*n + order[j])*W + l];
+
+        if (problem.nullVectors != NULL)
+            for(int i = 0; i < n; i++)
+                problem.nullVectors[problemIndex * n + i] = V[(i*n + order[n-1])*W + l];
+        }
+    }
+
+typedef void (*TJacobiKernel)(const QVBatchedProblem &problem, const int first, const int lanes);
+
+static TJacobiKernel jacobiKernel(const int size)
+    {
+    switch(size)
+        {
+        case 3:		return &jacobiEigenGroup<3>;
+        case 4:		return &jacobiEigenGroup<4>;
+        case 6:		return &jacobiEigenGroup<6>;
+        case 9:		return &jacobiEigenGroup<9>;
+        default:	return &jacobiEigenGroup<0>;
+        }
+    }
+
+// Decomposes a range of the matrices of a batch, in one of the threads of the global pool.
+class QVBatchedDecompositionTask : public QRunnable
+    {
+    public:
+        QVBatchedDecompositionTask(const QVBatchedProblem &problem, const int first, const int last, QSemaphore *finished):
+            QRunnable(), problem(problem), first(first), last(last), finished(finished)	{ }
+
+        void run()
+            {
+            const TJacobiKernel kernel = jacobiKernel(problem.size);
+            for(int i = first; i < last; i += QVBATCH_LANES)
+                kernel(problem, i, qMin(QVBATCH_LANES, last - i));
+            if (finished != NULL)
+                finished->release();
+            }
+
+    private:
+        const QVBatchedProblem problem;
+        const int first, last;
+        QSemaphore *finished;
+    };
+
+static void solveBatchedProblem(const QVBatchedProblem &problem, const int count, const int numThreads)
+    {
+    if (problem.size <= 0 or count <= 0)
+        return;
+
+    const int	maxThreads = (numThreads > 0)? numThreads: QThread::idealThreadCount(),
+                threads = qMax(1, qMin(maxThreads, count / QVBATCH_MIN_MATRICES_PER_THREAD));
+
+    // Ranges of matrices start at multiples of the number of lanes.
+    const int groups = (count + QVBATCH_LANES - 1) / QVBATCH_LANES;
+
+    // The calling thread decomposes the last range, so the batch progresses even if the global pool is busy.
+    QSemaphore finished;
+    for(int t = 0; t < threads; t++)
+        {
+        const int	first = qMin(count, (groups * t / threads) * QVBATCH_LANES),
+                    last = qMin(count, (groups * (t+1) / threads) * QVBATCH_LANES);
+        if (t < threads - 1)
+            {
+            QVBatchedDecompositionTask *task = new QVBatchedDecompositionTask(problem, first, last, &finished);
+            QThreadPool::globalInstance()->start(task);
+            }
+        else
+            QVBatchedDecompositionTask(problem, first, last, NULL).run();
+        }
+    finished.acquire(threads - 1);
+    }
+#endif // DOXYGEN_IGNORE_THIS
+
+void batchedEigenDecomposition(const int size, const int count, const double *matrices, double *eigenvalues,
+                                double *eigenvectors, const int numThreads)
+    {
+    QVBatchedProblem problem;
+    problem.size = size;
+    problem.rows = 0;
+    problem.matrices = matrices;
+    problem.eigenvalues = eigenvalues;
+    problem.eigenvectors = eigenvectors;
+    problem.nullVectors = NULL;
+    problem.singularValues = false;
+
+    solveBatchedProblem(problem, count, numThreads);
+    }
+
+void batchedEigenDecomposition(const QVector<QVMatrix> &matrices, QVector<QVVector> &eigenvalues,
+                                QVector<QVMatrix> &eigenvectors, const int numThreads)
+    {
+    const int count = matrices.count(), n = (count > 0)? matrices.first().getRows(): 0;
+
+    QVector<double> input(count * n * n), values(count * n), vectors(count * n * n);
+    for(int i = 0; i < count; i++)
+        {
+        const QVMatrix &M = matrices[i];
+        if (M.getRows() != n or M.getCols() != n)
+            {
+            std::cout << "[batchedEigenDecomposition] Error: matrix " << i << " has size " << M.getRows() << "x" << M.getCols()
+                      << ", while the batch contains " << n << "x" << n << " matrices." << std::endl;
+            exit(1);
+            }
+        qCopy(M.getReadData(), M.getReadData() + n*n, input.data() + i*n*n);
+        }
+
+    batchedEigenDecomposition(n, count, input.constData(), values.data(), vectors.data(), numThreads);
+
+    eigenvalues.resize(count);
+    eigenvectors.resize(count);
+    for(int i = 0; i < count; i++)
+        {
+        eigenvalues[i] = QVVector(n, values.constData() + i*n);
+        eigenvectors[i] = QVMatrix(n, n, vectors.constData() + i*n*n);
+        }
+    }
+
+void batchedSingularValueDecomposition(const int rows, const int cols, const int count, const double *matrices,
+                                        double *singularValues, double *V, const int numThreads)
+    {
+    QVBatchedProblem problem;
+    problem.size = cols;
+    problem.rows = rows;
+    problem.matrices = matrices;
+    problem.eigenvalues = singularValues;
+    problem.eigenvectors = V;
+    problem.nullVectors = NULL;
+    problem.singularValues = true;
+
+    solveBatchedProblem(problem, count, numThreads);
+    }
+
+void batchedSolveHomogeneous(const int rows, const int cols, const int count, const double *matrices,
+                                double *solutions, const int numThreads)
+    {
+    QVBatchedProblem problem;
+    problem.size = cols;
+    problem.rows = rows;
+    problem.matrices = matrices;
+    problem.eigenvalues = NULL;
+    problem.eigenvectors = NULL;
+    problem.nullVectors = solutions;
+    problem.singularValues = true;
+
+    solveBatchedProblem(problem, count, numThreads);
+    }
@@ -0,0 +1,121 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVBATCHEDDECOMPOSITION_H
+#define QVBATCHEDDECOMPOSITION_H
+
+#include <QVector>
+#include <qvmath/qvvector.h>
+#include <qvmath/qvmatrix.h>
+
+/*!
+@brief Obtains the eigen-decomposition of a batch of small symmetric matrices.
+
+This function decomposes a set of independent symmetric matrices of the same size, stored consecutively in a single
+buffer. Each matrix \f$ M_i \f$ is decomposed as
+
+\f$ M_i = Q_i \Lambda_i Q_i^T \f$
+
+where \f$ \Lambda_i \f$ is a diagonal matrix containing the eigenvalues of \f$ M_i \f$ in decreasing order, and
+\f$ Q_i \f$ is an orthogonal matrix containing the corresponding eigenvectors in its columns (the same convention as
+the GSL version of @ref eigenDecomposition).
+
+The function is intended for large numbers of small problems (for example, one \f$ 4 \times 4 \f$ matrix for each
+point in a triangulation, or one \f$ 9 \times 9 \f$ matrix for each view pair in GEA), where calling
+@ref eigenDecomposition for each matrix is dominated by the call overhead. The matrices are decomposed with the
+cyclic Jacobi method, interleaving groups of four matrices so the rotations are evaluated with vector instructions.
+The kernels are specialized for matrices of sizes \f$ 3 \times 3 \f$, \f$ 4 \times 4 \f$, \f$ 6 \times 6 \f$ and
+\f$ 9 \times 9 \f$. The batch is split among several threads of the global thread pool.
+
+@param size Number of rows and columns of each matrix.
+@param count Number of matrices in the batch.
+@param matrices Buffer containing the count matrices, each one of them stored in row major order.
+@param eigenvalues Output buffer for the count * size eigenvalues. It can be NULL if only the eigenvectors are needed.
+@param eigenvectors Output buffer for the count matrices of eigenvectors, stored in row major order. It can be NULL
+if only the eigenvalues are needed.
+@param numThreads Maximal number of threads. The value -1 uses the ideal number of threads for the system.
+@see eigenDecomposition
+@ingroup qvmath
+*/
+void batchedEigenDecomposition(const int size, const int count, const double *matrices, double *eigenvalues,
+                                double *eigenvectors, const int numThreads = -1);
+
+/*!
+@brief Obtains the eigen-decomposition of a list of small symmetric matrices.
+
+This is an overloaded version of the function @ref batchedEigenDecomposition(const int, const int, const double *, double *, double *, const int),
+provided for convenience. Every matrix in the list must have the same size.
+
+@param matrices List of symmetric matrices.
+@param eigenvalues Eigenvalues of each matrix, in decreasing order (overwritten on output).
+@param eigenvectors Eigenvectors of each matrix, stored as columns (overwritten on output).
+@param numThreads Maximal number of threads. The value -1 uses the ideal number of threads for the system.
+@ingroup qvmath
+*/
+void batchedEigenDecomposition(const QVector<QVMatrix> &matrices, QVector<QVVector> &eigenvalues,
+                                QVector<QVMatrix> &eigenvectors, const int numThreads = -1);
+
+/*!
+@brief Obtains the singular values and right singular vectors of a batch of small matrices.
+
+Each matrix \f$ A_i \f$ in the buffer is decomposed as \f$ A_i = U_i \Sigma_i V_i^T \f$. The function obtains the
+singular values (in decreasing order) and the matrices \f$ V_i \f$, from the batched eigen-decomposition of the
+matrices \f$ A_i^T A_i \f$. The matrices \f$ U_i \f$ are not evaluated.
+
+@note Squaring the matrices squares their condition number. This is appropriate for well scaled problems, like the
+linear triangulation or the reduced matrices of GEA, but not for ill-conditioned matrices. Use
+@ref singularValueDecomposition for those.
+
+@param rows Number of rows of each matrix.
+@param cols Number of columns of each matrix.
+@param count Number of matrices in the batch.
+@param matrices Buffer containing the count matrices, each one of them stored in row major order.
+@param singularValues Output buffer for the count * cols singular values.
+@param V Output buffer for the count matrices of right singular vectors, stored as columns.
+@param numThreads Maximal number of threads. The value -1 uses the ideal number of threads for the system.
+@see singularValueDecomposition
+@ingroup qvmath
+*/
+void batchedSingularValueDecomposition(const int rows, const int cols, const int count, const double *matrices,
+                                        double *singularValues, double *V, const int numThreads = -1);
+
+/*!
+@brief Solves a batch of small homogeneous linear systems.
+
+For each matrix \f$ A_i \f$ in the buffer, obtains the unit vector \f$ x_i \f$ which minimizes \f$ \| A_i x_i \| \f$,
+that is, the right singular vector corresponding to the smallest singular value.
+
+@param rows Number of rows of each matrix.
+@param cols Number of columns of each matrix.
+@param count Number of matrices in the batch.
+@param matrices Buffer containing the count matrices, each one of them stored in row major order.
+@param solutions Output buffer for the count solution vectors, of size cols each.
+@param numThreads Maximal number of threads. The value -1 uses the ideal number of threads for the system.
+@see solveHomogeneous
+@ingroup qvmath
+*/
+void batchedSolveHomogeneous(const int rows, const int cols, const int count, const double *matrices,
+                                double *solutions, const int numThreads = -1);
+
+#endif
@@ -0,0 +1,475 @@
+/*
+ *	Copyright (C) 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVBSRMATRIX_H
+#define QVBSRMATRIX_H
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include <QVector>
+#include <qvmath/qvmatrix.h>
+#include <qvmath/qvvector.h>
+#include <qvmath/qvsparseblockmatrix.h>
+
+/*!
+@class QVBSRMatrix qvmath/qvbsrmatrix.h QVBSRMatrix
+@brief Compressed block sparse row (BSR) matrices, with a block size fixed at compile time.
+
+This class stores the non-zero blocks of a sparse block matrix in three contiguous arrays, following the usual
+<i>BSR</i> layout: the values of every block (stored by rows, one block after the other), the block column index of
+every block, and the position in the former arrays of the first block of each block row.
+
+Unlike @ref QVSparseBlockMatrix, whose blocks are reference counted @ref QVMatrix objects stored in nested maps, this
+representation can not be modified once created. It is intended for the repeated products performed by iterative
+solvers, which traverse the whole matrix in every iteration. The size of the blocks is a template parameter, so
+the products of the blocks are unrolled by the compiler. The sizes most commonly found in bundle adjustment problems
+have their own type names:
+
+@code
+typedef QVBSRMatrix<6,6> QVBSRMatrix66;	// camera-camera blocks
+typedef QVBSRMatrix<3,3> QVBSRMatrix33;	// point-point blocks
+typedef QVBSRMatrix<6,3> QVBSRMatrix63;	// camera-point blocks
+@endcode
+
+A BSR matrix is created from a @ref QVSparseBlockMatrix with matching block size:
+
+@code
+QVSparseBlockMatrix M(100, 100, 6, 6);
+[...]
+const QVBSRMatrix66 bsrM(M);
+
+QVVector y;
+bsrM.dotProduct(x, y);		// y = M x
+bsrM.dotProduct(x, y, true);	// y = M^T x, without transposing M
+@endcode
+
+The products write the result in an existing vector or matrix, which is only resized when its size is not correct,
+so the storage of the result can be reused between iterations.
+
+@ingroup qvmath
+*/
+template <int BlockRows, int BlockCols> class QVBSRMatrix
+    {
+    protected:
+        int majorRows, majorCols;
+        bool upperTriangular;
+        QVector<int> rowStart, blockColumns;
+        QVector<double> values;
+
+    public:
+        /// @brief Number of elements of each block.
+        static const int blockSize = BlockRows * BlockCols;
+
+        /// @brief Default constructor, creates an empty matrix.
+        QVBSRMatrix(): majorRows(0), majorCols(0), upperTriangular(false), rowStart(1, 0)
+            { }
+
+        /// @brief Creates a BSR matrix from a sparse block matrix.
+        ///
+        /// The block size of the sparse block matrix must be BlockRows x BlockCols.
+        ///
+        /// @param other sparse block matrix to convert.
+        /// @param upperTriangular if true, only the blocks in or above the diagonal of the matrix are stored, and the
+        /// matrix is considered symmetric in the products (see @ref isUpperTriangular).
+        QVBSRMatrix(const QVSparseBlockMatrix &other, const bool upperTriangular = false):
+            majorRows(other.getMajorRows()), majorCols(other.getMajorCols()), upperTriangular(upperTriangular),
+            rowStart(other.getMajorRows() + 1, 0)
+            {
+            if (other.getMinorRows() != BlockRows || other.getMinorCols() != BlockCols)
+                {
+                std::cout << "[QVBSRMatrix] Error: tried to construct a BSR matrix from a sparse block matrix with a different block size." << std::endl
+                    << "\tSparse block matrix block size:\t" << other.getMinorRows() << "x" << other.getMinorCols() << std::endl
+                    << "\tBSR matrix block size:\t" << BlockRows << "x" << BlockCols << std::endl;
+                exit(1);
+                }
+
+            if (upperTriangular && (majorRows != majorCols || BlockRows != BlockCols))
+                {
+                std::cout << "[QVBSRMatrix] Error: only square matrices with square blocks can be stored as upper triangular." << std::endl;
+                exit(1);
+                }
+
+            // Count the blocks first, so the arrays are allocated only once.
+            int count = 0;
+            foreach(int ib, other.keys())
+                foreach(int jb, other[ib].keys())
+                    if (!upperTriangular || jb >= ib)
+                        count++;
+
+            blockColumns.resize(count);
+            values.resize(count * blockSize);
+
+            // Keys of the maps are sorted, so blocks are stored by rows, and by columns inside each row.
+            int k = 0, row = 0;
+            foreach(int ib, other.keys())
+                {
+                for(; row <= ib; row++)
+                    rowStart[row] = k;
+
+                const QMap<int, QVMatrix> &majorRow = other[ib];
+                foreach(int jb, majorRow.keys())
+                    if (!upperTriangular || jb >= ib)
+                        {
+                        blockColumns[k] = jb;
+                        memcpy(values.data() + k * blockSize, majorRow[jb].getReadData(), blockSize * sizeof(double));
+                        k++;
+                        }
+                }
+            for(; row <= majorRows; row++)
+                rowStart[row] = k;
+            }
+
+        /// @brief Get majorRows from a BSR matrix
+        inline int getMajorRows() const { return majorRows; };
+
+        /// @brief Get majorCols from a BSR matrix
+        inline int getMajorCols() const { return majorCols; };
+
+        /// @brief Get minorRows from a BSR matrix
+        inline int getMinorRows() const { return BlockRows; };
+
+        /// @brief Get minorCols from a BSR matrix
+        inline int getMinorCols() const { return BlockCols; };
+
+        /// @brief Number of stored blocks.
+        inline int getBlockCount() const { return blockColumns.size(); };
+
+        /// @brief True if only the upper triangular blocks of a symmetric matrix are stored.
+        ///
+        /// In that case the products use each block above the diagonal twice: once as stored, and once transposed
+        /// in the symmetric position. This avoids storing (and mirroring) the lower triangular half of the matrix.
+        inline bool isUpperTriangular() const { return upperTriangular; };
+
+        /// @brief Position of the first block of a block row in the block arrays (for <i>majorRow = getMajorRows()</i>, the number of blocks).
+        inline int getRowStart(const int majorRow) const { return rowStart[majorRow]; };
+
+        /// @brief Block column index of the k-th stored block.
+        inline int getBlockColumn(const int k) const { return blockColumns[k]; };
+
+        /// @brief Values of the k-th stored block, stored by rows.
+        inline const double *getBlockData(const int k) const { return values.constData() + k * blockSize; };
+
+        /// @brief Gets a symmetric matrix stored in full, from a matrix storing its upper triangular blocks.
+        ///
+        /// Each block above the diagonal is stored also transposed in its symmetric position. The products of the
+        /// resulting matrix can be split by block rows (see @ref dotProductRows), as they do not scatter results to
+        /// other rows.
+        QVBSRMatrix symmetricExpansion() const
+            {
+            if (!upperTriangular)
+                return *this;
+
+            QVBSRMatrix result;
+            result.majorRows = majorRows;
+            result.majorCols = majorCols;
+            result.rowStart = QVector<int>(majorRows + 1, 0);
+
+            // Count the blocks of each row of the result.
+            for(int ib = 0; ib < majorRows; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++)
+                    {
+                    result.rowStart[ib+1]++;
+                    if (blockColumns[k] != ib)
+                        result.rowStart[blockColumns[k]+1]++;
+                    }
+            for(int ib = 0; ib < majorRows; ib++)
+                result.rowStart[ib+1] += result.rowStart[ib];
+
+            const int count = result.rowStart[majorRows];
+            result.blockColumns.resize(count);
+            result.values.resize(count * blockSize);
+
+            // Rows are traversed in ascending order, so the mirrored blocks of a row (with columns smaller than the
+            // row index) are placed before its stored blocks, and the columns of each row remain sorted.
+            QVector<int> next = result.rowStart;
+            const double *blockData = values.constData();
+            for(int ib = 0; ib < majorRows; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++, blockData += blockSize)
+                    {
+                    const int jb = blockColumns[k];
+
+                    const int kr = next[ib]++;
+                    result.blockColumns[kr] = jb;
+                    memcpy(result.values.data() + kr * blockSize, blockData, blockSize * sizeof(double));
+
+                    if (jb != ib)
+                        {
+                        const int kt = next[jb]++;
+                        result.blockColumns[kt] = ib;
+                        double *transposed = result.values.data() + kt * blockSize;
+                        for(int i = 0; i < BlockRows; i++)
+                            for(int j = 0; j < BlockCols; j++)
+                                transposed[j * BlockRows + i] = blockData[i * BlockCols + j];
+                        }
+                    }
+
+            return result;
+            }
+
+        /// @brief Updates the values of a symmetric matrix, keeping its sparsity pattern.
+        ///
+        /// The matrix must store every block of a symmetric matrix, as those obtained with @ref symmetricExpansion.
+        /// The values are copied from the blocks in or above the diagonal of a sparse block matrix, and mirrored to
+        /// their symmetric positions. This avoids creating the matrix again when only the values of the blocks change.
+        ///
+        /// @param other sparse block matrix. Its blocks below the diagonal are ignored.
+        /// @returns false, without modifying the matrix, if the blocks in or above the diagonal of <i>other</i> do
+        /// not match the sparsity pattern of the matrix.
+        bool setSymmetricValues(const QVSparseBlockMatrix &other)
+            {
+            if (upperTriangular || BlockRows != BlockCols || other.getMajorRows() != majorRows || other.getMajorCols() != majorCols ||
+                other.getMinorRows() != BlockRows || other.getMinorCols() != BlockCols)
+                return false;
+
+            // Check the pattern first, so the matrix is not modified when it does not match.
+            int count = 0;
+            foreach(int ib, other.keys())
+                foreach(int jb, other[ib].keys())
+                    if (jb >= ib)
+                        {
+                        if (findBlock(ib, jb) < 0)
+                            return false;
+                        count += (jb == ib)? 1: 2;
+                        }
+            if (count != blockColumns.size())
+                return false;
+
+            foreach(int ib, other.keys())
+                {
+                const QMap<int, QVMatrix> &majorRow = other[ib];
+                foreach(int jb, majorRow.keys())
+                    if (jb >= ib)
+                        {
+                        const QVMatrix block = majorRow[jb];
+                        const double *blockData = block.getReadData();
+                        memcpy(values.data() + findBlock(ib, jb) * blockSize, blockData, blockSize * sizeof(double));
+                        if (jb != ib)
+                            {
+                            double *transposed = values.data() + findBlock(jb, ib) * blockSize;
+                            for(int i = 0; i < BlockRows; i++)
+                                for(int j = 0; j < BlockCols; j++)
+                                    transposed[j * BlockRows + i] = blockData[i * BlockCols + j];
+                            }
+                        }
+                }
+            return true;
+            }
+
+        /// @brief Converts the BSR matrix back to the sparse block matrix form.
+        operator QVSparseBlockMatrix () const
+            {
+            QVSparseBlockMatrix result(majorRows, majorCols, BlockRows, BlockCols);
+            for(int ib = 0; ib < majorRows; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++)
+                    result.setBlock(ib, blockColumns[k], QVMatrix(BlockRows, BlockCols, getBlockData(k)));
+            return result;
+            }
+
+        /// @brief Sparse matrix-vector product on raw arrays.
+        ///
+        /// Evaluates \f$ y = A x \f$, or \f$ y = A^T x \f$ if <i>transpose</i> is true. The transposed product is
+        /// evaluated directly from the stored blocks.
+        ///
+        /// @param x input vector, of size <i>getMajorCols() * BlockCols</i> (<i>getMajorRows() * BlockRows</i> when transposing).
+        /// @param y output vector, of size <i>getMajorRows() * BlockRows</i> (<i>getMajorCols() * BlockCols</i> when transposing). It must not overlap with x.
+        /// @param transpose multiply by the transpose of the matrix.
+        /// @param accumulate add the product to the contents of y, instead of overwritting them.
+        void dotProduct(const double *x, double *y, const bool transpose = false, const bool accumulate = false) const
+            {
+            const int outRows = (transpose? majorCols * BlockCols: majorRows * BlockRows);
+            if (!accumulate)
+                memset(y, 0, outRows * sizeof(double));
+
+            const double *blockData = values.constData();
+            for(int ib = 0; ib < majorRows; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++, blockData += blockSize)
+                    {
+                    const int jb = blockColumns[k];
+                    if (!transpose || (upperTriangular && ib != jb))
+                        multiplyBlock(blockData, x + jb * BlockCols, y + ib * BlockRows);
+                    if (transpose || (upperTriangular && ib != jb))
+                        multiplyTransposedBlock(blockData, x + ib * BlockRows, y + jb * BlockCols);
+                    }
+            }
+
+        /// @brief Sparse matrix-vector product for a range of block rows.
+        ///
+        /// Evaluates the elements of \f$ y = A x \f$ corresponding to the block rows in the range
+        /// <i>[firstRow, lastRow)</i>. Different ranges can be evaluated concurrently. The matrix must not be
+        /// stored as upper triangular (see @ref symmetricExpansion).
+        ///
+        /// @param x input vector, of size <i>getMajorCols() * BlockCols</i>.
+        /// @param y output vector, of size <i>getMajorRows() * BlockRows</i>. Only the elements of the range are written.
+        void dotProductRows(const double *x, double *y, const int firstRow, const int lastRow) const
+            {
+            Q_ASSERT(!upperTriangular);
+
+            memset(y + firstRow * BlockRows, 0, (lastRow - firstRow) * BlockRows * sizeof(double));
+
+            const double *blockData = values.constData() + rowStart[firstRow] * blockSize;
+            for(int ib = firstRow; ib < lastRow; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++, blockData += blockSize)
+                    multiplyBlock(blockData, x + blockColumns[k] * BlockCols, y + ib * BlockRows);
+            }
+
+        /// @brief Sparse matrix-vector product.
+        ///
+        /// @param x input vector.
+        /// @param y output vector. It is resized only if its size does not match the size of the product.
+        /// @param transpose multiply by the transpose of the matrix.
+        void dotProduct(const QVVector &x, QVVector &y, const bool transpose = false) const
+            {
+            const int inRows = (transpose? majorRows * BlockRows: majorCols * BlockCols),
+                      outRows = (transpose? majorCols * BlockCols: majorRows * BlockRows);
+
+            if (x.size() != inRows)
+                {
+                std::cout << "[QVBSRMatrix::dotProduct] Error: vector of size " << x.size()
+                    << " incompatible with matrix of size " << majorRows * BlockRows << "x" << majorCols * BlockCols << "." << std::endl;
+                exit(1);
+                }
+
+            if (y.size() != outRows)
+                y.resize(outRows);
+
+            dotProduct(x.constData(), y.data(), transpose);
+            }
+
+        /// @brief Sparse matrix-vector product operator.
+        QVVector operator*(const QVVector &x) const
+            {
+            QVVector y;
+            dotProduct(x, y);
+            return y;
+            }
+
+        /// @brief Sparse matrix-dense matrix product.
+        ///
+        /// Evaluates \f$ Y = A X \f$, or \f$ Y = A^T X \f$ if <i>transpose</i> is true.
+        ///
+        /// @param X input dense matrix.
+        /// @param Y output dense matrix. It is reallocated only if its size does not match the size of the product.
+        /// @param transpose multiply by the transpose of the sparse matrix.
+        void dotProduct(const QVMatrix &X, QVMatrix &Y, const bool transpose = false) const
+            {
+            const int inRows = (transpose? majorRows * BlockRows: majorCols * BlockCols),
+                      outRows = (transpose? majorCols * BlockCols: majorRows * BlockRows),
+                      n = X.getCols();
+
+            if (X.getRows() != inRows)
+                {
+                std::cout << "[QVBSRMatrix::dotProduct] Error: matrix of size " << X.getRows() << "x" << n
+                    << " incompatible with sparse matrix of size " << majorRows * BlockRows << "x" << majorCols * BlockCols << "." << std::endl;
+                exit(1);
+                }
+
+            if (Y.getRows() != outRows || Y.getCols() != n)
+                Y = QVMatrix(outRows, n, 0.0);
+            else
+                memset(Y.getWriteData(), 0, outRows * n * sizeof(double));
+
+            const double *xData = X.getReadData();
+            double *yData = Y.getWriteData();
+            const double *blockData = values.constData();
+            for(int ib = 0; ib < majorRows; ib++)
+                for(int k = rowStart[ib]; k < rowStart[ib+1]; k++, blockData += blockSize)
+                    {
+                    const int jb = blockColumns[k];
+                    if (!transpose || (upperTriangular && ib != jb))
+                        multiplyBlockRows(blockData, xData + jb * BlockCols * n, yData + ib * BlockRows * n, n);
+                    if (transpose || (upperTriangular && ib != jb))
+                        multiplyTransposedBlockRows(blockData, xData + ib * BlockRows * n, yData + jb * BlockCols * n, n);
+                    }
+            }
+
+    private:
+        // Position of the block (ib, jb) in the block arrays, or -1 if it is not stored.
+        inline int findBlock(const int ib, const int jb) const
+            {
+            const int *first = blockColumns.constData() + rowStart[ib], *last = blockColumns.constData() + rowStart[ib+1];
+            const int *found = std::lower_bound(first, last, jb);
+            return (found != last && *found == jb)? int(found - blockColumns.constData()): -1;
+            }
+
+        // y += B x, for a block B.
+        static inline void multiplyBlock(const double *B, const double *x, double *y)
+            {
+            for(int i = 0; i < BlockRows; i++)
+                {
+                double accum = 0.0;
+                for(int j = 0; j < BlockCols; j++)
+                    accum += B[i * BlockCols + j] * x[j];
+                y[i] += accum;
+                }
+            }
+
+        // y += B^T x, for a block B.
+        static inline void multiplyTransposedBlock(const double *B, const double *x, double *y)
+            {
+            for(int i = 0; i < BlockRows; i++)
+                for(int j = 0; j < BlockCols; j++)
+                    y[j] += B[i * BlockCols + j] * x[i];
+            }
+
+        // Y += B X, for a block B and the n columns of the block rows of the dense matrices X and Y.
+        static inline void multiplyBlockRows(const double *B, const double *X, double *Y, const int n)
+            {
+            for(int i = 0; i < BlockRows; i++)
+                for(int j = 0; j < BlockCols; j++)
+                    {
+                    const double b = B[i * BlockCols + j];
+                    const double *xRow = X + j * n;
+                    double *yRow = Y + i * n;
+                    for(int c = 0; c < n; c++)
+                        yRow[c] += b * xRow[c];
+                    }
+            }
+
+        // Y += B^T X, for a block B and the n columns of the block rows of the dense matrices X and Y.
+        static inline void multiplyTransposedBlockRows(const double *B, const double *X, double *Y, const int n)
+            {
+            for(int i = 0; i < BlockRows; i++)
+                for(int j = 0; j < BlockCols; j++)
+                    {
+                    const double b = B[i * BlockCols + j];
+                    const double *xRow = X + i * n;
+                    double *yRow = Y + j * n;
+                    for(int c = 0; c < n; c++)
+                        yRow[c] += b * xRow[c];
+                    }
+            }
+    };
+
+/// @brief BSR matrix with 6x6 blocks (camera-camera blocks in bundle adjustment problems).
+typedef QVBSRMatrix<6,6> QVBSRMatrix66;
+
+/// @brief BSR matrix with 3x3 blocks (point-point blocks in bundle adjustment problems).
+typedef QVBSRMatrix<3,3> QVBSRMatrix33;
+
+/// @brief BSR matrix with 6x3 blocks (camera-point blocks in bundle adjustment problems).
+typedef QVBSRMatrix<6,3> QVBSRMatrix63;
+
+#endif
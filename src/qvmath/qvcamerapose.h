@@ -27,6 +27,7 @@
 
 #include<QV3DPointF>
 #include<QVEuclideanMapping3>
+#include<qvmath/qvfixedmatrix.h>
 
 /*!
 @class QVCameraPose qvmath/qvcamerapos.h QVCameraPose
@@ -212,6 +213,30 @@ class QVCameraPose
 			return Rt;
 			}
 
+		/// @brief Cast to a fixed size pin-hole projection matrix.
+		///
+		/// This version does not allocate memory, so it is preferable in inner loops.
+		/// @return The first three rows of the matrix returned by @ref toProjectionMatrix.
+		QVFixedMatrix<3,4> toFixedProjectionMatrix() const
+			{
+			Q_ASSERT(orientation.norm2() > 0);
+			Q_WARNING(not orientation.containsNaN());
+			Q_WARNING(not center.containsNaN());
+
+			QVFixedMatrix<3,4> Rt;
+			const QVFixedMatrix<3,3> R = orientation.toFixedRotationMatrix();
+			const QV3DPointF t = orientation.rotate(-center);
+
+			for (int i = 0; i < 3; i++)
+				{
+				for (int j = 0; j < 3; j++)
+					Rt(i,j) = R(i,j);
+				Rt(i,3) = t[i];
+				}
+
+			return Rt;
+			}
+
 		/// @brief Composes two camera poses.
 		///
 		/// @param Operand camera pose for the composition.
@@ -0,0 +1,651 @@
+/*
+ *	Copyright (C) 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <iostream>
+#include <cmath>
+
+#include <QThread>
+#include <QRunnable>
+
+#include <QVConjugateGradientSolver>
+#include <qvmath/qvmatrix.h>
+
+// Minimal number of block rows for each thread. Smaller problems do not pay the synchronization of the threads.
+#define QVCG_MIN_ROWS_PER_THREAD	64
+
+// Minimal number of block rows for each thread in a level of the triangular solves. Smaller levels are solved by the
+// calling thread.
+#define QVCG_MIN_LEVEL_ROWS_PER_THREAD	16
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Evaluates a step of the iteration for the block rows of a thread. Workers are reused for every step, so they are
+// not deleted by the thread pool.
+class QVConjugateGradientWorker : public QRunnable
+    {
+    public:
+        typedef void (*TStepFunction)(void *solver, const int step, const int thread);
+
+        QVConjugateGradientWorker(TStepFunction function, void *solver, const int thread, QSemaphore *finished):
+            QRunnable(), function(function), solver(solver), thread(thread), step(0), finished(finished)
+            { setAutoDelete(false); }
+
+        void setStep(const int step)    { this->step = step; }
+
+        void run()
+            {
+            function(solver, step, thread);
+            finished->release();
+            }
+
+    private:
+        TStepFunction function;
+        void *solver;
+        const int thread;
+        int step;
+        QSemaphore *finished;
+    };
+
+template <int BlockSize> static void runConjugateGradientStep(void *solver, const int step, const int thread)
+    {
+    static_cast<QVConjugateGradientSolver<BlockSize> *>(solver)->runStep(step, thread);
+    }
+#endif // DOXYGEN_IGNORE_THIS
+
+template <int BlockSize> QVConjugateGradientSolver<BlockSize>::QVConjugateGradientSolver(const QVSparseBlockMatrix &sparseA,
+            const bool upperTriangular, const TPreconditioner preconditioner, const int numThreads):
+    A(QVBSRMatrix<BlockSize, BlockSize>(sparseA, upperTriangular).symmetricExpansion()), preconditioner(preconditioner),
+    numThreads(1), rows(sparseA.getMajorRows()), currentLevel(0), zData(NULL), x(NULL), b(NULL), alpha(0.0), beta(0.0), iterations(0)
+    {
+    if (sparseA.getMajorRows() != sparseA.getMajorCols())
+        {
+        std::cout << "[QVConjugateGradientSolver] Error: the coefficient matrix is not square." << std::endl
+            << "\tSparse matrix number of blocks:\t" << sparseA.getMajorRows() << "x" << sparseA.getMajorCols() << std::endl;
+        exit(1);
+        }
+
+    // Split the block rows in ranges with a similar number of blocks.
+    this->numThreads = qMax(1, qMin((numThreads > 0)? numThreads: QThread::idealThreadCount(), rows / QVCG_MIN_ROWS_PER_THREAD));
+
+    const int totalBlocks = A.getRowStart(rows);
+    firstRow = QVector<int>(this->numThreads + 1, rows);
+    firstRow[0] = 0;
+    for(int t = 1, row = 0; t < this->numThreads; t++)
+        {
+        const qint64 target = (qint64) totalBlocks * t / this->numThreads;
+        while (row < rows and A.getRowStart(row) < target)
+            row++;
+        firstRow[t] = row;
+        }
+
+    if (preconditioner == BlockCholesky)
+        analyzeIncompleteCholesky();
+    evaluatePreconditioner();
+
+    // Vectors of the iteration. The preconditioned residual is the residual itself when there is no preconditioner.
+    const int n = rows * BlockSize;
+    r = QVVector(n, 0.0);
+    p = QVVector(n, 0.0);
+    Ap = QVVector(n, 0.0);
+    if (preconditioner != NoPreconditioner)
+        {
+        z = QVVector(n, 0.0);
+        zData = z.data();
+        }
+    else
+        zData = r.data();
+
+    partials = QVector<double>(this->numThreads * PartialStride, 0.0);
+
+    // Thread 0 is the calling thread.
+    pool.setMaxThreadCount(qMax(1, this->numThreads - 1));
+    for(int t = 1; t < this->numThreads; t++)
+        workers << new QVConjugateGradientWorker(&runConjugateGradientStep<BlockSize>, this, t, &finishedWorkers);
+    }
+
+template <int BlockSize> QVConjugateGradientSolver<BlockSize>::~QVConjugateGradientSolver()
+    {
+    pool.waitForDone();
+    qDeleteAll(workers);
+    }
+
+template <int BlockSize> bool QVConjugateGradientSolver<BlockSize>::setMatrix(const QVSparseBlockMatrix &sparseA)
+    {
+    if (not A.setSymmetricValues(sparseA))
+        return false;
+
+    evaluatePreconditioner();
+    return true;
+    }
+
+template <int BlockSize> double QVConjugateGradientSolver<BlockSize>::solve(QVVector &xVector, const QVVector &bVector,
+            const int maxIters, const int minIters, const double minAbsoluteError)
+    {
+    const int n = rows * BlockSize;
+    if (bVector.size() != n)
+        {
+        std::cout << "[QVConjugateGradientSolver::solve] Error: right-hand side vector of size " << bVector.size()
+            << " incompatible with matrix of size " << n << "x" << n << "." << std::endl;
+        exit(1);
+        }
+
+    if (xVector.size() != n)
+        xVector = QVVector(n, 0.0);
+
+    x = xVector.data();
+    b = bVector.constData();
+
+    // r = b - A x, z = M^-1 r, p = z.
+    runParallel(InitStep);
+    if (preconditioner == BlockCholesky)
+        {
+        applyIncompleteCholesky();
+        runParallel(InitDotStep);
+        }
+    double rr = sumPartials(0), rz = sumPartials(1);
+
+    residualHistory.clear();
+    residualHistory.reserve(maxIters + 1);
+    residualHistory << sqrt(rr);
+
+    iterations = 0;
+    for (int i = 0; i < maxIters; i++)
+        {
+        // Ap = A p.
+        runParallel(ProductStep);
+        alpha = rz / sumPartials(0);
+
+        // x = x + alpha p, r = r - alpha Ap, z = M^-1 r.
+        runParallel(UpdateStep);
+        if (preconditioner == BlockCholesky)
+            {
+            applyIncompleteCholesky();
+            runParallel(DotStep);
+            }
+        rr = sumPartials(0);
+        const double rzNew = sumPartials(1);
+
+        iterations = i + 1;
+        residualHistory << sqrt(rr);
+
+        if ( (rr < minAbsoluteError) and (i > minIters) )
+            break;
+
+        // p = z + beta p.
+        beta = rzNew / rz;
+        rz = rzNew;
+        runParallel(DirectionStep);
+        }
+
+    x = NULL;
+    b = NULL;
+
+    return sqrt(rr);
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::runParallel(const int step)
+    {
+    for(int t = 1; t < numThreads; t++)
+        {
+        workers[t-1]->setStep(step);
+        pool.start(workers[t-1]);
+        }
+
+    runStep(step, 0);
+
+    if (numThreads > 1)
+        finishedWorkers.acquire(numThreads - 1);
+    }
+
+template <int BlockSize> double QVConjugateGradientSolver<BlockSize>::sumPartials(const int index) const
+    {
+    double sum = 0.0;
+    for(int t = 0; t < numThreads; t++)
+        sum += partials[t * PartialStride + index];
+    return sum;
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::evaluatePreconditioner()
+    {
+    if (preconditioner == BlockJacobi)
+        {
+        // Missing diagonal blocks are left as the identity.
+        diagonal = QVector<double>(rows * BlockSize * BlockSize, 0.0);
+        for(int ib = 0; ib < rows; ib++)
+            {
+            double *D = diagonal.data() + ib * BlockSize * BlockSize;
+            for(int i = 0; i < BlockSize; i++)
+                D[i * BlockSize + i] = 1.0;
+
+            int k = A.getRowStart(ib);
+            while (k < A.getRowStart(ib+1) and A.getBlockColumn(k) != ib)
+                k++;
+            if (k == A.getRowStart(ib+1))
+                continue;
+
+            const QVMatrix inverse = QVMatrix(BlockSize, BlockSize, A.getBlockData(k)).inverse();
+            memcpy(D, inverse.getReadData(), BlockSize * BlockSize * sizeof(double));
+            }
+        }
+    else if (preconditioner == BlockCholesky)
+        {
+        // The incomplete factorization of a positive definite matrix can break down. In that case, it is repeated
+        // increasing the diagonal of the matrix.
+        const double shifts[] = { 0.0, 1e-3, 1e-2, 1e-1, 1.0 };
+        const int numShifts = sizeof(shifts) / sizeof(double);
+
+        int s = 0;
+        while (s < numShifts and not factorIncompleteCholesky(shifts[s]))
+            s++;
+
+        if (s == numShifts)
+            {
+            std::cout << "[QVConjugateGradientSolver] Warning: incomplete Cholesky factorization failed, the preconditioner is not used." << std::endl;
+            lowerValues.fill(0.0);
+            for(int ib = 0; ib < rows; ib++)
+                {
+                double *L = lowerValues.data() + (lowerStart[ib+1] - 1) * BlockSize * BlockSize;
+                for(int i = 0; i < BlockSize; i++)
+                    L[i * BlockSize + i] = 1.0;
+                }
+            }
+        else if (s > 0)
+            std::cout << "[QVConjugateGradientSolver] Warning: incomplete Cholesky factorization evaluated with the diagonal increased by a factor "
+                      << shifts[s] << "." << std::endl;
+        }
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::applyPreconditioner(const int firstBlockRow, const int lastBlockRow)
+    {
+    const double *rData = r.constData();
+    for(int ib = firstBlockRow; ib < lastBlockRow; ib++)
+        {
+        const double *D = diagonal.constData() + ib * BlockSize * BlockSize, *rBlock = rData + ib * BlockSize;
+        double *zBlock = zData + ib * BlockSize;
+
+        for(int i = 0; i < BlockSize; i++)
+            {
+            double accum = 0.0;
+            for(int j = 0; j < BlockSize; j++)
+                accum += D[i * BlockSize + j] * rBlock[j];
+            zBlock[i] = accum;
+            }
+        }
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::analyzeIncompleteCholesky()
+    {
+    // Blocks of L: the blocks of A below the diagonal, followed by the diagonal block, for each block row.
+    lowerStart = QVector<int>(rows + 1, 0);
+    for(int ib = 0; ib < rows; ib++)
+        {
+        int count = 1;
+        for(int k = A.getRowStart(ib); k < A.getRowStart(ib+1) and A.getBlockColumn(k) < ib; k++)
+            count++;
+        lowerStart[ib+1] = lowerStart[ib] + count;
+        }
+
+    const int lowerBlocks = lowerStart[rows];
+    lowerColumns = QVector<int>(lowerBlocks);
+    lowerSource = QVector<int>(lowerBlocks);
+    lowerValues = QVector<double>(lowerBlocks * BlockSize * BlockSize);
+
+    for(int ib = 0; ib < rows; ib++)
+        {
+        int q = lowerStart[ib], k = A.getRowStart(ib);
+        for(; k < A.getRowStart(ib+1) and A.getBlockColumn(k) < ib; k++, q++)
+            {
+            lowerColumns[q] = A.getBlockColumn(k);
+            lowerSource[q] = k;
+            }
+        lowerColumns[q] = ib;
+        lowerSource[q] = (k < A.getRowStart(ib+1) and A.getBlockColumn(k) == ib)? k: -1;
+        }
+
+    // Blocks of L^T above the diagonal. Rows of L are traversed in ascending order, so the columns of each row of
+    // L^T remain sorted.
+    upperStart = QVector<int>(rows + 1, 0);
+    for(int ib = 0; ib < rows; ib++)
+        for(int q = lowerStart[ib]; q < lowerStart[ib+1] - 1; q++)
+            upperStart[lowerColumns[q]+1]++;
+    for(int ib = 0; ib < rows; ib++)
+        upperStart[ib+1] += upperStart[ib];
+
+    upperColumns = QVector<int>(upperStart[rows]);
+    upperBlocks = QVector<int>(upperStart[rows]);
+    QVector<int> next = upperStart;
+    for(int ib = 0; ib < rows; ib++)
+        for(int q = lowerStart[ib]; q < lowerStart[ib+1] - 1; q++)
+            {
+            const int u = next[lowerColumns[q]]++;
+            upperColumns[u] = ib;
+            upperBlocks[u] = q;
+            }
+
+    // Levels of the substitutions. A block row can be solved once the rows it depends on are solved, so its level is
+    // one more than the largest level of those rows.
+    QVector<int> forwardLevel(rows, 0), backwardLevel(rows, 0);
+    int forwardLevels = 0, backwardLevels = 0;
+    for(int ib = 0; ib < rows; ib++)
+        {
+        for(int q = lowerStart[ib]; q < lowerStart[ib+1] - 1; q++)
+            forwardLevel[ib] = qMax(forwardLevel[ib], forwardLevel[lowerColumns[q]] + 1);
+        forwardLevels = qMax(forwardLevels, forwardLevel[ib] + 1);
+        }
+    for(int ib = rows - 1; ib >= 0; ib--)
+        {
+        for(int u = upperStart[ib]; u < upperStart[ib+1]; u++)
+            backwardLevel[ib] = qMax(backwardLevel[ib], backwardLevel[upperColumns[u]] + 1);
+        backwardLevels = qMax(backwardLevels, backwardLevel[ib] + 1);
+        }
+
+    forwardLevelStart = QVector<int>(forwardLevels + 1, 0);
+    backwardLevelStart = QVector<int>(backwardLevels + 1, 0);
+    for(int ib = 0; ib < rows; ib++)
+        {
+        forwardLevelStart[forwardLevel[ib]+1]++;
+        backwardLevelStart[backwardLevel[ib]+1]++;
+        }
+    for(int l = 0; l < forwardLevels; l++)
+        forwardLevelStart[l+1] += forwardLevelStart[l];
+    for(int l = 0; l < backwardLevels; l++)
+        backwardLevelStart[l+1] += backwardLevelStart[l];
+
+    forwardRows = QVector<int>(rows);
+    backwardRows = QVector<int>(rows);
+    QVector<int> nextForward = forwardLevelStart, nextBackward = backwardLevelStart;
+    for(int ib = 0; ib < rows; ib++)
+        {
+        forwardRows[nextForward[forwardLevel[ib]]++] = ib;
+        backwardRows[nextBackward[backwardLevel[ib]]++] = ib;
+        }
+    }
+
+template <int BlockSize> bool QVConjugateGradientSolver<BlockSize>::factorIncompleteCholesky(const double shift)
+    {
+    const int blockSize = BlockSize * BlockSize;
+    double *values = lowerValues.data();
+
+    // Left-looking factorization by block rows: L_ij = (A_ij - sum_k L_ik L_jk^T) L_jj^-T, for the blocks (i,j) and
+    // (i,k), (j,k) of the pattern of L, with k < j.
+    for(int ib = 0; ib < rows; ib++)
+        for(int q = lowerStart[ib]; q < lowerStart[ib+1]; q++)
+            {
+            const int jb = lowerColumns[q];
+
+            double S[BlockSize * BlockSize];
+            if (lowerSource[q] >= 0)
+                memcpy(S, A.getBlockData(lowerSource[q]), blockSize * sizeof(double));
+            else	{
+                // Missing diagonal block.
+                for(int i = 0; i < blockSize; i++)
+                    S[i] = 0.0;
+                for(int i = 0; i < BlockSize; i++)
+                    S[i * BlockSize + i] = 1.0;
+                }
+
+            if (jb == ib)
+                for(int i = 0; i < BlockSize; i++)
+                    S[i * BlockSize + i] += shift * fabs(S[i * BlockSize + i]);
+
+            // Blocks of rows i and j with common columns k < j.
+            for(int a = lowerStart[ib], c = lowerStart[jb]; a < q and c < lowerStart[jb+1] - 1; )
+                if (lowerColumns[a] < lowerColumns[c])
+                    a++;
+                else if (lowerColumns[c] < lowerColumns[a])
+                    c++;
+                else	{
+                    const double *Lik = values + a * blockSize, *Ljk = values + c * blockSize;
+                    for(int i = 0; i < BlockSize; i++)
+                        for(int j = 0; j < BlockSize; j++)
+                            {
+                            double accum = 0.0;
+                            for(int m = 0; m < BlockSize; m++)
+                                accum += Lik[i * BlockSize + m] * Ljk[j * BlockSize + m];
+                            S[i * BlockSize + j] -= accum;
+                            }
+                    a++;
+                    c++;
+                    }
+
+            double *L = values + q * blockSize;
+            if (jb < ib)
+                {
+                // Solve L_ij L_jj^T = S by rows.
+                const double *Ljj = values + (lowerStart[jb+1] - 1) * blockSize;
+                for(int i = 0; i < BlockSize; i++)
+                    for(int j = 0; j < BlockSize; j++)
+                        {
+                        double accum = S[i * BlockSize + j];
+                        for(int m = 0; m < j; m++)
+                            accum -= L[i * BlockSize + m] * Ljj[j * BlockSize + m];
+                        L[i * BlockSize + j] = accum / Ljj[j * BlockSize + j];
+                        }
+                }
+            else	{
+                // Lower triangular Cholesky factor of the block, with S = L L^T.
+                for(int i = 0; i < blockSize; i++)
+                    L[i] = 0.0;
+                for(int j = 0; j < BlockSize; j++)
+                    for(int i = j; i < BlockSize; i++)
+                        {
+                        double accum = S[i * BlockSize + j];
+                        for(int m = 0; m < j; m++)
+                            accum -= L[i * BlockSize + m] * L[j * BlockSize + m];
+
+                        if (i != j)
+                            L[i * BlockSize + j] = accum / L[j * BlockSize + j];
+                        else if (accum > 0.0)
+                            L[j * BlockSize + j] = sqrt(accum);
+                        else
+                            return false;
+                        }
+                }
+            }
+
+    return true;
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::applyIncompleteCholesky()
+    {
+    // Solve L y = r, and L^T z = y, level by level.
+    for(int l = 0; l < 2; l++)
+        {
+        const int step = (l == 0)? ForwardStep: BackwardStep;
+        const QVector<int> &levelStart = (l == 0)? forwardLevelStart: backwardLevelStart;
+        for(int level = 0; level < levelStart.size() - 1; level++)
+            if (levelStart[level+1] - levelStart[level] < numThreads * QVCG_MIN_LEVEL_ROWS_PER_THREAD)
+                solveLevelRows(step, levelStart[level], levelStart[level+1]);
+            else	{
+                currentLevel = level;
+                runParallel(step);
+                }
+        }
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::solveLevelRows(const int step, const int first, const int last)
+    {
+    const int blockSize = BlockSize * BlockSize;
+    const double *rData = r.constData(), *values = lowerValues.constData();
+
+    if (step == ForwardStep)
+        for(int index = first; index < last; index++)
+            {
+            const int ib = forwardRows[index];
+            double accum[BlockSize];
+            for(int i = 0; i < BlockSize; i++)
+                accum[i] = rData[ib * BlockSize + i];
+
+            for(int q = lowerStart[ib]; q < lowerStart[ib+1] - 1; q++)
+                {
+                const double *L = values + q * blockSize, *y = zData + lowerColumns[q] * BlockSize;
+                for(int i = 0; i < BlockSize; i++)
+                    for(int j = 0; j < BlockSize; j++)
+                        accum[i] -= L[i * BlockSize + j] * y[j];
+                }
+
+            const double *D = values + (lowerStart[ib+1] - 1) * blockSize;
+            double *y = zData + ib * BlockSize;
+            for(int i = 0; i < BlockSize; i++)
+                {
+                for(int j = 0; j < i; j++)
+                    accum[i] -= D[i * BlockSize + j] * y[j];
+                y[i] = accum[i] / D[i * BlockSize + i];
+                }
+            }
+    else
+        for(int index = first; index < last; index++)
+            {
+            const int ib = backwardRows[index];
+            double *z = zData + ib * BlockSize;
+            double accum[BlockSize];
+            for(int i = 0; i < BlockSize; i++)
+                accum[i] = z[i];
+
+            // Block (i,k) of L^T is the transpose of block (k,i) of L.
+            for(int u = upperStart[ib]; u < upperStart[ib+1]; u++)
+                {
+                const double *L = values + upperBlocks[u] * blockSize, *zk = zData + upperColumns[u] * BlockSize;
+                for(int j = 0; j < BlockSize; j++)
+                    for(int i = 0; i < BlockSize; i++)
+                        accum[i] -= L[j * BlockSize + i] * zk[j];
+                }
+
+            const double *D = values + (lowerStart[ib+1] - 1) * blockSize;
+            for(int i = BlockSize - 1; i >= 0; i--)
+                {
+                for(int j = i + 1; j < BlockSize; j++)
+                    accum[i] -= D[j * BlockSize + i] * z[j];
+                z[i] = accum[i] / D[i * BlockSize + i];
+                }
+            }
+    }
+
+template <int BlockSize> void QVConjugateGradientSolver<BlockSize>::runStep(const int step, const int thread)
+    {
+    const int firstBlockRow = firstRow[thread], lastBlockRow = firstRow[thread+1],
+              first = firstBlockRow * BlockSize, last = lastBlockRow * BlockSize;
+
+    double *rData = r.data(), *pData = p.data(), *ApData = Ap.data();
+    double *partial = partials.data() + thread * PartialStride;
+
+    switch(step)
+        {
+        case InitStep:
+            {
+            A.dotProductRows(x, ApData, firstBlockRow, lastBlockRow);
+            for(int k = first; k < last; k++)
+                rData[k] = b[k] - ApData[k];
+
+            // The incomplete Cholesky preconditioner is applied to the whole residual, before the InitDotStep.
+            if (preconditioner == BlockCholesky)
+                break;
+
+            if (preconditioner == BlockJacobi)
+                applyPreconditioner(firstBlockRow, lastBlockRow);
+
+            double rr = 0.0, rz = 0.0;
+            for(int k = first; k < last; k++)
+                {
+                pData[k] = zData[k];
+                rr += rData[k] * rData[k];
+                rz += rData[k] * zData[k];
+                }
+            partial[0] = rr;
+            partial[1] = rz;
+            break;
+            }
+
+        case ProductStep:
+            {
+            A.dotProductRows(pData, ApData, firstBlockRow, lastBlockRow);
+
+            double pAp = 0.0;
+            for(int k = first; k < last; k++)
+                pAp += pData[k] * ApData[k];
+            partial[0] = pAp;
+            break;
+            }
+
+        case UpdateStep:
+            {
+            for(int k = first; k < last; k++)
+                {
+                x[k] += alpha * pData[k];
+                rData[k] -= alpha * ApData[k];
+                }
+
+            if (preconditioner == BlockCholesky)
+                break;
+
+            if (preconditioner == BlockJacobi)
+                applyPreconditioner(firstBlockRow, lastBlockRow);
+
+            double rr = 0.0, rz = 0.0;
+            for(int k = first; k < last; k++)
+                {
+                rr += rData[k] * rData[k];
+                rz += rData[k] * zData[k];
+                }
+            partial[0] = rr;
+            partial[1] = rz;
+            break;
+            }
+
+        case DirectionStep:
+            {
+            for(int k = first; k < last; k++)
+                pData[k] = zData[k] + beta * pData[k];
+            break;
+            }
+
+        case InitDotStep:
+        case DotStep:
+            {
+            double rr = 0.0, rz = 0.0;
+            for(int k = first; k < last; k++)
+                {
+                if (step == InitDotStep)
+                    pData[k] = zData[k];
+                rr += rData[k] * rData[k];
+                rz += rData[k] * zData[k];
+                }
+            partial[0] = rr;
+            partial[1] = rz;
+            break;
+            }
+
+        case ForwardStep:
+        case BackwardStep:
+            {
+            // The block rows of a level are independent, and they are split evenly between the threads.
+            const QVector<int> &levelStart = (step == ForwardStep)? forwardLevelStart: backwardLevelStart;
+            const int levelFirst = levelStart[currentLevel], levelSize = levelStart[currentLevel+1] - levelFirst;
+            solveLevelRows(step, levelFirst + levelSize * thread / numThreads, levelFirst + levelSize * (thread + 1) / numThreads);
+            break;
+            }
+        }
+    }
+
+template class QVConjugateGradientSolver<3>;
+template class QVConjugateGradientSolver<6>;
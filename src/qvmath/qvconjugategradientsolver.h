@@ -0,0 +1,193 @@
+/*
+ *	Copyright (C) 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVCONJUGATEGRADIENTSOLVER_H
+#define QVCONJUGATEGRADIENTSOLVER_H
+
+#include <QVector>
+#include <QThreadPool>
+#include <QSemaphore>
+
+#include <qvmath/qvvector.h>
+#include <qvmath/qvsparseblockmatrix.h>
+#include <qvmath/qvbsrmatrix.h>
+
+#ifndef DOXYGEN_IGNORE_THIS
+class QVConjugateGradientWorker;
+#endif
+
+/*!
+@class QVConjugateGradientSolver qvmath/qvconjugategradientsolver.h QVConjugateGradientSolver
+@brief Multithreaded (preconditioned) conjugate gradient solver for sparse block matrices.
+
+This class solves linear systems \f$ A x = b \f$, where \f$ A \f$ is a symmetric positive definite sparse block
+matrix with square blocks of size @c BlockSize. The matrix is stored in contiguous arrays (see @ref QVBSRMatrix),
+and the block rows are split in ranges with a similar number of blocks, one for each thread. Each iteration runs
+three parallel steps: the sparse matrix-vector product, the update of the solution, residual and preconditioned
+residual vectors, and the update of the search direction. The dot products are accumulated inside the same
+steps, and every vector is allocated when the solver is created, so no memory is allocated while iterating.
+
+Two preconditioners are available. The block Jacobi preconditioner (@ref BlockJacobi) multiplies by the inverse of
+the diagonal blocks. The block incomplete Cholesky preconditioner (@ref BlockCholesky) uses a factorization
+\f$ A \approx L L^T \f$, where the block lower triangular matrix \f$ L \f$ has the same blocks as the lower triangle
+of \f$ A \f$ (a block <i>IC(0)</i> factorization). Applying it requires a forward and a backward substitution. The
+block rows are grouped in levels, so each level only depends on the previous ones, and the rows of a level are solved
+in parallel. If the factorization breaks down, it is repeated increasing the diagonal of \f$ A \f$ by a small factor.
+
+The sparsity pattern of the matrix is analyzed when the solver is created. The values of the matrix can be changed
+afterwards with @ref setMatrix, which reuses the storage, the threads and the structure of the factorization of the solver.
+
+The solver reports the number of iterations performed and the residual norm after each of them:
+
+@code
+QVSparseBlockMatrix H(numCameras, numCameras, 6, 6);
+[...] // Only the upper triangular blocks of H are set.
+
+QVConjugateGradientSolver<6> solver(H, true, QVConjugateGradientSolver<6>::BlockJacobi);
+solver.solve(x, b, 100, 0, 1e-10);
+
+std::cout << "Iterations: " << solver.getIterations() << std::endl;
+std::cout << "Final residual: " << solver.getResidualHistory().last() << std::endl;
+@endcode
+
+Solvers are available for blocks of size 3 and 6.
+
+@ingroup qvmath
+*/
+template <int BlockSize> class QVConjugateGradientSolver
+    {
+    public:
+        /// @brief Preconditioners available for the solver.
+        typedef enum {
+            /// @brief No preconditioning.
+            NoPreconditioner,
+            /// @brief Block Jacobi preconditioner (inverse of the diagonal blocks).
+            BlockJacobi,
+            /// @brief Block incomplete Cholesky preconditioner, with the sparsity pattern of the matrix.
+            BlockCholesky
+        } TPreconditioner;
+
+        /// @brief Creates a solver for a sparse block matrix.
+        ///
+        /// @param A coefficient matrix. Its blocks must be of size BlockSize x BlockSize.
+        /// @param upperTriangular if true, only the blocks in or above the diagonal of A are used, and A is
+        /// considered symmetric.
+        /// @param preconditioner preconditioner to use.
+        /// @param numThreads number of threads. If 0, the number of processor cores is used. Small matrices
+        /// use less threads.
+        QVConjugateGradientSolver(const QVSparseBlockMatrix &A, const bool upperTriangular = false,
+                                  const TPreconditioner preconditioner = NoPreconditioner, const int numThreads = 0);
+
+        ~QVConjugateGradientSolver();
+
+        /// @brief Changes the values of the coefficient matrix, keeping its sparsity pattern.
+        ///
+        /// The preconditioner is evaluated again for the new values.
+        ///
+        /// @param A coefficient matrix. Only its blocks in or above the diagonal are used, and it is considered symmetric.
+        /// @returns false, without modifying the solver, if the blocks in or above the diagonal of A do not match the
+        /// sparsity pattern of the matrix used to create the solver.
+        bool setMatrix(const QVSparseBlockMatrix &A);
+
+        /// @brief Preconditioner used by the solver.
+        TPreconditioner getPreconditioner() const           { return preconditioner; }
+
+        /// @brief Solves the system.
+        ///
+        /// @param x initial solution, overwritten with the solution found.
+        /// @param b right-hand side vector.
+        /// @param maxIters maximal number of iterations.
+        /// @param minIters the iteration does not stop before this number of iterations.
+        /// @param minAbsoluteError iteration stops when the square norm of the residual is below this value.
+        /// @returns the norm of the residual.
+        double solve(QVVector &x, const QVVector &b, const int maxIters, const int minIters = 0, const double minAbsoluteError = 0.0);
+
+        /// @brief Number of iterations performed in the last call to @ref solve.
+        int getIterations() const                           { return iterations; }
+
+        /// @brief Norm of the residual after each iteration of the last call to @ref solve (the first element is the initial residual).
+        const QVector<double> & getResidualHistory() const  { return residualHistory; }
+
+        /// @brief Number of threads used by the solver.
+        int getNumThreads() const                           { return numThreads; }
+
+    #ifndef DOXYGEN_IGNORE_THIS
+        // Steps of the iteration, evaluated for the block rows of a thread.
+        void runStep(const int step, const int thread);
+    #endif
+
+    private:
+        enum { InitStep, ProductStep, UpdateStep, DirectionStep, InitDotStep, DotStep, ForwardStep, BackwardStep };
+
+        QVBSRMatrix<BlockSize, BlockSize> A;
+        const TPreconditioner preconditioner;
+        int numThreads, rows;
+
+        // Range of block rows of each thread.
+        QVector<int> firstRow;
+
+        // Inverses of the diagonal blocks, for the block Jacobi preconditioner.
+        QVector<double> diagonal;
+
+        // Blocks of the incomplete Cholesky factor L, by block rows, with sorted columns (the diagonal block is the
+        // last one of each row). lowerSource contains the position of each block in A, or -1 if A lacks it.
+        QVector<int> lowerStart, lowerColumns, lowerSource;
+        QVector<double> lowerValues;
+
+        // Blocks of L^T above the diagonal, by block rows, as positions in the arrays of L.
+        QVector<int> upperStart, upperColumns, upperBlocks;
+
+        // Block rows of each level of the forward and backward substitutions, and level solved by the threads.
+        QVector<int> forwardLevelStart, forwardRows, backwardLevelStart, backwardRows;
+        int currentLevel;
+
+        // Vectors of the iteration, and values used by the steps.
+        QVVector r, z, p, Ap;
+        double *zData, *x;
+        const double *b;
+        double alpha, beta;
+
+        // Partial dot products of each thread, spaced to avoid sharing cache lines.
+        enum { PartialStride = 8 };
+        QVector<double> partials;
+
+        int iterations;
+        QVector<double> residualHistory;
+
+        QThreadPool pool;
+        QSemaphore finishedWorkers;
+        QVector<QVConjugateGradientWorker *> workers;
+
+        void runParallel(const int step);
+        double sumPartials(const int index) const;
+        void evaluatePreconditioner();
+        void applyPreconditioner(const int firstBlockRow, const int lastBlockRow);
+
+        void analyzeIncompleteCholesky();
+        bool factorIncompleteCholesky(const double shift);
+        void applyIncompleteCholesky();
+        void solveLevelRows(const int step, const int first, const int last);
+    };
+
+#endif
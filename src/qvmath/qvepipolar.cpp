@@ -19,6 +19,8 @@
  */
 
 #include <qvmath/qvepipolar.h>
+#include <qvmath/qvparallelsampleconsensus.h>
+#include <qvmath/qvpointfmatchingset.h>
 #include <math.h>
 
 // Returns M = DLT matrix
@@ -250,10 +252,9 @@ QVVector symmetricEpipolarDistance2(const QVMatrix &F, const QVector<QPointFMatc
 	return result;
 	}
 
-double symmetricEpipolarDistance(const QVMatrix &F, const QPointFMatching &matching)
+// Symmetric epipolar distance for a fundamental matrix stored as a row-major array of 9 elements.
+static inline double symmetricEpipolarDistance(const double *f, const QPointFMatching &matching)
 	{
-	const double *f = F.getReadData();
-
 	const QPointF	&p1 = matching.first,
 					&p2 = matching.second;
 	const double	p1x = p1.x(), p1y = p1.y(),
@@ -298,6 +299,16 @@ double symmetricEpipolarDistance(const QVMatrix &F, const QPointFMatching &match
 	return ABS(cg0)/sqrt(cg1) + ABS(cg2)/sqrt(cg3);
 	}
 
+double symmetricEpipolarDistance(const QVMatrix &F, const QPointFMatching &matching)
+	{
+	return symmetricEpipolarDistance(F.getReadData(), matching);
+	}
+
+double symmetricEpipolarDistance(const QVFixedMatrix<3,3> &F, const QPointFMatching &matching)
+	{
+	return symmetricEpipolarDistance(F.getReadData(), matching);
+	}
+
 // 10-fold speed up compared to symmetricEpipolarDistance2
 QVVector symmetricEpipolarDistance(const QVMatrix &F, const QVector<QPointFMatching> &matchings)
 	{
@@ -377,6 +388,20 @@ QVVector symmetricEpipolarDistance(const QVMatrix &F, const QVector<QPointFMatch
 	return result;
 	}
 
+QVVector symmetricEpipolarDistance(const QVMatrix &F, const QVPointFMatchingSet &matchings)
+	{
+	QVVector distances(matchings.size());
+	matchings.symmetricEpipolarDistances(F.getReadData(), distances.data());
+	return distances;
+	}
+
+QVVector sampsonDistance(const QVMatrix &F, const QVPointFMatchingSet &matchings)
+	{
+	QVVector distances(matchings.size());
+	matchings.sampsonDistances(F.getReadData(), distances.data());
+	return distances;
+	}
+
 // --------------------------------------------------------------------------
 
 bool iterativeLocalOptimization2(const QList<QPointFMatching> &matchings,  QList<QPointFMatching> &result, const double maxEE, const int minInliers)
@@ -423,6 +448,7 @@ bool iterativeLocalOptimization2(const QList<QPointFMatching> &matchings,  QList
 bool iterativeLocalOptimization(const QList<QPointFMatching> &matchings,  QList<QPointFMatching> &result, const double maxEE, const int minInliers)
 	{
 	result = matchings;
+	QVPointFMatchingSet matchingSet(matchings);
 
 	while(true)
 		{
@@ -432,7 +458,7 @@ bool iterativeLocalOptimization(const QList<QPointFMatching> &matchings,  QList<
 			return false;
 
 		// Evaluate symmetric epipolar error for the matchings.
-		const QVVector residuals = symmetricEpipolarDistance(F, result.toVector());
+		const QVVector residuals = symmetricEpipolarDistance(F, matchingSet);
 
 		// If the maximal error is below a threshold value 'maxEE', the algorithm successes and returns the fundamental matrix.
 		const double actualMax = residuals.max();
@@ -449,9 +475,10 @@ bool iterativeLocalOptimization(const QList<QPointFMatching> &matchings,  QList<
 
 		// Otherwise, eliminate matchings with an error above a threshold value.
 		// This value is the maximal of two times the median and 'maxEE'.
+		QVector<bool> mask(residuals.count());
 		QList<QPointFMatching> newMatchings;
 		for(int i = 0; i < residuals.count(); i++)
-			if (residuals[i] < MAX(2*median, maxEE))
+			if ( (mask[i] = (residuals[i] < MAX(2*median, maxEE))) )
 				newMatchings << result[i];
 
 		// If there are not enough remaining matchings, return fail.
@@ -460,8 +487,64 @@ bool iterativeLocalOptimization(const QList<QPointFMatching> &matchings,  QList<
 
 		// Otherwise start again the filtering process.
 		result = newMatchings;
+		matchingSet = matchingSet.select(mask);
 		}
 
 	return true;
 	}
 
+#ifndef DOXYGEN_IGNORE_THIS
+class QVFundamentalMatrixRANSAC: public QVParallelRANSAC<QPointFMatching, QVFixedMatrix<3,3> >
+	{
+	private:
+		const double maxEE;
+		QVPointFMatchingSet matchingSet;
+
+	protected:
+		bool init()
+			{
+			matchingSet = QVPointFMatchingSet(elements);
+			return true;
+			}
+
+		int testElements(const QVFixedMatrix<3,3> &F, QVector<bool> &mask) const
+			{
+			QVector<double> distances(matchingSet.size());
+			matchingSet.symmetricEpipolarDistances(F.getReadData(), distances.data());
+			return matchingSet.selectInliers(distances.constData(), maxEE, &mask);
+			}
+
+	public:
+		QVFundamentalMatrixRANSAC(const QList<QPointFMatching> &matchings, const double maxEE, const int minInliers, const double confidence):
+			QVParallelRANSAC<QPointFMatching, QVFixedMatrix<3,3> >(8, minInliers, confidence), maxEE(maxEE)
+			{
+			setSPRTParameters(200.0);
+			foreach(QPointFMatching matching, matchings)
+				addElement(matching);
+			}
+
+		bool fit(const QList<QPointFMatching> &matchings, QVFixedMatrix<3,3> &F) const
+			{
+			QVMatrix fundamental;
+			if (not computeFundamentalMatrix(matchings.toVector(), fundamental))
+				return false;
+			F = fundamental;
+			return true;
+			}
+
+		bool test(const QVFixedMatrix<3,3> &F, const QPointFMatching &matching) const
+			{ return symmetricEpipolarDistance(F, matching) < maxEE; }
+	};
+#endif // DOXYGEN_IGNORE_THIS
+
+bool computeFundamentalMatrixRANSAC(const QList<QPointFMatching> &matchings, QVMatrix &F, QList<QPointFMatching> &inliers,
+									const double maxEE, const int minInliers, const int maxIterations, const double confidence)
+	{
+	QVFundamentalMatrixRANSAC ransac(matchings, maxEE, minInliers, confidence);
+	if (not ransac.iterate(maxIterations))
+		return false;
+
+	F = ransac.getBestModel();
+	inliers = ransac.getBestInliers();
+	return true;
+	}
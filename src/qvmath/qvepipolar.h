@@ -24,6 +24,7 @@
 #include <qvmath.h>
 #include <QVMatrix>
 #include <qvprojective.h>
+#include <qvmath/qvpointfmatchingset.h>
 
 #define	MIN_FUNDAMENTAL_MATRIX_NORM	1e-16
 
@@ -69,6 +70,18 @@ Where \f$ d(p,l) \f$ is the euclidean distance in the 2D plane between the point
 */
 double symmetricEpipolarDistance(const QVMatrix &F, const QPointFMatching &matching);
 
+/*!
+@brief Evaluates the symmetric epipolar distance for a point matching, using a fixed size fundamental matrix.
+
+This is an overloaded version of the function @ref symmetricEpipolarDistance(const QVMatrix &, const QPointFMatching &), which avoids the memory allocation and reference counting overhead of the @ref QVMatrix class.
+
+@param F Fundamental matrix.
+@param matching Point matching.
+@returns The symmetric epipolar distance \f$ e \f$.
+@ingroup qvprojectivegeometry
+*/
+double symmetricEpipolarDistance(const QVFixedMatrix<3,3> &F, const QPointFMatching &matching);
+
 
 /*!
 @brief Evaluate symmetric epipolar errors for a fundamental matrix defined between two images and a list of image point correspondences.
@@ -86,6 +99,34 @@ Where \f$ d(p,l) \f$ is the euclidean distance in the 2D plane between the point
 */
 QVVector symmetricEpipolarDistance(const QVMatrix &F, const QVector<QPointFMatching> &matchings);
 
+/*!
+@brief Evaluate symmetric epipolar errors for a fundamental matrix and a set of image point correspondences.
+
+This is an overloaded version of the function @ref symmetricEpipolarDistance(const QVMatrix &, const QVector<QPointFMatching> &),
+which evaluates the errors with the SIMD kernels of the class @ref QVPointFMatchingSet.
+
+@param F fundamental matrix.
+@param matchings set of point matchings.
+@returns A vector, containing the distance \f$ e_i \f$ for each matching.
+@ingroup qvprojectivegeometry
+*/
+QVVector symmetricEpipolarDistance(const QVMatrix &F, const QVPointFMatchingSet &matchings);
+
+/*!
+@brief Evaluate the Sampson distances for a fundamental matrix and a set of image point correspondences.
+
+The Sampson distance is a first order approximation to the squared reprojection error of an image point correspondence
+for a given fundamental matrix:
+
+\f$ e_i = \frac{(x'^T_i F x_i)^2}{(Fx_i)_1^2 + (Fx_i)_2^2 + (F^Tx'_i)_1^2 + (F^Tx'_i)_2^2} \f$
+
+@param F fundamental matrix.
+@param matchings set of point matchings.
+@returns A vector, containing the distance \f$ e_i \f$ for each matching.
+@ingroup qvprojectivegeometry
+*/
+QVVector sampsonDistance(const QVMatrix &F, const QVPointFMatchingSet &matchings);
+
 /*! @brief Iterative matching selection for local optimization in LO-RANSAC.
 
 This algorithm implements the method used in LO-RANSAC, as described in [1], to eliminate iteratively the outliers of a set of image point matchings.
@@ -108,5 +149,27 @@ The procedure is as follows:
 */
 bool iterativeLocalOptimization(const QList<QPointFMatching> &matchings,  QList<QPointFMatching> &result, const double maxEE = 1.0, const int minInliers = 32);
 
+/*!
+@brief Robust estimation of the fundamental matrix from a set of image point matchings containing outliers.
+
+This function uses the @ref QVParallelRANSAC engine to search for the fundamental matrix with the largest set of
+matchings whose symmetric epipolar distance (see @ref symmetricEpipolarDistance) is below a threshold value. Tentative
+fundamental matrices are obtained with the normalized 8-point algorithm, verified sequentially in several threads, and the
+best one is fitted again to its inlier matchings.
+
+@param matchings list of image point matchings.
+@param F output fundamental matrix.
+@param inliers output list containing the matchings consistent with the fundamental matrix.
+@param maxEE threshold value for maximal admissible epipolar error.
+@param minInliers minimal number of inliers admissible.
+@param maxIterations maximal number of sample sets of 8 matchings to test.
+@param confidence probability of drawing at least one sample set without outliers, used to stop the search.
+@returns true if a fundamental matrix consistent with at least <i>minInliers</i> matchings was found, false otherwise.
+@ingroup qvprojectivegeometry
+*/
+bool computeFundamentalMatrixRANSAC(const QList<QPointFMatching> &matchings, QVMatrix &F, QList<QPointFMatching> &inliers,
+                                    const double maxEE = 1.0, const int minInliers = 16, const int maxIterations = 2000,
+                                    const double confidence = 0.99);
+
 #endif // QVEPIPOLAR_H
 
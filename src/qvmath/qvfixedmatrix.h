@@ -0,0 +1,397 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVFIXEDMATRIX_H
+#define QVFIXEDMATRIX_H
+
+#include <math.h>
+#include <iostream>
+
+#include <QPointF>
+#include <qvmath/qvvector.h>
+#include <qvmath/qvmatrix.h>
+
+/*!
+@class QVFixedVector qvmath/qvfixedmatrix.h QVFixedVector
+@brief Numerical vector with a size fixed at compile time.
+
+Unlike @ref QVVector, this class stores its elements inside the object, so creating, copying and destroying these
+vectors does not allocate memory. The size is a template parameter, so the loops of the arithmetic operators are
+unrolled by the compiler. It is intended for the small vectors (2, 3 or 4 elements) used in the geometry functions.
+
+These vectors can be converted implicitly from and to @ref QVVector objects.
+
+@see QVFixedMatrix
+@ingroup qvmath
+*/
+template <int N> class QVFixedVector
+    {
+    protected:
+        double data[N];
+
+    public:
+        /// @brief Number of elements of the vector.
+        enum { Size = N };
+
+        /// @brief Creates a vector with every element set to a given value (zero by default).
+        explicit QVFixedVector(const double value = 0.0)
+            { for(int i = 0; i < N; i++) data[i] = value; }
+
+        /// @brief Creates a vector from an array of N values.
+        explicit QVFixedVector(const double *values)
+            { for(int i = 0; i < N; i++) data[i] = values[i]; }
+
+        /// @brief Convert constructor from a QVVector of size N.
+        QVFixedVector(const QVVector &vector)
+            {
+            if (vector.size() != N)
+                {
+                std::cout << "[QVFixedVector] Error: tried to construct a fixed vector of size " << N
+                          << " from a vector of size " << vector.size() << "." << std::endl;
+                exit(1);
+                }
+            const double *values = vector.constData();
+            for(int i = 0; i < N; i++)
+                data[i] = values[i];
+            }
+
+        /// @brief Converts the vector to a QVVector.
+        operator QVVector() const               { return QVVector(N, data); }
+
+        /// @brief Gets the size of the vector.
+        int size() const                        { return N; }
+
+        /// @brief Gets a pointer to the elements of the vector.
+        const double *getReadData() const       { return data; }
+
+        /// @brief Gets a pointer to the elements of the vector.
+        double *getWriteData()                  { return data; }
+
+        /// @brief Element access operator.
+        double & operator[](const int i)        { Q_ASSERT(i >= 0 and i < N); return data[i]; }
+
+        /// @brief Element access operator.
+        double operator[](const int i) const    { Q_ASSERT(i >= 0 and i < N); return data[i]; }
+
+        /// @brief Vector addition.
+        QVFixedVector operator+(const QVFixedVector &other) const
+            { QVFixedVector result; for(int i = 0; i < N; i++) result.data[i] = data[i] + other.data[i]; return result; }
+
+        /// @brief Vector substraction.
+        QVFixedVector operator-(const QVFixedVector &other) const
+            { QVFixedVector result; for(int i = 0; i < N; i++) result.data[i] = data[i] - other.data[i]; return result; }
+
+        /// @brief Product by a scalar value.
+        QVFixedVector operator*(const double value) const
+            { QVFixedVector result; for(int i = 0; i < N; i++) result.data[i] = data[i] * value; return result; }
+
+        /// @brief Division by a scalar value.
+        QVFixedVector operator/(const double value) const
+            { QVFixedVector result; for(int i = 0; i < N; i++) result.data[i] = data[i] / value; return result; }
+
+        /// @brief Dot product.
+        double operator*(const QVFixedVector &other) const      { return dotProduct(other); }
+
+        /// @brief Dot product.
+        double dotProduct(const QVFixedVector &other) const
+            { double result = 0.0; for(int i = 0; i < N; i++) result += data[i] * other.data[i]; return result; }
+
+        /// @brief Cross product (only for vectors of size 3).
+        QVFixedVector crossProduct(const QVFixedVector &other) const
+            {
+            Q_ASSERT(N == 3);
+            QVFixedVector result;
+            result.data[0] = data[1] * other.data[2] - data[2] * other.data[1];
+            result.data[1] = data[2] * other.data[0] - data[0] * other.data[2];
+            result.data[2] = data[0] * other.data[1] - data[1] * other.data[0];
+            return result;
+            }
+
+        /// @brief Euclidean norm of the vector.
+        double norm2() const                    { return sqrt(dotProduct(*this)); }
+
+        /// @brief Gets the vector divided by its norm.
+        QVFixedVector normalize() const         { return operator/(norm2()); }
+    };
+
+/*!
+@class QVFixedMatrix qvmath/qvfixedmatrix.h QVFixedMatrix
+@brief Numerical matrix with dimensions fixed at compile time.
+
+This class stores the elements of the matrix, in row major order, inside the object. Unlike @ref QVMatrix objects,
+these matrices do not allocate memory, and their products do not use the BLAS routines, whose call overhead
+dominates the cost for the small matrices (3x3, 3x4, 4x4) used in the geometry functions. The dimensions are
+template parameters, so the loops of the arithmetic operators are unrolled by the compiler.
+
+Fixed matrices can be converted implicitly from and to @ref QVMatrix objects, so they can be passed to any function
+taking a QVMatrix:
+
+@code
+const QVFixedMatrix<3,3> H = computeProjectiveHomography(matchings);
+const QPointF p = applyHomography(H, QPointF(10, 20));	// Uses the fixed size overload.
+@endcode
+
+@see QVFixedVector
+@ingroup qvmath
+*/
+template <int R, int C> class QVFixedMatrix
+    {
+    protected:
+        double data[R*C];
+
+    public:
+        /// @brief Number of rows and columns of the matrix.
+        enum { Rows = R, Cols = C };
+
+        /// @brief Creates a matrix with every element set to a given value (zero by default).
+        explicit QVFixedMatrix(const double value = 0.0)
+            { for(int i = 0; i < R*C; i++) data[i] = value; }
+
+        /// @brief Creates a matrix from an array of R*C values, in row major order.
+        explicit QVFixedMatrix(const double *values)
+            { for(int i = 0; i < R*C; i++) data[i] = values[i]; }
+
+        /// @brief Convert constructor from a QVMatrix of size R x C.
+        QVFixedMatrix(const QVMatrix &matrix)
+            {
+            if (matrix.getRows() != R or matrix.getCols() != C)
+                {
+                std::cout << "[QVFixedMatrix] Error: tried to construct a fixed matrix of size " << R << "x" << C
+                          << " from a matrix of size " << matrix.getRows() << "x" << matrix.getCols() << "." << std::endl;
+                exit(1);
+                }
+            const double *values = matrix.getReadData();
+            for(int i = 0; i < R*C; i++)
+                data[i] = values[i];
+            }
+
+        /// @brief Converts the matrix to a QVMatrix.
+        operator QVMatrix() const                               { return QVMatrix(R, C, data); }
+
+        /// @brief Gets the identity matrix.
+        static QVFixedMatrix identity()
+            {
+            QVFixedMatrix result;
+            for(int i = 0; i < R and i < C; i++)
+                result.data[i*C + i] = 1.0;
+            return result;
+            }
+
+        /// @brief Gets the number of rows of the matrix.
+        int getRows() const                                     { return R; }
+
+        /// @brief Gets the number of columns of the matrix.
+        int getCols() const                                     { return C; }
+
+        /// @brief Gets a pointer to the elements of the matrix, in row major order.
+        const double *getReadData() const                       { return data; }
+
+        /// @brief Gets a pointer to the elements of the matrix, in row major order.
+        double *getWriteData()                                  { return data; }
+
+        /// @brief Element access operator.
+        double & operator()(const int row, const int col)
+            { Q_ASSERT(row >= 0 and row < R and col >= 0 and col < C); return data[row*C + col]; }
+
+        /// @brief Element access operator.
+        double operator()(const int row, const int col) const
+            { Q_ASSERT(row >= 0 and row < R and col >= 0 and col < C); return data[row*C + col]; }
+
+        /// @brief Gets a row of the matrix.
+        QVFixedVector<C> getRow(const int row) const            { return QVFixedVector<C>(data + row*C); }
+
+        /// @brief Gets a column of the matrix.
+        QVFixedVector<R> getCol(const int col) const
+            { QVFixedVector<R> result; for(int i = 0; i < R; i++) result[i] = data[i*C + col]; return result; }
+
+        /// @brief Matrix addition.
+        QVFixedMatrix operator+(const QVFixedMatrix &other) const
+            { QVFixedMatrix result; for(int i = 0; i < R*C; i++) result.data[i] = data[i] + other.data[i]; return result; }
+
+        /// @brief Matrix substraction.
+        QVFixedMatrix operator-(const QVFixedMatrix &other) const
+            { QVFixedMatrix result; for(int i = 0; i < R*C; i++) result.data[i] = data[i] - other.data[i]; return result; }
+
+        /// @brief Product by a scalar value.
+        QVFixedMatrix operator*(const double value) const
+            { QVFixedMatrix result; for(int i = 0; i < R*C; i++) result.data[i] = data[i] * value; return result; }
+
+        /// @brief Division by a scalar value.
+        QVFixedMatrix operator/(const double value) const
+            { QVFixedMatrix result; for(int i = 0; i < R*C; i++) result.data[i] = data[i] / value; return result; }
+
+        /// @brief Matrix product.
+        template <int K> QVFixedMatrix<R,K> operator*(const QVFixedMatrix<C,K> &other) const
+            {
+            QVFixedMatrix<R,K> result;
+            const double *b = other.getReadData();
+            double *c = result.getWriteData();
+            for(int i = 0; i < R; i++)
+                for(int k = 0; k < K; k++)
+                    {
+                    double accum = 0.0;
+                    for(int j = 0; j < C; j++)
+                        accum += data[i*C + j] * b[j*K + k];
+                    c[i*K + k] = accum;
+                    }
+            return result;
+            }
+
+        /// @brief Matrix-vector product.
+        QVFixedVector<R> operator*(const QVFixedVector<C> &vector) const
+            {
+            QVFixedVector<R> result;
+            for(int i = 0; i < R; i++)
+                {
+                double accum = 0.0;
+                for(int j = 0; j < C; j++)
+                    accum += data[i*C + j] * vector[j];
+                result[i] = accum;
+                }
+            return result;
+            }
+
+        /// @brief Gets the transpose of the matrix.
+        QVFixedMatrix<C,R> transpose() const
+            {
+            QVFixedMatrix<C,R> result;
+            double *t = result.getWriteData();
+            for(int i = 0; i < R; i++)
+                for(int j = 0; j < C; j++)
+                    t[j*R + i] = data[i*C + j];
+            return result;
+            }
+
+        /// @brief Gets the trace of the matrix.
+        double trace() const
+            { double result = 0.0; for(int i = 0; i < R and i < C; i++) result += data[i*C + i]; return result; }
+
+        /// @brief Gets the Frobenius norm of the matrix.
+        double norm2() const
+            { double result = 0.0; for(int i = 0; i < R*C; i++) result += data[i] * data[i]; return sqrt(result); }
+
+        /// @brief Gets the determinant of the matrix (only for 3x3 matrices).
+        double det() const
+            {
+            Q_ASSERT(R == 3 and C == 3);
+            return	data[0] * (data[4] * data[8] - data[5] * data[7])
+                -	data[1] * (data[3] * data[8] - data[5] * data[6])
+                +	data[2] * (data[3] * data[7] - data[4] * data[6]);
+            }
+    };
+
+/// @brief Product of a scalar value and a fixed size vector.
+template <int N> QVFixedVector<N> operator*(const double value, const QVFixedVector<N> &vector)   { return vector * value; }
+
+/// @brief Product of a scalar value and a fixed size matrix.
+template <int R, int C> QVFixedMatrix<R,C> operator*(const double value, const QVFixedMatrix<R,C> &matrix)   { return matrix * value; }
+
+/// @brief Product of a row vector and a fixed size matrix.
+template <int R, int C> QVFixedVector<C> operator*(const QVFixedVector<R> &vector, const QVFixedMatrix<R,C> &matrix)
+    {
+    QVFixedVector<C> result;
+    for(int j = 0; j < C; j++)
+        {
+        double accum = 0.0;
+        for(int i = 0; i < R; i++)
+            accum += vector[i] * matrix(i,j);
+        result[j] = accum;
+        }
+    return result;
+    }
+
+/// @brief Prints a fixed size vector.
+template <int N> std::ostream& operator << ( std::ostream &os, const QVFixedVector<N> &vector )    { return os << QVVector(vector); }
+
+/// @brief Prints a fixed size matrix.
+template <int R, int C> std::ostream& operator << ( std::ostream &os, const QVFixedMatrix<R,C> &matrix )    { return os << QVMatrix(matrix); }
+
+/*!
+@brief Solves a small homogeneous linear system \f$ A x = 0 \f$ with fixed size.
+
+The solution is the unit eigenvector of \f$ A^T A \f$ corresponding to its smallest eigenvalue. It is obtained with
+the cyclic Jacobi eigenvalue algorithm, which for these sizes is faster than a general SVD on a @ref QVMatrix.
+
+@param A coefficient matrix.
+@param x unit vector minimizing \f$ \| A x \| \f$ (overwritten on output).
+@see solveHomogeneous(const QVMatrix &, QVector<double> &, const TQVSVD_Method)
+@ingroup qvmath
+*/
+template <int R, int N> void solveHomogeneous(const QVFixedMatrix<R,N> &A, QVFixedVector<N> &x)
+    {
+    QVFixedMatrix<N,N> S = A.transpose() * A, V = QVFixedMatrix<N,N>::identity();
+
+    for(int sweep = 0; sweep < 32; sweep++)
+        {
+        double offDiagonal = 0.0, diagonal = 0.0;
+        for(int p = 0; p < N; p++)
+            {
+            diagonal += S(p,p) * S(p,p);
+            for(int q = p+1; q < N; q++)
+                offDiagonal += S(p,q) * S(p,q);
+            }
+        if (offDiagonal <= 1e-30 * diagonal)
+            break;
+
+        for(int p = 0; p < N; p++)
+            for(int q = p+1; q < N; q++)
+                {
+                if (S(p,q) == 0.0)
+                    continue;
+
+                // Rotation annihilating S(p,q).
+                const double    theta = (S(q,q) - S(p,p)) / (2.0 * S(p,q)),
+                                t = ((theta >= 0.0)? 1.0: -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0)),
+                                c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+
+                for(int k = 0; k < N; k++)
+                    {
+                    const double skp = S(k,p), skq = S(k,q);
+                    S(k,p) = c * skp - s * skq;
+                    S(k,q) = s * skp + c * skq;
+                    }
+                for(int k = 0; k < N; k++)
+                    {
+                    const double spk = S(p,k), sqk = S(q,k);
+                    S(p,k) = c * spk - s * sqk;
+                    S(q,k) = s * spk + c * sqk;
+                    }
+                for(int k = 0; k < N; k++)
+                    {
+                    const double vkp = V(k,p), vkq = V(k,q);
+                    V(k,p) = c * vkp - s * vkq;
+                    V(k,q) = s * vkp + c * vkq;
+                    }
+                }
+        }
+
+    int smallest = 0;
+    for(int i = 1; i < N; i++)
+        if (S(i,i) < S(smallest,smallest))
+            smallest = i;
+
+    x = V.getCol(smallest);
+    }
+
+#endif
@@ -57,6 +57,9 @@
         QVArrayIndex(const QVMatrix &matrix, const int col): matrix(&matrix), row(-1), col(col) { };
     };*/
 
+class QVMatrixProduct;
+template <class E> class QVMatrixExpression;
+
 /*!
 @class QVMatrix qvmath/qvmatrix.h QVMatrix
 @brief Implementation of numerical matrices.
@@ -283,6 +286,53 @@ class QVMatrix
         /// @param matrix matrix to be copied.
         QVMatrix & operator=(const QVMatrix &matrix);
 
+        // Lazy expression operators
+
+        /// @brief Constructs a matrix evaluating a lazy matrix expression.
+        ///
+        /// @param expression expression to evaluate, in a single pass.
+        /// @see QVMatrixExpression
+        template <class E> QVMatrix(const QVMatrixExpression<E> &expression);
+
+        /// @brief Evaluates a lazy matrix expression, reusing the data buffer of the matrix when possible.
+        ///
+        /// @param expression expression to evaluate, in a single pass.
+        /// @see QVMatrixExpression
+        template <class E> QVMatrix & operator=(const QVMatrixExpression<E> &expression);
+
+        /// @brief Adds a lazy matrix expression to the matrix, without creating temporary matrices.
+        ///
+        /// @param expression expression to add.
+        /// @see QVMatrixExpression
+        template <class E> QVMatrix & operator+=(const QVMatrixExpression<E> &expression);
+
+        /// @brief Substracts a lazy matrix expression from the matrix, without creating temporary matrices.
+        ///
+        /// @param expression expression to substract.
+        /// @see QVMatrixExpression
+        template <class E> QVMatrix & operator-=(const QVMatrixExpression<E> &expression);
+
+        /// @brief Constructs a matrix evaluating a lazy matrix product, with a single gemm call.
+        ///
+        /// @param product product to evaluate.
+        /// @see QVMatrixExpression
+        QVMatrix(const QVMatrixProduct &product);
+
+        /// @brief Evaluates a lazy matrix product, with a single gemm call.
+        ///
+        /// @param product product to evaluate.
+        QVMatrix & operator=(const QVMatrixProduct &product);
+
+        /// @brief Accumulates a lazy matrix product on the matrix, with a single gemm call.
+        ///
+        /// @param product product to add.
+        QVMatrix & operator+=(const QVMatrixProduct &product);
+
+        /// @brief Substracts a lazy matrix product from the matrix, with a single gemm call.
+        ///
+        /// @param product product to substract.
+        QVMatrix & operator-=(const QVMatrixProduct &product);
+
         // Matrix-matrix operators
 
         /// @brief Matrix-matrix equality operator
@@ -1020,5 +1070,7 @@ QVMatrix expSO3(const QV3DPointF& w);
 #include <QMetaType>
 Q_DECLARE_METATYPE(QVMatrix);
 
+#include <qvmath/qvmatrixexpression.h>
+
 #endif
 
@@ -76,6 +76,8 @@ extern "C" {
 #endif
 
 #include <QVPermutation>
+#include <QVConjugateGradientSolver>
+#include <QThreadStorage>
 
 void singularValueDecomposition_internal(const QVMatrix &M, QVMatrix &U, QVVector &s, QVMatrix &V,
                                          const TQVSVD_Method method, bool only_singular_values = false)
@@ -1113,8 +1115,63 @@ double solveResidual(const QVMatrix &M, const QVVector &x, const QVVector &b)
 }
 
 #ifndef DOXYGEN_IGNORE_THIS
+// Conjugate gradient on a BSR matrix. Vectors are allocated once, and updated in place in each iteration.
+template <int BlockRows, int BlockCols> double solveConjugateGradientBSR(const QVBSRMatrix<BlockRows, BlockCols> &A, QVVector &x, const QVVector &b,
+                                                                         const int maxIters, const int minIters, const double minAbsoluteError)
+    {
+    const int n = b.size();
+    QVVector r(n), p(n), Ap(n);
+
+    A.dotProduct(x, r);
+    for (int k = 0; k < n; k++)
+        r[k] = b[k] - r[k];
+    p = r;
+    double rsold = r.dotProduct(r);
+
+    double *xPtr = x.data(), *rPtr = r.data(), *pPtr = p.data(), *ApPtr = Ap.data();
+    for (int i = 0; i < maxIters; i++)
+        {
+        A.dotProduct(pPtr, ApPtr);
+
+        double pAp = 0.0;
+        for (int k = 0; k < n; k++)
+            pAp += pPtr[k] * ApPtr[k];
+
+        const double alpha = rsold / pAp;
+        double rsnew = 0.0;
+        for (int k = 0; k < n; k++)
+            {
+            xPtr[k] += alpha * pPtr[k];
+            rPtr[k] -= alpha * ApPtr[k];
+            rsnew += rPtr[k] * rPtr[k];
+            }
+
+        if ( (rsnew < minAbsoluteError) and (i > minIters) )
+            break;
+
+        const double beta = rsnew / rsold;
+        for (int k = 0; k < n; k++)
+            pPtr[k] = rPtr[k] + beta * pPtr[k];
+        rsold = rsnew;
+        }
+
+    return sqrt(rsold);
+    }
+
+double solveConjugateGradient(const QVBSRMatrix66 &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters, const double minAbsoluteError)
+    { return solveConjugateGradientBSR(A, x, b, maxIters, minIters, minAbsoluteError); }
+
+double solveConjugateGradient(const QVBSRMatrix33 &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters, const double minAbsoluteError)
+    { return solveConjugateGradientBSR(A, x, b, maxIters, minIters, minAbsoluteError); }
+
 double solveConjugateGradient(const QVSparseBlockMatrix &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters, const double minAbsoluteError)
-    {				
+    {
+    // Use the contiguous representation for the common block sizes.
+    if (A.getMinorRows() == 6 and A.getMinorCols() == 6)
+        return solveConjugateGradient(QVBSRMatrix66(A), x, b, maxIters, minIters, minAbsoluteError);
+    if (A.getMinorRows() == 3 and A.getMinorCols() == 3)
+        return solveConjugateGradient(QVBSRMatrix33(A), x, b, maxIters, minIters, minAbsoluteError);
+
     QVVector	r = b - A.dotProduct(x),
 				p = r;
     double rsold = r.dotProduct(r);
@@ -1213,10 +1270,48 @@ bool blockJacobiPreconditioning(QVSparseBlockMatrix &A, QVVector &b)
 
 int dummy;
 
+// Last conjugate gradient solver used by each thread. Iterative optimizations solve many systems with the same sparsity
+// pattern, so the solver (with its threads, its storage and the analysis of the preconditioner) is reused while the
+// pattern and the preconditioner do not change.
+template <int BlockSize> struct QVConjugateGradientSolverCache
+	{
+	static QThreadStorage<QVConjugateGradientSolver<BlockSize> *> solvers;
+	};
+
+template <int BlockSize> QThreadStorage<QVConjugateGradientSolver<BlockSize> *> QVConjugateGradientSolverCache<BlockSize>::solvers;
+
+// Multithreaded conjugate gradient for the QV_SCG, QV_BJPCG and QV_BCPCG methods, on symmetric matrices with only
+// their upper triangular blocks defined.
+template <int BlockSize> double solveConjugateGradient(const QVSparseBlockMatrix &A, const TQVSparseSolve_Method method,
+                                                       QVVector &x, const QVVector &b, const int iters, const double resid,
+                                                       int &final_iter_count, QVector<double> *residual_history)
+	{
+	typedef QVConjugateGradientSolver<BlockSize> Solver;
+	const typename Solver::TPreconditioner preconditioner =	(method == QV_BJPCG)? Solver::BlockJacobi:
+								(method == QV_BCPCG)? Solver::BlockCholesky: Solver::NoPreconditioner;
+
+	QThreadStorage<Solver *> &solvers = QVConjugateGradientSolverCache<BlockSize>::solvers;
+	Solver *solver = solvers.hasLocalData()? solvers.localData(): NULL;
+	if (solver == NULL or solver->getPreconditioner() != preconditioner or not solver->setMatrix(A))
+		{
+		// Setting the local data deletes the previous solver of the thread.
+		solver = new Solver(A, true, preconditioner);
+		solvers.setLocalData(solver);
+		}
+
+	const double residual = solver->solve(x, b, iters, 0, resid);
+
+	final_iter_count = solver->getIterations();
+	if (residual_history != NULL)
+		*residual_history = solver->getResidualHistory();
+
+	return residual;
+	}
+
 double sparseSolve(const QVSparseBlockMatrix &qvspmatrixPre, QVVector &x, const QVVector &bPre,
                  const bool isSymmetric, const bool isPosDefinite, const TQVSparseSolve_Method method,
                  const bool start_from_x, const bool iters_or_resid,
-                 const int iters, const double resid, int &final_iter_count)
+                 const int iters, const double resid, int &final_iter_count, QVector<double> *residual_history)
     {
 	QVSparseBlockMatrix qvspmatrix = qvspmatrixPre;
 	QVVector b = bPre;
@@ -1425,10 +1520,19 @@ double sparseSolve(const QVSparseBlockMatrix &qvspmatrixPre, QVVector &x, const
             }
 
 		case QV_BJPCG:
+		case QV_BCPCG:
 			{
 			if ( not isSymmetric )
 				qFatal("[sparseSolve] Cannot use block Jacobi preconditioner on a non-symmetric coefficient matrix.");
 
+			if (qvspmatrix.getMinorRows() == 6 and qvspmatrix.getMinorCols() == 6)
+				return solveConjugateGradient<6>(qvspmatrix, method, x, b, iters, resid, final_iter_count, residual_history);
+			if (qvspmatrix.getMinorRows() == 3 and qvspmatrix.getMinorCols() == 3)
+				return solveConjugateGradient<3>(qvspmatrix, method, x, b, iters, resid, final_iter_count, residual_history);
+
+			if (method == QV_BCPCG)
+				std::cout << "[sparseSolve] Warning: block Cholesky preconditioner only available for blocks of size 3 or 6, using block Jacobi preconditioner." << std::endl;
+
 			QVSparseBlockMatrix invM;
 			if (not blockJacobiPreconditionMatrix(qvspmatrix, b, invM))
 				return false;
@@ -1439,6 +1543,12 @@ double sparseSolve(const QVSparseBlockMatrix &qvspmatrixPre, QVVector &x, const
 
         case QV_SCG:
             {
+			// For the common block sizes, the upper triangular blocks are used directly, without mirroring them.
+			if (qvspmatrix.getMinorRows() == 6 and qvspmatrix.getMinorCols() == 6)
+				return solveConjugateGradient<6>(qvspmatrix, method, x, b, iters, resid, final_iter_count, residual_history);
+			if (qvspmatrix.getMinorRows() == 3 and qvspmatrix.getMinorCols() == 3)
+				return solveConjugateGradient<3>(qvspmatrix, method, x, b, iters, resid, final_iter_count, residual_history);
+
 			foreach(int ib, qvspmatrix.keys())
 				{
 				const QMap<int, QVMatrix> &majorRow = qvspmatrix[ib];
@@ -35,6 +35,7 @@
 #include <QV3DPointF>
 #include <qvmath/qvmatrix.h>
 #include <QVSparseBlockMatrix>
+#include <QVBSRMatrix>
 
 // Substituted default values.
 //	#define DEFAULT_TQVSVD_METHOD			GSL_THIN_DECOMP_MOD
@@ -143,7 +144,9 @@ typedef enum {
 	/// Block Jacobian preconditioned conjugate gradient.
     QV_BJPCG = 4,
 	/// Direct dense method.
-    QV_DENSE = 5
+    QV_DENSE = 5,
+	/// Conjugate gradient preconditioned with a block incomplete Cholesky factorization.
+    QV_BCPCG = 6
 } TQVSparseSolve_Method;
 
 
@@ -1112,7 +1115,11 @@ Given a coefficient matrix <i>M</i> and an objective vector <i>b</i>, this funct
 @param iters_or_resid only for the QVMKL_ISS method, if true, use max iterations termination test (see param iters), otherwise use max residual (see param max_resid)
 @param iters only for the incremental methods (QVMKL_ISS and QV_SCG). Number of iterations to execute (if zero, iterate until convergence or error)
 @param max_resid only for the incremental methods (QVMKL_ISS and QV_SCG). Iterate until square of residual is below this parameter
-@param iters only for the QVMKL_ISS method, final number of iterations really executed (overwritten on output)
+@param final_iter_count only for the incremental methods (QVMKL_ISS, QV_SCG, QV_BJPCG and QV_BCPCG), final number of iterations really executed (overwritten on output). For the conjugate gradient methods, it is set only for blocks of size 3 or 6.
+@param residual_history only for the QV_SCG, QV_BJPCG and QV_BCPCG methods, with blocks of size 3 or 6. If not NULL, the norm of the residual after each iteration is stored in this vector (the first element is the initial residual).
+
+For blocks of size 3 or 6, the conjugate gradient methods run on several threads (see @ref QVConjugateGradientSolver). Each
+thread keeps the last solver it used, and reuses it while the sparsity pattern of M and the method do not change.
 
 @returns square norm of current residual, for  incremental methods (QVMKL_ISS and QV_SCG), always 0.0 for QVMKL_DSS
 
@@ -1124,7 +1131,7 @@ double sparseSolve(const QVSparseBlockMatrix &M, QVVector &x, const QVVector &b,
                  const bool isSymmetric = false, const bool isPosDefinite = false,
                  const TQVSparseSolve_Method method = DEFAULT_TQVSPARSESOLVE_METHOD, const bool start_from_x = false,
                  const bool iters_or_resid = true, const int iters = 0, const double resid = 1.0E-10,
-                 int &final_iter_count = dummy);
+                 int &final_iter_count = dummy, QVector<double> *residual_history = NULL);
 
 /*! @brief Solves a sparse homogeneous linear system using the <a href="http://en.wikipedia.org/wiki/Inverse_iteration">inverse iteration</a> algorithm and the MKL sparse routines.
 
@@ -1153,6 +1160,8 @@ bool solveHomogeneous(const QVSparseBlockMatrix &A, QVVector &x, const int maxIt
 void cold_start_mkl_initialization(const int size = 2);
 
 double solveConjugateGradient(const QVSparseBlockMatrix &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters = 0, const double minAbsoluteError = 0.0);
+double solveConjugateGradient(const QVBSRMatrix66 &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters = 0, const double minAbsoluteError = 0.0);
+double solveConjugateGradient(const QVBSRMatrix33 &A, QVVector &x, const QVVector &b, const int maxIters, const int minIters = 0, const double minAbsoluteError = 0.0);
 
 double sparseSolve(const MKLPardisoSparseFormat &pardisomatrix, QVVector &x, const QVVector &b,
                  const bool isSymmetric = false, const bool isPosDefinite = false,
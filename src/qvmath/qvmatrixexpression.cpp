@@ -0,0 +1,76 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <qvmath.h>
+#include <qvdefines.h>
+#include <qvmatrixalgebra.h>
+
+#include <QVMatrix>
+#include <qvmath/qvmatrixexpression.h>
+
+#ifdef BLAS_AVAILABLE
+void QVMatrixProduct::evaluate(double *result, const double beta) const
+	{
+	cblas_dgemm(CblasRowMajor,
+			left.transposed?CblasTrans:CblasNoTrans,
+			right.transposed?CblasTrans:CblasNoTrans,
+			getRows(), getCols(), left.getCols(), factor,
+			left.data, left.cols,
+			right.data, right.cols, beta,
+			result, getCols());
+	}
+
+void QVMatrixVectorProduct::evaluate(double *result, const double beta) const
+	{
+	cblas_dgemv(CblasRowMajor, matrix.transposed?CblasTrans:CblasNoTrans, matrix.rows, matrix.cols, factor,
+			matrix.data, matrix.cols, vector, 1, beta, result, 1);
+	}
+#else
+void QVMatrixProduct::evaluate(double *result, const double beta) const
+	{
+	const int m = getRows(), n = getCols(), o = left.getCols();
+
+	for(int i = 0; i < m; i++)
+		for(int j = 0; j < n; j++)
+			{
+			double accum = 0.0;
+			for(int k = 0; k < o; k++)
+				accum += left(i,k) * right(k,j);
+			result[i*n + j] = factor * accum + ((beta == 0.0)? 0.0: beta * result[i*n + j]);
+			}
+	}
+
+void QVMatrixVectorProduct::evaluate(double *result, const double beta) const
+	{
+	const int m = matrix.getRows(), n = matrix.getCols();
+
+	for(int i = 0; i < m; i++)
+		{
+		double accum = 0.0;
+		for(int k = 0; k < n; k++)
+			accum += matrix(i,k) * vector[k];
+		result[i] = factor * accum + ((beta == 0.0)? 0.0: beta * result[i]);
+		}
+	}
+#endif
@@ -0,0 +1,643 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVMATRIXEXPRESSION_H
+#define QVMATRIXEXPRESSION_H
+
+#include <iostream>
+#include <qvmath/qvvector.h>
+#include <qvmath/qvmatrix.h>
+
+/*!
+@class QVMatrixExpression qvmath/qvmatrixexpression.h QVMatrixExpression
+@brief Base class for the lazy matrix expressions.
+
+The arithmetic operators of the @ref QVMatrix class create a new matrix for each operation. Expressions like
+<i>A + B * 2.0 - C</i> allocate a temporary matrix for each operator, and traverse the data of every operand once
+per operator.
+
+The function @ref qvLazy(const QVMatrix &) returns a light reference to a matrix, which can be combined with the
+arithmetic operators to build a lazy expression. Nothing is computed until the expression is assigned to a
+@ref QVMatrix object. Element-wise expressions (additions, substractions and products by scalar values) are then
+evaluated in a single pass, without temporaries:
+
+@code
+QVMatrix M = A;
+M = qvLazy(M) + 2.0 * qvLazy(B) - qvLazy(C).transpose();	// One pass over the data, no allocations.
+@endcode
+
+Matrix products between references are evaluated with a single BLAS <i>gemm</i> call, which takes the transposition
+flags and the scalar factor of the operands. The compound assignment operators accumulate the product directly on
+the target matrix:
+
+@code
+covariance += weight * (qvLazy(X).transpose() * qvLazy(Y));	// covariance = weight * X^T * Y + covariance
+@endcode
+
+Chains of products are evaluated with a <i>gemm</i> call for each product, from left to right. The intermediate products
+are stored in temporary buffers, which are computed when the chain is built. Products of a chain of matrices and a vector
+are evaluated from right to left, with a <i>gemv</i> call for each matrix, so no intermediate matrix is computed:
+
+@code
+M = qvLazy(A) * qvLazy(B) * qvLazy(C);		// Two gemm calls, one temporary matrix.
+y = qvLazy(A) * qvLazy(B) * qvLazy(x);		// A * (B * x). Two gemv calls, one temporary vector.
+@endcode
+
+Expressions keep pointers to the data of their operands, so they should not outlive the full expression statement
+where they are created.
+
+@see qvLazy(const QVMatrix &)
+@see QVVectorExpression
+@ingroup qvmath
+*/
+template <class E> class QVMatrixExpression
+    {
+    public:
+        /// @brief Gets the number of rows of the result of the expression.
+        int getRows() const                                         { return derived().getRows(); }
+
+        /// @brief Gets the number of columns of the result of the expression.
+        int getCols() const                                         { return derived().getCols(); }
+
+        /// @brief Evaluates an element of the expression.
+        double operator()(const int row, const int col) const      { return derived()(row, col); }
+
+        /// @brief Checks whether the evaluation of the expression reads a given buffer in a non element-wise order.
+        bool aliases(const double *buffer) const                    { return derived().aliases(buffer); }
+
+        /// @brief Gets the actual expression object.
+        const E &derived() const                                    { return static_cast<const E &>(*this); }
+    };
+
+/*!
+@class QVVectorExpression qvmath/qvmatrixexpression.h QVVectorExpression
+@brief Base class for the lazy vector expressions.
+
+The function @ref qvLazy(const QVVector &) returns a light reference to a vector, which can be combined with the
+additions, substractions and scalar products to build an expression, evaluated in a single pass when assigned to a
+@ref QVVector object:
+
+@code
+x = qvLazy(x) + alpha * qvLazy(p);	// No temporary vectors.
+r -= alpha * (qvLazy(A) * qvLazy(p));	// One gemv call.
+@endcode
+
+@see QVMatrixExpression
+@ingroup qvmath
+*/
+template <class E> class QVVectorExpression
+    {
+    public:
+        /// @brief Gets the size of the result of the expression.
+        int size() const                                { return derived().size(); }
+
+        /// @brief Evaluates an element of the expression.
+        double operator[](const int index) const        { return derived()[index]; }
+
+        /// @brief Gets the actual expression object.
+        const E &derived() const                        { return static_cast<const E &>(*this); }
+    };
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Leaf of the matrix expressions. References the data of a matrix, maybe transposed.
+class QVMatrixReference: public QVMatrixExpression<QVMatrixReference>
+    {
+    public:
+        const double *data;
+        int rows, cols;
+        bool transposed;
+
+        explicit QVMatrixReference(const QVMatrix &matrix, const bool transposed = false):
+            data(matrix.getReadData()), rows(matrix.getRows()), cols(matrix.getCols()), transposed(transposed)	{ }
+
+        QVMatrixReference(const double *data, const int rows, const int cols):
+            data(data), rows(rows), cols(cols), transposed(false)	{ }
+
+        int getRows() const                         { return transposed? cols: rows; }
+        int getCols() const                         { return transposed? rows: cols; }
+        double operator()(const int row, const int col) const
+            { return transposed? data[col*cols + row]: data[row*cols + col]; }
+        bool aliases(const double *buffer) const    { return transposed and buffer == data; }
+
+        // Transposition does not copy the data.
+        QVMatrixReference transpose() const
+            { QVMatrixReference result(*this); result.transposed = not transposed; return result; }
+    };
+
+inline void qvCheckExpressionSizes(const char *operation, const int rows1, const int cols1, const int rows2, const int cols2)
+    {
+    if (rows1 != rows2 or cols1 != cols2)
+        {
+        std::cout << "ERROR: incompatible matrix sizes at " << operation << "." << std::endl
+                  << "\tMatrix 1 dimensions:\t" << rows1 << "x" << cols1 << std::endl
+                  << "\tMatrix 2 dimensions:\t" << rows2 << "x" << cols2 << std::endl;
+        exit(1);
+        }
+    }
+
+template <class L, class R> class QVMatrixSum: public QVMatrixExpression< QVMatrixSum<L,R> >
+    {
+    public:
+        const L left;
+        const R right;
+
+        QVMatrixSum(const L &left, const R &right): left(left), right(right)
+            { qvCheckExpressionSizes("QVMatrixSum", left.getRows(), left.getCols(), right.getRows(), right.getCols()); }
+
+        int getRows() const                         { return left.getRows(); }
+        int getCols() const                         { return left.getCols(); }
+        double operator()(const int row, const int col) const   { return left(row, col) + right(row, col); }
+        bool aliases(const double *buffer) const    { return left.aliases(buffer) or right.aliases(buffer); }
+    };
+
+template <class L, class R> class QVMatrixDifference: public QVMatrixExpression< QVMatrixDifference<L,R> >
+    {
+    public:
+        const L left;
+        const R right;
+
+        QVMatrixDifference(const L &left, const R &right): left(left), right(right)
+            { qvCheckExpressionSizes("QVMatrixDifference", left.getRows(), left.getCols(), right.getRows(), right.getCols()); }
+
+        int getRows() const                         { return left.getRows(); }
+        int getCols() const                         { return left.getCols(); }
+        double operator()(const int row, const int col) const   { return left(row, col) - right(row, col); }
+        bool aliases(const double *buffer) const    { return left.aliases(buffer) or right.aliases(buffer); }
+    };
+
+template <class E> class QVMatrixScaled: public QVMatrixExpression< QVMatrixScaled<E> >
+    {
+    public:
+        const E expression;
+        const double factor;
+
+        QVMatrixScaled(const E &expression, const double factor): expression(expression), factor(factor)	{ }
+
+        int getRows() const                         { return expression.getRows(); }
+        int getCols() const                         { return expression.getCols(); }
+        double operator()(const int row, const int col) const   { return factor * expression(row, col); }
+        bool aliases(const double *buffer) const    { return expression.aliases(buffer); }
+    };
+
+// Product of two matrix references, scaled by a factor. It is evaluated with a single gemm call.
+//
+// Chains of products, like A*B*C, are evaluated from left to right: the product of the first factors is evaluated
+// when the chain is built, in a temporary buffer, which is referenced as an operand of the next product. So every
+// product in the chain takes one gemm call, and only the intermediate results are allocated.
+class QVMatrixProduct
+    {
+    public:
+        // Intermediate results of chained products, referenced by 'left' or 'right'. Empty otherwise.
+        const QVector<double> leftStorage, rightStorage;
+        const QVMatrixReference left, right;
+        const double factor;
+
+        QVMatrixProduct(const QVMatrixReference &left, const QVMatrixReference &right, const double factor = 1.0):
+            left(left), right(right), factor(factor)
+            { checkSizes(); }
+
+        QVMatrixProduct(const QVMatrixProduct &left, const QVMatrixReference &right, const double factor = 1.0):
+            leftStorage(left.evaluate()), left(leftStorage.constData(), left.getRows(), left.getCols()), right(right), factor(factor)
+            { checkSizes(); }
+
+        QVMatrixProduct(const QVMatrixReference &left, const QVMatrixProduct &right, const double factor = 1.0):
+            rightStorage(right.evaluate()), left(left), right(rightStorage.constData(), right.getRows(), right.getCols()), factor(factor)
+            { checkSizes(); }
+
+        QVMatrixProduct(const QVMatrixProduct &left, const QVMatrixProduct &right):
+            leftStorage(left.evaluate()), rightStorage(right.evaluate()),
+            left(leftStorage.constData(), left.getRows(), left.getCols()),
+            right(rightStorage.constData(), right.getRows(), right.getCols()), factor(1.0)
+            { checkSizes(); }
+
+        // Same product, with a different factor.
+        QVMatrixProduct(const QVMatrixProduct &product, const double factor):
+            leftStorage(product.leftStorage), rightStorage(product.rightStorage),
+            left(product.left), right(product.right), factor(factor)	{ }
+
+        int getRows() const                         { return left.getRows(); }
+        int getCols() const                         { return right.getCols(); }
+        bool aliases(const double *buffer) const    { return buffer == left.data or buffer == right.data; }
+
+        // Stores in 'result' the value factor * left * right + beta * result.
+        void evaluate(double *result, const double beta) const;
+
+        // Returns the value factor * left * right, in row-major order.
+        QVector<double> evaluate() const
+            {
+            QVector<double> result(getRows() * getCols());
+            evaluate(result.data(), 0.0);
+            return result;
+            }
+
+    private:
+        void checkSizes() const
+            {
+            if (left.getCols() != right.getRows())
+                {
+                std::cout << "ERROR: tried to multiply matrices with incompatible sizes at QVMatrixProduct." << std::endl
+                          << "\tMatrix 1 dimensions:\t" << left.getRows() << "x" << left.getCols() << std::endl
+                          << "\tMatrix 2 dimensions:\t" << right.getRows() << "x" << right.getCols() << std::endl;
+                exit(1);
+                }
+            }
+    };
+
+// Product of a matrix reference and a vector, scaled by a factor. It is evaluated with a single gemv call.
+//
+// Products of a matrix chain and a vector, like A*B*v, are evaluated from right to left, as A*(B*v), with a gemv call
+// for each matrix and a temporary vector for each intermediate result.
+class QVMatrixVectorProduct
+    {
+    public:
+        // Intermediate results of chained products, referenced by 'matrix' or 'vector'. Empty otherwise.
+        const QVector<double> matrixStorage, vectorStorage;
+        const QVMatrixReference matrix;
+        const double *vector;
+        const double factor;
+
+        QVMatrixVectorProduct(const QVMatrixReference &matrix, const double *vector, const int size, const double factor = 1.0):
+            matrix(matrix), vector(vector), factor(factor)
+            { checkSizes(size); }
+
+        QVMatrixVectorProduct(const QVMatrixReference &matrix, const QVMatrixVectorProduct &product, const double factor = 1.0):
+            vectorStorage(product.evaluate()), matrix(matrix), vector(vectorStorage.constData()), factor(factor)
+            { checkSizes(product.size()); }
+
+        QVMatrixVectorProduct(const QVMatrixProduct &product, const double *vector, const int size):
+            matrixStorage(product.leftStorage), vectorStorage(QVMatrixVectorProduct(product.right, vector, size).evaluate()),
+            matrix(product.left), vector(vectorStorage.constData()), factor(product.factor)
+            { }
+
+        // Same product, with a different factor.
+        QVMatrixVectorProduct(const QVMatrixVectorProduct &product, const double factor):
+            matrixStorage(product.matrixStorage), vectorStorage(product.vectorStorage),
+            matrix(product.matrix), vector(product.vector), factor(factor)	{ }
+
+        int size() const                            { return matrix.getRows(); }
+        bool aliases(const double *buffer) const    { return buffer == matrix.data or buffer == vector; }
+
+        // Stores in 'result' the value factor * matrix * vector + beta * result.
+        void evaluate(double *result, const double beta) const;
+
+        // Returns the value factor * matrix * vector.
+        QVector<double> evaluate() const
+            {
+            QVector<double> result(size());
+            evaluate(result.data(), 0.0);
+            return result;
+            }
+
+    private:
+        void checkSizes(const int size) const
+            {
+            if (matrix.getCols() != size)
+                {
+                std::cout << "ERROR: tried to multiply a matrix with a vector of incompatible sizes at QVMatrixVectorProduct." << std::endl
+                          << "\tMatrix dimensions:\t" << matrix.getRows() << "x" << matrix.getCols() << std::endl
+                          << "\tVector dimension:\t" << size << std::endl;
+                exit(1);
+                }
+            }
+    };
+
+// Leaf of the vector expressions.
+class QVVectorReference: public QVVectorExpression<QVVectorReference>
+    {
+    public:
+        const double *data;
+        int length;
+
+        explicit QVVectorReference(const QVVector &vector): data(vector.constData()), length(vector.size())	{ }
+
+        int size() const                                { return length; }
+        double operator[](const int index) const        { return data[index]; }
+    };
+
+inline void qvCheckExpressionSizes(const char *operation, const int size1, const int size2)
+    {
+    if (size1 != size2)
+        {
+        std::cout << "ERROR: incompatible vector sizes at " << operation << "." << std::endl
+                  << "\tVector 1 dimension:\t" << size1 << std::endl
+                  << "\tVector 2 dimension:\t" << size2 << std::endl;
+        exit(1);
+        }
+    }
+
+template <class L, class R> class QVVectorSum: public QVVectorExpression< QVVectorSum<L,R> >
+    {
+    public:
+        const L left;
+        const R right;
+
+        QVVectorSum(const L &left, const R &right): left(left), right(right)
+            { qvCheckExpressionSizes("QVVectorSum", left.size(), right.size()); }
+
+        int size() const                                { return left.size(); }
+        double operator[](const int index) const        { return left[index] + right[index]; }
+    };
+
+template <class L, class R> class QVVectorDifference: public QVVectorExpression< QVVectorDifference<L,R> >
+    {
+    public:
+        const L left;
+        const R right;
+
+        QVVectorDifference(const L &left, const R &right): left(left), right(right)
+            { qvCheckExpressionSizes("QVVectorDifference", left.size(), right.size()); }
+
+        int size() const                                { return left.size(); }
+        double operator[](const int index) const        { return left[index] - right[index]; }
+    };
+
+template <class E> class QVVectorScaled: public QVVectorExpression< QVVectorScaled<E> >
+    {
+    public:
+        const E expression;
+        const double factor;
+
+        QVVectorScaled(const E &expression, const double factor): expression(expression), factor(factor)	{ }
+
+        int size() const                                { return expression.size(); }
+        double operator[](const int index) const        { return factor * expression[index]; }
+    };
+#endif
+
+/*!
+@brief Gets a lazy reference to a matrix, to build a @ref QVMatrixExpression.
+
+@param matrix Referenced matrix. It must not be modified or destroyed while the expression is in use.
+@see QVMatrixExpression
+@ingroup qvmath
+*/
+inline QVMatrixReference qvLazy(const QVMatrix &matrix)     { return QVMatrixReference(matrix); }
+
+/*!
+@brief Gets a lazy reference to a vector, to build a @ref QVVectorExpression.
+
+@param vector Referenced vector. It must not be modified or destroyed while the expression is in use.
+@see QVVectorExpression
+@ingroup qvmath
+*/
+inline QVVectorReference qvLazy(const QVVector &vector)     { return QVVectorReference(vector); }
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Matrix expression operators.
+template <class L, class R> QVMatrixSum<L,R> operator+(const QVMatrixExpression<L> &left, const QVMatrixExpression<R> &right)
+    { return QVMatrixSum<L,R>(left.derived(), right.derived()); }
+
+template <class L, class R> QVMatrixDifference<L,R> operator-(const QVMatrixExpression<L> &left, const QVMatrixExpression<R> &right)
+    { return QVMatrixDifference<L,R>(left.derived(), right.derived()); }
+
+template <class E> QVMatrixScaled<E> operator*(const double factor, const QVMatrixExpression<E> &expression)
+    { return QVMatrixScaled<E>(expression.derived(), factor); }
+
+template <class E> QVMatrixScaled<E> operator*(const QVMatrixExpression<E> &expression, const double factor)
+    { return QVMatrixScaled<E>(expression.derived(), factor); }
+
+template <class E> QVMatrixScaled<E> operator/(const QVMatrixExpression<E> &expression, const double value)
+    { return QVMatrixScaled<E>(expression.derived(), 1.0 / value); }
+
+template <class E> QVMatrixScaled<E> operator-(const QVMatrixExpression<E> &expression)
+    { return QVMatrixScaled<E>(expression.derived(), -1.0); }
+
+inline QVMatrixProduct operator*(const QVMatrixReference &left, const QVMatrixReference &right)
+    { return QVMatrixProduct(left, right); }
+
+inline QVMatrixProduct operator*(const QVMatrixScaled<QVMatrixReference> &left, const QVMatrixReference &right)
+    { return QVMatrixProduct(left.expression, right, left.factor); }
+
+inline QVMatrixProduct operator*(const QVMatrixReference &left, const QVMatrixScaled<QVMatrixReference> &right)
+    { return QVMatrixProduct(left, right.expression, right.factor); }
+
+inline QVMatrixProduct operator*(const QVMatrixProduct &left, const QVMatrixReference &right)
+    { return QVMatrixProduct(left, right); }
+
+inline QVMatrixProduct operator*(const QVMatrixProduct &left, const QVMatrixScaled<QVMatrixReference> &right)
+    { return QVMatrixProduct(left, right.expression, right.factor); }
+
+inline QVMatrixProduct operator*(const QVMatrixReference &left, const QVMatrixProduct &right)
+    { return QVMatrixProduct(left, right); }
+
+inline QVMatrixProduct operator*(const QVMatrixScaled<QVMatrixReference> &left, const QVMatrixProduct &right)
+    { return QVMatrixProduct(left.expression, right, left.factor); }
+
+inline QVMatrixProduct operator*(const QVMatrixProduct &left, const QVMatrixProduct &right)
+    { return QVMatrixProduct(left, right); }
+
+inline QVMatrixProduct operator*(const double factor, const QVMatrixProduct &product)
+    { return QVMatrixProduct(product, factor * product.factor); }
+
+inline QVMatrixProduct operator*(const QVMatrixProduct &product, const double factor)
+    { return QVMatrixProduct(product, factor * product.factor); }
+
+inline QVMatrixProduct operator-(const QVMatrixProduct &product)
+    { return QVMatrixProduct(product, -product.factor); }
+
+inline QVMatrixVectorProduct operator*(const QVMatrixReference &matrix, const QVVectorReference &vector)
+    { return QVMatrixVectorProduct(matrix, vector.data, vector.size()); }
+
+inline QVMatrixVectorProduct operator*(const QVMatrixProduct &product, const QVVectorReference &vector)
+    { return QVMatrixVectorProduct(product, vector.data, vector.size()); }
+
+inline QVMatrixVectorProduct operator*(const QVMatrixReference &matrix, const QVMatrixVectorProduct &product)
+    { return QVMatrixVectorProduct(matrix, product); }
+
+inline QVMatrixVectorProduct operator*(const double factor, const QVMatrixVectorProduct &product)
+    { return QVMatrixVectorProduct(product, factor * product.factor); }
+
+inline QVMatrixVectorProduct operator*(const QVMatrixVectorProduct &product, const double factor)
+    { return QVMatrixVectorProduct(product, factor * product.factor); }
+
+inline QVMatrixVectorProduct operator-(const QVMatrixVectorProduct &product)
+    { return QVMatrixVectorProduct(product, -product.factor); }
+
+// Vector expression operators.
+template <class L, class R> QVVectorSum<L,R> operator+(const QVVectorExpression<L> &left, const QVVectorExpression<R> &right)
+    { return QVVectorSum<L,R>(left.derived(), right.derived()); }
+
+template <class L, class R> QVVectorDifference<L,R> operator-(const QVVectorExpression<L> &left, const QVVectorExpression<R> &right)
+    { return QVVectorDifference<L,R>(left.derived(), right.derived()); }
+
+template <class E> QVVectorScaled<E> operator*(const double factor, const QVVectorExpression<E> &expression)
+    { return QVVectorScaled<E>(expression.derived(), factor); }
+
+template <class E> QVVectorScaled<E> operator*(const QVVectorExpression<E> &expression, const double factor)
+    { return QVVectorScaled<E>(expression.derived(), factor); }
+
+template <class E> QVVectorScaled<E> operator/(const QVVectorExpression<E> &expression, const double value)
+    { return QVVectorScaled<E>(expression.derived(), 1.0 / value); }
+
+template <class E> QVVectorScaled<E> operator-(const QVVectorExpression<E> &expression)
+    { return QVVectorScaled<E>(expression.derived(), -1.0); }
+
+// Evaluation of the matrix expressions.
+template <class E> QVMatrix::QVMatrix(const QVMatrixExpression<E> &expression):
+    cols(expression.getCols()), rows(expression.getRows()), type(General), transposed(false), data(new QBlasDataBuffer(cols*rows))
+    {
+    double *matrixData = getWriteData();
+    for(int i = 0; i < rows; i++)
+        for(int j = 0; j < cols; j++)
+            matrixData[i*cols + j] = expression(i, j);
+    }
+
+template <class E> QVMatrix & QVMatrix::operator=(const QVMatrixExpression<E> &expression)
+    {
+    if (rows != expression.getRows() or cols != expression.getCols() or expression.aliases(getReadData()))
+        return operator=(QVMatrix(expression));
+
+    double *matrixData = getWriteData();
+    for(int i = 0; i < rows; i++)
+        for(int j = 0; j < cols; j++)
+            matrixData[i*cols + j] = expression(i, j);
+    type = General;
+    return *this;
+    }
+
+template <class E> QVMatrix & QVMatrix::operator+=(const QVMatrixExpression<E> &expression)
+    {
+    qvCheckExpressionSizes("QVMatrix::operator+=", rows, cols, expression.getRows(), expression.getCols());
+    if (expression.aliases(getReadData()))
+        return operator+=(QVMatrix(expression));
+
+    double *matrixData = getWriteData();
+    for(int i = 0; i < rows; i++)
+        for(int j = 0; j < cols; j++)
+            matrixData[i*cols + j] += expression(i, j);
+    type = General;
+    return *this;
+    }
+
+template <class E> QVMatrix & QVMatrix::operator-=(const QVMatrixExpression<E> &expression)
+    {
+    return operator+=(-expression);
+    }
+
+inline QVMatrix::QVMatrix(const QVMatrixProduct &product):
+    cols(product.getCols()), rows(product.getRows()), type(General), transposed(false), data(new QBlasDataBuffer(cols*rows))
+    {
+    product.evaluate(getWriteData(), 0.0);
+    }
+
+inline QVMatrix & QVMatrix::operator=(const QVMatrixProduct &product)
+    {
+    if (rows != product.getRows() or cols != product.getCols() or product.aliases(getReadData()))
+        return operator=(QVMatrix(product));
+
+    product.evaluate(getWriteData(), 0.0);
+    type = General;
+    return *this;
+    }
+
+inline QVMatrix & QVMatrix::operator+=(const QVMatrixProduct &product)
+    {
+    qvCheckExpressionSizes("QVMatrix::operator+=", rows, cols, product.getRows(), product.getCols());
+    if (product.aliases(getReadData()))
+        return operator+=(QVMatrix(product));
+
+    product.evaluate(getWriteData(), 1.0);
+    type = General;
+    return *this;
+    }
+
+inline QVMatrix & QVMatrix::operator-=(const QVMatrixProduct &product)
+    {
+    return operator+=(-product);
+    }
+
+// Evaluation of the vector expressions.
+template <class E> QVVector::QVVector(const QVVectorExpression<E> &expression): QVector<double>(expression.size())
+    {
+    const int n = size();
+    double *vectorData = data();
+    for(int i = 0; i < n; i++)
+        vectorData[i] = expression[i];
+    }
+
+template <class E> QVVector & QVVector::operator=(const QVVectorExpression<E> &expression)
+    {
+    if (size() != expression.size())
+        return operator=(QVVector(expression));
+
+    const int n = size();
+    double *vectorData = data();
+    for(int i = 0; i < n; i++)
+        vectorData[i] = expression[i];
+    return *this;
+    }
+
+template <class E> QVVector & QVVector::operator+=(const QVVectorExpression<E> &expression)
+    {
+    qvCheckExpressionSizes("QVVector::operator+=", size(), expression.size());
+
+    const int n = size();
+    double *vectorData = data();
+    for(int i = 0; i < n; i++)
+        vectorData[i] += expression[i];
+    return *this;
+    }
+
+template <class E> QVVector & QVVector::operator-=(const QVVectorExpression<E> &expression)
+    {
+    qvCheckExpressionSizes("QVVector::operator-=", size(), expression.size());
+
+    const int n = size();
+    double *vectorData = data();
+    for(int i = 0; i < n; i++)
+        vectorData[i] -= expression[i];
+    return *this;
+    }
+
+inline QVVector::QVVector(const QVMatrixVectorProduct &product): QVector<double>(product.size())
+    {
+    product.evaluate(data(), 0.0);
+    }
+
+inline QVVector & QVVector::operator=(const QVMatrixVectorProduct &product)
+    {
+    if (size() != product.size() or product.aliases(constData()))
+        return operator=(QVVector(product));
+
+    product.evaluate(data(), 0.0);
+    return *this;
+    }
+
+inline QVVector & QVVector::operator+=(const QVMatrixVectorProduct &product)
+    {
+    qvCheckExpressionSizes("QVVector::operator+=", size(), product.size());
+    if (product.aliases(constData()))
+        return operator+=(QVVector(product));
+
+    product.evaluate(data(), 1.0);
+    return *this;
+    }
+
+inline QVVector & QVVector::operator-=(const QVMatrixVectorProduct &product)
+    {
+    return operator+=(-product);
+    }
+#endif
+
+#endif
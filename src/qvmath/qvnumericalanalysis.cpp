@@ -30,11 +30,12 @@ const QVVector qvEstimateGradient(QVFunction<QVVector, double> &multivariateFunc
     const int dim = location.size();
     QVVector gradient(dim);
     const double actual = multivariateFunction(location);
+    QVVector stepLocation = location;
     for (int i = 0; i < dim; i++)
         {
-        QVVector stepLocation = location;
         stepLocation[i] += h;
         gradient[i] = (multivariateFunction(stepLocation) - actual)/h;
+        stepLocation[i] = location[i];
         }
     return gradient;
     }
@@ -45,11 +46,15 @@ const QVMatrix qvEstimateJacobian(QVFunction<QVVector, QVVector> &multivariateFu
 
     QVMatrix jacobian(actual.size(), location.size());
 
+    // Reuse the step location and the column buffers between iterations.
+    QVVector stepLocation = location, column(actual.size());
     for (int i = 0; i < location.size(); i++)
         {
-        QVVector stepLocation = location;
         stepLocation[i] += h;
-        jacobian.setCol(i, (multivariateFunction(stepLocation) - actual)/h);
+        const QVVector stepValue = multivariateFunction(stepLocation);
+        column = (qvLazy(stepValue) - qvLazy(actual)) / h;
+        jacobian.setCol(i, column);
+        stepLocation[i] = location[i];
         }
 
     return jacobian;
@@ -64,13 +69,15 @@ const QVMatrix qvEstimateHessian(	QVFunction<QVVector, double> &multivariateFunc
     QVMatrix hessian(dim, dim);
 
     const double actual = multivariateFunction(location);
+    QVVector stepLocationIJ = location;
     for (int i = 0; i < dim; i++)
         for (int j = 0; j < dim; j++)
         {
-        QVVector stepLocationIJ = location;
         stepLocationIJ[i] += h;
         stepLocationIJ[j] += h;
         hessian(i,j) = (multivariateFunction(stepLocationIJ) - actual)/(h*h) - (g[i] + g[j])/h;
+        stepLocationIJ[i] = location[i];
+        stepLocationIJ[j] = location[j];
         }
     return hessian;
     }
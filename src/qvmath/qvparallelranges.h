@@ -0,0 +1,118 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVPARALLELRANGES_H
+#define QVPARALLELRANGES_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Evaluates one range of a qvParallelRanges call, in one of the threads of the global pool.
+template <typename Functor> class QVParallelRangeRunnable: public QRunnable
+    {
+    public:
+        QVParallelRangeRunnable(Functor &functor, const int range, const int first, const int last, QSemaphore &finished):
+            QRunnable(), functor(functor), range(range), first(first), last(last), finished(finished)	{ }
+
+        void run()
+            {
+            functor(range, first, last);
+            finished.release();
+            }
+
+    private:
+        Functor &functor;
+        const int range, first, last;
+        QSemaphore &finished;
+    };
+#endif // DOXYGEN_IGNORE_THIS
+
+/*!
+@brief Evaluates a functor on contiguous ranges of indexes, in parallel.
+
+The indexes from 0 to <i>size</i> - 1 are split in <i>ranges</i> contiguous ranges of similar size, and the functor
+is called once for each range, as <i>functor(range, first, last)</i>, where <i>range</i> is the number of the range
+and <i>[first, last)</i> its indexes. Every range except the last one is handed to a free thread of the global thread
+pool (see QThreadPool::globalInstance()), and the calling thread evaluates the last range and those for which no thread
+was free. Ranges are never queued in the pool, so the function can be called from a task of the same pool, for example
+from a functor of an outer call, without waiting for threads that are blocked in turn. The function returns when every
+range is evaluated.
+
+The ranges only depend on the values of <i>size</i> and <i>ranges</i>, so partial results stored by range can be
+reduced in a deterministic order.
+
+@code
+class SumRange
+    {
+    public:
+        SumRange(const QVector<double> &values, QVector<double> &sums): values(values), sums(sums)	{ }
+        void operator()(const int range, const int first, const int last)
+            {
+            sums[range] = 0.0;
+            for(int i = first; i < last; i++)
+                sums[range] += values[i];
+            }
+    private:
+        const QVector<double> &values;
+        QVector<double> &sums;
+    };
+
+QVector<double> sums(ranges);
+SumRange sumRange(values, sums);
+qvParallelRanges(sumRange, values.size(), ranges);
+@endcode
+
+@param functor object called for each range. It must be safe to call it concurrently for different ranges.
+@param size number of indexes.
+@param ranges number of ranges. Values smaller than 1 are taken as 1.
+@ingroup qvmath
+*/
+template <typename Functor> void qvParallelRanges(Functor &functor, const int size, const int ranges)
+    {
+    const int numRanges = qMax(1, ranges);
+
+    QSemaphore finished;
+    int started = 0;
+    for(int r = 0; r < numRanges; r++)
+        {
+        const int	first = int(qint64(size) * r / numRanges),
+                    last = int(qint64(size) * (r+1) / numRanges);
+        if (r < numRanges - 1)
+            {
+            QVParallelRangeRunnable<Functor> *runnable = new QVParallelRangeRunnable<Functor>(functor, r, first, last, finished);
+            if (QThreadPool::globalInstance()->tryStart(runnable))
+                {
+                started++;
+                continue;
+                }
+            delete runnable;
+            }
+        functor(r, first, last);
+        }
+    finished.acquire(started);
+    }
+
+#endif // QVPARALLELRANGES_H
@@ -0,0 +1,81 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <float.h>
+#include <qvmath/qvparallelsampleconsensus.h>
+
+#ifndef DOXYGEN_IGNORE_THIS
+// From section 2.1 of 'Optimal Randomized RANSAC' (Chum and Matas, 2008).
+double sprtDecisionThreshold(const double epsilon, const double delta, const double modelEstimationCost, const double modelsPerSample)
+    {
+    // The test can not distinguish good from bad models.
+    if (delta >= epsilon)
+        return DBL_MAX;
+
+    const double	C = (1.0 - delta) * log((1.0 - delta) / (1.0 - epsilon)) + delta * log(delta / epsilon),
+                    A0 = modelEstimationCost * C / modelsPerSample + 1.0;
+
+    // Fixed point iteration for A = A0 + log(A).
+    double A = A0;
+    for(int i = 0; i < 10; i++)
+        A = A0 + log(A);
+
+    return A;
+    }
+
+int adaptiveSampleConsensusIterations(const double epsilon, const int sampleSetSize, const double confidence, const int maxIterations)
+    {
+    const double outlierFreeProbability = pow(epsilon, sampleSetSize);
+
+    if (outlierFreeProbability <= DBL_EPSILON)
+        return maxIterations;
+    if (outlierFreeProbability >= 1.0)
+        return 1;
+
+    const double iterations = log(1.0 - confidence) / log(1.0 - outlierFreeProbability);
+    return (iterations >= maxIterations)? maxIterations: qMax(1, int(ceil(iterations)));
+    }
+
+// From section 2.3 of 'Matching with PROSAC - Progressive Sample Consensus' (Chum and Matas, 2005).
+QVector<int> prosacGrowthSchedule(const int sampleSetSize, const int elementCount, const int maxIterations)
+    {
+    QVector<int> schedule(elementCount, 0);
+    if (sampleSetSize <= 0 or sampleSetSize > elementCount)
+        return schedule;
+
+    // Average number of samples drawn from the first 'sampleSetSize' elements, in 'maxIterations' samples.
+    double Tn = maxIterations;
+    for(int i = 0; i < sampleSetSize; i++)
+        Tn *= double(sampleSetSize - i) / double(elementCount - i);
+
+    int TnPrime = 1;
+    schedule[sampleSetSize-1] = TnPrime;
+    for(int n = sampleSetSize; n < elementCount; n++)
+        {
+        const double nextTn = Tn * double(n + 1) / double(n + 1 - sampleSetSize);
+        TnPrime += int(ceil(nextTn - Tn));
+        Tn = nextTn;
+        schedule[n] = TnPrime;
+        }
+
+    return schedule;
+    }
+#endif // DOXYGEN_IGNORE_THIS
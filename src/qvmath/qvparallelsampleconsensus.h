@@ -0,0 +1,494 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVPARALLELSAMPLECONSENSUS_H
+#define QVPARALLELSAMPLECONSENSUS_H
+
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <qvmath.h>
+
+#ifndef DOXYGEN_IGNORE_THIS
+// Decision threshold A of the sequential probability ratio test, for a probability 'epsilon' of an element being
+// consistent with a good model, a probability 'delta' of being consistent with a bad model, the cost of fitting a model
+// measured in element tests, and the average number of models obtained from each sample.
+double sprtDecisionThreshold(const double epsilon, const double delta, const double modelEstimationCost, const double modelsPerSample);
+
+// Number of samples needed to draw an outlier-free sample with the given confidence, for an inlier ratio 'epsilon'.
+int adaptiveSampleConsensusIterations(const double epsilon, const int sampleSetSize, const double confidence, const int maxIterations);
+
+// Progressive sampling schedule of PROSAC. Element n of the result is the number of samples after which the
+// sampling set grows to contain the n+1 elements with the best preference values.
+QVector<int> prosacGrowthSchedule(const int sampleSetSize, const int elementCount, const int maxIterations);
+#endif // DOXYGEN_IGNORE_THIS
+
+/*!
+@class QVParallelRANSAC qvmath/qvparallelsampleconsensus.h QVParallelRANSAC
+@brief Multithreaded implementation of RANSAC and PROSAC, with sequential model verification and local optimization.
+
+This class implements the same robust model fitting search than the class @ref QVRANSAC, but it is designed to obtain
+accurate models in real time, for problems such as the estimation of the fundamental matrix or a planar homography from
+a set of image point matchings:
+
+<ul>
+<li>Sample sets are drawn and tested in parallel by several threads of the global thread pool.</li>
+<li>Each tentative model is verified using the sequential probability ratio test (SPRT) described in [1]. The elements
+are tested in random order, and the verification stops as soon as the likelihood ratio reveals a bad model, or when
+the model can not improve the best model found so far. Usually a wrong model is discarded after testing a few elements.</li>
+<li>The search does not stop at the first model with enough inliers. It keeps the model with the largest consensus
+set, and the number of samples is adapted to the inlier ratio of that model, to ensure that an outlier-free sample was
+drawn with a given confidence.</li>
+<li>Each new best model is refined by fitting it again to its consensus set, as in the LO-RANSAC algorithm [2].</li>
+<li>When the elements are added with a preference value, samples are drawn following the progressive schedule of
+PROSAC (see @ref QVPROSAC), from the sets of elements with the lowest preference values.</li>
+</ul>
+
+Usage is similar to that of the @ref QVRANSAC class. The methods @ref fit and @ref test must be implemented by the
+subclasses, and they must be reentrant, because they are called concurrently from several threads. Thus they are
+declared as <i>const</i> methods, and should not modify the state of the object.
+
+@code
+class LineRANSAC: public QVParallelRANSAC<QPointF, Line>
+    {
+    private:
+        double maximalDistance;
+
+    public:
+        LineRANSAC(const QList<QPointF> &observedPoints, const double maximalDistance):
+            QVParallelRANSAC<QPointF, Line>(2, 10), maximalDistance(maximalDistance)
+            {
+            foreach(QPointF point, observedPoints)
+                addElement(point);
+            }
+
+        bool fit(const QList<QPointF> &testInliers, Line &model) const
+            {
+            model = Line(testInliers);
+            return true;
+            };
+
+        bool test(const Line &model, const QPointF &point) const
+            { return model.distance(point) < maximalDistance; };
+    };
+
+[...]
+
+LineRANSAC samplerConsensus(observedData, 1.5);
+if (samplerConsensus.iterate(1000))
+    const Line line = samplerConsensus.getBestModel();
+@endcode
+
+@section References
+<p>[1] Chum, Ondřej, Matas, Jiř&iacute;. <i>Optimal Randomized RANSAC</i>. IEEE Transactions on Pattern Analysis and
+Machine Intelligence, 30(8):1472-1482, 2008.</p>
+<p>[2] Chum, Ondřej, Matas, Jiř&iacute;, Kittler, Josef. <i>Locally optimized RANSAC</i>. DAGM-Symposium, pages 236-243, 2003.</p>
+
+@see QVRANSAC
+@see QVPROSAC
+
+@ingroup qvstatistics
+*/
+template <typename Element, typename Model> class QVParallelRANSAC
+    {
+    protected:
+        int sampleSetSize, minInliers, iteration;
+        double confidence, modelEstimationCost, modelsPerSample;
+        int numThreads, localOptimizationIterations;
+
+        QVector<Element> elements;
+        QVector<double> preferences;
+
+        // To return to the user.
+        QList<Element> bestInliers;
+        Model bestModel;
+
+        // Called before each search, once the elements are sorted. Subclasses can reimplement it to prepare data
+        // structures indexed like the vector 'elements'.
+        virtual bool init()							{ return true; }
+
+        // Tests the whole set of elements against a model. Subclasses can reimplement it with a faster batch test,
+        // which must be equivalent to calling 'test' for every element.
+        virtual int testElements(const Model &model, QVector<bool> &mask) const
+            {
+            const int count = elements.size();
+            int consistent = 0;
+            mask.resize(count);
+            for(int i = 0; i < count; i++)
+                if ( (mask[i] = test(model, elements[i])) )
+                    consistent++;
+            return consistent;
+            }
+
+    #ifndef DOXYGEN_IGNORE_THIS
+    private:
+        // Minimal random number generator, to draw samples in each thread without the serialization of 'rand()'.
+        class Random
+            {
+            public:
+                Random(const quint32 seed): state(seed == 0? 0x9E3779B9u: seed)	{ }
+
+                // Uniform integer value in the range [0, range).
+                int operator()(const int range)
+                    {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    return int((quint64(state) * quint64(range)) >> 32);
+                    }
+
+            private:
+                quint32 state;
+            };
+
+        // State of a search, shared by the threads.
+        class Search
+            {
+            public:
+                QMutex mutex;
+                int samples, maxSamples, bestCount;
+                Model bestModel;
+                QVector<bool> bestMask;
+                double epsilon, delta, threshold, rejectedConsistency;
+                int rejectedModels;
+                QVector<int> schedule;
+            };
+
+        class Worker: public QRunnable
+            {
+            public:
+                Worker(const QVParallelRANSAC *ransac, Search *search, const quint32 seed, QSemaphore *finished):
+                    QRunnable(), ransac(ransac), search(search), random(seed), finished(finished)	{ }
+
+                void run()
+                    {
+                    ransac->searchModels(*search, random);
+                    if (finished != NULL)
+                        finished->release();
+                    }
+
+            private:
+                const QVParallelRANSAC *ransac;
+                Search *search;
+                Random random;
+                QSemaphore *finished;
+            };
+
+        void drawSample(const Search &search, const int sample, Random &random, QList<Element> &tentativeInliers) const
+            {
+            const int count = elements.size();
+
+            // Size of the set of elements with best preference values, to draw the sample from.
+            int n = count;
+            if (not search.schedule.isEmpty())
+                {
+                n = sampleSetSize;
+                while(n < count and search.schedule[n-1] < sample)
+                    n++;
+                }
+
+            QVarLengthArray<int, 16> indexes;
+            // PROSAC samples always contain the last element added to the sampling set.
+            if (n < count)
+                indexes.append(n-1);
+
+            const int range = (n < count)? n-1: n;
+            while(indexes.size() < sampleSetSize)
+                {
+                const int index = random(range);
+                bool repeated = false;
+                for(int i = 0; i < indexes.size() and not repeated; i++)
+                    repeated = (indexes[i] == index);
+                if (not repeated)
+                    indexes.append(index);
+                }
+
+            tentativeInliers.clear();
+            for(int i = 0; i < indexes.size(); i++)
+                tentativeInliers.append(elements[indexes[i]]);
+            }
+
+        // Tests the elements in random order, until the SPRT rejects the model, or it can not improve the best model.
+        // Returns the number of consistent elements, -1 if the model was rejected by the SPRT, or -2 if it can not improve
+        // the best model.
+        int verifyModel(const Model &model, const int bestCount, const double epsilon, const double delta,
+                        const double threshold, Random &random, int &tested, int &consistent) const
+            {
+            const int count = elements.size();
+            const Element *data = elements.constData();
+            const double	consistentRatio = delta / epsilon,
+                            inconsistentRatio = (1.0 - delta) / (1.0 - epsilon);
+
+            double lambda = 1.0;
+            tested = consistent = 0;
+            for(int i = random(count); tested < count; i = (i+1 == count)? 0: i+1)
+                {
+                tested++;
+                if (test(model, data[i]))
+                    {
+                    consistent++;
+                    lambda *= consistentRatio;
+                    }
+                else
+                    lambda *= inconsistentRatio;
+
+                if (lambda > threshold)
+                    return -1;
+                if (consistent + count - tested <= bestCount)
+                    return -2;
+                }
+            return consistent;
+            }
+
+        int getConsensusSet(const Model &model, QVector<bool> &mask, QList<Element> &inliers) const
+            {
+            testElements(model, mask);
+            inliers.clear();
+            for(int i = 0; i < mask.size(); i++)
+                if (mask[i])
+                    inliers.append(elements[i]);
+            return inliers.size();
+            }
+
+        void searchModels(Search &search, Random &random) const
+            {
+            const int count = elements.size();
+            QList<Element> tentativeInliers, inliers, refinedInliers;
+            QVector<bool> mask, refinedMask;
+
+            forever
+                {
+                int sample, bestCount;
+                double epsilon, delta, threshold;
+                    {
+                    QMutexLocker locker(&search.mutex);
+                    if (search.samples >= search.maxSamples)
+                        break;
+                    sample = ++search.samples;
+                    bestCount = search.bestCount;
+                    epsilon = search.epsilon;
+                    delta = search.delta;
+                    threshold = search.threshold;
+                    }
+
+                Model model;
+                drawSample(search, sample, random, tentativeInliers);
+                if (not fit(tentativeInliers, model))
+                    continue;
+
+                int tested, consistent;
+                const int verification = verifyModel(model, bestCount, epsilon, delta, threshold, random, tested, consistent);
+                if (verification == -2)
+                    continue;
+                else if (verification == -1)
+                    {
+                    // Estimate the probability of an element being consistent with a bad model from rejected models.
+                    QMutexLocker locker(&search.mutex);
+                    search.rejectedModels++;
+                    search.rejectedConsistency += double(consistent) / double(tested);
+                    const double newDelta = qBound(0.001, search.rejectedConsistency / search.rejectedModels, 0.5);
+                    if (ABS(newDelta - search.delta) > 0.05 * search.delta)
+                        {
+                        search.delta = newDelta;
+                        search.threshold = sprtDecisionThreshold(search.epsilon, search.delta, modelEstimationCost, modelsPerSample);
+                        }
+                    continue;
+                    }
+
+                // Local optimization: the model is fitted again to its consensus set, while it grows.
+                getConsensusSet(model, mask, inliers);
+                for(int i = 0; i < localOptimizationIterations and inliers.size() > sampleSetSize; i++)
+                    {
+                    Model refinedModel;
+                    if (not fit(inliers, refinedModel) or getConsensusSet(refinedModel, refinedMask, refinedInliers) <= inliers.size())
+                        break;
+                    model = refinedModel;
+                    qSwap(mask, refinedMask);
+                    qSwap(inliers, refinedInliers);
+                    }
+
+                QMutexLocker locker(&search.mutex);
+                if (inliers.size() > search.bestCount)
+                    {
+                    search.bestCount = inliers.size();
+                    search.bestModel = model;
+                    search.bestMask = mask;
+                    search.epsilon = qMax(search.epsilon, double(inliers.size()) / double(count));
+                    search.threshold = sprtDecisionThreshold(search.epsilon, search.delta, modelEstimationCost, modelsPerSample);
+                    search.maxSamples = qMin(search.maxSamples,
+                        adaptiveSampleConsensusIterations(double(inliers.size()) / double(count), sampleSetSize, confidence, search.maxSamples));
+                    }
+                }
+            }
+    #endif // DOXYGEN_IGNORE_THIS
+
+    public:
+        /// @brief Constructor for QVParallelRANSAC class
+        ///
+        /// Because QVParallelRANSAC is a pure virtual class, this constructor should only be called from the constructor of
+        /// its subclasses.
+        /// @param sampleSetSize size of the subsets <i><b>s</b></i> to be used for model fitting.
+        /// @param minInliers minimum number of sample data for a model to fit, to be considered a valid model.
+        /// @param confidence probability of drawing at least one sample set without outliers, used to stop the search.
+        /// @param numThreads number of threads used in the search. If it is not positive, the ideal thread count is used.
+        QVParallelRANSAC(const int sampleSetSize, const int minInliers, const double confidence = 0.99, const int numThreads = -1):
+            sampleSetSize(sampleSetSize), minInliers(minInliers), iteration(0), confidence(confidence),
+            modelEstimationCost(200.0), modelsPerSample(1.0), numThreads(numThreads), localOptimizationIterations(4)
+            { }
+
+        virtual ~QVParallelRANSAC()	{ }
+
+        /// @brief Generate a model from a set of observations
+        ///
+        /// This method should be implemented by subclasses of QVParallelRANSAC with the code
+        /// to generate a model, from a set of sample data. It is called concurrently from several threads.
+        /// @param elementList list of test inliers.
+        /// @param model model to store parameters fitting the observed elements.
+        /// @returns true if model fitting was successful, for the elementList set of observations, Else false.
+        virtual bool fit(const QList<Element> &elementList, Model &model) const = 0;
+
+        /// @brief Check if an observation fits in a model.
+        ///
+        /// This method should be implemented by subclasses of QVParallelRANSAC with the code to
+        /// check if a sample data fits in a generated model. It is called concurrently from several threads.
+        /// @param element element.
+        /// @param model model.
+        /// @returns true if the observation fits in the model, else false.
+        virtual bool test(const Model &model, const Element &element) const = 0;
+
+        /// @brief Adds a data sample to the observations set.
+        ///
+        /// This method should be called before performing any search with the function @ref iterate.
+        ///
+        /// @param element element.
+        void addElement(const Element &element)						{ elements.append(element); }
+
+        /// @brief Adds a data sample to the observations set, with a preference value.
+        ///
+        /// If any element is added with this method, the search draws the samples following the progressive
+        /// schedule of PROSAC. Elements with a low preference value are chosen first.
+        ///
+        /// @param element element.
+        /// @param preference heuristic value for the element.
+        void addElement(const Element &element, const double preference)
+            {
+            preferences.resize(elements.size());
+            elements.append(element);
+            preferences.append(preference);
+            }
+
+        /// @brief Sets the parameters of the sequential verification of the models.
+        ///
+        /// @param modelEstimationCost time spent fitting a model to a sample set, measured in calls to @ref test.
+        /// @param modelsPerSample average number of models obtained from each sample set.
+        void setSPRTParameters(const double modelEstimationCost, const double modelsPerSample = 1.0)
+            {
+            this->modelEstimationCost = modelEstimationCost;
+            this->modelsPerSample = modelsPerSample;
+            }
+
+        /// @brief Sets the maximal number of times a new best model is fitted again to its consensus set.
+        ///
+        /// A zero value disables the local optimization of the models.
+        void setLocalOptimizationIterations(const int iterations)		{ localOptimizationIterations = iterations; }
+
+        /// @brief Gets the best model obtained in a search.
+        const Model & getBestModel() const							{ return bestModel; }
+
+        /// @brief Gets the data elements matching with the best model.
+        const QList<Element> & getBestInliers() const				{ return bestInliers; }
+
+        /// @brief Gets the number of sample sets drawn in a search.
+        int getIterations() const									{ return iteration; }
+
+        /// @brief Starts a RANSAC search.
+        ///
+        /// This method draws sample sets until a model with enough inliers was found with the confidence specified
+        /// in the constructor, or the maximal number of iterations is reached.
+        /// @param maxIterations maximal number of sample sets to draw.
+        /// @returns true if the best model obtained fits in at least the minimum number of observations specified
+        /// in the construction of the object, else false.
+        bool iterate(const int maxIterations)
+            {
+            const int count = elements.size();
+            iteration = 0;
+            bestInliers.clear();
+            if (count < sampleSetSize or count < minInliers)
+                return false;
+
+            // Elements are sorted by preference value for PROSAC sampling.
+            if (preferences.size() == count)
+                {
+                QMultiMap<double, Element> elementsMap;
+                for(int i = 0; i < count; i++)
+                    elementsMap.insert(preferences[i], elements[i]);
+                elements = elementsMap.values().toVector();
+                preferences = elementsMap.keys().toVector();
+                }
+
+            if (not init())
+                return false;
+
+            Search search;
+            search.samples = 0;
+            search.maxSamples = maxIterations;
+            search.bestCount = qMax(0, minInliers - 1);
+            search.epsilon = qBound(0.05, double(minInliers) / double(count), 0.95);
+            search.delta = 0.01;
+            search.threshold = sprtDecisionThreshold(search.epsilon, search.delta, modelEstimationCost, modelsPerSample);
+            search.rejectedConsistency = 0.0;
+            search.rejectedModels = 0;
+            if (preferences.size() == count)
+                search.schedule = prosacGrowthSchedule(sampleSetSize, count, maxIterations);
+
+            // The calling thread also searches, so the search progresses even if the global pool is busy.
+            const int threads = qMax(1, (numThreads > 0)? numThreads: QThread::idealThreadCount());
+            QSemaphore finished;
+            for(int t = 0; t < threads - 1; t++)
+                QThreadPool::globalInstance()->start(new Worker(this, &search, quint32(rand()) * 2654435761u + t, &finished));
+            Worker(this, &search, quint32(rand()) * 2654435761u + threads, NULL).run();
+            finished.acquire(threads - 1);
+
+            iteration = search.samples;
+            if (search.bestMask.isEmpty())
+                return false;
+
+            bestModel = search.bestModel;
+            for(int i = 0; i < count; i++)
+                if (search.bestMask[i])
+                    bestInliers.append(elements[i]);
+
+            return true;
+            }
+    };
+
+#endif // QVPARALLELSAMPLECONSENSUS_H
@@ -0,0 +1,362 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <math.h>
+#include <qvmath.h>
+#include <qvmath/qvpointfmatchingset.h>
+#include <qvip/qvsimd.h>
+
+QVPointFMatchingSet::QVPointFMatchingSet(const QList<QPointFMatching> &matchings)
+	{
+	reserve(matchings.size());
+	foreach(const QPointFMatching &matching, matchings)
+		append(matching);
+	}
+
+QVPointFMatchingSet::QVPointFMatchingSet(const QVector<QPointFMatching> &matchings)
+	{
+	reserve(matchings.size());
+	foreach(const QPointFMatching &matching, matchings)
+		append(matching);
+	}
+
+void QVPointFMatchingSet::reserve(const int size)
+	{
+	x1.reserve(size);	y1.reserve(size);
+	x2.reserve(size);	y2.reserve(size);
+	}
+
+void QVPointFMatchingSet::clear()
+	{
+	x1.clear();	y1.clear();
+	x2.clear();	y2.clear();
+	}
+
+QList<QPointFMatching> QVPointFMatchingSet::toList() const
+	{
+	QList<QPointFMatching> result;
+	result.reserve(size());
+	for(int i = 0; i < size(); i++)
+		result << at(i);
+	return result;
+	}
+
+QVector<QPointFMatching> QVPointFMatchingSet::toVector() const
+	{
+	QVector<QPointFMatching> result(size());
+	for(int i = 0; i < size(); i++)
+		result[i] = at(i);
+	return result;
+	}
+
+QVPointFMatchingSet QVPointFMatchingSet::select(const QVector<bool> &mask) const
+	{
+	QVPointFMatchingSet result;
+	result.reserve(size());
+	for(int i = 0; i < size() and i < mask.size(); i++)
+		if (mask[i])
+			{
+			result.x1.append(x1[i]);	result.y1.append(y1[i]);
+			result.x2.append(x2[i]);	result.y2.append(y2[i]);
+			}
+	return result;
+	}
+
+int QVPointFMatchingSet::selectInliers(const double *residuals, const double threshold, QVector<bool> *mask) const
+	{
+	const int count = size();
+	int inliers = 0;
+
+	if (mask == NULL)
+		{
+		for(int i = 0; i < count; i++)
+			inliers += (residuals[i] < threshold)? 1: 0;
+		}
+	else
+		{
+		mask->resize(count);
+		bool *maskData = mask->data();
+		for(int i = 0; i < count; i++)
+			inliers += (maskData[i] = (residuals[i] < threshold))? 1: 0;
+		}
+
+	return inliers;
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar kernels. They are the reference for the SIMD ones, and process the
+// remaining matchings at the end of the arrays. The SIMD kernels perform the
+// same operations in the same order, so every level gives the same results,
+// which are also those of the per-matching functions used by the RANSAC test().
+
+#ifndef DOXYGEN_IGNORE_THIS
+static void symmetricEpipolarDistancesScalar(const double *f, const double *x1, const double *y1, const double *x2, const double *y2,
+											double *result, const int first, const int count)
+	{
+	for(int i = first; i < count; i++)
+		{
+		const double	p1x = x1[i], p1y = y1[i], p2x = x2[i], p2y = y2[i],
+						l1x = f[0] * p1x + f[1] * p1y + f[2],
+						l1y = f[3] * p1x + f[4] * p1y + f[5],
+						l2x = f[0] * p2x + f[3] * p2y + f[6],
+						l2y = f[1] * p2x + f[4] * p2y + f[7],
+						e1 = l1x * p2x + l1y * p2y + f[6] * p1x + f[7] * p1y + f[8],
+						e2 = l2x * p1x + l2y * p1y + f[2] * p2x + f[5] * p2y + f[8];
+
+		result[i] = ABS(e1) / sqrt(l1x*l1x + l1y*l1y) + ABS(e2) / sqrt(l2x*l2x + l2y*l2y);
+		}
+	}
+
+static void sampsonDistancesScalar(const double *f, const double *x1, const double *y1, const double *x2, const double *y2,
+									double *result, const int first, const int count)
+	{
+	for(int i = first; i < count; i++)
+		{
+		const double	p1x = x1[i], p1y = y1[i], p2x = x2[i], p2y = y2[i],
+						l1x = f[0] * p1x + f[1] * p1y + f[2],
+						l1y = f[3] * p1x + f[4] * p1y + f[5],
+						l2x = f[0] * p2x + f[3] * p2y + f[6],
+						l2y = f[1] * p2x + f[4] * p2y + f[7],
+						e = l1x * p2x + l1y * p2y + f[6] * p1x + f[7] * p1y + f[8];
+
+		result[i] = e*e / (l1x*l1x + l1y*l1y + l2x*l2x + l2y*l2y);
+		}
+	}
+
+static void homographyTransferErrorsScalar(const double *h, const double *x1, const double *y1, const double *x2, const double *y2,
+											double *result, const int first, const int count)
+	{
+	for(int i = first; i < count; i++)
+		{
+		const double	p1x = x1[i], p1y = y1[i],
+						w = h[6] * p1x + h[7] * p1y + h[8],
+						dx = (h[0] * p1x + h[1] * p1y + h[2]) / w - x2[i],
+						dy = (h[3] * p1x + h[4] * p1y + h[5]) / w - y2[i];
+
+		result[i] = sqrt(dx*dx + dy*dy);
+		}
+	}
+
+#ifdef QVSIMD_X86
+////////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels. Four matchings per iteration, evaluated in two groups of two double precision lanes.
+
+#define QVSIMD_SSE2_RESIDUAL_KERNEL(NAME, RESIDUAL)															\
+QVSIMD_TARGET_SSE2 static void NAME(const double *m, const double *x1, const double *y1, const double *x2,		\
+									const double *y2, double *result, const int count)						\
+	{																										\
+	__m128d M[9];																							\
+	for(int k = 0; k < 9; k++)																				\
+		M[k] = _mm_set1_pd(m[k]);																			\
+																											\
+	int i = 0;																								\
+	for(; i + 4 <= count; i += 4)																			\
+		{																									\
+		const __m128d	low = RESIDUAL(M, _mm_loadu_pd(x1 + i), _mm_loadu_pd(y1 + i),									\
+										_mm_loadu_pd(x2 + i), _mm_loadu_pd(y2 + i)),								\
+						high = RESIDUAL(M, _mm_loadu_pd(x1 + i + 2), _mm_loadu_pd(y1 + i + 2),						\
+										_mm_loadu_pd(x2 + i + 2), _mm_loadu_pd(y2 + i + 2));						\
+		_mm_storeu_pd(result + i, low);																		\
+		_mm_storeu_pd(result + i + 2, high);																\
+		}																									\
+	}
+
+QVSIMD_TARGET_SSE2 static inline __m128d absSSE2(const __m128d value)
+	{
+	return _mm_andnot_pd(_mm_set1_pd(-0.0), value);
+	}
+
+QVSIMD_TARGET_SSE2 static inline __m128d symmetricEpipolarDistanceSSE2(const __m128d *f, const __m128d p1x, const __m128d p1y,
+																		const __m128d p2x, const __m128d p2y)
+	{
+	const __m128d	l1x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[0], p1x), _mm_mul_pd(f[1], p1y)), f[2]),
+					l1y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[3], p1x), _mm_mul_pd(f[4], p1y)), f[5]),
+					l2x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[0], p2x), _mm_mul_pd(f[3], p2y)), f[6]),
+					l2y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[1], p2x), _mm_mul_pd(f[4], p2y)), f[7]),
+					e1 = absSSE2(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(l1x, p2x), _mm_mul_pd(l1y, p2y)), _mm_mul_pd(f[6], p1x)),
+								_mm_mul_pd(f[7], p1y)), f[8])),
+					e2 = absSSE2(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(l2x, p1x), _mm_mul_pd(l2y, p1y)), _mm_mul_pd(f[2], p2x)),
+								_mm_mul_pd(f[5], p2y)), f[8])),
+					n1 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(l1x, l1x), _mm_mul_pd(l1y, l1y))),
+					n2 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(l2x, l2x), _mm_mul_pd(l2y, l2y)));
+	return _mm_add_pd(_mm_div_pd(e1, n1), _mm_div_pd(e2, n2));
+	}
+
+QVSIMD_TARGET_SSE2 static inline __m128d sampsonDistanceSSE2(const __m128d *f, const __m128d p1x, const __m128d p1y,
+															const __m128d p2x, const __m128d p2y)
+	{
+	const __m128d	l1x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[0], p1x), _mm_mul_pd(f[1], p1y)), f[2]),
+					l1y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[3], p1x), _mm_mul_pd(f[4], p1y)), f[5]),
+					l2x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[0], p2x), _mm_mul_pd(f[3], p2y)), f[6]),
+					l2y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[1], p2x), _mm_mul_pd(f[4], p2y)), f[7]),
+					e = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(l1x, p2x), _mm_mul_pd(l1y, p2y)), _mm_mul_pd(f[6], p1x)),
+								_mm_mul_pd(f[7], p1y)), f[8]),
+					n = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(l1x, l1x), _mm_mul_pd(l1y, l1y)), _mm_mul_pd(l2x, l2x)),
+								_mm_mul_pd(l2y, l2y));
+	return _mm_div_pd(_mm_mul_pd(e, e), n);
+	}
+
+QVSIMD_TARGET_SSE2 static inline __m128d homographyTransferErrorSSE2(const __m128d *h, const __m128d p1x, const __m128d p1y,
+																		const __m128d p2x, const __m128d p2y)
+	{
+	const __m128d	w = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h[6], p1x), _mm_mul_pd(h[7], p1y)), h[8]),
+					dx = _mm_sub_pd(_mm_div_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(h[0], p1x), _mm_mul_pd(h[1], p1y)), h[2]), w), p2x),
+					dy = _mm_sub_pd(_mm_div_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(h[3], p1x), _mm_mul_pd(h[4], p1y)), h[5]), w), p2y);
+	return _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+	}
+
+QVSIMD_SSE2_RESIDUAL_KERNEL(symmetricEpipolarDistancesSSE2, symmetricEpipolarDistanceSSE2)
+QVSIMD_SSE2_RESIDUAL_KERNEL(sampsonDistancesSSE2, sampsonDistanceSSE2)
+QVSIMD_SSE2_RESIDUAL_KERNEL(homographyTransferErrorsSSE2, homographyTransferErrorSSE2)
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels. Eight matchings per iteration, evaluated in two groups of four double precision lanes.
+
+#define QVSIMD_AVX2_RESIDUAL_KERNEL(NAME, RESIDUAL)															\
+QVSIMD_TARGET_AVX2 static void NAME(const double *m, const double *x1, const double *y1, const double *x2,		\
+									const double *y2, double *result, const int count)						\
+	{																										\
+	__m256d M[9];																							\
+	for(int k = 0; k < 9; k++)																				\
+		M[k] = _mm256_set1_pd(m[k]);																		\
+																											\
+	int i = 0;																								\
+	for(; i + 8 <= count; i += 8)																			\
+		{																									\
+		const __m256d	low = RESIDUAL(M, _mm256_loadu_pd(x1 + i), _mm256_loadu_pd(y1 + i),							\
+										_mm256_loadu_pd(x2 + i), _mm256_loadu_pd(y2 + i)),							\
+						high = RESIDUAL(M, _mm256_loadu_pd(x1 + i + 4), _mm256_loadu_pd(y1 + i + 4),				\
+										_mm256_loadu_pd(x2 + i + 4), _mm256_loadu_pd(y2 + i + 4));				\
+		_mm256_storeu_pd(result + i, low);																	\
+		_mm256_storeu_pd(result + i + 4, high);																\
+		}																									\
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256d absAVX2(const __m256d value)
+	{
+	return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value);
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256d symmetricEpipolarDistanceAVX2(const __m256d *f, const __m256d p1x, const __m256d p1y,
+																		const __m256d p2x, const __m256d p2y)
+	{
+	const __m256d	l1x = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[0], p1x), _mm256_mul_pd(f[1], p1y)), f[2]),
+					l1y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[3], p1x), _mm256_mul_pd(f[4], p1y)), f[5]),
+					l2x = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[0], p2x), _mm256_mul_pd(f[3], p2y)), f[6]),
+					l2y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[1], p2x), _mm256_mul_pd(f[4], p2y)), f[7]),
+					e1 = absAVX2(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(l1x, p2x), _mm256_mul_pd(l1y, p2y)), _mm256_mul_pd(f[6], p1x)),
+								_mm256_mul_pd(f[7], p1y)), f[8])),
+					e2 = absAVX2(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(l2x, p1x), _mm256_mul_pd(l2y, p1y)), _mm256_mul_pd(f[2], p2x)),
+								_mm256_mul_pd(f[5], p2y)), f[8])),
+					n1 = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(l1x, l1x), _mm256_mul_pd(l1y, l1y))),
+					n2 = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(l2x, l2x), _mm256_mul_pd(l2y, l2y)));
+	return _mm256_add_pd(_mm256_div_pd(e1, n1), _mm256_div_pd(e2, n2));
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256d sampsonDistanceAVX2(const __m256d *f, const __m256d p1x, const __m256d p1y,
+															const __m256d p2x, const __m256d p2y)
+	{
+	const __m256d	l1x = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[0], p1x), _mm256_mul_pd(f[1], p1y)), f[2]),
+					l1y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[3], p1x), _mm256_mul_pd(f[4], p1y)), f[5]),
+					l2x = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[0], p2x), _mm256_mul_pd(f[3], p2y)), f[6]),
+					l2y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(f[1], p2x), _mm256_mul_pd(f[4], p2y)), f[7]),
+					e = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(l1x, p2x), _mm256_mul_pd(l1y, p2y)), _mm256_mul_pd(f[6], p1x)),
+								_mm256_mul_pd(f[7], p1y)), f[8]),
+					n = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(l1x, l1x), _mm256_mul_pd(l1y, l1y)), _mm256_mul_pd(l2x, l2x)),
+								_mm256_mul_pd(l2y, l2y));
+	return _mm256_div_pd(_mm256_mul_pd(e, e), n);
+	}
+
+QVSIMD_TARGET_AVX2 static inline __m256d homographyTransferErrorAVX2(const __m256d *h, const __m256d p1x, const __m256d p1y,
+																		const __m256d p2x, const __m256d p2y)
+	{
+	const __m256d	w = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(h[6], p1x), _mm256_mul_pd(h[7], p1y)), h[8]),
+					dx = _mm256_sub_pd(_mm256_div_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(h[0], p1x), _mm256_mul_pd(h[1], p1y)), h[2]), w), p2x),
+					dy = _mm256_sub_pd(_mm256_div_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(h[3], p1x), _mm256_mul_pd(h[4], p1y)), h[5]), w), p2y);
+	return _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+	}
+
+QVSIMD_AVX2_RESIDUAL_KERNEL(symmetricEpipolarDistancesAVX2, symmetricEpipolarDistanceAVX2)
+QVSIMD_AVX2_RESIDUAL_KERNEL(sampsonDistancesAVX2, sampsonDistanceAVX2)
+QVSIMD_AVX2_RESIDUAL_KERNEL(homographyTransferErrorsAVX2, homographyTransferErrorAVX2)
+#endif // QVSIMD_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// Run time dispatch. The SIMD kernels process the largest multiple of their
+// group size, and the scalar kernels the remaining matchings.
+
+typedef void (*TResidualKernel)(const double *, const double *, const double *, const double *, const double *, double *, const int);
+typedef void (*TScalarResidualKernel)(const double *, const double *, const double *, const double *, const double *, double *, const int, const int);
+
+static void evaluateResiduals(const double *m, const double *x1, const double *y1, const double *x2, const double *y2, double *result,
+							const int count, const TResidualKernel sse2, const TResidualKernel avx2, const TScalarResidualKernel scalar)
+	{
+	int first = 0;
+
+	#ifdef QVSIMD_X86
+	switch(qvSimdLevel())
+		{
+		case QVSIMD_AVX2:
+			avx2(m, x1, y1, x2, y2, result, count);
+			first = count - count % 8;
+			break;
+		case QVSIMD_SSE2:
+			sse2(m, x1, y1, x2, y2, result, count);
+			first = count - count % 4;
+			break;
+		default:
+			break;
+		}
+	#else
+	Q_UNUSED(sse2);
+	Q_UNUSED(avx2);
+	#endif
+
+	scalar(m, x1, y1, x2, y2, result, first, count);
+	}
+#endif // DOXYGEN_IGNORE_THIS
+
+#ifdef QVSIMD_X86
+	#define QVSIMD_KERNELS(NAME)	NAME##SSE2, NAME##AVX2, NAME##Scalar
+#else
+	#define QVSIMD_KERNELS(NAME)	NULL, NULL, NAME##Scalar
+#endif
+
+void QVPointFMatchingSet::symmetricEpipolarDistances(const double *F, double *distances) const
+	{
+	evaluateResiduals(F, getFirstX(), getFirstY(), getSecondX(), getSecondY(), distances, size(),
+					QVSIMD_KERNELS(symmetricEpipolarDistances));
+	}
+
+void QVPointFMatchingSet::sampsonDistances(const double *F, double *distances) const
+	{
+	evaluateResiduals(F, getFirstX(), getFirstY(), getSecondX(), getSecondY(), distances, size(),
+					QVSIMD_KERNELS(sampsonDistances));
+	}
+
+void QVPointFMatchingSet::homographyTransferErrors(const double *H, double *errors) const
+	{
+	evaluateResiduals(H, getFirstX(), getFirstY(), getSecondX(), getSecondY(), errors, size(),
+					QVSIMD_KERNELS(homographyTransferErrors));
+	}
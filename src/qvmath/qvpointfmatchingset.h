@@ -0,0 +1,148 @@
+/*
+ *	Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef QVPOINTFMATCHINGSET_H
+#define QVPOINTFMATCHINGSET_H
+
+#include <QList>
+#include <QVector>
+#include <QPointF>
+#include <qvdefines.h>
+
+/*!
+@class QVPointFMatchingSet qvmath/qvpointfmatchingset.h QVPointFMatchingSet
+@brief Set of image point matchings, stored as four contiguous arrays of coordinates.
+
+This class stores the coordinates of a set of @ref QPointFMatching objects in a structure of arrays: the coordinates
+<i>x</i> and <i>y</i> of the first and the second point of each matching are stored in four separate double precision
+arrays. This layout is used by the SIMD kernels that evaluate the residuals of a fundamental matrix or a planar homography
+for every matching of the set:
+
+- @ref symmetricEpipolarDistances
+- @ref sampsonDistances
+- @ref homographyTransferErrors
+
+These kernels process four or eight matchings at once, using the SSE2 or AVX2 instruction sets when the processor
+supports them (see @ref qvSimdLevel). The coordinates and the residuals are kept in double precision, the same used by
+the residual functions for single matchings, to avoid the cancellation of the terms of the epipolar constraint for pixel
+coordinates. They are used by robust estimators such as @ref computeFundamentalMatrixRANSAC,
+@ref computeProjectiveHomographyRANSAC and @ref iterativeLocalOptimization.
+
+Fundamental matrices and homographies are given as \f$ 3 \times 3 \f$ row-major arrays. They follow the convention of the
+functions @ref symmetricEpipolarDistance and @ref applyHomography: the fundamental matrix satisfies
+\f$ x'^T F x = 0 \f$, and the homography maps the first point \f$ x \f$ of each matching to the second point \f$ x' \f$.
+
+@ingroup qvprojectivegeometry
+*/
+class QVPointFMatchingSet
+    {
+    public:
+        /// @brief Constructs an empty set.
+        QVPointFMatchingSet()	{ }
+
+        /// @brief Constructs a set from a list of matchings.
+        QVPointFMatchingSet(const QList<QPointFMatching> &matchings);
+
+        /// @brief Constructs a set from a vector of matchings.
+        QVPointFMatchingSet(const QVector<QPointFMatching> &matchings);
+
+        /// @brief Number of matchings in the set.
+        int size() const								{ return x1.size(); }
+
+        /// @brief Returns true if the set contains no matchings.
+        bool isEmpty() const							{ return x1.isEmpty(); }
+
+        /// @brief Reserves space for a number of matchings.
+        void reserve(const int size);
+
+        /// @brief Removes every matching from the set.
+        void clear();
+
+        /// @brief Appends a matching at the end of the set.
+        void append(const QPointFMatching &matching)
+            {
+            x1.append(matching.first.x());	y1.append(matching.first.y());
+            x2.append(matching.second.x());	y2.append(matching.second.y());
+            }
+
+        /// @brief Returns the matching at the given position of the set.
+        QPointFMatching at(const int index) const
+            { return QPointFMatching(QPointF(x1[index], y1[index]), QPointF(x2[index], y2[index])); }
+
+        /// @brief Converts the set to a list of matchings.
+        QList<QPointFMatching> toList() const;
+
+        /// @brief Converts the set to a vector of matchings.
+        QVector<QPointFMatching> toVector() const;
+
+        /// @brief Returns the matchings whose value in the mask is true.
+        QVPointFMatchingSet select(const QVector<bool> &mask) const;
+
+        /// @brief Coordinates x of the first points of the matchings.
+        const double *getFirstX() const					{ return x1.constData(); }
+        /// @brief Coordinates y of the first points of the matchings.
+        const double *getFirstY() const					{ return y1.constData(); }
+        /// @brief Coordinates x of the second points of the matchings.
+        const double *getSecondX() const					{ return x2.constData(); }
+        /// @brief Coordinates y of the second points of the matchings.
+        const double *getSecondY() const					{ return y2.constData(); }
+
+        /// @brief Evaluates the symmetric epipolar distance of every matching.
+        ///
+        /// The distance for a matching \f$ (x, x') \f$ is \f$ d(x', Fx) + d(x, F^Tx') \f$, where \f$ d(p,l) \f$ is the
+        /// euclidean distance between the point \f$ p \f$ and the line \f$ l \f$.
+        /// @param F fundamental matrix, as a row-major array of 9 elements.
+        /// @param distances output array, with space for @ref size elements.
+        void symmetricEpipolarDistances(const double *F, double *distances) const;
+
+        /// @brief Evaluates the Sampson distance of every matching.
+        ///
+        /// The Sampson distance is the first order approximation to the squared geometric reprojection error:
+        ///
+        /// \f$ \frac{(x'^T F x)^2}{(Fx)_1^2 + (Fx)_2^2 + (F^Tx')_1^2 + (F^Tx')_2^2} \f$
+        ///
+        /// @param F fundamental matrix, as a row-major array of 9 elements.
+        /// @param distances output array, with space for @ref size elements.
+        void sampsonDistances(const double *F, double *distances) const;
+
+        /// @brief Evaluates the transfer error of every matching for a planar homography.
+        ///
+        /// The error for a matching \f$ (x, x') \f$ is the euclidean distance between \f$ Hx \f$ and \f$ x' \f$.
+        /// @param H homography, as a row-major array of 9 elements.
+        /// @param errors output array, with space for @ref size elements.
+        void homographyTransferErrors(const double *H, double *errors) const;
+
+        /// @brief Counts the matchings with a residual below a threshold, and marks them in a mask.
+        ///
+        /// @param residuals array containing @ref size residual values, evaluated by one of the previous methods.
+        /// @param threshold maximal residual for a matching to be considered an inlier.
+        /// @param mask optional output mask, resized to the number of matchings.
+        /// @returns the number of matchings with a residual below the threshold.
+        int selectInliers(const double *residuals, const double threshold, QVector<bool> *mask = NULL) const;
+
+    private:
+        QVector<double> x1, y1, x2, y2;
+    };
+
+#endif // QVPOINTFMATCHINGSET_H
@@ -24,6 +24,9 @@
 #include <qvmath.h>
 #include <float.h>
 #include <qvnumericalanalysis.h>
+#include <qvmath/qvbatcheddecomposition.h>
+#include <qvmath/qvparallelsampleconsensus.h>
+#include <qvmath/qvpointfmatchingset.h>
 
 /// @file
 /// @brief File from the QVision library.
@@ -662,6 +665,31 @@ QList<QPointF> applyHomography(const QVMatrix &homography, const QList<QPointF>
     return result;
     }
 
+QPointF applyHomography(const QVFixedMatrix<3,3> &H, const QPointF &point)
+    {
+    const double	*h = H.getReadData(),
+            x = point.x(), y = point.y(),
+            homogenizer = h[6]*x + h[7]*y + h[8];
+
+    return QPointF(h[0]*x + h[1]*y + h[2], h[3]*x + h[4]*y + h[5])/homogenizer;
+    }
+
+QList<QPointF> applyHomography(const QVFixedMatrix<3,3> &homography, const QList<QPointF> &sourcePoints)
+    {
+    QList<QPointF> result;
+    result.reserve(sourcePoints.size());
+    foreach(QPointF point, sourcePoints)
+        result.append(applyHomography(homography, point));
+    return result;
+    }
+
+QVVector homographyTransferError(const QVMatrix &homography, const QVPointFMatchingSet &matchings)
+    {
+    QVVector errors(matchings.size());
+    matchings.homographyTransferErrors(homography.getReadData(), errors.data());
+    return errors;
+    }
+
 #ifdef QVIPP
 QVImage<uChar, 1> applyHomography(const QVMatrix &homography, const QVImage<uChar, 1> &image, const int interpolation)
     {
@@ -1085,9 +1113,33 @@ QV3DPointF linear3DPointTriangulation(const QPointFMatching &matching, const QVM
     return QV3DPointF(x[0] / x[3], x[1] / x[3], x[2] / x[3]);
     }
 
+QV3DPointF linear3DPointTriangulation(const QPointFMatching &matching, const QVFixedMatrix<3,4> &P1, const QVFixedMatrix<3,4> &P2)
+    {
+    QVFixedMatrix<4,4> A;
+    double	*a = A.getWriteData();
+    const double	*p1 = P1.getReadData(),
+            *p2 = P2.getReadData(),
+            p_x1 = matching.first.x(),	p_y1 = matching.first.y(),
+            p_x2 = matching.second.x(),	p_y2 = matching.second.y();
+
+    for(int j = 0; j < 4; j++)
+        {
+        a[j] = p1[8+j] * p_x1 - p1[j];
+        a[4+j] = p1[8+j] * p_y1 - p1[4+j];
+        a[8+j] = p2[8+j] * p_x2 - p2[j];
+        a[12+j] = p2[8+j] * p_y2 - p2[4+j];
+        }
+
+    QVFixedVector<4> x;
+    solveHomogeneous(A, x);
+
+    return QV3DPointF(x[0] / x[3], x[1] / x[3], x[2] / x[3]);
+    }
+
 QV3DPointF linear3DPointTriangulation(const QPointFMatching &matching, const QVCameraPose &pose1, const QVCameraPose &pose2, const TQVSVD_Method method)
     {
-	return linear3DPointTriangulation(matching, pose1.toProjectionMatrix(), pose2.toProjectionMatrix()	);
+    Q_UNUSED(method);
+	return linear3DPointTriangulation(matching, pose1.toFixedProjectionMatrix(), pose2.toFixedProjectionMatrix());
     }
 
 QVector<QVMatrix> cameraPosesToProjectionMatrices(const QList<QVCameraPose> &cameraPoses)
@@ -1108,68 +1160,90 @@ QVector<QVMatrix> cameraPosesToProjectionMatrices(const QList<QVEuclideanMapping
 	return cameraMatrices.toVector();
 	}
 
-QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVEuclideanMapping3> &cameras, const QList<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
-    {
-   /* QList<QVMatrix> cameraMatrices;
-    foreach(QVEuclideanMapping3 E3, cameras)
-        cameraMatrices << E3.toRotationTranslationMatrix();*/
+#ifndef DOXYGEN_IGNORE_THIS
+// Number of points triangulated in each batch. Bounds the memory used by the normal matrices of the points.
+#define QV_TRIANGULATION_BATCH_SIZE	65536
 
-    const QVector<QVMatrix> cameraMatricesVector = cameraPosesToProjectionMatrices(cameras);
+// Triangulates the points with a batched eigen-decomposition of the 4x4 matrices A^T A, where A is the coefficient
+// matrix used by linear3DPointTriangulation for each point. The location of each point is the eigenvector
+// corresponding to the smallest eigenvalue of its matrix A^T A.
+template <typename TPointTrackings> QList<QV3DPointF> batchedLinear3DPointsTriangulation(const QVector<QVMatrix> &cameraMatrices, const TPointTrackings &pointTrackings)
+    {
+    const int count = pointTrackings.count();
 
     QList<QV3DPointF> result;
-    QHash<int, QPointF> projectionsOfAPoint;
-    foreach(projectionsOfAPoint, pointTrackings)
-        result << linear3DPointTriangulation(cameraMatricesVector, projectionsOfAPoint, method);
-
-    return result;
-    }
+    result.reserve(count);
 
-QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVEuclideanMapping3> &cameras, const QVector<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
-    {
-   /* QList<QVMatrix> cameraMatrices;
-    foreach(QVEuclideanMapping3 E3, cameras)
-        cameraMatrices << E3.toRotationTranslationMatrix();*/
+    QVector<double> normalMatrices, eigenvectors;
+    for(int first = 0; first < count; first += QV_TRIANGULATION_BATCH_SIZE)
+        {
+        const int batchSize = qMin(QV_TRIANGULATION_BATCH_SIZE, count - first);
+        normalMatrices.fill(0.0, 16 * batchSize);
+        eigenvectors.resize(16 * batchSize);
 
-    const QVector<QVMatrix> cameraMatricesVector = cameraPosesToProjectionMatrices(cameras);
+        for(int i = 0; i < batchSize; i++)
+            {
+            double *ata = normalMatrices.data() + 16 * i;
 
-    QList<QV3DPointF> result;
-    QHash<int, QPointF> projectionsOfAPoint;
-    foreach(projectionsOfAPoint, pointTrackings)
-        result << linear3DPointTriangulation(cameraMatricesVector, projectionsOfAPoint, method);
+            QHashIterator<int, QPointF> it(pointTrackings[first + i]);
+            while (it.hasNext())
+                {
+                it.next();
+                const double	*p = cameraMatrices[it.key()].getReadData(),
+                                p_x = it.value().x(), p_y = it.value().y();
 
-    return result;
-    }
+                double a1[4], a2[4];
+                for(int j = 0; j < 4; j++)
+                    {
+                    a1[j] = p[8+j] * p_x - p[j];
+                    a2[j] = p[8+j] * p_y - p[4+j];
+                    }
 
-QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVCameraPose> &cameraPoses, const QList<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
-    {
-   /* QList<QVMatrix> cameraMatrices;
-    foreach(QVCameraPose cameraPose, cameraPoses)
-        cameraMatrices << cameraPose.toProjectionMatrix();*/
+                for(int j = 0; j < 4; j++)
+                    for(int k = 0; k < 4; k++)
+                        ata[4*j+k] += a1[j] * a1[k] + a2[j] * a2[k];
+                }
+            }
 
-    const QVector<QVMatrix> cameraMatricesVector = cameraPosesToProjectionMatrices(cameraPoses);
+        batchedEigenDecomposition(4, batchSize, normalMatrices.constData(), NULL, eigenvectors.data());
 
-    QList<QV3DPointF> result;
-    QHash<int, QPointF> projectionsOfAPoint;
-    foreach(projectionsOfAPoint, pointTrackings)
-        result << linear3DPointTriangulation(cameraMatricesVector, projectionsOfAPoint, method);
+        for(int i = 0; i < batchSize; i++)
+            {
+            // Smallest eigenvalue is the last one, so its eigenvector is the last column.
+            const double *x = eigenvectors.constData() + 16 * i;
+            if (pointTrackings[first + i].count() < 2)
+                result << QV3DPointF(0.0, 0.0, 0.0);
+            else
+                result << QV3DPointF(x[3] / x[15], x[7] / x[15], x[11] / x[15]);
+            }
+        }
 
     return result;
     }
+#endif // DOXYGEN_IGNORE_THIS
 
-QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVCameraPose> &cameraPoses, const QVector<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
+QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVEuclideanMapping3> &cameras, const QList<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
     {
-   /* QList<QVMatrix> cameraMatrices;
-    foreach(QVCameraPose cameraPose, cameraPoses)
-        cameraMatrices << cameraPose.toProjectionMatrix();*/
+    Q_UNUSED(method);
+    return batchedLinear3DPointsTriangulation(cameraPosesToProjectionMatrices(cameras), pointTrackings);
+    }
 
-    const QVector<QVMatrix> cameraMatricesVector = cameraPosesToProjectionMatrices(cameraPoses);
+QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVEuclideanMapping3> &cameras, const QVector<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
+    {
+    Q_UNUSED(method);
+    return batchedLinear3DPointsTriangulation(cameraPosesToProjectionMatrices(cameras), pointTrackings);
+    }
 
-    QList<QV3DPointF> result;
-    QHash<int, QPointF> projectionsOfAPoint;
-    foreach(projectionsOfAPoint, pointTrackings)
-        result << linear3DPointTriangulation(cameraMatricesVector, projectionsOfAPoint, method);
+QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVCameraPose> &cameraPoses, const QList<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
+    {
+    Q_UNUSED(method);
+    return batchedLinear3DPointsTriangulation(cameraPosesToProjectionMatrices(cameraPoses), pointTrackings);
+    }
 
-    return result;
+QList<QV3DPointF> linear3DPointsTriangulation(const QList<QVCameraPose> &cameraPoses, const QVector<QHash<int, QPointF> > &pointTrackings, const TQVSVD_Method method)
+    {
+    Q_UNUSED(method);
+    return batchedLinear3DPointsTriangulation(cameraPosesToProjectionMatrices(cameraPoses), pointTrackings);
     }
 
 #ifndef DOXYGEN_IGNORE_THIS
@@ -1334,6 +1408,65 @@ QVMatrix computeProjectiveHomography(const QList< QPointFMatching > &matchings)
 	return H;
 	}
 
+#ifndef DOXYGEN_IGNORE_THIS
+class QVHomographyRANSAC: public QVParallelRANSAC<QPointFMatching, QVFixedMatrix<3,3> >
+	{
+	private:
+		const double maxError;
+		QVPointFMatchingSet matchingSet;
+
+	protected:
+		bool init()
+			{
+			matchingSet = QVPointFMatchingSet(elements);
+			return true;
+			}
+
+		int testElements(const QVFixedMatrix<3,3> &H, QVector<bool> &mask) const
+			{
+			QVector<double> errors(matchingSet.size());
+			matchingSet.homographyTransferErrors(H.getReadData(), errors.data());
+			return matchingSet.selectInliers(errors.constData(), maxError, &mask);
+			}
+
+	public:
+		QVHomographyRANSAC(const QList< QPointFMatching > &matchings, const double maxError, const int minInliers, const double confidence):
+			QVParallelRANSAC<QPointFMatching, QVFixedMatrix<3,3> >(4, minInliers, confidence), maxError(maxError)
+			{
+			setSPRTParameters(100.0);
+			foreach(QPointFMatching matching, matchings)
+				addElement(matching);
+			}
+
+		bool fit(const QList< QPointFMatching > &matchings, QVFixedMatrix<3,3> &H) const
+			{
+			QVMatrix homography;
+			if (not computeProjectiveHomography(matchings, homography))
+				return false;
+			H = homography;
+			return true;
+			}
+
+		bool test(const QVFixedMatrix<3,3> &H, const QPointFMatching &matching) const
+			{
+			const QPointF residual = applyHomography(H, matching.first) - matching.second;
+			return residual.x()*residual.x() + residual.y()*residual.y() < maxError*maxError;
+			}
+	};
+#endif // DOXYGEN_IGNORE_THIS
+
+bool computeProjectiveHomographyRANSAC(const QList< QPointFMatching > &matchings, QVMatrix &H, QList< QPointFMatching > &inliers,
+										const double maxError, const int minInliers, const int maxIterations, const double confidence)
+	{
+	QVHomographyRANSAC ransac(matchings, maxError, minInliers, confidence);
+	if (not ransac.iterate(maxIterations))
+		return false;
+
+	H = ransac.getBestModel();
+	inliers = ransac.getBestInliers();
+	return true;
+	}
+
 QV3DPointF linear3DPointTriangulation(const QPointF &point1, const QVMatrix &P1, const QPointF &point2, const QVMatrix &P2, const TQVSVD_Method method)
     {
     std::cout << "WARNING: this version of 'linear3DPointTriangulation' for two views is deprecated." << std::endl;
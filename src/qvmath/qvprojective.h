@@ -27,6 +27,8 @@
 #include <QVEuclideanMapping3>
 #include <QV3DPointF>
 #include <QVCameraPose>
+#include <QVFixedMatrix>
+#include <qvmath/qvpointfmatchingset.h>
 
 #ifdef QVIPP
 #include <QVImage>
@@ -119,6 +121,29 @@ bool computeProjectiveHomography2(const QList< QPointFMatching > &matchings, QVM
 */
 QVMatrix computeProjectiveHomography(const QList< QPointFMatching > &matchings);
 
+/*!
+@brief Robust estimation of a planar homography from a set of image point matchings containing outliers.
+
+This function uses the @ref QVParallelRANSAC engine to search for the planar homography \f$ H \f$ which maps the first
+point of the largest set of matchings, to a location closer than <i>maxError</i> pixels from the second point of the matching.
+Tentative homographies are obtained from samples of four matchings with the function
+@ref computeProjectiveHomography(const QList< QPointFMatching > &, QVMatrix &), and the best one is fitted again to its
+inlier matchings.
+
+@param matchings list of image point matchings.
+@param H output homography.
+@param inliers output list containing the matchings consistent with the homography.
+@param maxError threshold value for maximal admissible transfer error.
+@param minInliers minimal number of inliers admissible.
+@param maxIterations maximal number of sample sets of four matchings to test.
+@param confidence probability of drawing at least one sample set without outliers, used to stop the search.
+@returns true if an homography consistent with at least <i>minInliers</i> matchings was found, false otherwise.
+@ingroup qvprojectivegeometry
+*/
+bool computeProjectiveHomographyRANSAC(const QList< QPointFMatching > &matchings, QVMatrix &H, QList< QPointFMatching > &inliers,
+                                        const double maxError = 1.0, const int minInliers = 8, const int maxIterations = 2000,
+                                        const double confidence = 0.99);
+
 /*!
 @brief Obtains an affine homography from a list of point correspondences.
 
@@ -246,6 +271,42 @@ This is an overloaded version of the @ref ApplyHomography(const QVMatrix &, cons
 */
 QList<QPointF> applyHomography(const QVMatrix &homography, const QList<QPointF> &sourcePoints);
 
+/*!
+@brief Maps a point using an homography stored in a fixed size matrix
+
+This is an overloaded version of the @ref ApplyHomography(const QVMatrix &, const QPointF &) function, which avoids the memory allocation and the element access overhead of the @ref QVMatrix class.
+
+@param homography The homography transformation matrix
+@param point Point to apply the homography transformation
+@ingroup qvprojectivegeometry
+*/
+QPointF applyHomography(const QVFixedMatrix<3,3> &homography, const QPointF &point);
+
+/*!
+@brief Maps a set of points using an homography stored in a fixed size matrix
+
+This is an overloaded version of the @ref ApplyHomography(const QVMatrix &, const QList<QPointF> &) function, which avoids the memory allocation and the element access overhead of the @ref QVMatrix class.
+
+@param homography The homography transformation matrix
+@param sourcePoints Points to apply the homography transformation
+@ingroup qvprojectivegeometry
+*/
+QList<QPointF> applyHomography(const QVFixedMatrix<3,3> &homography, const QList<QPointF> &sourcePoints);
+
+/*!
+@brief Evaluates the transfer errors of a planar homography for a set of point matchings.
+
+For each matching \f$ (x_i, x'_i) \f$ of the set, this function evaluates the euclidean distance between the point
+\f$ x_i \f$ mapped by the homography, and the point \f$ x'_i \f$. The errors are evaluated with the SIMD kernels of
+the class @ref QVPointFMatchingSet.
+
+@param homography homography matrix.
+@param matchings set of point matchings.
+@returns A vector, containing the transfer error for each matching.
+@ingroup qvprojectivegeometry
+*/
+QVVector homographyTransferError(const QVMatrix &homography, const QVPointFMatchingSet &matchings);
+
 /*!
 @brief Performs an homography distortion on an image
 
@@ -668,6 +729,20 @@ The method used is described at section 12.2 from <i>Multiple View Geometry in C
 */
 QV3DPointF linear3DPointTriangulation(const QPointFMatching &matching, const QVMatrix &P1, const QVMatrix &P2, const TQVSVD_Method method = DEFAULT_TQVSVD_METHOD);
 
+/*!
+@brief Recovers the location of a 3D point from its projection on two images, and their fixed size camera matrices.
+
+This is an overloaded version of the function @ref linear3DPointTriangulation(const QPointFMatching &, const QVMatrix &, const QVMatrix &, const TQVSVD_Method).
+It does not allocate memory: the \f$ 4 \times 4 \f$ linear system is stored in a fixed size matrix, and solved with the function @ref solveHomogeneous(const QVFixedMatrix<R,N> &, QVFixedVector<N> &).
+
+@param matching Point matching containing the projections of each 3D point at both cameras.
+@param P1 The camera matrix for the first image.
+@param P2 The camera matrix for the second image.
+@return The triangulated location for the point.
+@ingroup qvprojectivegeometry
+*/
+QV3DPointF linear3DPointTriangulation(const QPointFMatching &matching, const QVFixedMatrix<3,4> &P1, const QVFixedMatrix<3,4> &P2);
+
 /*!
 @brief Recovers the location of a 3D point from its projection on two images, and their corresponding camera matrices.
 
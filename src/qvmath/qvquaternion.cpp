@@ -25,6 +25,7 @@
 #include <QString>
 #include <QVMatrix>
 #include <QVQuaternion>
+#include <QVFixedMatrix>
 #include <qvmath.h>
 
 ///////////////////////////////////
@@ -250,7 +251,7 @@ void QVQuaternion::toEulerAngles(double &xAngle, double &yAngle, double &zAngle)
 	zAngle = atan2f(2.f * (y*z + x*s), -sqx - sqy + sqz + sqw);
 	}
 
-QVMatrix QVQuaternion::toRotationMatrix() const
+QVFixedMatrix<3,3> QVQuaternion::toFixedRotationMatrix() const
 	{
 	Q_WARNING(not containsNaN());
 	Q_ASSERT(norm2() > 0);
@@ -261,7 +262,7 @@ QVMatrix QVQuaternion::toRotationMatrix() const
 			z = operator[](2) / norm,
 			w = operator[](3) / norm;
 
-	QVMatrix result(3,3);
+	QVFixedMatrix<3,3> result;
 	result(0,0) = 1.0 - 2.0 * (y*y + z*z);
 	result(0,1) = 2.0 * (x*y - z*w);
 	result(0,2) = 2.0 * (z*x + y*w);
@@ -277,6 +278,11 @@ QVMatrix QVQuaternion::toRotationMatrix() const
 	return result;
 	}
 
+QVMatrix QVQuaternion::toRotationMatrix() const
+	{
+	return toFixedRotationMatrix();
+	}
+
 QVQuaternion QVQuaternion::conjugate() const
 	{
 	const QVQuaternion result(-operator[](0), -operator[](1), -operator[](2), operator[](3));
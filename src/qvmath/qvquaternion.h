@@ -31,6 +31,7 @@
 #include <QV3DPointF>
 
 class QVMatrix;
+template <int R, int C> class QVFixedMatrix;
 
 /*!
 @class QVQuaternion qvmath/qvquaternion.h QVQuaternion
@@ -146,6 +147,12 @@ class QVQuaternion: public QVVector
         /// @return rotation matrix
         QVMatrix toRotationMatrix() const;
 
+        /// @brief Gets the rotation matrix corresponding to the Quaternion, as a fixed size matrix.
+        ///
+        /// This version does not allocate memory, so it is preferable in inner loops.
+        /// @return rotation matrix
+        QVFixedMatrix<3,3> toFixedRotationMatrix() const;
+
         /// @brief Gets the conjugate of the quaternion
         ///
         /// @return The conjugate quaternion.
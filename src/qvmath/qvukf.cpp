@@ -61,7 +61,6 @@ QVMatrix QVUKF::sigmaPoints(const QVMatrix &X, const QVMatrix &P) const
 
 	//Calling to Cholesky decomposition
 	CholeskyDecomposition(aux, aux2);
-	aux2 = aux2.transpose();
 	QVMatrix Sigma = QVMatrix(2*n + 1, n, 0.0);
 	QVVector Xvector = QVVector(X);
 	for(int i=0; i<2*n+1; i++)
@@ -69,9 +68,9 @@ QVMatrix QVUKF::sigmaPoints(const QVMatrix &X, const QVMatrix &P) const
 		if(i==0)
 			Sigma.setRow(i, Xvector);
 		if (i>0 && i<=n)
-			Sigma.setRow(i, X + aux2.getRow(i-1));
+			Sigma.setRow(i, X + aux2.getCol(i-1));
 		if (i>n && i<2*n+1)
-			Sigma.setRow(i, X - aux2.getRow(i-n-1));
+			Sigma.setRow(i, X - aux2.getCol(i-n-1));
 	}
 
 	return Sigma;
@@ -126,12 +125,8 @@ QVMatrix QVUKF::computeCovariance(const QVMatrix &mean, const QVMatrix &FdeSigma
 
 	for(int i=0; i<2*n+1; i++)
 	{
-		QVMatrix accum = QVMatrix(mean.getCols(), mean.getCols(), 0.0);
-		QVMatrix YXprima = FdeSigma.getRow(i)-mean;
-		QVMatrix YXprimaTrans = YXprima.transpose();
-		accum = YXprimaTrans*YXprima;
-		accum = accum.operator*(weights.Wc(i, 0));
-		covariance = covariance + accum;
+		const QVMatrix YXprima = FdeSigma.getRow(i)-mean;
+		covariance += weights.Wc(i, 0) * (qvLazy(YXprima).transpose() * qvLazy(YXprima));
 	}
 
 	return covariance;
@@ -144,13 +139,10 @@ QVMatrix QVUKF::CrossCovariance (const QVMatrix &mean, const QVMatrix &FdeSigma,
 
 	for(int i=0; i<2*n+1; i++)
 	{
-		QVMatrix accum = QVMatrix(n, zt.getRows(), 0.0);
-		QVMatrix YXprima = FdeSigma.getRow(i) - mean;
-		QVMatrix zZprima = Zt.getRow(i) - zt;
+		const QVMatrix	YXprima = FdeSigma.getRow(i) - mean,
+				zZprima = Zt.getRow(i) - zt;
 
-		accum = YXprima.transpose()*zZprima;
-		accum = accum.operator*(weights.Wc(i,0));
-		covariance = covariance + accum;
+		covariance += weights.Wc(i,0) * (qvLazy(YXprima).transpose() * qvLazy(zZprima));
 	}
 
 	return covariance;
@@ -192,8 +184,12 @@ void QVUKF::update(const QVMatrix &obs, QVFunction<QVVector, QVVector> &g, QVFun
 	//QVMatrix Kt = CrossCov * St.inverse();
 
 	QVMatrix dis = obs - zt;
-	QVMatrix final_mean = mean_t + (dis)*Kt.transpose();
-	QVMatrix final_covariance = covar_t - Kt*St*Kt.transpose();
+	QVMatrix final_mean = mean_t;
+	final_mean += qvLazy(dis) * qvLazy(Kt).transpose();
+
+	const QVMatrix KtSt = qvLazy(Kt) * qvLazy(St);
+	QVMatrix final_covariance = covar_t;
+	final_covariance -= qvLazy(KtSt) * qvLazy(Kt).transpose();
 
 	//Updating current state (mu, sigma)
 	this->currentState.mean = final_mean;
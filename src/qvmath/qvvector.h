@@ -46,6 +46,8 @@
 #endif // _MSC_VER
 
 class QVMatrix;
+class QVMatrixVectorProduct;
+template <class E> class QVVectorExpression;
 
 /*!
 @class QVVector qvmath/qvvector.h QVVector
@@ -222,6 +224,51 @@ class QVVector: public QVector<double>
             return *this;
             }
 
+        /// @brief Constructs a vector evaluating a lazy vector expression.
+        ///
+        /// @param expression expression to evaluate, in a single pass.
+        /// @see QVVectorExpression
+        template <class E> QVVector(const QVVectorExpression<E> &expression);
+
+        /// @brief Evaluates a lazy vector expression, reusing the data buffer of the vector when possible.
+        ///
+        /// @param expression expression to evaluate, in a single pass.
+        /// @see QVVectorExpression
+        template <class E> QVVector & operator=(const QVVectorExpression<E> &expression);
+
+        /// @brief Adds a lazy vector expression to the vector, without creating temporary vectors.
+        ///
+        /// @param expression expression to add.
+        /// @see QVVectorExpression
+        template <class E> QVVector & operator+=(const QVVectorExpression<E> &expression);
+
+        /// @brief Substracts a lazy vector expression from the vector, without creating temporary vectors.
+        ///
+        /// @param expression expression to substract.
+        /// @see QVVectorExpression
+        template <class E> QVVector & operator-=(const QVVectorExpression<E> &expression);
+
+        /// @brief Constructs a vector evaluating a lazy matrix-vector product, with a single gemv call.
+        ///
+        /// @param product product to evaluate.
+        /// @see QVVectorExpression
+        QVVector(const QVMatrixVectorProduct &product);
+
+        /// @brief Evaluates a lazy matrix-vector product, with a single gemv call.
+        ///
+        /// @param product product to evaluate.
+        QVVector & operator=(const QVMatrixVectorProduct &product);
+
+        /// @brief Accumulates a lazy matrix-vector product on the vector, with a single gemv call.
+        ///
+        /// @param product product to add.
+        QVVector & operator+=(const QVMatrixVectorProduct &product);
+
+        /// @brief Substracts a lazy matrix-vector product from the vector, with a single gemv call.
+        ///
+        /// @param product product to substract.
+        QVVector & operator-=(const QVMatrixVectorProduct &product);
+
         /// @brief Convert to QPointF operator
         ///
         /// Cast from homogeneous coordinates.
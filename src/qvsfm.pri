@@ -38,6 +38,7 @@
                 $$PWD/qvsfm/qvgea/geaoptimization.h              	\
                 $$PWD/qvsfm/qvgea/quaternionEssentialEvaluation.h	\
                 $$PWD/qvsfm/qvgea/so3EssentialEvaluation.h			\
+                $$PWD/qvsfm/qvgea/batchedEssentialEvaluation.h		\
      #           $$PWD/qvsfm/laSBA/laSBAWrapper.h
 
     SOURCES +=  $$PWD/qvsfm/qvsfm.cpp                               \
@@ -46,6 +47,7 @@
                 $$PWD/qvsfm/qvgea/geaoptimization.cpp               \
                 $$PWD/qvsfm/qvgea/quaternionEssentialEvaluation.cpp \
                 $$PWD/qvsfm/qvgea/so3EssentialEvaluation.cpp		\
+                $$PWD/qvsfm/qvgea/batchedEssentialEvaluation.cpp	\
       #          $$PWD/qvsfm/laSBA/laSBAWrapper.cpp
 
 }
@@ -0,0 +1,340 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#include <math.h>
+#include <string.h>
+#include <qvip/qvsimd.h>
+#include <qvsfm/qvgea/batchedEssentialEvaluation.h>
+
+// The generic kernels below are written with the arithmetic operators of the GCC vector types __m128d and __m256d,
+// and they are always inlined in the SIMD kernels compiled for each instruction set (see the target attributes in
+// 'qvsimd.h').
+
+#ifdef __GNUC__
+	#define GEA_INLINE	inline __attribute__((always_inline))
+#else
+	#define GEA_INLINE	inline
+#endif
+
+// Coefficients for the so3 rotation of vector 'v', with angle 't = |v|':
+//
+//	R = a I + b [v]x + c v v^T
+//	dR/dv_i = -b v_i I + B v_i [v]x + b [e_i]x + C v_i v v^T + c (e_i v^T + v e_i^T)
+//
+// with a = cos(t), b = sin(t)/t, c = (1-cos(t))/t^2, B = b'(t)/t and C = c'(t)/t. Coefficients 'B' and 'C' cancel
+// badly for small angles, so the Taylor series are used below 1e-2 radians.
+static void so3RotationCoefficients(const double *v, const int stride, double *k)
+    {
+    const double	theta2 = v[0]*v[0] + v[stride]*v[stride] + v[2*stride]*v[2*stride],
+                    theta = sqrt(theta2);
+
+    if (theta < 1e-2)
+        {
+        const double theta4 = theta2 * theta2;
+        k[0] = cos(theta);
+        k[1] = 1.0 - theta2 / 6.0 + theta4 / 120.0;
+        k[2] = 0.5 - theta2 / 24.0 + theta4 / 720.0;
+        k[3] = -1.0 / 3.0 + theta2 / 30.0 - theta4 / 840.0;
+        k[4] = -1.0 / 12.0 + theta2 / 180.0 - theta4 / 6720.0;
+        }
+    else
+        {
+        // For angles below pi/2, 1-cos(t) is obtained as sin(t)^2/(1+cos(t)) to avoid the cancellation.
+        const double	sinTheta = sin(theta),
+                        cosTheta = cos(theta),
+                        oneMinusCos = (cosTheta > 0.0)? sinTheta * sinTheta / (1.0 + cosTheta) : 1.0 - cosTheta;
+        k[0] = cosTheta;
+        k[1] = sinTheta / theta;
+        k[2] = oneMinusCos / theta2;
+        k[3] = (theta * cosTheta - sinTheta) / (theta2 * theta);
+        k[4] = (theta * sinTheta - 2.0 * oneMinusCos) / (theta2 * theta2);
+        }
+    }
+
+// Inverse of the distance between the camera centers.
+static double inverseBaselineNorm(const double *c1, const double *c2, const int stride)
+    {
+    const double	d0 = c2[0] - c1[0],
+                    d1 = c2[stride] - c1[stride],
+                    d2 = c2[2*stride] - c1[2*stride];
+    return 1.0 / sqrt(d0*d0 + d1*d1 + d2*d2);
+    }
+
+// -----------------------------------------------------------------------------
+// Generic kernels. Type 'Real' is either double, or a vector type with the values of several pairs.
+
+template <typename Real> static GEA_INLINE void crossProduct(const Real *a, const Real *b, Real *c)
+    {
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+// Evaluates the rotation matrix, and its derivatives dR/dv_i, for a so3 vector and its coefficients.
+template <typename Real> static GEA_INLINE void so3RotationDerivatives(const Real *v, const Real *k, Real *R, Real *dR)
+    {
+    const Real	&a = k[0], &b = k[1], &c = k[2], &B = k[3], &C = k[4];
+    const Real	zero = Real(),
+                X[9] = { zero, -v[2], v[1], v[2], zero, -v[0], -v[1], v[0], zero };		// [v]x
+
+    for(int r = 0; r < 3; r++)
+        for(int s = 0; s < 3; s++)
+            R[3*r+s] = b * X[3*r+s] + c * v[r] * v[s];
+    for(int r = 0; r < 3; r++)
+        R[4*r] += a;
+
+    for(int i = 0; i < 3; i++)
+        {
+        Real *D = dR + 9*i;
+        for(int r = 0; r < 3; r++)
+            for(int s = 0; s < 3; s++)
+                D[3*r+s] = v[i] * (B * X[3*r+s] + C * v[r] * v[s]);
+        for(int r = 0; r < 3; r++)
+            D[4*r] -= b * v[i];
+
+        // Term b [e_i]x.
+        const int j = (i+1) % 3, l = (i+2) % 3;
+        D[3*l+j] += b;
+        D[3*j+l] -= b;
+
+        // Term c (e_i v^T + v e_i^T).
+        for(int s = 0; s < 3; s++)
+            D[3*i+s] += c * v[s];
+        for(int r = 0; r < 3; r++)
+            D[3*r+i] += c * v[r];
+        }
+    }
+
+// Evaluates the rotation matrix, and its derivatives dR/dq_i, for a (not necessarily unit) quaternion:
+//
+//	R = I + 2/|q|^2 S(q)
+//	dR/dq_i = 2/|q|^2 dS/dq_i - 4 q_i/|q|^4 S(q)
+template <typename Real> static GEA_INLINE void quaternionRotationDerivatives(const Real *q, Real *R, Real *dR)
+    {
+    const Real	zero = Real(),
+                one = zero + 1.0,
+                invNorm = one / (q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]),
+                twoInvNorm = invNorm * 2.0;
+
+    const Real	S[9] = {	-q[1]*q[1] - q[2]*q[2],	q[0]*q[1] - q[2]*q[3],	q[2]*q[0] + q[1]*q[3],
+                            q[0]*q[1] + q[2]*q[3],	-q[2]*q[2] - q[0]*q[0],	q[1]*q[2] - q[0]*q[3],
+                            q[2]*q[0] - q[1]*q[3],	q[1]*q[2] + q[0]*q[3],	-q[1]*q[1] - q[0]*q[0]	},
+                dS[36] = {	zero,		q[1],		q[2],		q[1],		q[0]*-2.0,	-q[3],		q[2],		q[3],		q[0]*-2.0,
+                            q[1]*-2.0,	q[0],		q[3],		q[0],		zero,		q[2],		-q[3],		q[2],		q[1]*-2.0,
+                            q[2]*-2.0,	-q[3],		q[0],		q[3],		q[2]*-2.0,	q[1],		q[0],		q[1],		zero,
+                            zero,		-q[2],		q[1],		q[2],		zero,		-q[0],		-q[1],		q[0],		zero		};
+
+    for(int r = 0; r < 9; r++)
+        R[r] = twoInvNorm * S[r];
+    for(int r = 0; r < 3; r++)
+        R[4*r] += one;
+
+    for(int i = 0; i < 4; i++)
+        {
+        const Real factor = q[i] * invNorm * invNorm * 4.0;
+        for(int r = 0; r < 9; r++)
+            dR[9*i+r] = twoInvNorm * dS[9*i+r] - factor * S[r];
+        }
+    }
+
+// Evaluates the matrix [D1|D2|v] for the essential matrix E = R2 [t]x R1^T, where t = (c2-c1)/|c2-c1|, given the
+// rotation matrices of both poses and their derivatives for each of the 'Params' rotation parameters.
+//
+// Each element of E is E_rs = t · w_rs, where w_rs is the cross product of the row 's' of R1 and the row 'r' of R2.
+// Thus, the derivatives for the camera centers are dE_rs/dc2 = -dE_rs/dc1 = (w_rs - t E_rs) / |c2-c1|.
+template <typename Real, int Params> static GEA_INLINE void essentialJacobians(const Real *R1, const Real *dR1, const Real *c1,
+                                                                              const Real *R2, const Real *dR2, const Real *c2,
+                                                                              const Real &invNorm, Real *cg)
+    {
+    const int cols = 2*(Params+3) + 1;
+
+    Real t[3];
+    for(int i = 0; i < 3; i++)
+        t[i] = (c2[i] - c1[i]) * invNorm;
+
+    // M = R2 [t]x, and N = [t]x R1^T.
+    Real M[9], N[9], column[3];
+    for(int r = 0; r < 3; r++)
+        crossProduct(R2 + 3*r, t, M + 3*r);
+    for(int s = 0; s < 3; s++)
+        {
+        crossProduct(t, R1 + 3*s, column);
+        for(int m = 0; m < 3; m++)
+            N[3*m+s] = column[m];
+        }
+
+    for(int r = 0; r < 3; r++)
+        for(int s = 0; s < 3; s++)
+            {
+            Real *row = cg + (3*r+s) * cols, w[3];
+            crossProduct(R1 + 3*s, R2 + 3*r, w);
+            const Real E = t[0] * w[0] + t[1] * w[1] + t[2] * w[2];
+
+            // dE/dR1_i = M dR1_i^T, and dE/dR2_i = dR2_i N.
+            for(int i = 0; i < Params; i++)
+                {
+                row[i] = M[3*r] * dR1[9*i+3*s] + M[3*r+1] * dR1[9*i+3*s+1] + M[3*r+2] * dR1[9*i+3*s+2];
+                row[Params+3+i] = dR2[9*i+3*r] * N[s] + dR2[9*i+3*r+1] * N[3+s] + dR2[9*i+3*r+2] * N[6+s];
+                }
+
+            for(int i = 0; i < 3; i++)
+                {
+                const Real dc2 = (w[i] - t[i] * E) * invNorm;
+                row[Params+i] = -dc2;
+                row[2*Params+3+i] = dc2;
+                }
+
+            row[cols-1] = E;
+            }
+    }
+
+// Loads the values of a component for the pairs evaluated at once. Values in 'cg' are stored in the same way.
+template <typename Real> static GEA_INLINE void loadPairs(const double *data, Real &value)
+    {
+    memcpy(&value, data, sizeof(Real));
+    }
+
+template <typename Real> static GEA_INLINE void storePairs(double *data, const Real &value)
+    {
+    memcpy(data, &value, sizeof(Real));
+    }
+
+// Evaluates pairs from 'first', in groups of 'Lanes' pairs. Returns the index of the first pair not evaluated.
+template <typename Real, int Lanes> static GEA_INLINE int so3EssentialEvaluationPairs(const int first, const int count,
+                                                                                       const double *poses1, const double *poses2, double *cg)
+    {
+    int p = first;
+    for(; p + Lanes <= count; p += Lanes)
+        {
+        // The trigonometric coefficients and the baseline norm are evaluated with the scalar math library.
+        double coefficients[11*Lanes];
+        for(int l = 0; l < Lanes; l++)
+            {
+            double k[11];
+            so3RotationCoefficients(poses1 + p + l, count, k);
+            so3RotationCoefficients(poses2 + p + l, count, k + 5);
+            k[10] = inverseBaselineNorm(poses1 + 3*count + p + l, poses2 + 3*count + p + l, count);
+            for(int j = 0; j < 11; j++)
+                coefficients[j*Lanes + l] = k[j];
+            }
+
+        Real pose1[6], pose2[6], k[11];
+        for(int j = 0; j < 6; j++)
+            {
+            loadPairs(poses1 + j*count + p, pose1[j]);
+            loadPairs(poses2 + j*count + p, pose2[j]);
+            }
+        for(int j = 0; j < 11; j++)
+            loadPairs(coefficients + j*Lanes, k[j]);
+
+        Real R1[9], dR1[27], R2[9], dR2[27], result[9*13];
+        so3RotationDerivatives(pose1, k, R1, dR1);
+        so3RotationDerivatives(pose2, k + 5, R2, dR2);
+        essentialJacobians<Real, 3>(R1, dR1, pose1 + 3, R2, dR2, pose2 + 3, k[10], result);
+
+        for(int j = 0; j < 9*13; j++)
+            storePairs(cg + j*count + p, result[j]);
+        }
+    return p;
+    }
+
+template <typename Real, int Lanes> static GEA_INLINE int quaternionEssentialEvaluationPairs(const int first, const int count,
+                                                                                              const double *poses1, const double *poses2, double *cg)
+    {
+    int p = first;
+    for(; p + Lanes <= count; p += Lanes)
+        {
+        double invNorms[Lanes];
+        for(int l = 0; l < Lanes; l++)
+            invNorms[l] = inverseBaselineNorm(poses1 + 4*count + p + l, poses2 + 4*count + p + l, count);
+
+        Real pose1[7], pose2[7];
+        for(int j = 0; j < 7; j++)
+            {
+            loadPairs(poses1 + j*count + p, pose1[j]);
+            loadPairs(poses2 + j*count + p, pose2[j]);
+            }
+        Real invNorm;
+        loadPairs(invNorms, invNorm);
+
+        Real R1[9], dR1[36], R2[9], dR2[36], result[9*15];
+        quaternionRotationDerivatives(pose1, R1, dR1);
+        quaternionRotationDerivatives(pose2, R2, dR2);
+        essentialJacobians<Real, 4>(R1, dR1, pose1 + 4, R2, dR2, pose2 + 4, invNorm, result);
+
+        for(int j = 0; j < 9*15; j++)
+            storePairs(cg + j*count + p, result[j]);
+        }
+    return p;
+    }
+
+// -----------------------------------------------------------------------------
+
+#ifdef QVSIMD_X86
+QVSIMD_TARGET_SSE2 static int so3EssentialEvaluationSSE2(const int count, const double *poses1, const double *poses2, double *cg)
+    { return so3EssentialEvaluationPairs<__m128d, 2>(0, count, poses1, poses2, cg); }
+
+QVSIMD_TARGET_AVX2 static int so3EssentialEvaluationAVX2(const int count, const double *poses1, const double *poses2, double *cg)
+    { return so3EssentialEvaluationPairs<__m256d, 4>(0, count, poses1, poses2, cg); }
+
+QVSIMD_TARGET_SSE2 static int quaternionEssentialEvaluationSSE2(const int count, const double *poses1, const double *poses2, double *cg)
+    { return quaternionEssentialEvaluationPairs<__m128d, 2>(0, count, poses1, poses2, cg); }
+
+QVSIMD_TARGET_AVX2 static int quaternionEssentialEvaluationAVX2(const int count, const double *poses1, const double *poses2, double *cg)
+    { return quaternionEssentialEvaluationPairs<__m256d, 4>(0, count, poses1, poses2, cg); }
+#endif // QVSIMD_X86
+
+void so3EssentialEvaluationBatch(const int count, const double *poses1, const double *poses2, double *cg)
+    {
+    int first = 0;
+
+    #ifdef QVSIMD_X86
+    switch(qvSimdLevel())
+        {
+        case QVSIMD_AVX2:	first = so3EssentialEvaluationAVX2(count, poses1, poses2, cg);	break;
+        case QVSIMD_SSE2:	first = so3EssentialEvaluationSSE2(count, poses1, poses2, cg);	break;
+        default:			break;
+        }
+    #endif // QVSIMD_X86
+
+    // Remaining pairs.
+    so3EssentialEvaluationPairs<double, 1>(first, count, poses1, poses2, cg);
+    }
+
+void quaternionEssentialEvaluationBatch(const int count, const double *poses1, const double *poses2, double *cg)
+    {
+    int first = 0;
+
+    #ifdef QVSIMD_X86
+    switch(qvSimdLevel())
+        {
+        case QVSIMD_AVX2:	first = quaternionEssentialEvaluationAVX2(count, poses1, poses2, cg);	break;
+        case QVSIMD_SSE2:	first = quaternionEssentialEvaluationSSE2(count, poses1, poses2, cg);	break;
+        default:			break;
+        }
+    #endif // QVSIMD_X86
+
+    // Remaining pairs.
+    quaternionEssentialEvaluationPairs<double, 1>(first, count, poses1, poses2, cg);
+    }
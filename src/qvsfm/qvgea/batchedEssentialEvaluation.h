@@ -0,0 +1,40 @@
+/*
+ *	Copyright (C) 2012. PARP Research Group.
+ *	<http://perception.inf.um.es>
+ *	University of Murcia, Spain.
+ *
+ *	This file is part of the QVision library.
+ *
+ *	QVision is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU Lesser General Public License as
+ *	published by the Free Software Foundation, version 3 of the License.
+ *
+ *	QVision is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with QVision. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// @brief File from the QVision library.
+/// @author PARP Research Group. University of Murcia, Spain.
+
+#ifndef BATCHEDESSENTIALEVALUATION_H
+#define BATCHEDESSENTIALEVALUATION_H
+#ifndef DOXYGEN_IGNORE_THIS
+
+// Batched versions of 'so3EssentialEvaluation' and 'quaternionEssentialEvaluation'. They obtain the matrix [D1|D2|v]
+// containing the vectorized essential matrix and its jacobians for many pairs of camera poses, using analytic
+// derivatives of the rotation parametrization instead of the generated code.
+//
+// Poses and results are stored in structure of arrays layout. Component 'k' of the first pose of the pair 'i' is stored
+// at poses1[k*count + i], and element 'j' of the row-major matrix [D1|D2|v] for that pair is stored at cg[j*count + i].
+// The pairs are evaluated four or two at a time with the AVX2 or SSE2 instruction sets, depending on 'qvSimdLevel'.
+void so3EssentialEvaluationBatch(const int count, const double *poses1, const double *poses2, double *cg);
+void quaternionEssentialEvaluationBatch(const int count, const double *poses1, const double *poses2, double *cg);
+
+#endif // DOXYGEN_IGNORE_THIS
+#endif // BATCHEDESSENTIALEVALUATION_H
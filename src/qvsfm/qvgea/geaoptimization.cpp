@@ -23,8 +23,11 @@
 /// @author PARP Research Group. University of Murcia, Spain.
 
 #include <QTime>
+#include <QThread>
 #include <qvsfm/qvgea/geaoptimization.h>
 #include <QVSparseBlockMatrix>
+#include <qvmath/qvparallelranges.h>
+#include <qvmath/qvbatcheddecomposition.h>
 #include <qvsfm/qvgea/so3EssentialEvaluation.h>
 #include <qvsfm/qvgea/quaternionEssentialEvaluation.h>
 
@@ -139,6 +142,32 @@ QVDirectedGraph< QList<QPointFMatching> > pointMatchingsListOld(const QList<QHas
     return result;
     }
 
+#ifndef DOXYGEN_IGNORE_THIS
+// Defined below.
+QVMatrix getTransposeProductOf8PointsCoefficientMatrix(const QVector<QPointFMatching> &matchings, const bool normalize);
+
+// Stores in the graph the reduced matrices Q*diag(sqrt(lambda)) for a set of view pairs, obtained with a single
+// batched eigen-decomposition of their 9x9 matrices M^T M.
+static void storeBatchedEigenReducedMatrices(const QList<QVGraphLink> &links, const QVector<double> &MtMs, QVDirectedGraph<QVMatrix> &reducedMatricesGraph)
+    {
+    const int count = links.count();
+    QVector<double> lambdas(9 * count), Qs(81 * count);
+    batchedEigenDecomposition(9, count, MtMs.constData(), lambdas.data(), Qs.data());
+
+    for(int k = 0; k < count; k++)
+        {
+        QVMatrix Q(9, 9, Qs.constData() + 81 * k);
+        const double *dataLambda = lambdas.constData() + 9 * k;
+        double *dataQ = Q.getWriteData();
+        for(int i = 0, idx = 0; i < 9; i++)
+            for(int j = 0; j < 9; j++, idx++)
+                dataQ[idx] *= sqrt(fabs(dataLambda[j]));
+
+        reducedMatricesGraph[links[k]] = Q;
+        }
+    }
+#endif // DOXYGEN_IGNORE_THIS
+
 QVDirectedGraph<QVMatrix>  getReducedMatrices(	const QVDirectedGraph< QList<QPointFMatching> > &pointLists,
                             const bool normalize,
                             const TGEA_decomposition_method decomposition_method,
@@ -149,6 +178,10 @@ QVDirectedGraph<QVMatrix>  getReducedMatrices(	const QVDirectedGraph< QList<QPoi
     //std::cout << "WARNING: 'getReducedMatrices' deprecated. Use functions 'getSquaredDLTMatrix' and 'getDLTMatrix' to obtain the reduced matrices, and 'globalEpipolarAdjustment2' to perform GEA optimization." << std::endl;
     QVDirectedGraph<QVMatrix> reducedMatricesGraph;
 
+    // View pairs whose reduced matrices are obtained with a single batched eigen-decomposition.
+    QList<QVGraphLink> batchedLinks;
+    QVector<double> batchedMtMs;
+
     // For each pair of views linked with point correspondences...
     foreach(QPoint p, pointLists.keys())
         {
@@ -157,9 +190,20 @@ QVDirectedGraph<QVMatrix>  getReducedMatrices(	const QVDirectedGraph< QList<QPoi
             continue;
 
         // Evaluate reduced coefficient matrix.
-        reducedMatricesGraph[p] = getReduced8PointsCoefficientsMatrix(pointList, decomposition_method, normalize, gsl, choleskyLambda);
+        if (decomposition_method == GEA_EIGEN_DECOMPOSITION and pointList.count() > 9)
+            {
+            const QVMatrix MtM = getTransposeProductOf8PointsCoefficientMatrix(pointList, normalize);
+            const double *dataMtM = MtM.getReadData();
+            for(int i = 0; i < 81; i++)
+                batchedMtMs << dataMtM[i];
+            batchedLinks << p;
+            }
+        else
+            reducedMatricesGraph[p] = getReduced8PointsCoefficientsMatrix(pointList, decomposition_method, normalize, gsl, choleskyLambda);
         }
 
+    storeBatchedEigenReducedMatrices(batchedLinks, batchedMtMs, reducedMatricesGraph);
+
     return reducedMatricesGraph;
     }
 
@@ -173,6 +217,10 @@ QVDirectedGraph<QVMatrix>  getReducedMatrices(	const QVDirectedGraph< QVector<QP
     //std::cout << "WARNING: 'getReducedMatrices' deprecated. Use functions 'getSquaredDLTMatrix' and 'getDLTMatrix' to obtain the reduced matrices, and 'globalEpipolarAdjustment2' to perform GEA optimization." << std::endl;
     QVDirectedGraph<QVMatrix> reducedMatricesGraph;
 
+    // View pairs whose reduced matrices are obtained with a single batched eigen-decomposition.
+    QList<QVGraphLink> batchedLinks;
+    QVector<double> batchedMtMs;
+
     // For each pair of views linked with point correspondences...
     foreach(QPoint p, pointLists.keys())
         {
@@ -181,9 +229,20 @@ QVDirectedGraph<QVMatrix>  getReducedMatrices(	const QVDirectedGraph< QVector<QP
             continue;
 
         // Evaluate reduced coefficient matrix.
-        reducedMatricesGraph[p] = getReduced8PointsCoefficientsMatrix(pointList.toList(), decomposition_method, normalize, gsl, choleskyLambda);
+        if (decomposition_method == GEA_EIGEN_DECOMPOSITION and pointList.count() > 9)
+            {
+            const QVMatrix MtM = getTransposeProductOf8PointsCoefficientMatrix(pointList, normalize);
+            const double *dataMtM = MtM.getReadData();
+            for(int i = 0; i < 81; i++)
+                batchedMtMs << dataMtM[i];
+            batchedLinks << p;
+            }
+        else
+            reducedMatricesGraph[p] = getReduced8PointsCoefficientsMatrix(pointList.toList(), decomposition_method, normalize, gsl, choleskyLambda);
         }
 
+    storeBatchedEigenReducedMatrices(batchedLinks, batchedMtMs, reducedMatricesGraph);
+
     return reducedMatricesGraph;
     }
 
@@ -405,6 +464,259 @@ QVDirectedGraph< QVector<QPointFMatching> > getPointMatchingsListsVec(const QLis
 
 // -----------------------------------------------------------------------------
 
+#ifndef DOXYGEN_IGNORE_THIS
+// Minimal number of GEA terms evaluated by each thread, and maximal degrees of freedom of each camera.
+#define GEA_MIN_TERMS_PER_THREAD	256
+#define GEA_MAX_DOF					7
+
+// Evaluates the matrix [J1|J2|e] for the GEA term of the views 'xIndex' and 'yIndex', where 'e' is the vector of
+// residuals for the term, and J1 and J2 are its jacobians for the parameters of each view. The number of rows of the
+// matrix equals the number of columns of the reduced matrix M, and its leading dimension is 'DOF*2+1'.
+static inline void evaluateGEATerm(const int DOF, const double *xData, const int xIndex, const int yIndex, const QVMatrix &reducedM, double *J1J2e)
+    {
+    // jacRows	Rows for the matrix [D1|D2|v] explained below.
+    // jacCols	Cols for the matrix [D1|D2|v] explained below.
+    const int	jacRows = 9,
+                jacCols = DOF*2+1;
+
+    // Evaluate partial jacobians (D1 and D2) and partial objective function vector (v).
+    // These elements are such:
+    //	[J1|J2|e] = M * [D1|D2|v]
+    double	D1D2v[9*(GEA_MAX_DOF*2+1)];
+
+    // Use a different function, depending on the parametrization used for the rotations.
+    #ifdef SO3_PARAMETRIZATION
+        so3EssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v, 1e-32);
+    #else
+        quaternionEssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v);
+    #endif
+
+    const int reducedMCols = reducedM.getCols();
+    Q_ASSERT(reducedM.getRows() == 9);
+    Q_ASSERT(reducedMCols <= 9);
+    Q_ASSERT(reducedMCols > 0);
+
+    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, reducedMCols, jacCols, jacRows, 1.0, reducedM.getReadData(), reducedMCols, D1D2v, jacCols, 0.0, J1J2e, jacCols);
+    }
+
+// Checks the order and the range of the indexes of the views for a GEA term.
+static void checkGEATermIndexes(const int xIndex, const int yIndex, const int numCameras)
+    {
+    if (xIndex > yIndex)
+        {
+        std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: provided invalid order for indexes 'x' and 'y'." << std::endl;
+        exit(0);
+        }
+
+    if (xIndex >= numCameras)
+        {
+        std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'x' out of bounds." << std::endl;
+        exit(0);
+        }
+
+    if (yIndex >= numCameras)
+        {
+        std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'y' out of bounds." << std::endl;
+        exit(0);
+        }
+    }
+
+// Number of contiguous ranges of GEA terms evaluated in parallel. It only depends on the number of terms and threads,
+// so the reduction of the partial sums obtained for each range is deterministic.
+static int geaTermRanges(const int numTerms)
+    {
+    return qMax(1, qMin(QThread::idealThreadCount(), numTerms / GEA_MIN_TERMS_PER_THREAD));
+    }
+
+// -----------------------------------------------------------------------------
+
+// A GEA term, for a pair of views related by a reduced measurement matrix.
+class GEATerm
+    {
+    public:
+        int xIndex, yIndex;
+        const QVMatrix *reducedM;
+        // Data of the off-diagonal Hessian block (xIndex, yIndex), or NULL if one of the views is fixed.
+        double *offDiagonalBlock;
+    };
+
+// Symbolic structure of the Hessian matrix of the GEA cost error. It contains the terms which involve a free camera,
+// and the Hessian matrix with every non-zero block already allocated. It is evaluated once, and each iteration of the
+// GEA optimization overwrites the contents of the blocks in place, without map lookups or block allocations.
+class GEAHessianStructure
+    {
+    public:
+        GEAHessianStructure(const int numCameras, const int DOF, const QVDirectedGraph<QVMatrix> &reducedMatricesGraph, const QVector<bool> &freeCamera):
+            numCameras(numCameras), DOF(DOF), freeCamera(freeCamera), hessian(numCameras, numCameras, DOF, DOF), diagonalBlocks(numCameras)
+            {
+            QMapIterator<QVGraphLink, QVMatrix> iterator(reducedMatricesGraph);
+            while (iterator.hasNext())
+                {
+                iterator.next();
+
+                const int	xIndex = iterator.key().x(),
+                            yIndex = iterator.key().y();
+
+                if (not freeCamera[xIndex] and not freeCamera[yIndex])
+                    continue;
+
+                checkGEATermIndexes(xIndex, yIndex, numCameras);
+
+                GEATerm term;
+                term.xIndex = xIndex;
+                term.yIndex = yIndex;
+                term.reducedM = &iterator.value();
+                term.offDiagonalBlock = NULL;
+                terms << term;
+
+                if (freeCamera[xIndex] and freeCamera[yIndex])
+                    hessian.setBlock(xIndex, yIndex, QVMatrix(DOF, DOF, 0.0));
+                }
+
+            // Diagonal blocks of the fixed cameras are zero, and become a diagonal matrix after adding the lambda value.
+            for(int i = 0; i < numCameras; i++)
+                hessian.setBlock(i, i, QVMatrix(DOF, DOF, 0.0));
+
+            // The pointers are obtained once every block was inserted, and the data of each block is not shared.
+            for(int i = 0; i < numCameras; i++)
+                diagonalBlocks[i] = hessian.getBlock(i, i).getWriteData();
+
+            for(int t = 0; t < terms.count(); t++)
+                if (freeCamera[terms[t].xIndex] and freeCamera[terms[t].yIndex])
+                    terms[t].offDiagonalBlock = hessian.getBlock(terms[t].xIndex, terms[t].yIndex).getWriteData();
+            }
+
+        const int numCameras, DOF;
+        const QVector<bool> freeCamera;
+        QVector<GEATerm> terms;
+        QVSparseBlockMatrix hessian;
+        QVector<double *> diagonalBlocks;
+    };
+
+// Evaluates the contributions of a range of terms to the Hessian matrix. Off-diagonal blocks are written directly,
+// because each term owns its block. Diagonal blocks and objective vector elements are accumulated in separate buffers
+// for each range.
+class GEAHessianAssemblyTask
+    {
+    public:
+        GEAHessianAssemblyTask(const GEAHessianStructure &structure, const double *xData, const int ranges):
+            structure(structure), xData(xData),
+            diagonalSize(structure.numCameras * structure.DOF * structure.DOF), objectiveSize(structure.numCameras * structure.DOF),
+            accumulators(ranges * (diagonalSize + objectiveSize), 0.0), errorFound(ranges, false)
+            { accumulatorsData = accumulators.data(); }
+
+        double *getDiagonals(const int range)		{ return accumulatorsData + range * (diagonalSize + objectiveSize); }
+        double *getObjectives(const int range)		{ return getDiagonals(range) + diagonalSize; }
+
+        void operator()(const int range, const int first, const int last)
+            {
+            const int	DOF = structure.DOF,
+                        jacCols = DOF*2+1;
+            const QVector<bool> &freeCamera = structure.freeCamera;
+            const GEATerm *terms = structure.terms.constData();
+            double	*diags = getDiagonals(range),
+                    *objectives = getObjectives(range);
+
+            for(int t = first; t < last; t++)
+                {
+                const GEATerm &term = terms[t];
+                const int	xIndex = term.xIndex,
+                            yIndex = term.yIndex,
+                            reducedMCols = term.reducedM->getCols();
+
+                double	J1J2e[9*(GEA_MAX_DOF*2+1)]; 	// [J1|J2|e]
+                evaluateGEATerm(DOF, xData, xIndex, yIndex, *term.reducedM, J1J2e);
+
+                #ifdef DEBUG
+                if (QVVector(reducedMCols*jacCols, J1J2e).containsNaN())
+                    {
+                    std::cout << "[globalEpipolarAdjustment] Error: NaN value found in Jacobian matrix for views (" << xIndex << ", " << yIndex << ")." << std::endl;
+                    errorFound[range] = true;
+                    }
+                #endif // DEBUG
+
+                if (freeCamera[xIndex])
+                    {
+                    cblas_dgemv(CblasRowMajor, CblasTrans, reducedMCols, DOF, 1.0, J1J2e, jacCols, J1J2e+jacCols-1, jacCols, 1.0, objectives + DOF*xIndex, 1);		// objective element 'x' += J1^T * e
+                    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e, jacCols, J1J2e, jacCols, 1.0, diags + xIndex*DOF*DOF, DOF);	// Diagonal block 'x' += J1^T*J1
+                    }
+
+                if (freeCamera[yIndex])
+                    {
+                    cblas_dgemv(CblasRowMajor, CblasTrans, reducedMCols, DOF, 1.0, J1J2e+DOF, jacCols, J1J2e+jacCols-1, jacCols, 1.0, objectives + DOF*yIndex, 1);	// objective element 'y' += J2^T * e
+                    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e+DOF, jacCols, J1J2e+DOF, jacCols, 1.0, diags + yIndex*DOF*DOF, DOF);	// Diagonal block 'y' += J2^T*J2
+                    }
+
+                if (term.offDiagonalBlock != NULL)
+                    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e, jacCols, J1J2e+DOF, jacCols, 0.0, term.offDiagonalBlock, DOF);	// Hessian block 'x,y' = J1^T*J2
+                }
+            }
+
+        const GEAHessianStructure &structure;
+        const double *xData;
+        const int diagonalSize, objectiveSize;
+        QVector<double> accumulators;
+        double *accumulatorsData;
+        QVector<bool> errorFound;
+    };
+
+// A GEA term of the Jacobian matrix, with the data of the blocks for both views in its block row.
+class GEAJacobianTerm
+    {
+    public:
+        int xIndex, yIndex;
+        const QVMatrix *reducedM;
+        double *J1Block, *J2Block, *residuals;
+    };
+
+class GEAJacobianAssemblyTask
+    {
+    public:
+        GEAJacobianAssemblyTask(const QVector<GEAJacobianTerm> &terms, const int DOF, const double *xData):
+            terms(terms), DOF(DOF), xData(xData), errorFound(false)
+            { }
+
+        void operator()(const int range, const int first, const int last)
+            {
+            Q_UNUSED(range);
+            const int jacCols = DOF*2+1;
+
+            for(int t = first; t < last; t++)
+                {
+                const GEAJacobianTerm &term = terms[t];
+                const int reducedMCols = term.reducedM->getCols();
+
+                double	J1J2e[9*(GEA_MAX_DOF*2+1)]; 	// [J1|J2|e]
+                evaluateGEATerm(DOF, xData, term.xIndex, term.yIndex, *term.reducedM, J1J2e);
+
+                #ifdef DEBUG
+                if (QVVector(reducedMCols*jacCols, J1J2e).containsNaN())
+                    {
+                    std::cout << "[evaluateGEAJacobianAndResidual] Error: NaN value found in block jacobian for views " << term.xIndex << ", " << term.yIndex << std::endl;
+                    errorFound = true;
+                    }
+                #endif
+
+                // Rows of the blocks and the residual vector above the number of columns of the reduced matrix are zero.
+                for(int i = 0; i < reducedMCols; i++)
+                    {
+                    for(int j = 0; j < DOF; j++)
+                        {
+                        term.J1Block[i*DOF + j] = J1J2e[i*jacCols + j];
+                        term.J2Block[i*DOF + j] = J1J2e[i*jacCols + DOF + j];
+                        }
+                    term.residuals[i] = J1J2e[i*jacCols + jacCols - 1];
+                    }
+                }
+            }
+
+        const QVector<GEAJacobianTerm> &terms;
+        const int DOF;
+        const double *xData;
+        bool errorFound;
+    };
+#endif // DOXYGEN_IGNORE_THIS
+
 // Thist function obtains the Jacobian matrix, and the residual vector
 // for the GEA cost error.
 // This is an internal function, used by 'incrementalGEA'.
@@ -428,9 +740,6 @@ bool evaluateGEAJacobianAndResidual(	// Number of cameras.
     estimatedJ = QVSparseBlockMatrix(numLinks, numCameras, 9, DOF);
     residuals = QVVector(numLinks*9, 0.0);
 
-    // Pointers to the data of the vectors 'x' and 'objectives'.
-    const double	*xData = x.constData();
-
     #ifdef DEBUG
     if (x.containsNaN())
         {
@@ -439,319 +748,89 @@ bool evaluateGEAJacobianAndResidual(	// Number of cameras.
         }
     #endif
 
-    // Loop 1. Evaluate the block-jacobians for each pair of views
-    // related by a reduced measurement matrix M.
-    int linkIndex = 0;
-    foreach(QVGraphLink link, links)
+    // Allocate the blocks of the Jacobian matrix, and look up the reduced matrices, before the parallel evaluation.
+    QVector<GEAJacobianTerm> terms(numLinks);
+    for(int linkIndex = 0; linkIndex < numLinks; linkIndex++)
         {
-        // Indexes for the pair of views in the adjacency graph.
-        const int	xIndex = link.x(),	// Index 'x' for the first camera.
-                yIndex = link.y();	// Index 'y' for the second camera.
-
-        // Sanity check.
-        if (xIndex > yIndex)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: provided invalid order for indexes 'x' and 'y'." << std::endl;
-            exit(0);
-            }
-
-        if (xIndex >= numCameras)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'x' out of bounds." << std::endl;
-            exit(0);
-            }
-
-        if (yIndex >= numCameras)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'y' out of bounds." << std::endl;
-            exit(0);
-            }
-
-        // jacRows	Rows for the matrix [D1|D2|v] explained below.
-        // jacCols	Cols for the matrix [D1|D2|v] explained below.
-        const int jacRows = 9, jacCols = DOF*2+1;
-
-        // Evaluate partial jacobians (D1 and D2) and partial objective function vector (v).
-        // These elements are such:
-        //	[J1|J2|e] = M * [D1|D2|v]
-        double	D1D2v[jacRows*jacCols];
-
-        // Use a different function, depending on the parametrization used for the rotations.
-        #ifdef SO3_PARAMETRIZATION
-            so3EssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v, 1e-32);
-        #else
-            quaternionEssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v);
-        #endif
+        GEAJacobianTerm &term = terms[linkIndex];
+        term.xIndex = links[linkIndex].x();
+        term.yIndex = links[linkIndex].y();
+        checkGEATermIndexes(term.xIndex, term.yIndex, numCameras);
 
-        // Get reduced matrix M for the pair of views 'x,y'
-        //const QVMatrix &reducedM = reducedMatricesGraph[index];
-        const QVMatrix &reducedM = reducedMatricesGraph.value(xIndex, yIndex);
-        const int reducedMCols = reducedM.getCols();
-
-        #ifdef DEBUG
-        if (reducedM.containsNaN())
+        const QMap<QVGraphLink, QVMatrix>::const_iterator reducedM = reducedMatricesGraph.constFind(links[linkIndex]);
+        if (reducedM == reducedMatricesGraph.constEnd())
             {
-            std::cout << "[evaluateGEAJacobianAndResidual] Error: NaN value found in reduced matrix for views " << xIndex << ", " << yIndex << std::endl;
+            std::cout << "[evaluateGEAJacobianAndResidual] Error: no reduced matrix for views " << term.xIndex << ", " << term.yIndex << std::endl;
             return false;
             }
-        #endif
+        term.reducedM = &reducedM.value();
+        estimatedJ.setBlock(linkIndex, term.xIndex, QVMatrix(9, DOF, 0.0));
+        estimatedJ.setBlock(linkIndex, term.yIndex, QVMatrix(9, DOF, 0.0));
+        }
 
-        // Get the matrix of jacobians and evaluation vector with the following operation:
-        //	[J1|J2|e] = M x [D1|D2|v]
-        //
-        double	J1J2e[jacRows*jacCols]; 	// [J1|J2|e]
-        cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, reducedMCols, jacCols, jacRows, 1.0, reducedM.getReadData(), reducedMCols, D1D2v, jacCols, 0.0, J1J2e, jacCols);
-        const QVMatrix mJ1J2e(jacRows, jacCols, J1J2e);
+    double *residualsData = residuals.data();
+    for(int linkIndex = 0; linkIndex < numLinks; linkIndex++)
+        {
+        GEAJacobianTerm &term = terms[linkIndex];
+        term.J1Block = estimatedJ.getBlock(linkIndex, term.xIndex).getWriteData();
+        term.J2Block = estimatedJ.getBlock(linkIndex, term.yIndex).getWriteData();
+        term.residuals = residualsData + linkIndex*9;
 
         #ifdef DEBUG
-        if (mJ1J2e.containsNaN())
+        if (term.reducedM->containsNaN())
             {
-            std::cout << "[evaluateGEAJacobianAndResidual] Error: NaN value found in block jacobian for views " << xIndex << ", " << yIndex << std::endl;
+            std::cout << "[evaluateGEAJacobianAndResidual] Error: NaN value found in reduced matrix for views " << term.xIndex << ", " << term.yIndex << std::endl;
             return false;
             }
         #endif
-
-        QVMatrix mJ1(9, DOF, 0.0), mJ2(9, DOF, 0.0);
-        QVVector r(9, 0.0);
-        for(int i = 0; i < reducedMCols; i++)
-            {
-            r[i] = mJ1J2e(i, DOF*2);
-            for(int j = 0; j < DOF; j++)
-                {
-                mJ1(i,j) = mJ1J2e(i,j);
-                mJ2(i,j) = mJ1J2e(i,DOF+j);
-                }
-            }
-
-        estimatedJ.setBlock(linkIndex, xIndex, mJ1);				// Hessian block 'x,y' = J1^T*J2
-        estimatedJ.setBlock(linkIndex, yIndex, mJ2);				// Hessian block 'x,y' = J1^T*J2
-        for(int i = 0; i < 9; i++)
-            residuals[linkIndex*9+i] = mJ1J2e(i, jacCols-1);
-
-        linkIndex++;
         }
 
-    return true;
+    GEAJacobianAssemblyTask task(terms, DOF, x.constData());
+    qvParallelRanges(task, numLinks, geaTermRanges(numLinks));
+
+    return not task.errorFound;
     }
 
 // Thist function obtains the Hessian matrix, and the objective vector
 // for the second level system in each Levenger-Marquardt iteration
 // of the GEA optimization.
+// The blocks of the Hessian matrix in the structure are overwritten with the new values.
 // This is an internal function, used by 'globalEpipolarAdjustment'.
 bool evaluateGEAHessianAndObjectiveVector(
-						// Number of cameras.
-                        const int numCameras,
-                        // Degrees of freedom for each camera (DOF): size of each camera in the vector 'x'.
-                        const int DOF,
-                        // Graph containing the reduced matrix, for each view link.
-                        const QVDirectedGraph<QVMatrix> &reducedMatricesGraph,
-                        // A vector of booleans, one for each camera, indicating whether it is fixed or not.
-						const QVector<bool> &freeCamera,
+                        // Symbolic structure of the Hessian matrix, for the reduced matrices graph and the free cameras.
+                        GEAHessianStructure &structure,
                         // Vector containing the components of the cameras.
                         const QVVector &x,
-                        // Overriden on output with the Hessian matrix.
-                        QVSparseBlockMatrix &estimatedH,
                         // Overriden on output with the objective vector.
                         QVVector &objectives
                         )
     {
 	Q_ASSERT_X(not x.containsNaN(),					"[evaluateGEAHessianAndObjectiveVector2]", "NaN value found in state vector");
 
-    // Clear objective vector and Hessian matrix.
-    objectives = QVVector(DOF*numCameras, 0.0);
-    estimatedH = QVSparseBlockMatrix(numCameras, numCameras, DOF, DOF);
-
-    // Block elements at the diagonal of the sparse matrix 'estimatedH' will not be updated in the loop 1.
-    // Instead, the values of these blocks will be accumulated on the vector 'diags'.
-    // They will be translated to the Hessian matrix diagonal block elements in a final step,
-    // posterior to the loop 1.
-    double diags[numCameras*DOF*DOF];
-    for(int i = 0; i < numCameras*DOF*DOF; i++)
-        diags[i] = 0.0;
-
-    // Pointers to the data of the vectors 'x' and 'objectives'.
-    const double	*xData = x.constData();
-    double			*objectivesData = objectives.data();
-
-    #ifdef DEBUG // -----------------------------------------------------------------
-    bool errorFound = false;
-	int jacobianEvaluations = 0;
-    #endif // ------------------------ DEBUG -----------------------------------------
+    const int	numTerms = structure.terms.count(),
+                ranges = geaTermRanges(numTerms);
 
     // Loop 1. Evaluate the block-jacobians for each pair of views
-    // related by a reduced measurement matrix M.
-	QMapIterator<QVGraphLink, QVMatrix> iterator(reducedMatricesGraph);
-	while (iterator.hasNext())
-		{
-		iterator.next();
-
-        // Indexes for the pair of views in the adjacency graph.
-        const int	xIndex = iterator.key().x(),	// Index 'x' for the first camera.
-               		yIndex = iterator.key().y();	// Index 'y' for the second camera.
-
-		if (not freeCamera[xIndex] and not freeCamera[yIndex])
-			continue;
-
-        // Sanity check.
-        if (xIndex > yIndex)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: provided invalid order for indexes 'x' and 'y'." << std::endl;
-            exit(0);
-            }
-
-        if (xIndex >= numCameras)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'x' out of bounds." << std::endl;
-            exit(0);
-            }
-
-        if (yIndex >= numCameras)
-            {
-            std::cout << "[evaluateGEAHessianAndObjectiveVector] Error: malformed coefficient matrices graph: index 'y' out of bounds." << std::endl;
-            exit(0);
-            }
-
-        // Main data elements:
-        //	M	Reduced coefficient matrix.
-        //	e	Vectorization of essential matrix E.
-        //	J1	Jacobian of vector e, for the components of the first camera.
-        //	J2	Jacobian of vector e, for the components of the second camera.
-        //
-        QVMatrix J1J2(DOF,DOF);
-        double temp1[DOF], temp2[DOF];
-        double J1J1Data[DOF*DOF], J2J2Data[DOF*DOF];
-
-        // jacRows	Rows for the matrix [D1|D2|v] explained below.
-        // jacCols	Cols for the matrix [D1|D2|v] explained below.
-        const int	jacRows = 9,
-          		    jacCols = DOF*2+1;
-
-        // Evaluate partial jacobians (D1 and D2) and partial objective function vector (v).
-        // These elements are such:
-        //	J1 = M * D1
-        //	J2 = M * D2
-        //	e = M * v
-        //
-        double	D1D2v[jacRows*jacCols];
-
-        // Use a different function, depending on the parametrization used for the rotations.
-        #ifdef SO3_PARAMETRIZATION
-            so3EssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v, 1e-32);
-        #else
-            quaternionEssentialEvaluation(xData + DOF*xIndex, xData + DOF*yIndex, D1D2v);
-        #endif
-
-        // Get reduced matrix M for the pair of views 'x,y'
-        //const QVMatrix &reducedM = reducedMatricesGraph[index];
-        const QVMatrix &reducedM = iterator.value();
-        const int reducedMCols = reducedM.getCols();
-		Q_ASSERT(reducedM.getRows() == 9);
-		Q_ASSERT(reducedM.getCols() <= 9);
-		Q_ASSERT(reducedM.getCols() > 0);
-
-        // Get the matrix of jacobians and evaluation vector with the following operation:
-        //	[J1|J2|e] = M x [D1|D2|v]
-        //
-        double	J1J2e[jacRows*jacCols]; 	// [J1|J2|e]
-        cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, reducedMCols, jacCols, jacRows, 1.0, reducedM.getReadData(), reducedMCols, D1D2v, jacCols, 0.0, J1J2e, jacCols);
-
-		if (freeCamera[xIndex])
-			{
-	        // Update elements of the objective vector
-		    cblas_dgemv(CblasRowMajor, CblasTrans, reducedMCols, DOF, 1.0, J1J2e, jacCols, J1J2e+jacCols-1, jacCols, 0.0, temp1, 1);	// J1^T * e
-		    cblas_daxpy(DOF, 1.0, temp1, 1, objectivesData + DOF*xIndex, 1);	// objective element 'x' += J1^T * e
-	        // Update diagonal block (xIndex, xIndex) of the Hessian matrix.
-			//std::cout << " A2 " << std::endl;
-		    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e,	jacCols, J1J2e, jacCols, 0.0, J1J1Data, DOF);			// J1^T * J1
-			//std::cout << " A3 " << std::endl;
-		    cblas_daxpy(DOF*DOF, 1.0, J1J1Data, 1, diags + xIndex*DOF*DOF, 1);	// Diagonal block 'x' += J1^T*J1
-			}
-
-		if (freeCamera[yIndex])
-			{
-	        // Update elements of the objective vector.
-		    cblas_dgemv(CblasRowMajor, CblasTrans, reducedMCols, DOF, 1.0, J1J2e+DOF, jacCols, J1J2e+jacCols-1, jacCols, 0.0, temp2, 1);	// J2^T * e
-		    cblas_daxpy(DOF, 1.0, temp2, 1, objectivesData + DOF*yIndex, 1);	// objective element 'y' += J2^T * e
-	        // Update diagonal block (yIndex, yIndex) of the Hessian matrix.
-			//std::cout << " A4 " << std::endl;
-		    cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e+DOF,	jacCols, J1J2e+DOF,	jacCols, 0.0, J2J2Data, DOF);			// J2^T * J2
-			//std::cout << " A5 " << std::endl;
-		    cblas_daxpy(DOF*DOF, 1.0, J2J2Data, 1, diags + yIndex*DOF*DOF, 1);	// Diagonal block 'y' += J2^T*J2
-			}
-
-		if (freeCamera[xIndex] and freeCamera[yIndex])
-			{
-	        // Update off-diagonal block (xIndex, yIndex) of the Hessian matrix.
-			//std::cout << " A6 " << std::endl;
-	        cblas_dgemm(CblasRowMajor, CblasTrans, CblasNoTrans, DOF, DOF, reducedMCols, 1.0, J1J2e, 	jacCols, J1J2e+DOF, 	jacCols, 0.0, J1J2.getWriteData(), DOF);	// J1^T * J2
-			//std::cout << " A7 " << std::endl;
-	        estimatedH.setBlock(xIndex, yIndex, J1J2);				// Hessian block 'x,y' = J1^T*J2
-			}
-
-        #ifdef DEBUG // -----------------------------------------------------------------
-		jacobianEvaluations++;
-
-        // The following lines check for NaN values in the Jacobian matrices.
-
-        // A NaN value can appear at:
-        //	- The input reduced matrix.
-        //	- The input view pose parameters.
-        //	- The estimated matrix 'D1D2v', containing the Jacobian matrices and the objective vector.
-       /* if (QVVector(DOF*DOF, xData + DOF*xIndex).containsNaN())
-            {
-            errorFound = true;
-            std::cout << "[globalEpipolarAdjustment] Error: NaN value found in the vector for view pose " << xIndex << std::endl;
-            }
-
-        if (QVVector(DOF*DOF, xData + DOF*yIndex).containsNaN())
-            {
-            errorFound = true;
-            std::cout << "[globalEpipolarAdjustment] Error: NaN value found in the vector for view pose " << yIndex << std::endl;
-            }*/
-
-        // Do not check for NaN values in the 'D1D2v' matrix if a NaN value was found at the view pose vectors.
-        if (QVVector(jacRows*jacCols, D1D2v).containsNaN() and not errorFound)
-            {
-            errorFound = true;
-
-            std::cout << "[globalEpipolarAdjustment] Error: NaN value found in Jacobian matrix for views (" << xIndex << ", " << yIndex << ")." << std::endl;
-
-            // Try a simple diagnose of the reason why a NaN value was found at matrix 'D1D2v'.
-            const QVVector view1(DOF, xData + DOF*xIndex), view2(DOF, xData + DOF*yIndex);
-
-            if (view1 == view2)
-                	std::cout << "[globalEpipolarAdjustment] Reason: poses for views " << xIndex << " and " << yIndex << " are numerically EQUAL." << std::endl;
-            else	{
-		            std::cout << "[globalEpipolarAdjustment] View 1 pose vector:" << std::endl << QVEuclideanMapping3(view1).toRotationTranslationMatrix() << std::endl;
-		            std::cout << "[globalEpipolarAdjustment] View 2 pose vector:" << std::endl << QVEuclideanMapping3(view2).toRotationTranslationMatrix() << std::endl;
-		            std::cout << "[globalEpipolarAdjustment] Values for Jacobian matrix:" << std::endl << QVVector(jacRows*jacCols, D1D2v) << std::endl;
-		            }
-            }
-
-        if (reducedM.containsNaN())
-            {
-            errorFound = true;
-            std::cout << "[globalEpipolarAdjustment] Error: NaN value found in reduced matrix for views (" << xIndex << ", " << yIndex << ")." << std::endl;
-            }
-
-        // If an error was found, try a diagnose in some cases.
-        if (errorFound)
-            // Error diagnose.
-            break;
-        #endif // ------------------------ DEBUG -----------------------------------------
-        }
-
-    // Set the diagonal elements of the Hessian matrix corresponding to free cameras, from the vector 'diags'.
-    for(int i = 0; i < numCameras; i++)
-        {
-        const QVMatrix diagMatrix(DOF, DOF, diags + i*DOF*DOF);
-        estimatedH.setBlock(i,i, diagMatrix);
-        }
+    // related by a reduced measurement matrix M, in parallel.
+    GEAHessianAssemblyTask task(structure, x.constData(), ranges);
+    qvParallelRanges(task, numTerms, ranges);
+
+    // Add the partial sums of each range, in order, to the first one.
+    double	*diags = task.getDiagonals(0),
+            *objectivesData = task.getObjectives(0);
+    for(int r = 1; r < ranges; r++)
+        cblas_daxpy(task.diagonalSize + task.objectiveSize, 1.0, task.getDiagonals(r), 1, diags, 1);
+
+    // Set the diagonal blocks of the Hessian matrix, and the objective vector.
+    const int DOF = structure.DOF;
+    for(int i = 0; i < structure.numCameras; i++)
+        cblas_dcopy(DOF*DOF, diags + i*DOF*DOF, 1, structure.diagonalBlocks[i], 1);
+    objectives = QVVector(task.objectiveSize, objectivesData);
 
     #ifdef DEBUG // -----------------------------------------------------------------
-   // std::cout << "[globalEpipolarAdjustment] Number of Jacobian evaluations = " << jacobianEvaluations << std::endl;
-	if (errorFound)
-		return false;
+    for(int r = 0; r < ranges; r++)
+        if (task.errorFound[r])
+            return false;
     #endif // ------------------------ DEBUG -----------------------------------------
 
     return true;
@@ -789,60 +868,36 @@ QList<QVCameraPose> globalEpipolarAdjustment(
 	}
 
 int gea_time_eval = 0, gea_time_solve = 0;
-QList<QVCameraPose> globalEpipolarAdjustment(
-						const int numIterations,
-                        const QList<QVCameraPose> &initialCameraPoses,
-                        const QVDirectedGraph<QVMatrix> &reducedMatricesGraph,
-						const QVector<bool> &freeCameras,
-                        const double lambda,
-                        const bool adaptativeLambda,
-						const TQVSparseSolve_Method solveMethod,
-                        const int secondLevelIterations
-                        )
-    {
-	#ifdef DEBUG
-    std::cout << "[globalEpipolarAdjustment] Number of terms in the GEA cost error function = " << reducedMatricesGraph.count() << std::endl;
-	#endif // DEBUG
-
-    const int numCameras = initialCameraPoses.count();
-
-    // Degrees of freedom for each camera (DOF): size of each camera in the vector 'x' obtained below.
-    // Depending on the parametrization of the rotations in the camera poses, this value will be 3+3
-    // (for a so3 rotation vector) or 4+3 (for quaternion rotation parametrization):
-    #ifdef SO3_PARAMETRIZATION
-        const int DOF = 6;
-    #else
-        const int DOF = 7;
-    #endif
 
+// Applies the Levenberg-Marquardt iterations of the GEA optimization on the vector 'x', containing the
+// parameters of the camera poses. On input, vector 'xInc' contains the initial approximation to the increment
+// for the iterative sparse solvers. It is overwritten with the increment of the last iteration.
+// This is an internal function, used by 'globalEpipolarAdjustment' and 'QVIncrementalGEA'.
+static void optimizeGEAParameters(	const int numIterations,
+                                    const int DOF,
+                                    const QVDirectedGraph<QVMatrix> &reducedMatricesGraph,
+                                    const QVector<bool> &freeCameras,
+                                    const double lambda,
+                                    const bool adaptativeLambda,
+                                    const TQVSparseSolve_Method solveMethod,
+                                    const int secondLevelIterations,
+                                    QVVector &x,
+                                    QVVector &xInc
+                                    )
+    {
+    const int numCameras = freeCameras.count();
     QTime time;
 
-    // Create vector 'x', containing the coordinates of each camera pose (orientations and centers) in the corresponding parametrization.
-    // @note Esta parte con el data-set dubrovnik, y números de vistas de 88 o más, se lleva un tiempo significativamente alto.
-    time.start();
-    QVVector x;
-    foreach(QVCameraPose cameraPose, initialCameraPoses)
-        #ifdef SO3_PARAMETRIZATION
-            x << lnSO3(cameraPose.getOrientation()) << cameraPose.getCenter();
-        #else
-            x << QVVector(cameraPose);
-        #endif
-
-    // Variables to accumulate the time spend on the main stages of the function.
-    gea_time_eval = 0;
-    gea_time_solve = 0;
+    // The structure of the Hessian matrix is the same for every iteration. Its blocks are overwritten at each evaluation.
+    GEAHessianStructure structure(numCameras, DOF, reducedMatricesGraph, freeCameras);
+    QVSparseBlockMatrix &H = structure.hessian;
 
-    // Main optimization loop.
-    // Apply for a fixed number of iterations.
-    // In the near future: also stop when a maximal residual error is reached.
-    QVVector xInc(numCameras * DOF, 0.0);
     for(int iteration = 0; iteration < numIterations; iteration++)
         {
         // Evaluate function and Hessian estimation.
         time.start();
-        QVSparseBlockMatrix	H;
         QVVector b;
-        if ( not evaluateGEAHessianAndObjectiveVector(numCameras, DOF, reducedMatricesGraph, freeCameras, x, H, b) )
+        if ( not evaluateGEAHessianAndObjectiveVector(structure, x, b) )
             {
             std::cout << "[globalEpipolarAdjustment] Stopping optimization at iteration " << iteration << std::endl;
             break;
@@ -862,7 +917,7 @@ QList<QVCameraPose> globalEpipolarAdjustment(
         gea_time_solve += time.elapsed();
 
         // Update vector 'x'
-        x = x - xInc;
+        x -= qvLazy(xInc);
 
         #ifdef DEBUG // -----------------------------------------------------------------
 		if (iteration == 0)
@@ -907,6 +962,56 @@ QList<QVCameraPose> globalEpipolarAdjustment(
 
         #endif // ------------------------ DEBUG -----------------------------------------
         }
+    }
+
+QList<QVCameraPose> globalEpipolarAdjustment(
+						const int numIterations,
+                        const QList<QVCameraPose> &initialCameraPoses,
+                        const QVDirectedGraph<QVMatrix> &reducedMatricesGraph,
+						const QVector<bool> &freeCameras,
+                        const double lambda,
+                        const bool adaptativeLambda,
+						const TQVSparseSolve_Method solveMethod,
+                        const int secondLevelIterations
+                        )
+    {
+	#ifdef DEBUG
+    std::cout << "[globalEpipolarAdjustment] Number of terms in the GEA cost error function = " << reducedMatricesGraph.count() << std::endl;
+	#endif // DEBUG
+
+    const int numCameras = initialCameraPoses.count();
+
+    // Degrees of freedom for each camera (DOF): size of each camera in the vector 'x' obtained below.
+    // Depending on the parametrization of the rotations in the camera poses, this value will be 3+3
+    // (for a so3 rotation vector) or 4+3 (for quaternion rotation parametrization):
+    #ifdef SO3_PARAMETRIZATION
+        const int DOF = 6;
+    #else
+        const int DOF = 7;
+    #endif
+
+    QTime time;
+
+    // Create vector 'x', containing the coordinates of each camera pose (orientations and centers) in the corresponding parametrization.
+    // @note Esta parte con el data-set dubrovnik, y números de vistas de 88 o más, se lleva un tiempo significativamente alto.
+    time.start();
+    QVVector x;
+    foreach(QVCameraPose cameraPose, initialCameraPoses)
+        #ifdef SO3_PARAMETRIZATION
+            x << lnSO3(cameraPose.getOrientation()) << cameraPose.getCenter();
+        #else
+            x << QVVector(cameraPose);
+        #endif
+
+    // Variables to accumulate the time spend on the main stages of the function.
+    gea_time_eval = 0;
+    gea_time_solve = 0;
+
+    // Main optimization loop.
+    // Apply for a fixed number of iterations.
+    // In the near future: also stop when a maximal residual error is reached.
+    QVVector xInc(numCameras * DOF, 0.0);
+    optimizeGEAParameters(numIterations, DOF, reducedMatricesGraph, freeCameras, lambda, adaptativeLambda, solveMethod, secondLevelIterations, x, xInc);
 
     // Compose the list of optimized camera poses, from the vector 'x'.
     QList<QVCameraPose> optimizedCameraPoses;
@@ -1040,7 +1145,7 @@ QList<QVCameraPose> incrementalGEA(	const int numIterations,
             }
 
         // Update vector 'x'
-        x = x - xInc;
+        x -= qvLazy(xInc);
         }
 
     #ifdef DEBUG
@@ -1060,3 +1165,171 @@ QList<QVCameraPose> incrementalGEA(	const int numIterations,
     return optimizedCameraPoses;
     }
 
+// --------------------------------------------------------------------------------------
+
+QVIncrementalGEA::QVIncrementalGEA(	const int windowSize,
+                                    const int anchorSize,
+                                    const double lambda,
+                                    const bool adaptativeLambda,
+                                    const TQVSparseSolve_Method solveMethod,
+                                    const int secondLevelIterations,
+                                    const TGEA_decomposition_method decompositionMethod,
+                                    const bool normalize,
+                                    const int minPointCorrespondences
+                                    ):
+    windowSize(MAX(1, windowSize)), anchorSize(MAX(0, anchorSize)), lambda(lambda), adaptativeLambda(adaptativeLambda),
+    solveMethod(solveMethod), secondLevelIterations(secondLevelIterations), decompositionMethod(decompositionMethod),
+    normalize(normalize), minPointCorrespondences(minPointCorrespondences), lastOptimizationTime(0)
+    { }
+
+// The first view is always fixed, to remove the gauge freedom of the reconstruction.
+int QVIncrementalGEA::getFirstFreeView() const
+    {
+    return MAX(1, cameraPoses.count() - windowSize);
+    }
+
+int QVIncrementalGEA::getFirstAnchorView() const
+    {
+    return MAX(0, getFirstFreeView() - anchorSize);
+    }
+
+// Removes the links between fixed views, and the links with views before the anchor range. Their reduced
+// matrices are not needed anymore, because the window only moves forward.
+void QVIncrementalGEA::removeFixedLinks()
+    {
+    const int	firstFreeView = getFirstFreeView(),
+                firstAnchorView = getFirstAnchorView();
+
+    QMutableMapIterator<QVGraphLink, QVMatrix> iterator(reducedMatrices);
+    while (iterator.hasNext())
+        {
+        iterator.next();
+        if (iterator.key().y() < firstFreeView or iterator.key().x() < firstAnchorView)
+            iterator.remove();
+        }
+
+    foreach(int view, increments.keys())
+        if (view < firstFreeView)
+            increments.remove(view);
+    }
+
+int QVIncrementalGEA::addView(const QVCameraPose &cameraPose, const QHash<int, QList<QPointFMatching> > &matchings)
+    {
+    const int view = cameraPoses.count();
+    cameraPoses << cameraPose;
+    removeFixedLinks();
+
+    // Only the reduced matrices for the links of the new view are evaluated.
+    QHashIterator<int, QList<QPointFMatching> > iterator(matchings);
+    while (iterator.hasNext())
+        {
+        iterator.next();
+        setMatchings(iterator.key(), view, iterator.value());
+        }
+
+    return view;
+    }
+
+bool QVIncrementalGEA::setMatchings(const int previousView, const int view, const QList<QPointFMatching> &matchings)
+    {
+    if (previousView < 0 or previousView >= view or view >= cameraPoses.count())
+        {
+        std::cout << "[QVIncrementalGEA::setMatchings] Error: invalid indexes for views " << previousView << ", " << view << "." << std::endl;
+        return false;
+        }
+
+    const QVGraphLink link(previousView, view);
+    if (view < getFirstFreeView() or previousView < getFirstAnchorView() or matchings.count() < minPointCorrespondences)
+        {
+        reducedMatrices.remove(link);
+        return false;
+        }
+
+    reducedMatrices.insert(link, getReduced8PointsCoefficientsMatrix(matchings, decompositionMethod, normalize));
+    return true;
+    }
+
+void QVIncrementalGEA::optimize(const int numIterations)
+    {
+    QTime time;
+    time.start();
+
+    // Degrees of freedom for each camera (DOF), depending on the parametrization of the rotations in the camera poses.
+    #ifdef SO3_PARAMETRIZATION
+        const int DOF = 6;
+    #else
+        const int DOF = 7;
+    #endif
+
+    const int	numViews = cameraPoses.count(),
+                firstFreeView = getFirstFreeView(),
+                firstAnchorView = getFirstAnchorView();
+
+    if (numViews <= firstFreeView or reducedMatrices.isEmpty())
+        {
+        lastOptimizationTime = time.elapsed();
+        return;
+        }
+
+    // The optimization includes the window views, and the anchor views linked to them. Their indexes in the
+    // optimization keep the order of the views, so each link keeps its first view before the second one.
+    QVector<bool> includedViews(numViews - firstAnchorView, false);
+    for(int view = firstFreeView; view < numViews; view++)
+        includedViews[view - firstAnchorView] = true;
+    foreach(QVGraphLink link, reducedMatrices.keys())
+        includedViews[link.x() - firstAnchorView] = true;
+
+    QVector<int> localIndexes(numViews - firstAnchorView, -1);
+    QList<int> views;
+    for(int i = 0; i < includedViews.count(); i++)
+        if (includedViews[i])
+            {
+            localIndexes[i] = views.count();
+            views << firstAnchorView + i;
+            }
+
+    // Create vector 'x', containing the coordinates of the included camera poses, and the initial increment for the
+    // second level system, from the last increment obtained for each window view.
+    const int numCameras = views.count();
+    QVector<bool> freeCameras(numCameras, false);
+    QVVector x, xInc;
+    for(int i = 0; i < numCameras; i++)
+        {
+        const QVCameraPose &cameraPose = cameraPoses[views[i]];
+        #ifdef SO3_PARAMETRIZATION
+            x << lnSO3(cameraPose.getOrientation()) << cameraPose.getCenter();
+        #else
+            x << QVVector(cameraPose);
+        #endif
+
+        freeCameras[i] = views[i] >= firstFreeView;
+        xInc << increments.value(views[i], QVVector(DOF, 0.0));
+        }
+
+    QVDirectedGraph<QVMatrix> localReducedMatrices;
+    QMapIterator<QVGraphLink, QVMatrix> iterator(reducedMatrices);
+    while (iterator.hasNext())
+        {
+        iterator.next();
+        localReducedMatrices.insert(localIndexes[iterator.key().x() - firstAnchorView], localIndexes[iterator.key().y() - firstAnchorView], iterator.value());
+        }
+
+    gea_time_eval = 0;
+    gea_time_solve = 0;
+    optimizeGEAParameters(numIterations, DOF, localReducedMatrices, freeCameras, lambda, adaptativeLambda, solveMethod, secondLevelIterations, x, xInc);
+
+    // Update the poses of the window views, and store their increments.
+    for(int i = 0; i < numCameras; i++)
+        if (freeCameras[i])
+            {
+            #ifdef SO3_PARAMETRIZATION
+                cameraPoses[views[i]] = QVCameraPose(QVQuaternion(expSO3(QV3DPointF(x.mid(DOF*i, 3)))), QV3DPointF(x.mid(DOF*i+3,3)));
+            #else
+                cameraPoses[views[i]] = QVCameraPose(QVQuaternion(x.mid(DOF*i, 4)), QV3DPointF(x.mid(DOF*i+4,3)) );
+            #endif
+            increments[views[i]] = xInc.mid(DOF*i, DOF);
+            }
+
+    lastOptimizationTime = time.elapsed();
+    }
+
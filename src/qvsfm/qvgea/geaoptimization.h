@@ -131,6 +131,120 @@ QList<QVCameraPose> incrementalGEA(	const int numIterations,
                     const int secondLevelIterations = 10
                     );
 
+/*!
+@class QVIncrementalGEA qvsfm/qvgea/geaoptimization.h
+@brief Sliding-window GEA refinement for real-time camera tracking.
+
+This class keeps a GEA optimization session for a growing sequence of views. Unlike @ref incrementalGEA, it does not
+evaluate the reduced matrices of the whole reconstruction, or solve the GEA system for every view on each call.
+Only the last views of the sequence (the <i>window</i>) are optimized. When a new view is added, the reduced matrices are
+evaluated only for its links with the previous views, and the views leaving the window are fixed at their current pose.
+
+The links between a window view and a fixed view (an <i>anchor</i>) remain in the cost error, constraining the window
+views to the rest of the reconstruction. Only the views in a limited number of anchors before the window are used, and the
+links between fixed views are removed from the session. Thus, the time spent by each call to @ref optimize is bounded by the
+sizes of the window and the anchor range, and not by the size of the reconstruction:
+
+@code
+QVIncrementalGEA gea(10, 10);
+[...]
+// Processing of each new frame, inside a QVProcessingBlock:
+QHash<int, QList<QPointFMatching> > matchings;
+[...] // Matchings of the new view with some of the previous views, with the points of the previous view as first points.
+gea.addView(initialPose, matchings);
+gea.optimize(3);
+const QVCameraPose pose = gea.getCameraPose(gea.getNumViews()-1);
+@endcode
+
+The increment obtained for each window view is stored between calls, and is used as the initial solution for the iterative
+sparse solvers (@ref QV_SCG, @ref QV_BJPCG and @ref QV_BCPCG) in the next call. These solvers also bound the time of the
+second level system resolution, through the number of second level iterations.
+
+@ingroup qvsfm
+*/
+class QVIncrementalGEA
+    {
+    public:
+        /// @brief Creates an empty GEA session.
+        ///
+        /// @param windowSize Number of views optimized. The optimized views are the last ones added to the session.
+        /// @param anchorSize Number of fixed views before the window whose links with the window views are used.
+        /// @param lambda Lambda parameter to increase the diagonal of the Hessian matrix.
+        /// @param adaptativeLambda If true, the lambda value is scaled with the mean value of the trace of the Hessian matrix.
+        /// @param solveMethod Method to solve the second level system.
+        /// @param secondLevelIterations Number of iterations in the second level resolution of the linear system.
+        /// @param decompositionMethod Decomposition used to obtain the reduced matrices.
+        /// @param normalize Perform pre-normalization of the point matchings.
+        /// @param minPointCorrespondences Links with a number of point correspondences below this value are ignored.
+        QVIncrementalGEA(	const int windowSize = 10,
+                            const int anchorSize = 10,
+                            const double lambda = 1e-3,
+                            const bool adaptativeLambda = true,
+                            const TQVSparseSolve_Method solveMethod = QV_BJPCG,
+                            const int secondLevelIterations = 10,
+                            const TGEA_decomposition_method decompositionMethod = GEA_CHOLESKY_DECOMPOSITION,
+                            const bool normalize = true,
+                            const int minPointCorrespondences = 9
+                            );
+
+        /// @brief Adds a new view at the end of the sequence.
+        ///
+        /// The views leaving the window are fixed, and the links which do not involve a window view are removed.
+        /// @param cameraPose Initial pose for the new view.
+        /// @param matchings Point matchings of the new view with previous views, indexed by the index of the previous view.
+        /// The first point of each matching corresponds to the previous view, and the second to the new view.
+        /// @returns the index of the new view.
+        int addView(const QVCameraPose &cameraPose, const QHash<int, QList<QPointFMatching> > &matchings);
+
+        /// @brief Replaces the point matchings between two views.
+        ///
+        /// The reduced matrix of the link is evaluated again. Links with a view outside the window and the anchor range are ignored.
+        /// @returns true if the link is included in the session.
+        bool setMatchings(const int previousView, const int view, const QList<QPointFMatching> &matchings);
+
+        /// @brief Optimizes the poses of the window views.
+        ///
+        /// @param numIterations Number of iterations of the GEA optimization.
+        void optimize(const int numIterations = 1);
+
+        /// @brief Number of views added to the session.
+        int getNumViews() const								{ return cameraPoses.count(); }
+
+        /// @brief Index of the first view optimized by the session.
+        int getFirstFreeView() const;
+
+        /// @brief Current pose of a view.
+        QVCameraPose getCameraPose(const int view) const		{ return cameraPoses[view]; }
+
+        /// @brief Current poses of every view added to the session.
+        const QList<QVCameraPose> & getCameraPoses() const	{ return cameraPoses; }
+
+        /// @brief Reduced matrices of the links between a window view and a window or anchor view.
+        const QVDirectedGraph<QVMatrix> & getReducedMatrices() const	{ return reducedMatrices; }
+
+        /// @brief Time spent in milliseconds by the last call to @ref optimize.
+        int getLastOptimizationTime() const					{ return lastOptimizationTime; }
+
+    private:
+        const int windowSize, anchorSize;
+        const double lambda;
+        const bool adaptativeLambda;
+        const TQVSparseSolve_Method solveMethod;
+        const int secondLevelIterations;
+        const TGEA_decomposition_method decompositionMethod;
+        const bool normalize;
+        const int minPointCorrespondences;
+
+        QList<QVCameraPose> cameraPoses;
+        QVDirectedGraph<QVMatrix> reducedMatrices;
+        // Last increment obtained for each window view.
+        QHash<int, QVVector> increments;
+        int lastOptimizationTime;
+
+        int getFirstAnchorView() const;
+        void removeFixedLinks();
+    };
+
 /*!
 @brief Gets the reduced matrices for a reconstruction.
 